@@ -4,41 +4,1564 @@
 #include <cstring> // strcpy, strcmp vb. için
 #include <sys/stat.h> // Dosya varlığını kontrol etmek için (fs_init)
 #include <unistd.h> // ftruncate için (fs_init, fs_format)
+#include <fcntl.h> // open için (toplu blok taşıma)
 #include <vector> // read_all_file_info için
+#include <limits> // std::numeric_limits için (taşma kontrolleri)
+#include <algorithm> // std::sort için (fs_readdir)
+#include <cstdlib> // std::abs için (yerleşim ipuçları)
+#include <set> // Buddy allocator boş listeleri için
+#include <map> // Gecikmeli tahsis tamponu için
+#include <mutex> // Tahsis grubu kilitleri için
+#include <cstddef> // offsetof için (süperblok alanlarının kısmi yazımı)
+#include <thread> // Arka plan birleştirme iş parçacığı için
+#include <condition_variable>
+#include <chrono> // Birleştirme adımlarının süre bütçesi için
+#include <cstdio> // snprintf için (parçalanma raporunun JSON çıktısı)
+#include <atomic> // Kilitsiz bitmap için
+#include <deque> // Asenkron G/Ç iş kuyruğu için
+#include <memory> // std::shared_ptr (asenkron işlerin packaged_task'ı)
+#include <cerrno>
+#include <sys/mman.h> // io_uring halkalarının eşlenmesi için
+#include <sys/syscall.h>
+#include <sys/uio.h> // struct iovec (kayıtlı tampon)
+#include <linux/io_uring.h>
+
+// ------------- EŞZAMANLILIK (CONCURRENCY) -------------
+// Kilit hiyerarşisi; kilitler her zaman bu sırayla alınır:
+//   1. Cilt kilidi (volume_lock): İsim alanını (oluştur/sil/taşı/dizin) veya tüm diski ilgilendiren işlemler
+//      (format, birleştirme, ls, sync, yedekleme...) özel tutar. Tek dosyaya dokunan işlemler paylaşımlı tutar;
+//      onlar çalışırken FileInfo indeksleri ve dizin tabloları değişmez.
+//   2. Dosya kilitleri (file_locks, FileInfo indeksine göre): Okuyucular (fs_read, fs_size, fs_cat...) paylaşımlı,
+//      yazanlar (fs_write, fs_append, fs_truncate, fs_fallocate...) özel tutar. Aynı veya farklı dosyaların
+//      okuyucuları birbirini beklemez. Birden fazla dosya kilitlenecekse indeks sırasıyla alınır.
+//   3. Tahsis kilidi (allocator_lock): Paylaşılan kuyruk blokları, buddy listeleri ve bitmap'in tamamını tarayan
+//      tahsisler. Kuyruğa dokunan yazma yolları bu kilidi FileInfo'yu yazana kadar tutar, çünkü kuyruk yuvası
+//      seçimi diğer dosyaların FileInfo'larına bakar. Bitmap modundaki küçük tahsisler ve serbest bırakmalar
+//      almaz (bkz. ATOMİK BİTMAP). Okuyucular almaz.
+//   4. İç kilitler: grup kilitleri, space_stats_lock, delayed_write_lock.
+// Cilt kilidini özel tutan iş parçacığı dosya kilitlerini almaz, zaten diskte tek başınadır. Genel fonksiyonlar
+// birbirini çağırdığı için tutulan kilitler iş parçacığı başına izlenir; iç içe çağrılar kilidi yeniden almaz.
+// Paylaşımlıdan özele yükseltme desteklenmez (iki iş parçacığı aynı anda denerse ikisi de sonsuza dek bekler):
+// istek reddedilir, hata loglanır ve çağrı FS_ERROR_LOCK_UPGRADE ile (void fonksiyonlarda hiçbir şey yapmadan)
+// biter. Özel erişim gerektirebilecek iç içe çağrılar kilidi baştan özel almalıdır.
+
+// Okuyucu/yazıcı kilidi (C++11'de std::shared_mutex yok). Yazıcı önceliklidir: bekleyen bir yazıcı varken yeni
+// okuyucu alınmaz; sürekli okuma altında yazmalar ve arka plan birleştirmesi aç kalmaz.
+class RwLock {
+public:
+    RwLock() : readers_(0), writer_(false), waiting_writers_(0) {}
+
+    void lock_shared() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !writer_ && waiting_writers_ == 0; });
+        readers_++;
+    }
+
+    void unlock_shared() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--readers_ == 0) cond_.notify_all();
+    }
+
+    void lock() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_writers_++;
+        cond_.wait(lock, [this] { return !writer_ && readers_ == 0; });
+        waiting_writers_--;
+        writer_ = true;
+    }
+
+    bool try_lock() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writer_ || readers_ > 0) return false;
+        writer_ = true;
+        return true;
+    }
+
+    void unlock() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writer_ = false;
+        cond_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    int readers_;
+    bool writer_;
+    int waiting_writers_;
+};
+
+const int LOCK_MODE_NONE = 0;
+const int LOCK_MODE_SHARED = 1;
+const int LOCK_MODE_EXCLUSIVE = 2;
+
+// ------------- CİLT (VOLUME) DURUMU -------------
+// Bir disk görüntüsüne ait tüm durum tek bir Volume nesnesindedir: görüntü ve log yolları, kilitler, bağlı blok
+// aygıtı, gecikmeli yazmalar, tahsis önbellekleri (buddy listeleri, atomik bitmap, alan sayaçları) ve arka plan
+// birleştirme iş parçacığı. Genel fs_* fonksiyonları çağıran iş parçacığının bağlı olduğu cilt üzerinde çalışır
+// (active_volume); bağlama yoksa varsayılan cilt (DISK_FILENAME / LOG_FILENAME) kullanılır. FileSystem nesneleri
+// kendi ciltlerini sahiplenir ve metotları süresince o cildi bağlar (VolumeBinding). Tutulan kilit kipleri iş
+// parçacığı başına izlendiği için başka bir cilde geçerken kaydedilip geri yüklenir. Asenkron G/Ç havuzu ve
+// io_uring halkaları tüm ciltlerde ortaktır.
+
+class BlockDevice;
+
+struct DelayedWrite {
+    bool replace;       // true: content dosyanın yeni içeriğinin tamamı (fs_write); false: sona eklenecek byte'lar (fs_append)
+    int64_t base_size;  // replace == false iken tampon açıldığında diskteki dosya boyutu
+    std::string content;
+    DelayedWrite() : replace(false), base_size(0) {}
+};
+
+// Buddy modunun bellekteki boş listeleri (bkz. BUDDY ALLOCATOR)
+struct BuddyFreeLists {
+    bool valid;
+    std::vector<std::set<int> > lists; // lists[k]: 2^k bloklu boş parçaların başlangıç indeksleri
+    BuddyFreeLists() : valid(false), lists(BUDDY_MAX_ORDER + 1) {}
+};
+
+// Alan sayaçlarının bellekteki kopyası (bkz. ALAN İSTATİSTİKLERİ)
+struct SpaceStatsCache {
+    bool valid;
+    SpaceStats stats;
+    SpaceStatsCache() : valid(false) {}
+};
+
+const int ATOMIC_BITMAP_WORDS = (NUM_DATA_BLOCKS + 63) / 64;
+
+// Açık dosya tutamacı (bkz. TUTAMAÇ TABANLI G/Ç)
+struct FileHandleSlot {
+    bool in_use;
+    bool stale;          // Dosya silindi veya görüntü değişti; artık yalnızca fs_close kabul edilir
+    int file_index;
+    uint64_t generation; // cached okunduğunda dosyanın file_info_generation değeri
+    FileInfo cached;     // FileInfo kopyası: ardışık bloklar, kuyruk ve satır içi veri (extent haritası)
+    int64_t position;
+    FileHandleSlot() : in_use(false), stale(false), file_index(-1), generation(0), position(0) {}
+};
+
+struct Volume {
+    Volume(const char* disk_filename, const char* log_filename)
+        : disk_path(disk_filename), log_path(log_filename != nullptr ? log_filename : ""),
+          requested_io_backend(IO_BACKEND_IO_URING), active_io_backend(IO_BACKEND_PREAD), mounted_device_type(BLOCK_DEVICE_PREAD), mounted_device(nullptr),
+          delayed_bytes_total(0), atomic_bitmap_loaded(false), allocation_state_dirty(false), allocation_state_reconciled(false),
+          defrag_thread_stop_requested(false),
+          defrag_thread_running(false) {
+        for (int i = 0; i < ATOMIC_BITMAP_WORDS; ++i) atomic_bitmap[i].store(0, std::memory_order_relaxed);
+        memset(committed_bitmap, 0, BITMAP_SIZE_BYTES);
+        for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) group_free_blocks[g].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < MAX_FILES_CALCULATED; ++i) file_info_generation[i].store(0, std::memory_order_relaxed);
+    }
+
+    const std::string disk_path;
+
+    // Kilitler (bkz. EŞZAMANLILIK)
+    RwLock volume_lock;
+    RwLock file_locks[MAX_FILES_CALCULATED];
+    std::recursive_mutex allocator_lock;
+
+    // Log hedefi (fs_log) fs_set_log_file ile değiştirilebilir; boş yol loglamayı kapatır. Satırlar kilit altında
+    // yazıldığı için iç içe geçmez.
+    std::mutex log_lock;
+    std::string log_path;
+
+    // Blok aygıtı (bkz. BLOK AYGITI)
+    std::atomic<int> requested_io_backend;
+    std::atomic<int> active_io_backend; // fs_get_io_backend: cildin son toplu veri G/Ç'sinde fiilen kullanılan yol
+    std::atomic<int> mounted_device_type;
+    std::atomic<BlockDevice*> mounted_device;
+    std::mutex device_open_lock; // Paylaşımlı kilit altında aynı anda iki ilk açılışı önler
+    std::vector<char> block_move_staging;
+    StripedDeviceOptions striped_options; // Son fs_mount_striped seçenekleri; aygıt kapatılınca bununla yeniden açılır
+
+    // Gecikmeli tahsis (bkz. GECİKMELİ TAHSİS)
+    std::map<int, DelayedWrite> delayed_writes; // FileInfo indeksi -> bekleyen yazma
+    int64_t delayed_bytes_total;
+    std::mutex delayed_write_lock;
+
+    // Tahsis durumu
+    BuddyFreeLists buddy_state;
+    SpaceStatsCache space_stats_cache;
+    std::mutex space_stats_lock; // Sayaçlar tüm gruplara ortak olduğu için ayrı bir kilit
+    std::mutex allocation_group_locks[NUM_ALLOCATION_GROUPS];
+    std::atomic<uint64_t> atomic_bitmap[ATOMIC_BITMAP_WORDS];
+    std::atomic<bool> atomic_bitmap_loaded;
+    std::mutex atomic_bitmap_load_lock;
+    char committed_bitmap[BITMAP_SIZE_BYTES]; // İşlenmiş bitmap; grup kilitleriyle korunur
+    std::atomic<uint32_t> group_free_blocks[NUM_ALLOCATION_GROUPS]; // Grup özetlerinin bellekteki kopyası
+    std::atomic<bool> allocation_state_dirty; // Bellekteki bitmap/özet/sayaçlar diskteki kopyadan yeni (fs_sync yazar)
+    std::atomic<bool> allocation_state_reconciled; // Diskteki tahsis durumu bu aygıt açılışında FileInfo'larla karşılaştırıldı
+
+    // Açık tutamaçlar (bkz. TUTAMAÇ TABANLI G/Ç)
+    FileHandleSlot file_handles[FS_MAX_OPEN_FILES];
+    std::mutex file_handle_lock; // Tablo kilidi; tutulurken başka kilit alınmaz
+    std::atomic<uint64_t> file_info_generation[MAX_FILES_CALCULATED]; // Kayıt her diske yazıldığında artar
+
+    // Arka plan birleştirme (bkz. ARTIMLI BİRLEŞTİRME)
+    std::thread defrag_thread;
+    std::mutex defrag_thread_lock; // Aşağıdaki bayrakları korur
+    std::condition_variable defrag_thread_cv;
+    bool defrag_thread_stop_requested;
+    bool defrag_thread_running;
+
+private:
+    Volume(const Volume&);
+    Volume& operator=(const Volume&);
+};
+
+static thread_local Volume* bound_volume = nullptr;
+
+// Varsayılan cilt ilk kullanımda kurulur ve hiç yok edilmez: statik yıkıcılar (aygıt kapatma, asenkron havuz)
+// program çıkışında ona hâlâ log yazabilir.
+Volume& default_volume() {
+    static Volume* volume = new Volume(DISK_FILENAME, LOG_FILENAME);
+    return *volume;
+}
+
+Volume& active_volume() {
+    return bound_volume != nullptr ? *bound_volume : default_volume();
+}
+
+const char* disk_filename() {
+    return active_volume().disk_path.c_str();
+}
+
+// Bu iş parçacığının tuttuğu kipler (iç içe genel fonksiyon çağrıları için)
+static thread_local int volume_lock_mode = LOCK_MODE_NONE;
+static thread_local int file_lock_modes[MAX_FILES_CALCULATED];
+
+// İş parçacığını bir cilde bağlar (FileSystem::Scope). Başka bir cildin kilitleri tutulurken (örn. bir cildin işi
+// içinden başka bir cilt çağrılırsa) izlenen kipler kaydedilip sıfırlanır, yıkıcı hepsini geri yükler.
+typedef FileSystem::Scope VolumeBinding;
+
+FileSystem::Scope::Scope(FileSystem& file_system) : previous_(bound_volume), saved_volume_mode_(LOCK_MODE_NONE) {
+    bind(*file_system.volume_);
+}
+
+FileSystem::Scope::Scope(Volume& volume) : previous_(bound_volume), saved_volume_mode_(LOCK_MODE_NONE) {
+    bind(volume);
+}
+
+void FileSystem::Scope::bind(Volume& volume) {
+    if (&active_volume() != &volume && volume_lock_mode != LOCK_MODE_NONE) {
+        saved_volume_mode_ = volume_lock_mode;
+        saved_file_modes_.assign(file_lock_modes, file_lock_modes + MAX_FILES_CALCULATED);
+        volume_lock_mode = LOCK_MODE_NONE;
+        std::fill(file_lock_modes, file_lock_modes + MAX_FILES_CALCULATED, static_cast<int>(LOCK_MODE_NONE));
+    }
+    bound_volume = &volume;
+}
+
+FileSystem::Scope::~Scope() {
+    bound_volume = previous_;
+    if (saved_volume_mode_ == LOCK_MODE_NONE) return;
+    volume_lock_mode = saved_volume_mode_;
+    std::copy(saved_file_modes_.begin(), saved_file_modes_.end(), file_lock_modes);
+}
+
+void report_lock_upgrade(const char* what) {
+    std::cerr << "Error (" << what << "): exclusive access requested while holding the shared lock; the call is refused." << std::endl;
+    fs_log(("Lock upgrade refused (" + std::string(what) + "): exclusive access requested while holding the shared lock.").c_str());
+}
+
+class VolumeLockGuard {
+public:
+    explicit VolumeLockGuard(int mode) : volume_(active_volume()), acquired_(LOCK_MODE_NONE), refused_(false) {
+        if (volume_lock_mode == LOCK_MODE_EXCLUSIVE || volume_lock_mode == mode) return; // İç içe çağrı
+        if (volume_lock_mode == LOCK_MODE_SHARED) {
+            report_lock_upgrade("volume lock");
+            refused_ = true;
+            return;
+        }
+        if (mode == LOCK_MODE_EXCLUSIVE) {
+            volume_.volume_lock.lock();
+        } else {
+            volume_.volume_lock.lock_shared();
+        }
+        volume_lock_mode = acquired_ = mode;
+    }
+
+    ~VolumeLockGuard() {
+        if (acquired_ == LOCK_MODE_NONE) return;
+        volume_lock_mode = LOCK_MODE_NONE;
+        if (acquired_ == LOCK_MODE_EXCLUSIVE) {
+            volume_.volume_lock.unlock();
+        } else {
+            volume_.volume_lock.unlock_shared();
+        }
+    }
+
+    // false: yükseltme reddedildi, kilit tutulmuyor; çağıran işlemi yapmadan dönmelidir.
+    bool held() const { return !refused_; }
+
+private:
+    Volume& volume_;
+    int acquired_;
+    bool refused_;
+    VolumeLockGuard(const VolumeLockGuard&);
+    VolumeLockGuard& operator=(const VolumeLockGuard&);
+};
+
+bool has_delayed_write(int file_index);
+int64_t flush_delayed_write(int file_index);
+void invalidate_file_handles(int file_index);
+
+// Yolu FileInfo indeksine çözer (bulunamazsa -1). Cilt kilidi tutulurken indeks geçerli kalır.
+int resolve_file_index(const char* path) {
+    if (path == nullptr || strlen(path) == 0 || strlen(path) > MAX_FILENAME_LENGTH) return -1;
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) return -1;
+    return resolve_path(all_files, path);
+}
+
+// Dosya kilidi. Çağıran cilt kilidini tutmalıdır. flush_pending ile alınan paylaşımlı kilit, dosyanın bekleyen
+// (gecikmeli tahsisli) yazmasını önce kısa bir özel kilitle diske yazar: okuyucu diskteki son içeriği görür ve
+// paylaşımlı kilit tutulduğu sürece kimse yeni veri tamponlayamaz. Dosya bulunamazsa kilit alınmaz; işlemin
+// kendisi "bulunamadı" hatasını verir.
+class FileLockGuard {
+public:
+    FileLockGuard(int file_index, int mode, bool flush_pending = false)
+        : volume_(active_volume()), file_index_(-1), acquired_(LOCK_MODE_NONE), refused_(false) {
+        acquire(file_index, mode, flush_pending);
+    }
+
+    FileLockGuard(const char* path, int mode, bool flush_pending = false)
+        : volume_(active_volume()), file_index_(-1), acquired_(LOCK_MODE_NONE), refused_(false) {
+        acquire(resolve_file_index(path), mode, flush_pending);
+    }
+
+    ~FileLockGuard() {
+        if (acquired_ == LOCK_MODE_NONE) return;
+        file_lock_modes[file_index_] = LOCK_MODE_NONE;
+        if (acquired_ == LOCK_MODE_EXCLUSIVE) {
+            volume_.file_locks[file_index_].unlock();
+        } else {
+            volume_.file_locks[file_index_].unlock_shared();
+        }
+    }
+
+    // false: yükseltme reddedildi (bkz. VolumeLockGuard::held).
+    bool held() const { return !refused_; }
+
+private:
+    void acquire(int file_index, int mode, bool flush_pending) {
+        if (file_index < 0 || file_index >= MAX_FILES_CALCULATED) return;
+        int held = (volume_lock_mode == LOCK_MODE_EXCLUSIVE) ? LOCK_MODE_EXCLUSIVE : file_lock_modes[file_index];
+        if (held == LOCK_MODE_EXCLUSIVE || held == mode) {
+            if (flush_pending && held == LOCK_MODE_EXCLUSIVE) flush_delayed_write(file_index);
+            return;
+        }
+        if (held == LOCK_MODE_SHARED) {
+            report_lock_upgrade("file lock");
+            refused_ = true;
+            return;
+        }
+
+        RwLock& lock = volume_.file_locks[file_index];
+        if (mode == LOCK_MODE_EXCLUSIVE) {
+            lock.lock();
+        } else {
+            lock.lock_shared();
+            while (flush_pending && has_delayed_write(file_index)) {
+                lock.unlock_shared();
+                lock.lock();
+                file_lock_modes[file_index] = LOCK_MODE_EXCLUSIVE;
+                flush_delayed_write(file_index);
+                file_lock_modes[file_index] = LOCK_MODE_NONE;
+                lock.unlock();
+                lock.lock_shared();
+            }
+        }
+        file_lock_modes[file_index] = mode;
+        file_index_ = file_index;
+        acquired_ = mode;
+    }
+
+    Volume& volume_;
+    int file_index_;
+    int acquired_;
+    bool refused_;
+    FileLockGuard(const FileLockGuard&);
+    FileLockGuard& operator=(const FileLockGuard&);
+};
+
+// ------------- BLOK G/Ç ARKA UCU (io_uring / pread-pwrite) -------------
+// Veri bloklarının okuma ve yazmaları toplu istekler (BlockIoRequest) olarak verilir. Linux'ta her iş parçacığı
+// kendi io_uring halkasını kurar (liburing yok, ham sistem çağrıları). disk.sim tanımlayıcısı halkaya kayıtlıdır
+// (fixed file). Toplamı kayıtlı ara tampona sığan istekler READ_FIXED/WRITE_FIXED ile o tampondan geçer. Toplu istek
+// tek bir io_uring_enter çağrısıyla gönderilir ve aynı çağrıda tamamlanmaları beklenir. Halkalar ciltler arasında
+// ortaktır: kayıtlı dosya, halkayı kullanan aygıtın tanımlayıcısıdır ve başka bir aygıt gelince yeniden kaydedilir. Halka kurulamazsa (eski
+// çekirdek, seccomp, ENOSYS...) veya fs_set_io_backend ile istenirse pread/pwrite kullanılır. Halkayı yalnızca
+// pread/pwrite blok aygıtı kullanır; metadata aynı aygıttan tek tek okunup yazılır ve iki yol da aynı sayfa
+// önbelleğini gördüğü için karışık kullanım tutarlıdır.
+
+struct BlockIoRequest {
+    off_t offset;   // disk.sim içindeki mutlak ofset
+    char* buffer;   // Yazmada kaynak, okumada hedef
+    size_t length;
+    BlockIoRequest(off_t offset_in, char* buffer_in, size_t length_in) : offset(offset_in), buffer(buffer_in), length(length_in) {}
+};
+
+
+bool pread_full(int fd, char* buffer, size_t length, off_t offset);
+bool pwrite_full(int fd, const char* buffer, size_t length, off_t offset);
+
+class UringRing {
+public:
+    UringRing() : ring_fd_(-1), disk_fd_(-1), device_id_(0), unsubmitted_(0), setup_failed_(false), files_registered_(false),
+                  fixed_buffer_(nullptr), fixed_registered_(false), sq_ptr_(nullptr), cq_ptr_(nullptr), sqes_(nullptr),
+                  sq_map_size_(0), cq_map_size_(0), sqes_map_size_(0) {}
+    ~UringRing() { close_ring(); }
+
+    // Halka kurulu ise aygıtın tanımlayıcısını (fd, device_id ile tanınır) kullanıma hazırlar. Tanımlayıcı aygıtındır;
+    // halka onu kapatmaz.
+    bool ready(int fd, uint64_t device_id) {
+        if (ring_fd_ < 0 && (setup_failed_ || !setup())) return false;
+        if (device_id_ != device_id) register_disk(fd, device_id);
+        return true;
+    }
+
+    // Toplu isteği gönderir ve tamamlanmasını bekler. Gönderme (submit) ve toplama (reap) ayrı adımlardır: halkada
+    // yer oldukça istekler kuyruğa konup beklemeden gönderilir, sonra gelen tamamlanmalar toplanır ve boşalan yerlere
+    // sıradakiler konur. SQ'dan büyük toplu istekler halkayı boşaltmadan akar; uçuştaki istek SQ boyutunu aşmadığı
+    // için CQ (SQ'nun iki katı) taşmaz. Kısa kalan istekler pread/pwrite ile tamamlanır. Bir istek hata verse de
+    // çekirdek tamponları bırakana kadar tüm tamamlanmalar toplanır.
+    bool run(std::vector<BlockIoRequest>& batch, bool is_write) {
+        size_t total = 0;
+        for (const BlockIoRequest& request : batch) total += request.length;
+        bool use_fixed = fixed_registered_ && total <= URING_FIXED_BUFFER_BYTES;
+        if (use_fixed && is_write) {
+            size_t position = 0;
+            for (const BlockIoRequest& request : batch) {
+                memcpy(fixed_buffer_ + position, request.buffer, request.length);
+                position += request.length;
+            }
+        }
+
+        size_t next = 0;
+        size_t fixed_position = 0;
+        size_t in_flight = 0;
+        size_t reaped = 0;
+        bool failed = false;
+        while (reaped < batch.size()) {
+            unsigned int queued = 0;
+            for (; next < batch.size() && in_flight < sq_entries_; ++next, ++in_flight, ++queued) {
+                queue_request(batch[next], next, is_write, use_fixed ? fixed_buffer_ + fixed_position : nullptr);
+                if (use_fixed) fixed_position += batch[next].length;
+            }
+            if (!submit(queued)) return false;
+            int completed = reap(batch, is_write, use_fixed, failed);
+            if (completed < 0) return false;
+            reaped += static_cast<size_t>(completed);
+            in_flight -= static_cast<size_t>(completed);
+        }
+        if (failed) return false;
+
+        if (use_fixed && !is_write) {
+            size_t position = 0;
+            for (BlockIoRequest& request : batch) {
+                memcpy(request.buffer, fixed_buffer_ + position, request.length);
+                position += request.length;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool setup() {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, URING_QUEUE_DEPTH, &params));
+        if (ring_fd_ < 0) {
+            setup_failed_ = true;
+            fs_log(("io_uring unavailable (errno " + std::to_string(errno) + "), falling back to pread/pwrite.").c_str());
+            return false;
+        }
+        sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+        sq_ptr_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single_mmap ? sq_ptr_ : mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        sqes_map_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes == MAP_FAILED) {
+            if (sq_ptr_ == MAP_FAILED) sq_ptr_ = nullptr;
+            if (cq_ptr_ == MAP_FAILED) cq_ptr_ = nullptr;
+            if (sqes != MAP_FAILED) munmap(sqes, sqes_map_size_);
+            fs_log("io_uring ring mapping failed, falling back to pread/pwrite.");
+            close_ring();
+            setup_failed_ = true;
+            return false;
+        }
+        sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+        char* sq = static_cast<char*>(sq_ptr_);
+        char* cq = static_cast<char*>(cq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // Kayıtlı tampon isteğe bağlıdır: kaydedilemezse istekler doğrudan çağıranın tamponunu kullanır.
+        void* fixed = nullptr;
+        if (posix_memalign(&fixed, 4096, URING_FIXED_BUFFER_BYTES) == 0) {
+            fixed_buffer_ = static_cast<char*>(fixed);
+            struct iovec iov;
+            iov.iov_base = fixed_buffer_;
+            iov.iov_len = URING_FIXED_BUFFER_BYTES;
+            fixed_registered_ = syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+        }
+        fs_log(("io_uring ring set up: " + std::to_string(params.sq_entries) + " entries, registered buffer " +
+                (fixed_registered_ ? "on" : "off") + ".").c_str());
+        return true;
+    }
+
+    // İsteği SQ'ya yazar (henüz göndermez). fixed: kayıtlı tampondaki yeri (nullptr: çağıranın tamponu).
+    void queue_request(const BlockIoRequest& request, size_t user_data, bool is_write, char* fixed) {
+        unsigned int tail = *sq_tail_;
+        unsigned int index = tail & *sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        if (fixed != nullptr) {
+            sqe->opcode = is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<uint64_t>(fixed);
+            sqe->buf_index = 0;
+        } else {
+            sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->addr = reinterpret_cast<uint64_t>(request.buffer);
+        }
+        sqe->fd = files_registered_ ? 0 : disk_fd_;
+        if (files_registered_) sqe->flags |= IOSQE_FIXED_FILE;
+        sqe->off = static_cast<uint64_t>(request.offset);
+        sqe->len = static_cast<uint32_t>(request.length);
+        sqe->user_data = user_data;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // io_uring_enter; hata durumunda (EINTR hariç) halka bu iş parçacığı için kapatılır ve -1 döner.
+    int enter(unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+        for (;;) {
+            int entered = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0));
+            if (entered >= 0) return entered;
+            if (errno == EINTR) continue;
+            // Halka durumu artık bilinmiyor: bu iş parçacığı için io_uring kapatılır.
+            fs_log(("io_uring_enter failed (errno " + std::to_string(errno) + "), disabling io_uring for this thread.").c_str());
+            close_ring();
+            setup_failed_ = true;
+            return -1;
+        }
+    }
+
+    // Kuyruğa konan count isteği tamamlanmalarını beklemeden gönderir. Çekirdeğin o an almadıkları unsubmitted_'da
+    // kalır ve sonraki çağrılarla (reap'teki bekleme dahil) gönderilir.
+    bool submit(unsigned int count) {
+        unsubmitted_ += count;
+        if (unsubmitted_ == 0) return true;
+        int entered = enter(unsubmitted_, 0, 0);
+        if (entered < 0) return false;
+        unsubmitted_ -= std::min<unsigned int>(unsubmitted_, static_cast<unsigned int>(entered));
+        return true;
+    }
+
+    // CQ'daki tamamlanmaları toplar; hiç yoksa en az birini bekler. Toplanan sayıyı, halka kapandıysa -1 döndürür.
+    int reap(std::vector<BlockIoRequest>& batch, bool is_write, bool use_fixed, bool& failed) {
+        for (;;) {
+            int completed = 0;
+            unsigned int head = *cq_head_;
+            unsigned int cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            for (; head != cq_tail; ++head, ++completed) {
+                const struct io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+                if (!finish_request(batch[cqe.user_data], cqe.res, is_write, use_fixed)) failed = true;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            if (completed > 0) return completed;
+            int entered = enter(unsubmitted_, 1, IORING_ENTER_GETEVENTS);
+            if (entered < 0) return -1;
+            unsubmitted_ -= std::min<unsigned int>(unsubmitted_, static_cast<unsigned int>(entered));
+        }
+    }
+
+    void register_disk(int fd, uint64_t device_id) {
+        if (files_registered_) {
+            syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_FILES, nullptr, 0);
+            files_registered_ = false;
+        }
+        disk_fd_ = fd;
+        device_id_ = device_id;
+        files_registered_ = syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES, &disk_fd_, 1) == 0;
+    }
+
+    // Bir tamamlanmayı işler: kısa okuma/yazmanın kalanı pread/pwrite ile bitirilir, hata false döndürür.
+    bool finish_request(BlockIoRequest& request, int result, bool is_write, bool use_fixed) {
+        if (result < 0) {
+            fs_log(("io_uring request at offset " + std::to_string(static_cast<int64_t>(request.offset)) + " failed, errno " +
+                    std::to_string(-result) + ".").c_str());
+            return false;
+        }
+        size_t done = static_cast<size_t>(result);
+        if (done >= request.length) return true;
+        if (use_fixed) return false; // Veri ara tamponda; disk_io_batch tüm isteği pread/pwrite ile yineler
+        char* source = request.buffer + done;
+        return is_write ? pwrite_full(disk_fd_, source, request.length - done, request.offset + done)
+                        : pread_full(disk_fd_, source, request.length - done, request.offset + done);
+    }
+
+    void close_ring() {
+        if (sqes_ != nullptr) munmap(sqes_, sqes_map_size_);
+        if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_map_size_);
+        if (sq_ptr_ != nullptr) munmap(sq_ptr_, sq_map_size_);
+        if (ring_fd_ >= 0) close(ring_fd_);
+        free(fixed_buffer_);
+        sqes_ = nullptr;
+        sq_ptr_ = cq_ptr_ = nullptr;
+        fixed_buffer_ = nullptr;
+        ring_fd_ = disk_fd_ = -1;
+        device_id_ = 0;
+        unsubmitted_ = 0;
+        fixed_registered_ = files_registered_ = false;
+    }
+
+    int ring_fd_;
+    int disk_fd_;
+    uint64_t device_id_;
+    unsigned int unsubmitted_; // SQ'ya konmuş ama çekirdeğe henüz gönderilmemiş istekler
+    bool setup_failed_;
+    bool files_registered_;
+    char* fixed_buffer_;
+    bool fixed_registered_;
+    void* sq_ptr_;
+    void* cq_ptr_;
+    struct io_uring_sqe* sqes_;
+    size_t sq_map_size_;
+    size_t cq_map_size_;
+    size_t sqes_map_size_;
+    unsigned int* sq_tail_;
+    unsigned int* sq_mask_;
+    unsigned int* sq_array_;
+    unsigned int sq_entries_;
+    unsigned int* cq_head_;
+    unsigned int* cq_tail_;
+    unsigned int* cq_mask_;
+    struct io_uring_cqe* cqes_;
+    UringRing(const UringRing&);
+    UringRing& operator=(const UringRing&);
+};
+
+static thread_local UringRing uring_ring;
+
+void fs_set_io_backend(int backend) {
+    active_volume().requested_io_backend.store(backend == IO_BACKEND_IO_URING ? IO_BACKEND_IO_URING : IO_BACKEND_PREAD);
+    fs_log(("I/O backend set to " + std::string(backend == IO_BACKEND_IO_URING ? "io_uring (pread/pwrite fallback)" : "pread/pwrite") + ".").c_str());
+}
+
+int fs_get_io_backend() {
+    return active_volume().active_io_backend.load();
+}
+
+// ------------- BLOK AYGITI (BLOCK DEVICE) ARKA UÇLARI -------------
+// Tüm disk G/Ç'si bağlı (mounted) blok aygıtı üzerinden yapılır; aygıt türü fs_mount ile seçilir:
+//   BLOCK_DEVICE_BUFFERED_FILE: disk.sim üzerinde tek bir std::fstream (kullanıcı alanı tamponlu)
+//   BLOCK_DEVICE_PREAD:         pread/pwrite; toplu veri G/Ç'si io_uring ile (varsayılan)
+//   BLOCK_DEVICE_MMAP:          disk.sim MAP_SHARED eşlenir, G/Ç memcpy'dir
+//   BLOCK_DEVICE_DIRECT:        O_DIRECT; hizasız istekler hizalı ara tamponla (okuma-değiştir-yaz) yapılır
+//   BLOCK_DEVICE_RAM:           görüntü tamamen bellekte, disk.sim'e dokunulmaz
+//   BLOCK_DEVICE_STRIPED:       görüntü N üye dosyaya şerit birimleriyle dağıtılır, büyük istekler üyelere paralel gider
+//                               (kapasite tek görüntününkidir; üyeler toplamı cildi büyütmez)
+// Aygıt ilk G/Ç'de açılır ve volume kilidi özel tutulurken bırakılır (fs_mount, fs_unmount, disk yeniden
+// oluşturma). Paylaşımlı kilit tutan işlemler bu yüzden aygıt işaretçisini güvenle kullanabilir. Aygıtlar kendi
+// içlerinde eşzamanlı çağrılara karşı güvenlidir.
+
+class BlockDevice {
+public:
+    virtual ~BlockDevice() {}
+    virtual int type() const = 0;
+    virtual bool read_at(off_t offset, char* buffer, size_t length) = 0;
+    virtual bool write_at(off_t offset, const char* buffer, size_t length) = 0;
+    virtual bool flush() = 0; // Yazılanları aygıtın arkasındaki depoya (dosya/çekirdek) iletir
+    off_t size() const { return size_; }
+
+    // Veri alanındaki bloklar üzerinden okuma/yazma.
+    bool read_blocks(int first_block, unsigned int count, char* buffer) {
+        return read_at(data_block_offset(first_block), buffer, static_cast<size_t>(count) * BLOCK_SIZE_BYTES);
+    }
+    bool write_blocks(int first_block, unsigned int count, const char* buffer) {
+        return write_at(data_block_offset(first_block), buffer, static_cast<size_t>(count) * BLOCK_SIZE_BYTES);
+    }
+
+    // Toplu istek; varsayılan olarak istekler sırayla yürütülür.
+    virtual bool submit_batch(std::vector<BlockIoRequest>& batch, bool is_write) {
+        active_volume().active_io_backend.store(IO_BACKEND_PREAD);
+        for (BlockIoRequest& request : batch) {
+            if (!(is_write ? write_at(request.offset, request.buffer, request.length) : read_at(request.offset, request.buffer, request.length))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Görüntü içinde memmove anlamında aralık taşıma. Varsayılan: tek bir ortak ara tampon üzerinden parçalar,
+    // hedef öndeyse baştan, arkadaysa sondan kopyalanır; böylece henüz kopyalanmamış kaynak verinin üzerine
+    // yazılmaz. Çağıranlar volume kilidini özel tutar; ara tampon onunla korunur.
+    virtual bool move_range(off_t source, off_t destination, off_t length);
+
+protected:
+    BlockDevice() : size_(0) {}
+    static off_t data_block_offset(int block) { return METADATA_AREA_SIZE_BYTES + static_cast<off_t>(block) * BLOCK_SIZE_BYTES; }
+    bool in_bounds(off_t offset, size_t length) const {
+        return offset >= 0 && static_cast<uint64_t>(offset) + length <= static_cast<uint64_t>(size_);
+    }
+    off_t size_;
+
+private:
+    BlockDevice(const BlockDevice&);
+    BlockDevice& operator=(const BlockDevice&);
+};
+
+bool BlockDevice::move_range(off_t source, off_t destination, off_t length) {
+    Volume& volume = active_volume();
+    if (length <= 0 || source == destination) return true;
+    if (volume.block_move_staging.size() < BLOCK_MOVE_CHUNK_BYTES) {
+        volume.block_move_staging.resize(BLOCK_MOVE_CHUNK_BYTES);
+    }
+    char* staging = &volume.block_move_staging[0];
+    bool ok = true;
+    if (destination < source) {
+        for (off_t offset = 0; ok && offset < length; ) {
+            size_t chunk = static_cast<size_t>(std::min<off_t>(length - offset, BLOCK_MOVE_CHUNK_BYTES));
+            ok = read_at(source + offset, staging, chunk) && write_at(destination + offset, staging, chunk);
+            offset += chunk;
+        }
+    } else {
+        for (off_t end = length; ok && end > 0; ) {
+            size_t chunk = static_cast<size_t>(std::min<off_t>(end, BLOCK_MOVE_CHUNK_BYTES));
+            off_t offset = end - chunk;
+            ok = read_at(source + offset, staging, chunk) && write_at(destination + offset, staging, chunk);
+            end = offset;
+        }
+    }
+    return ok;
+}
+
+// disk.sim üzerinde tek bir tamponlu std::fstream. Konum akışta paylaşıldığı için her işlem kilit altında
+// konumlanıp okur/yazar; tüm G/Ç aynı akıştan geçtiği için tampon tutarlıdır.
+class BufferedFileDevice : public BlockDevice {
+public:
+    explicit BufferedFileDevice(const char* path) : file_(path, std::ios::binary | std::ios::in | std::ios::out) {
+        if (file_) {
+            file_.seekg(0, std::ios::end);
+            size_ = static_cast<off_t>(file_.tellg());
+        }
+    }
+    bool opened() const { return static_cast<bool>(file_); }
+    int type() const { return BLOCK_DEVICE_BUFFERED_FILE; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_.clear();
+        file_.seekg(offset);
+        file_.read(buffer, static_cast<std::streamsize>(length));
+        return file_.gcount() == static_cast<std::streamsize>(length);
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_.clear();
+        file_.seekp(offset);
+        file_.write(buffer, static_cast<std::streamsize>(length));
+        return static_cast<bool>(file_);
+    }
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_.flush();
+        return static_cast<bool>(file_);
+    }
+
+private:
+    std::fstream file_;
+    std::mutex mutex_;
+};
+
+static std::atomic<uint64_t> next_pread_device_id(1); // io_uring halkaları kayıtlı tanımlayıcının sahibini bununla tanır
+
+// pread/pwrite ile çalışan aygıt. Toplu veri G/Ç'si fs_set_io_backend'e göre io_uring halkasından geçer;
+// çakışmayan taşımalar copy_file_range ile çekirdek içinde yapılır (veri kullanıcı alanına çıkmaz).
+class PreadDevice : public BlockDevice {
+public:
+    explicit PreadDevice(const char* path) : fd_(open(path, O_RDWR)), id_(next_pread_device_id++) {
+        struct stat info;
+        if (fd_ >= 0 && fstat(fd_, &info) == 0) size_ = info.st_size;
+    }
+    ~PreadDevice() { if (fd_ >= 0) close(fd_); }
+    bool opened() const { return fd_ >= 0; }
+    int type() const { return BLOCK_DEVICE_PREAD; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        return in_bounds(offset, length) && pread_full(fd_, buffer, length, offset);
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        return in_bounds(offset, length) && pwrite_full(fd_, buffer, length, offset);
+    }
+    bool flush() { return true; } // Kullanıcı alanı tamponu yok
+    bool submit_batch(std::vector<BlockIoRequest>& batch, bool is_write) {
+        if (active_volume().requested_io_backend.load(std::memory_order_relaxed) == IO_BACKEND_IO_URING && uring_ring.ready(fd_, id_) &&
+            uring_ring.run(batch, is_write)) {
+            active_volume().active_io_backend.store(IO_BACKEND_IO_URING);
+            return true;
+        }
+        return BlockDevice::submit_batch(batch, is_write);
+    }
+    bool move_range(off_t source, off_t destination, off_t length) {
+        off_t distance = destination > source ? destination - source : source - destination;
+        off_t done = 0;
+        if (distance >= length) {
+            off_t in_offset = source;
+            off_t out_offset = destination;
+            while (done < length) {
+                ssize_t copied = copy_file_range(fd_, &in_offset, fd_, &out_offset,
+                                                 static_cast<size_t>(std::min<off_t>(length - done, BLOCK_MOVE_CHUNK_BYTES)), 0);
+                if (copied <= 0) break; // ENOSYS, EXDEV...: kalan kısım ara tamponla kopyalanır
+                done += copied;
+            }
+        }
+        return BlockDevice::move_range(source + done, destination + done, length - done);
+    }
+
+private:
+    int fd_;
+    uint64_t id_;
+};
+
+// disk.sim'in tamamı MAP_SHARED eşlenir; değişiklikler doğrudan sayfa önbelleğine gider.
+class MmapDevice : public BlockDevice {
+public:
+    explicit MmapDevice(const char* path) : fd_(open(path, O_RDWR)), map_(nullptr) {
+        struct stat info;
+        if (fd_ >= 0 && fstat(fd_, &info) == 0 && info.st_size > 0) {
+            void* map = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (map != MAP_FAILED) {
+                map_ = static_cast<char*>(map);
+                size_ = info.st_size;
+            }
+        }
+    }
+    ~MmapDevice() {
+        if (map_ != nullptr) munmap(map_, static_cast<size_t>(size_));
+        if (fd_ >= 0) close(fd_);
+    }
+    bool opened() const { return map_ != nullptr; }
+    int type() const { return BLOCK_DEVICE_MMAP; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memcpy(buffer, map_ + offset, length);
+        return true;
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memcpy(map_ + offset, buffer, length);
+        return true;
+    }
+    bool flush() { return msync(map_, static_cast<size_t>(size_), MS_ASYNC) == 0; }
+    bool move_range(off_t source, off_t destination, off_t length) {
+        if (!in_bounds(source, static_cast<size_t>(length)) || !in_bounds(destination, static_cast<size_t>(length))) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memmove(map_ + destination, map_ + source, static_cast<size_t>(length));
+        return true;
+    }
+
+private:
+    int fd_;
+    char* map_;
+    std::mutex mutex_; // memcpy'ler arası veri yarışını önler (çekirdek G/Ç'sinde bu çekirdeğin işiydi)
+};
+
+// O_DIRECT: Sayfa önbelleği atlanır; çekirdek tamponlamadığı için aygıt kendi sayfa önbelleğini tutar.
+// Tüm G/Ç açılışta bir kez ayrılan hizalı havuzdan geçer: DIRECT_IO_CACHE_PAGES çerçeve (LRU) ve çok sayfalı
+// aktarımlar için DIRECT_IO_STAGING_BYTES'lık ara tampon. Önbellek yazarak-geçir (write-through) çalışır, disk her
+// zaman güncel kalır. Hizasız/kısmi sayfa yazmaları önbellekteki çerçevede okuma-değiştir-yaz ile yapılır; sayfa
+// önbellekteyse diskten okuma gerekmez (metadata alanının küçük yazmaları böyle). Çerçeveler ve ara tampon
+// paylaşıldığı için aygıt işlemleri tek kilitle sıralanır.
+class DirectDevice : public BlockDevice {
+public:
+    explicit DirectDevice(const char* path) : fd_(open(path, O_RDWR | O_DIRECT)), pool_(nullptr), staging_(nullptr), clock_(0) {
+        struct stat info;
+        if (fd_ < 0 || fstat(fd_, &info) != 0) return;
+        void* memory = nullptr;
+        if (posix_memalign(&memory, DIRECT_IO_ALIGNMENT, DIRECT_IO_CACHE_PAGES * DIRECT_IO_ALIGNMENT + DIRECT_IO_STAGING_BYTES) != 0) {
+            return;
+        }
+        pool_ = static_cast<char*>(memory);
+        staging_ = pool_ + DIRECT_IO_CACHE_PAGES * DIRECT_IO_ALIGNMENT;
+        frames_.assign(DIRECT_IO_CACHE_PAGES, CachedPage());
+        size_ = info.st_size;
+    }
+    ~DirectDevice() {
+        free(pool_);
+        if (fd_ >= 0) close(fd_);
+    }
+    bool opened() const { return fd_ >= 0 && pool_ != nullptr; }
+    int type() const { return BLOCK_DEVICE_DIRECT; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        off_t end = offset + static_cast<off_t>(length);
+        off_t page = align_down(offset);
+        while (page < end) {
+            char* cached = lookup(page);
+            if (cached != nullptr) {
+                ++stats_.cache_hits;
+                copy_out(cached, page, offset, end, buffer);
+                page += PAGE;
+                continue;
+            }
+            // Önbellekte olmayan ardışık sayfalar tek okumayla ara tampona alınır ve önbelleğe eklenir
+            off_t run_end = page + PAGE;
+            while (run_end < end && run_end - page < static_cast<off_t>(DIRECT_IO_STAGING_BYTES) && !cached_page(run_end)) {
+                run_end += PAGE;
+            }
+            if (!pread_full(fd_, staging_, static_cast<size_t>(run_end - page), page)) return false;
+            for (off_t current = page; current < run_end; current += PAGE) {
+                const char* source = staging_ + (current - page);
+                copy_out(source, current, offset, end, buffer);
+                memcpy(insert(current), source, PAGE);
+                ++stats_.cache_misses;
+            }
+            page = run_end;
+        }
+        return true;
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        off_t end = offset + static_cast<off_t>(length);
+        off_t run_start = align_down(offset);
+        while (run_start < end) {
+            off_t run_end = std::min<off_t>(align_up(end), run_start + static_cast<off_t>(DIRECT_IO_STAGING_BYTES));
+            for (off_t page = run_start; page < run_end; page += PAGE) {
+                off_t from = std::max(page, offset);
+                off_t to = std::min(page + PAGE, end);
+                char* cached = lookup(page);
+                if (cached == nullptr && (from != page || to != page + PAGE)) {
+                    cached = insert(page); // Kısmi sayfa: önce önbelleğe okunur
+                    if (!pread_full(fd_, cached, PAGE, page)) {
+                        drop(page);
+                        return false;
+                    }
+                    ++stats_.rmw_reads;
+                }
+                char* target = staging_ + (page - run_start);
+                if (cached != nullptr) {
+                    memcpy(cached + (from - page), buffer + (from - offset), static_cast<size_t>(to - from));
+                    memcpy(target, cached, PAGE);
+                } else {
+                    memcpy(target, buffer + (from - offset), PAGE);
+                }
+            }
+            if (!pwrite_full(fd_, staging_, static_cast<size_t>(run_end - run_start), run_start)) {
+                // Diske gitmeyen değişiklikler önbellekte kalmasın
+                for (off_t page = run_start; page < run_end; page += PAGE) drop(page);
+                return false;
+            }
+            stats_.pages_written += static_cast<uint64_t>((run_end - run_start) / PAGE);
+            run_start = run_end;
+        }
+        return true;
+    }
+    bool flush() { return true; } // Önbellek yazarak-geçir; yazmalar zaten aygıtta
+    DirectIoStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    static const off_t PAGE = static_cast<off_t>(DIRECT_IO_ALIGNMENT);
+    struct CachedPage {
+        off_t page;          // -1: boş çerçeve
+        uint64_t last_use;
+        CachedPage() : page(-1), last_use(0) {}
+    };
+    static off_t align_down(off_t value) { return value - value % PAGE; }
+    static off_t align_up(off_t value) { return align_down(value + PAGE - 1); }
+    // [offset, end) aralığının 'page' sayfasına düşen kısmını çağıranın tamponuna kopyalar
+    static void copy_out(const char* source, off_t page, off_t offset, off_t end, char* buffer) {
+        off_t from = std::max(page, offset);
+        off_t to = std::min(page + PAGE, end);
+        memcpy(buffer + (from - offset), source + (from - page), static_cast<size_t>(to - from));
+    }
+    bool cached_page(off_t page) const { return index_.count(page) != 0; }
+    char* lookup(off_t page) {
+        std::map<off_t, size_t>::iterator it = index_.find(page);
+        if (it == index_.end()) return nullptr;
+        frames_[it->second].last_use = ++clock_;
+        return pool_ + it->second * DIRECT_IO_ALIGNMENT;
+    }
+    // Boş ya da en uzun süredir kullanılmayan çerçeveyi 'page' için ayırır; içeriği çağıran doldurur
+    char* insert(off_t page) {
+        size_t victim = 0;
+        for (size_t i = 0; i < frames_.size(); ++i) {
+            if (frames_[i].page < 0) {
+                victim = i;
+                break;
+            }
+            if (frames_[i].last_use < frames_[victim].last_use) victim = i;
+        }
+        if (frames_[victim].page >= 0) index_.erase(frames_[victim].page);
+        frames_[victim].page = page;
+        frames_[victim].last_use = ++clock_;
+        index_[page] = victim;
+        return pool_ + victim * DIRECT_IO_ALIGNMENT;
+    }
+    void drop(off_t page) {
+        std::map<off_t, size_t>::iterator it = index_.find(page);
+        if (it == index_.end()) return;
+        frames_[it->second] = CachedPage();
+        index_.erase(it);
+    }
+    int fd_;
+    char* pool_;    // DIRECT_IO_CACHE_PAGES çerçeve + ara tampon, DIRECT_IO_ALIGNMENT hizalı
+    char* staging_;
+    std::vector<CachedPage> frames_;
+    std::map<off_t, size_t> index_; // Sayfa ofseti -> çerçeve
+    uint64_t clock_;
+    DirectIoStats stats_;
+    std::mutex mutex_;
+};
+
+// Görüntü yalnızca bellekte durur (heap veya anonim mmap); fs_unmount sonrasında da korunur, başka bir aygıt
+// bağlanınca kaybolur. İsteğe bağlı olarak bir görüntü dosyasından yüklenir; dump_image verildiyse flush
+// (fs_sync, fs_unmount, aygıt değişimi) görüntünün tamamını o dosyaya yazar.
+class RamDevice : public BlockDevice {
+public:
+    explicit RamDevice(const RamDiskOptions& options = RamDiskOptions())
+        : image_(nullptr), mapped_(false), loaded_(false), dump_image_(options.dump_image != nullptr ? options.dump_image : "") {
+        if (options.anonymous_mmap) {
+            void* map = mmap(nullptr, DISK_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (map == MAP_FAILED) return;
+            image_ = static_cast<char*>(map); // Anonim sayfalar sıfırla gelir
+            mapped_ = true;
+        } else {
+            heap_.assign(DISK_SIZE_BYTES, '\0');
+            image_ = &heap_[0];
+        }
+        size_ = DISK_SIZE_BYTES;
+        if (options.load_image != nullptr) {
+            std::ifstream source(options.load_image, std::ios::binary);
+            source.read(image_, DISK_SIZE_BYTES);
+            // Görüntü tam olarak disk boyutunda olmalı (fs_backup çıktısı da uygundur)
+            if (source.gcount() != static_cast<std::streamsize>(DISK_SIZE_BYTES) || source.peek() != std::char_traits<char>::eof()) {
+                release_image();
+                return;
+            }
+            loaded_ = true;
+        }
+    }
+    ~RamDevice() { release_image(); }
+    bool opened() const { return image_ != nullptr; }
+    bool loaded() const { return loaded_; }
+    int type() const { return BLOCK_DEVICE_RAM; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memcpy(buffer, image_ + offset, length);
+        return true;
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memcpy(image_ + offset, buffer, length);
+        return true;
+    }
+    bool flush() {
+        if (dump_image_.empty()) return true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ofstream target(dump_image_.c_str(), std::ios::binary | std::ios::trunc);
+        target.write(image_, static_cast<std::streamsize>(size_));
+        target.close();
+        if (!target) {
+            fs_log(("RAM disk dump to '" + dump_image_ + "' failed.").c_str());
+            return false;
+        }
+        return true;
+    }
+    bool move_range(off_t source, off_t destination, off_t length) {
+        if (!in_bounds(source, static_cast<size_t>(length)) || !in_bounds(destination, static_cast<size_t>(length))) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        memmove(image_ + destination, image_ + source, static_cast<size_t>(length));
+        return true;
+    }
+
+private:
+    void release_image() {
+        if (mapped_ && image_ != nullptr) munmap(image_, DISK_SIZE_BYTES);
+        heap_.clear();
+        image_ = nullptr;
+        mapped_ = false;
+        size_ = 0;
+    }
+    char* image_;
+    std::vector<char> heap_;
+    bool mapped_;
+    bool loaded_;
+    std::string dump_image_;
+    std::mutex mutex_;
+};
+
+// Şeritli aygıt: Mantıksal ofset L, s = L / birim olmak üzere (s % N). üyenin (s / N) * birim + L % birim ofsetindedir.
+// İstekler üye başına parçalara bölünür. Tek üyeye düşen istekler (metadata, küçük dosyalar) çağıranın iş
+// parçacığında yapılır. Birden çok üyeye yayılanlar paralel yürür: her üyenin kendi G/Ç iş parçacığı ve kuyruğu
+// vardır (disk başına bir kuyruk), çağıran ilk üyenin parçalarını kendisi yapar ve diğerlerinin bitmesini bekler.
+// Toplu istekler (submit_batch) tek bir dağıtım olarak gönderilir.
+
+// Üye dosya boyutu: son satır da tam birimdir (görüntünün sonunu aşan kısım hiç kullanılmaz).
+off_t stripe_member_size(const StripedDeviceOptions& options) {
+    off_t unit = static_cast<off_t>(options.stripe_unit_bytes);
+    off_t units = (static_cast<off_t>(DISK_SIZE_BYTES) + unit - 1) / unit;
+    off_t rows = (units + static_cast<off_t>(options.members.size()) - 1) / static_cast<off_t>(options.members.size());
+    return rows * unit;
+}
+
+// Üye dosyalarını sıfırlarla oluşturur. Hata olursa oluşturulanlar silinir.
+bool create_stripe_members(const StripedDeviceOptions& options) {
+    for (size_t i = 0; i < options.members.size(); ++i) {
+        const char* path = options.members[i].c_str();
+        std::ofstream member(path, std::ios::binary | std::ios::out);
+        member.close();
+        if (!member || truncate(path, stripe_member_size(options)) != 0) {
+            std::cerr << "Error: Could not create striped device member '" << path << "'." << std::endl;
+            for (size_t j = 0; j <= i; ++j) remove(options.members[j].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+class StripedDevice : public BlockDevice {
+public:
+    explicit StripedDevice(const StripedDeviceOptions& options)
+        : unit_(static_cast<off_t>(options.stripe_unit_bytes)), members_(options.members.size(), nullptr), opened_(false) {
+        off_t member_size = stripe_member_size(options);
+        for (size_t i = 0; i < members_.size(); ++i) {
+            int fd = open(options.members[i].c_str(), O_RDWR);
+            struct stat info;
+            if (fd < 0 || fstat(fd, &info) != 0 || info.st_size != member_size) {
+                // Eksik veya başka bir birim/üye sayısıyla oluşturulmuş üye: cilt yanlış birleşirdi
+                fs_log(("Striped device member '" + options.members[i] + "' is missing or has the wrong size (expected " +
+                        std::to_string(static_cast<int64_t>(member_size)) + " bytes).").c_str());
+                if (fd >= 0) close(fd);
+                return;
+            }
+            members_[i] = new StripeMember(fd);
+        }
+        size_ = DISK_SIZE_BYTES;
+        opened_ = true;
+    }
+    ~StripedDevice() {
+        for (StripeMember* member : members_) delete member;
+    }
+    bool opened() const { return opened_; }
+    int type() const { return BLOCK_DEVICE_STRIPED; }
+    bool read_at(off_t offset, char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::vector<std::vector<StripeSegment> > segments(members_.size());
+        split(offset, buffer, length, segments);
+        return transfer(segments, false);
+    }
+    bool write_at(off_t offset, const char* buffer, size_t length) {
+        if (!in_bounds(offset, length)) return false;
+        std::vector<std::vector<StripeSegment> > segments(members_.size());
+        split(offset, const_cast<char*>(buffer), length, segments);
+        return transfer(segments, true);
+    }
+    bool submit_batch(std::vector<BlockIoRequest>& batch, bool is_write) {
+        active_volume().active_io_backend.store(IO_BACKEND_PREAD);
+        std::vector<std::vector<StripeSegment> > segments(members_.size());
+        for (BlockIoRequest& request : batch) {
+            if (!in_bounds(request.offset, request.length)) return false;
+            split(request.offset, request.buffer, request.length, segments);
+        }
+        return transfer(segments, is_write);
+    }
+    bool flush() { return true; } // pread/pwrite: kullanıcı alanı tamponu yok
+
+private:
+    struct StripeSegment {
+        off_t member_offset;
+        char* buffer;
+        size_t length;
+    };
+
+    // Bir üyenin tanımlayıcısı ve G/Ç iş parçacığı. İşler sırayla yürütülür.
+    class StripeMember {
+    public:
+        explicit StripeMember(int fd) : fd(fd), stopping_(false), worker_(&StripeMember::worker_loop, this) {}
+        ~StripeMember() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_one();
+            worker_.join();
+            close(fd);
+        }
+        void post(const std::function<void()>& job) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(job);
+            cv_.notify_one();
+        }
+        const int fd;
+
+    private:
+        void worker_loop() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                    if (jobs_.empty()) return;
+                    job.swap(jobs_.front());
+                    jobs_.pop_front();
+                }
+                job();
+            }
+        }
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::function<void()> > jobs_;
+        bool stopping_;
+        std::thread worker_; // En son kurulur: döngü diğer üyeleri kullanır
+    };
+
+    // [offset, offset + length) aralığını üye parçalarına böler; üyede ve tamponda bitişik parçalar birleştirilir.
+    void split(off_t offset, char* buffer, size_t length, std::vector<std::vector<StripeSegment> >& segments) const {
+        off_t members = static_cast<off_t>(members_.size());
+        size_t done = 0;
+        while (done < length) {
+            off_t logical = offset + static_cast<off_t>(done);
+            off_t stripe = logical / unit_;
+            off_t within = logical % unit_;
+            size_t chunk = static_cast<size_t>(std::min<off_t>(unit_ - within, static_cast<off_t>(length - done)));
+            StripeSegment segment = {(stripe / members) * unit_ + within, buffer + done, chunk};
+            std::vector<StripeSegment>& list = segments[static_cast<size_t>(stripe % members)];
+            if (!list.empty() && list.back().member_offset + static_cast<off_t>(list.back().length) == segment.member_offset &&
+                list.back().buffer + list.back().length == segment.buffer) {
+                list.back().length += chunk;
+            } else {
+                list.push_back(segment);
+            }
+            done += chunk;
+        }
+    }
+
+    static bool run_segments(int fd, const std::vector<StripeSegment>& list, bool is_write) {
+        for (const StripeSegment& segment : list) {
+            bool ok = is_write ? pwrite_full(fd, segment.buffer, segment.length, segment.member_offset)
+                               : pread_full(fd, segment.buffer, segment.length, segment.member_offset);
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    bool transfer(const std::vector<std::vector<StripeSegment> >& segments, bool is_write) {
+        std::vector<size_t> involved;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (!segments[i].empty()) involved.push_back(i);
+        }
+        if (involved.empty()) return true;
+        if (involved.size() == 1) return run_segments(members_[involved[0]]->fd, segments[involved[0]], is_write);
+
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        size_t remaining = involved.size() - 1;
+        bool all_ok = true;
+        for (size_t k = 1; k < involved.size(); ++k) {
+            StripeMember* member = members_[involved[k]];
+            const std::vector<StripeSegment>* list = &segments[involved[k]];
+            member->post([member, list, is_write, &done_mutex, &done_cv, &remaining, &all_ok]() {
+                bool ok = run_segments(member->fd, *list, is_write);
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (!ok) all_ok = false;
+                if (--remaining == 0) done_cv.notify_one();
+            });
+        }
+        bool ok = run_segments(members_[involved[0]]->fd, segments[involved[0]], is_write);
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [&remaining] { return remaining == 0; });
+        return ok && all_ok;
+    }
+
+    off_t unit_;
+    std::vector<StripeMember*> members_;
+    bool opened_;
+};
+
+template <typename Device, typename Source>
+BlockDevice* open_device_checked(const Source& source) {
+    Device* device = new Device(source);
+    if (!device->opened()) {
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+// Bağlı aygıtı döndürür, gerekirse açar. Açılamazsa nullptr (disk dosyası yok, O_DIRECT desteklenmiyor...).
+BlockDevice* block_device() {
+    Volume& volume = active_volume();
+    BlockDevice* device = volume.mounted_device.load(std::memory_order_acquire);
+    if (device != nullptr) return device;
+    std::lock_guard<std::mutex> lock(volume.device_open_lock);
+    device = volume.mounted_device.load(std::memory_order_acquire);
+    if (device != nullptr) return device;
+    switch (volume.mounted_device_type.load()) {
+        case BLOCK_DEVICE_BUFFERED_FILE: device = open_device_checked<BufferedFileDevice>(volume.disk_path.c_str()); break;
+        case BLOCK_DEVICE_MMAP: device = open_device_checked<MmapDevice>(volume.disk_path.c_str()); break;
+        case BLOCK_DEVICE_DIRECT: device = open_device_checked<DirectDevice>(volume.disk_path.c_str()); break;
+        case BLOCK_DEVICE_RAM: device = new RamDevice(); break;
+        case BLOCK_DEVICE_STRIPED: device = open_device_checked<StripedDevice>(volume.striped_options); break;
+        default: device = open_device_checked<PreadDevice>(volume.disk_path.c_str()); break;
+    }
+    if (device == nullptr) {
+        fs_log(("Could not open block device type " + std::to_string(volume.mounted_device_type.load()) + " on '" + volume.disk_path + "'.").c_str());
+        return nullptr;
+    }
+    volume.mounted_device.store(device, std::memory_order_release);
+    return device;
+}
+
+// Volume kilidi özel tutulurken çağrılır. RAM diski (keep_ram_disk ise) içeriği kaybolmasın diye tutulur.
+void release_block_device(bool keep_ram_disk) {
+    Volume& volume = active_volume();
+    volume.allocation_state_reconciled.store(false); // Sonraki aygıt (veya aradaki dış değişiklik) yeniden denetlenir
+    BlockDevice* device = volume.mounted_device.load();
+    if (device == nullptr) return;
+    device->flush();
+    if (keep_ram_disk && device->type() == BLOCK_DEVICE_RAM) return;
+    volume.mounted_device.store(nullptr);
+    delete device; // Yeni aygıtın tanımlayıcısı yeni bir kimlikle gelir; io_uring halkaları onu yeniden kaydeder
+}
+
+// Program çıkarken varsayılan cildin açık aygıtını boşaltıp kapatır (tamponlu dosya aygıtının tamponu, RAM
+// diskinin dump görüntüsü). Diğer ciltlerin aygıtlarını FileSystem yıkıcısı kapatır.
+struct BlockDeviceCloser {
+    ~BlockDeviceCloser() {
+        BlockDevice* device = default_volume().mounted_device.exchange(nullptr);
+        if (device != nullptr) device->flush();
+        delete device;
+    }
+};
+static BlockDeviceCloser block_device_closer;
+
+// std::fstream yerine kullanılan akış: Metadata kodunun kullandığı seekg/seekp/read/write/gcount ve durum
+// bitlerini bağlı aygıt üzerinde taklit eder. Akışın kendi tamponu yoktur, yazmalar doğrudan aygıta gider;
+// flush() bu yüzden yalnızca arayüz uyumluluğu içindir. Görüntü sabit boyutludur: sonun ötesine yazma başarısız olur.
+class DiskStream {
+public:
+    explicit DiskStream(std::ios::openmode mode = std::ios::in | std::ios::out)
+        : device_(block_device()), writable_((mode & std::ios::out) != 0), position_(0), gcount_(0),
+          state_(std::ios::goodbit) {
+        if (device_ == nullptr) state_ = std::ios::failbit;
+    }
+
+    DiskStream& seekg(std::streamoff offset, std::ios::seekdir direction = std::ios::beg) { return seek(offset, direction); }
+    DiskStream& seekp(std::streamoff offset, std::ios::seekdir direction = std::ios::beg) { return seek(offset, direction); }
+
+    DiskStream& read(char* buffer, std::streamsize length) {
+        gcount_ = 0;
+        if (state_ != std::ios::goodbit || device_ == nullptr) {
+            state_ |= std::ios::failbit;
+            return *this;
+        }
+        std::streamsize available = static_cast<std::streamsize>(device_->size() - position_);
+        std::streamsize got = std::min(length, std::max<std::streamsize>(available, 0));
+        if (got > 0 && !device_->read_at(position_, buffer, static_cast<size_t>(got))) {
+            state_ |= std::ios::badbit | std::ios::failbit;
+            return *this;
+        }
+        position_ += got;
+        gcount_ = got;
+        if (got < length) state_ |= std::ios::eofbit | std::ios::failbit;
+        return *this;
+    }
+
+    DiskStream& write(const char* buffer, std::streamsize length) {
+        if (state_ != std::ios::goodbit || device_ == nullptr || !writable_ ||
+            position_ + static_cast<off_t>(length) > device_->size()) {
+            state_ |= std::ios::failbit;
+            return *this;
+        }
+        if (length > 0 && !device_->write_at(position_, buffer, static_cast<size_t>(length))) {
+            state_ |= std::ios::badbit | std::ios::failbit;
+            return *this;
+        }
+        position_ += length;
+        return *this;
+    }
+
+    std::streamsize gcount() const { return gcount_; }
+    DiskStream& flush() { return *this; }
+    void close() { device_ = nullptr; }
+    void clear() { state_ = std::ios::goodbit; }
+    bool good() const { return state_ == std::ios::goodbit; }
+    bool eof() const { return (state_ & std::ios::eofbit) != 0; }
+    bool fail() const { return (state_ & (std::ios::failbit | std::ios::badbit)) != 0; }
+    bool operator!() const { return fail(); }
+    explicit operator bool() const { return !fail(); }
+
+private:
+    DiskStream& seek(std::streamoff offset, std::ios::seekdir direction) {
+        state_ &= ~std::ios::eofbit;
+        if (fail()) return *this;
+        off_t base = direction == std::ios::cur ? position_ : (direction == std::ios::end ? device_->size() : 0);
+        off_t target = base + static_cast<off_t>(offset);
+        if (target < 0 || target > device_->size()) {
+            state_ |= std::ios::failbit;
+            return *this;
+        }
+        position_ = target;
+        return *this;
+    }
+
+    BlockDevice* device_;
+    bool writable_;
+    off_t position_;
+    std::streamsize gcount_;
+    std::ios::iostate state_;
+};
+
+// Toplu veri G/Ç'sini bağlı aygıta verir.
+bool disk_io_batch(std::vector<BlockIoRequest>& batch, bool is_write) {
+    if (batch.empty()) return true;
+    BlockDevice* device = block_device();
+    if (device == nullptr) {
+        fs_log("disk_io_batch failed: no block device could be opened.");
+        return false;
+    }
+    return device->submit_batch(batch, is_write);
+}
+
+int fs_get_block_device() {
+    return active_volume().mounted_device_type.load();
+}
+
+bool fs_get_direct_io_stats(DirectIoStats& stats_out) {
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    BlockDevice* device = active_volume().mounted_device.load(std::memory_order_acquire);
+    if (device == nullptr || device->type() != BLOCK_DEVICE_DIRECT) return false;
+    stats_out = static_cast<DirectDevice*>(device)->stats();
+    return true;
+}
+
+// 64-bit boyut/offset aritmetiği için taşma kontrollü toplama.
+// a ve b negatif olmamalıdır. Taşma olursa false döner ve 'result' değiştirilmez.
+bool checked_add_size(int64_t a, int64_t b, int64_t& result) {
+    if (a < 0 || b < 0 || a > std::numeric_limits<int64_t>::max() - b) {
+        return false;
+    }
+    result = a + b;
+    return true;
+}
+
+// Verilen byte boyutunu tutmak için gereken blok sayısı.
+// (size + BLOCK_SIZE_BYTES - 1) ifadesi büyük boyutlarda taşabileceği için bölüm/kalan ile hesaplanır.
+int64_t blocks_needed_for_size(int64_t size) {
+    if (size <= 0) return 0;
+    return size / BLOCK_SIZE_BYTES + ((size % BLOCK_SIZE_BYTES) != 0 ? 1 : 0);
+}
 
 // Helper function to check if disk file exists
+// (RAM diskinde dosya yoktur: bellekteki görüntü ayrıldıysa disk var sayılır.)
 bool disk_exists() {
+    Volume& volume = active_volume();
+    if (volume.mounted_device_type.load() == BLOCK_DEVICE_RAM) return volume.mounted_device.load() != nullptr;
     struct stat buffer;
-    return (stat(DISK_FILENAME, &buffer) == 0);
+    if (volume.mounted_device_type.load() == BLOCK_DEVICE_STRIPED) {
+        for (const std::string& member : volume.striped_options.members) {
+            if (stat(member.c_str(), &buffer) != 0) return false;
+        }
+        return true;
+    }
+    return (stat(disk_filename(), &buffer) == 0);
 }
 
+bool reconcile_allocation_state();
+
 // Helper function to create and initialize the disk file if it doesn't exist
-void ensure_disk_initialized() {
+// Paylaşımlı kilit tutan işlemler bunu kilidi almadan önce çağırır (oluşturma ve format özel kilit ister).
+// Disk varsa ve bu açılışta henüz yapılmadıysa tahsis durumu FileInfo tablosuyla uzlaştırılır; paylaşımlı kilit
+// tutan iç içe çağrı bunu bir sonraki üst düzey çağrıya bırakır.
+bool ensure_disk_initialized() {
+    if (disk_exists()) {
+        if (active_volume().allocation_state_reconciled.load() || volume_lock_mode == LOCK_MODE_SHARED) return true;
+        VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+        if (!volume_guard.held()) return true;
+        if (!active_volume().allocation_state_reconciled.load()) reconcile_allocation_state();
+        return true;
+    }
+    if (volume_lock_mode == LOCK_MODE_SHARED) {
+        // Disk oluşturmak özel kilit ister ve yükseltme yapılmaz: çağrı başarısız olur, sonraki G/Ç hata döndürür
+        std::cerr << "Error: Disk file '" << disk_filename() << "' disappeared during an operation." << std::endl;
+        fs_log(("ensure_disk_initialized failed: disk file '" + std::string(disk_filename()) + "' is missing and the shared lock is held.").c_str());
+        return false;
+    }
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!disk_exists() && active_volume().mounted_device_type.load() == BLOCK_DEVICE_RAM) {
+        std::cout << "RAM disk not allocated. Creating and initializing..." << std::endl;
+        if (block_device() == nullptr) return false;
+        std::cout << "RAM disk created with size " << DISK_SIZE_BYTES << " bytes." << std::endl;
+        fs_format();
+        return true;
+    }
+    if (!disk_exists() && active_volume().mounted_device_type.load() == BLOCK_DEVICE_STRIPED) {
+        // Yalnızca hiçbir üye yoksa oluşturulur; eksik bir üye (takılmamış disk) diğerlerinin formatlanmasına yol açmamalı
+        const StripedDeviceOptions& options = active_volume().striped_options;
+        struct stat buffer;
+        for (const std::string& member : options.members) {
+            if (stat(member.c_str(), &buffer) == 0) {
+                std::cerr << "Error: Striped device is incomplete, member '" << member << "' exists but others are missing." << std::endl;
+                return false;
+            }
+        }
+        std::cout << "Striped device members not found. Creating " << options.members.size() << " members and initializing..." << std::endl;
+        if (!create_stripe_members(options)) return false;
+        release_block_device(false);
+        fs_format();
+        return true;
+    }
     if (!disk_exists()) {
-        std::cout << "Disk file '" << DISK_FILENAME << "' not found. Creating and initializing..." << std::endl;
-        std::ofstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::out);
+        std::cout << "Disk file '" << disk_filename() << "' not found. Creating and initializing..." << std::endl;
+        std::ofstream disk_file(disk_filename(), std::ios::binary | std::ios::out);
         if (!disk_file) {
-            std::cerr << "Error: Could not create disk file '" << DISK_FILENAME << "'." << std::endl;
+            std::cerr << "Error: Could not create disk file '" << disk_filename() << "'." << std::endl;
             // Proje gereksinimlerine göre burada programdan çıkılabilir veya hata yönetimi yapılabilir.
             // Şimdilik sadece bir hata mesajı veriyoruz.
-            return;
+            return false;
         }
         // Dosyayı istenen boyuta getirme (truncate)
-        if (truncate(DISK_FILENAME, DISK_SIZE_BYTES) != 0) {
+        if (truncate(disk_filename(), DISK_SIZE_BYTES) != 0) {
             std::cerr << "Error: Could not set disk file size to " << DISK_SIZE_BYTES << " bytes." << std::endl;
             disk_file.close();
             // Hata durumunda dosyayı silmek isteyebiliriz.
-            remove(DISK_FILENAME);
-            return;
+            remove(disk_filename());
+            return false;
         }
         disk_file.close();
-        std::cout << "Disk file '" << DISK_FILENAME << "' created with size " << DISK_SIZE_BYTES << " bytes." << std::endl;
+        release_block_device(false); // Silinmiş eski bir görüntüye açık kalan aygıt artık geçersiz
+        std::cout << "Disk file '" << disk_filename() << "' created with size " << DISK_SIZE_BYTES << " bytes." << std::endl;
         fs_format(); // Yeni diski formatla
     }
+    return disk_exists();
 }
 
 
 void fs_init() {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     std::cout << "Initializing SimpleFS..." << std::endl;
     ensure_disk_initialized();
     // TODO: Gerekirse disk dosyasını açıp, temel metadata kontrolleri yapılabilir.
@@ -46,14 +1569,22 @@ void fs_init() {
     std::cout << "SimpleFS initialized." << std::endl;
 }
 
-void fs_format() {
-    std::cout << "Formatting disk '" << DISK_FILENAME << "' with new metadata structure..." << std::endl;
+void fs_format(int allocator_mode) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    std::cout << "Formatting disk '" << disk_filename() << "' with new metadata structure..." << std::endl;
+
+    if (allocator_mode != ALLOCATOR_BITMAP_FIRST_FIT && allocator_mode != ALLOCATOR_BUDDY) {
+        std::cerr << "Error: Unknown allocator mode " << allocator_mode << ". Disk was not formatted." << std::endl;
+        fs_log(("fs_format failed: unknown allocator mode " + std::to_string(allocator_mode)).c_str());
+        return;
+    }
     
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' for formatting (new structure)." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' for formatting (new structure)." << std::endl;
         if (!disk_exists()) {
-             std::cerr << "Error: Disk file '" << DISK_FILENAME << "' does not exist. Cannot format." << std::endl;
+             std::cerr << "Error: Disk file '" << disk_filename() << "' does not exist. Cannot format." << std::endl;
              std::cerr << "Run fs_init() first to create and initialize the disk." << std::endl;
              // return; // ensure_disk_initialized zaten fs_init içinde çağrılıyor, burada return edebiliriz.
         } else {
@@ -73,8 +1604,12 @@ void fs_format() {
         return;
     }
 
-    // 2. Süperbloku diske yaz (varsayılan değerlerle)
+    // 2. Süperbloku diske yaz (varsayılan değerlerle, seçilen tahsis motoruyla)
     Superblock sb; // Kurucu metodunda num_active_files = 0 olur
+    sb.allocator_mode = allocator_mode;
+    sb.stats.free_blocks = NUM_DATA_BLOCKS; // Tüm veri alanı tek bir boş parça
+    sb.stats.largest_free_extent_hint = NUM_DATA_BLOCKS;
+    sb.stats.free_extent_count = 1;
     disk_file.seekp(0, std::ios::beg); 
     disk_file.write(reinterpret_cast<const char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
     if (!disk_file) {
@@ -85,19 +1620,64 @@ void fs_format() {
 
     // Bitmap alanı ve FileInfo dizisi alanı zaten yukarıdaki genel sıfırlama ile
     // (is_used = false vs. olacak şekilde) başlatılmış oldu.
+
+    // 3. Kök dizini ilk FileInfo slotuna yaz. Hash tablosu ilk girdide tembel olarak tahsis edilir,
+    //    böylece boş bir disk hiç veri bloğu kullanmaz. Kök, num_active_files'a dahil değildir.
+    FileInfo root_dir;
+    root_dir.name[0] = PATH_SEPARATOR;
+    root_dir.name[1] = '\0';
+    root_dir.creation_time = time(nullptr);
+    root_dir.is_used = true;
+    root_dir.type = FILE_TYPE_DIRECTORY;
+    root_dir.parent_index = ROOT_DIR_INDEX;
+    disk_file.seekp(FILE_INFO_ARRAY_START_OFFSET_IN_METADATA + ROOT_DIR_INDEX * FILE_INFO_ENTRY_SIZE, std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&root_dir), FILE_INFO_ENTRY_SIZE);
+    if (!disk_file) {
+        std::cerr << "Error: Could not write root directory entry to metadata." << std::endl;
+        disk_file.close();
+        return;
+    }
     
+    // 4. Tahsis grubu özetleri: Tüm bloklar boş.
+    char empty_bitmap[BITMAP_SIZE_BYTES] = {0};
+    if (!rebuild_group_summaries(disk_file, empty_bitmap)) {
+        std::cerr << "Error: Could not write allocation group summaries to metadata." << std::endl;
+        disk_file.close();
+        return;
+    }
+
     disk_file.close();
+    buddy_invalidate_free_lists(); // Bitmap sıfırlandı; bellekteki buddy listeleri artık geçersiz
+    allocation_state_invalidate();
+    active_volume().allocation_state_reconciled.store(true); // Yeni biçimlenen görüntü FileInfo tablosuyla tutarlı
+    discard_all_delayed_writes();
+    invalidate_file_handles(-1);
     std::cout << "Disk formatted successfully (new structure). Superblock, Bitmap, and FileInfo array initialized." << std::endl;
+    std::cout << "  Allocator: " << (allocator_mode == ALLOCATOR_BUDDY ? "buddy" : "bitmap first-fit") << std::endl;
     std::cout << "  Calculated MAX_FILES: " << MAX_FILES_CALCULATED << std::endl;
     std::cout << "  Bitmap size: " << BITMAP_SIZE_BYTES << " bytes (for " << NUM_DATA_BLOCKS << " data blocks)." << std::endl;
     std::cout << "  Superblock size: " << SUPERBLOCK_ACTUAL_SIZE << " bytes." << std::endl;
     std::cout << "  FileInfo entry size: " << FILE_INFO_ENTRY_SIZE << " bytes." << std::endl;
     std::cout << "  Offset for Bitmap in metadata: " << BITMAP_START_OFFSET_IN_METADATA << " bytes." << std::endl;
+    std::cout << "  Allocation groups: " << NUM_ALLOCATION_GROUPS << " x " << ALLOCATION_GROUP_BLOCKS << " blocks, summary table at offset " << GROUP_SUMMARY_START_OFFSET_IN_METADATA << " bytes." << std::endl;
     std::cout << "  Offset for FileInfo array in metadata: " << FILE_INFO_ARRAY_START_OFFSET_IN_METADATA << " bytes." << std::endl;
     std::cout << "  Usable space for FileInfo array: " << FILE_INFO_ARRAY_USABLE_SIZE << " bytes." << std::endl;
 
 
-    fs_log(("Disk formatted with new metadata structure (superblock, bitmap, FileInfo array). Max files: " + std::to_string(MAX_FILES_CALCULATED)).c_str());
+    fs_log(("Disk formatted with new metadata structure (superblock, bitmap, FileInfo array). Max files: " + std::to_string(MAX_FILES_CALCULATED) +
+            ", allocator mode: " + std::to_string(allocator_mode)).c_str());
+}
+
+int fs_get_allocator_mode() {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    DiskStream disk_file(std::ios::in);
+    Superblock sb;
+    disk_file.read(reinterpret_cast<char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
+    if (!disk_file) {
+        return -1;
+    }
+    return sb.allocator_mode;
 }
 
 // Helper function to read all FileInfo entries from metadata
@@ -105,9 +1685,9 @@ std::vector<FileInfo> read_all_file_info(Superblock& sb_out) { // Superblock'u r
     std::vector<FileInfo> infos;
     // sb_out.num_active_files = 0; // Fonksiyonun başında sıfırlamak yerine okunan değeri ata
 
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in);
+    DiskStream disk_file(std::ios::in);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' to read metadata (read_all_file_info)." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to read metadata (read_all_file_info)." << std::endl;
         sb_out.num_active_files = -1; // Hata durumunu belirtmek için özel bir değer
         return infos; 
     }
@@ -152,25 +1732,37 @@ bool write_file_info_at_index(int index, const FileInfo& fi_to_write, Superblock
         return false;
     }
 
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out); 
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' to write metadata (write_file_info_at_index)." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to write metadata (write_file_info_at_index)." << std::endl;
         return false;
     }
 
-    // 1. FileInfo'yu yaz
+    // 1. FileInfo'yu yaz (kullanım sayaçları için önce eski hali okunur)
     std::streampos pos = FILE_INFO_ARRAY_START_OFFSET_IN_METADATA + (index * FILE_INFO_ENTRY_SIZE);
+    FileInfo old_fi;
+    disk_file.seekg(pos, std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&old_fi), FILE_INFO_ENTRY_SIZE);
+    if (!disk_file) {
+        std::cerr << "Error: Could not read FileInfo at index " << index << " (write_file_info_at_index)." << std::endl;
+        disk_file.close();
+        return false;
+    }
     disk_file.seekp(pos, std::ios::beg);
     disk_file.write(reinterpret_cast<const char*>(&fi_to_write), FILE_INFO_ENTRY_SIZE);
+    active_volume().file_info_generation[index].fetch_add(1); // Açık tutamaçların önbelleği artık eski
     if (!disk_file) {
         std::cerr << "Error: Could not write FileInfo at index " << index << " (write_file_info_at_index)." << std::endl;
         disk_file.close();
         return false;
     }
 
-    // 2. Superblock'u güncelle (num_active_files)
-    disk_file.seekp(0, std::ios::beg);
-    disk_file.write(reinterpret_cast<const char*>(&sb_to_update), SUPERBLOCK_ACTUAL_SIZE);
+    account_file_info_change(disk_file, old_fi, fi_to_write);
+
+    // 2. Superblock'u güncelle (sadece num_active_files). Alan istatistikleri tahsis yolunda güncellenir;
+    //    çağıranın elindeki süperblok kopyası onlar için eski olabilir, bu yüzden tüm süperblok yazılmaz.
+    disk_file.seekp(offsetof(Superblock, num_active_files), std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&sb_to_update.num_active_files), sizeof(sb_to_update.num_active_files));
     if (!disk_file) {
         std::cerr << "Error: Could not update superblock in metadata (write_file_info_at_index)." << std::endl;
         disk_file.close();
@@ -181,87 +1773,667 @@ bool write_file_info_at_index(int index, const FileInfo& fi_to_write, Superblock
     return true;
 }
 
+// Tek bir FileInfo kaydını okur (tutamaç önbelleğini tazelemek için; dizinin tamamı okunmaz).
+bool read_file_info_at_index(int index, FileInfo& fi_out) {
+    if (index < 0 || index >= MAX_FILES_CALCULATED) return false;
+    DiskStream disk_file(std::ios::in);
+    if (!disk_file) {
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to read metadata (read_file_info_at_index)." << std::endl;
+        return false;
+    }
+    disk_file.seekg(FILE_INFO_ARRAY_START_OFFSET_IN_METADATA + (index * FILE_INFO_ENTRY_SIZE), std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&fi_out), FILE_INFO_ENTRY_SIZE);
+    bool ok = static_cast<bool>(disk_file);
+    disk_file.close();
+    return ok;
+}
 
-void fs_create(const char* filename) {
-    ensure_disk_initialized(); 
+// ------------- SATIR İÇİ (INLINE) VERİ YARDIMCI FONKSİYONLARI -------------
+// Satır içi veri, FileInfo::name dizisinde ismin NUL sonlandırıcısından sonraki baytlarda tutulur.
+// Bu yüzden kullanılabilir alan isim uzunluğuna bağlıdır: MAX_FILENAME_LENGTH - strlen(name).
 
-    if (filename == nullptr || strlen(filename) == 0) {
-        std::cerr << "Error: Filename cannot be empty." << std::endl;
-        fs_log("fs_create failed: empty filename.");
-        return;
-    }
+// Verilen isimle bir dosyanın satır içi tutabileceği en fazla byte.
+int64_t inline_capacity_for_name(const char* name) {
+    int64_t spare = static_cast<int64_t>(MAX_FILENAME_LENGTH) - static_cast<int64_t>(strlen(name));
+    return std::min(spare, static_cast<int64_t>(INLINE_DATA_MAX_BYTES));
+}
 
-    if (strlen(filename) > MAX_FILENAME_LENGTH) {
-        std::cerr << "Error: Filename '" << filename << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
-        fs_log("fs_create failed: filename too long.");
-        return;
-    }
+bool is_inline_file(const FileInfo& fi) {
+    return (fi.flags & FILE_FLAG_INLINE_DATA) != 0;
+}
 
-    Superblock sb; // Önce superblock'u okumak için
-    std::vector<FileInfo> all_files = read_all_file_info(sb); // sb referans ile güncellenecek
+// Bu boyuttaki içerik dosyanın kendi FileInfo kaydına sığar mı? (Dizinler her zaman bloklarda tutulur.)
+bool fits_inline(const FileInfo& fi, int64_t size) {
+    return fi.type == FILE_TYPE_REGULAR && !(fi.flags & FILE_FLAG_PREALLOCATED) && size > 0 && size <= inline_capacity_for_name(fi.name);
+}
 
-    if (sb.num_active_files == -1) { // read_all_file_info'dan hata geldi
-        std::cerr << "Error: Could not read metadata to create file." << std::endl;
-        fs_log("fs_create failed: metadata read error.");
-        return;
+char* inline_data_ptr(FileInfo& fi) {
+    return fi.name + strlen(fi.name) + 1;
+}
+
+const char* inline_data_ptr(const FileInfo& fi) {
+    return fi.name + strlen(fi.name) + 1;
+}
+
+// Satır içi veriyi ve bayrağı temizler (isimden sonraki tüm baytlar sıfırlanır).
+void clear_inline_data(FileInfo& fi) {
+    size_t name_len = strlen(fi.name);
+    memset(fi.name + name_len, 0, sizeof(fi.name) - name_len);
+    fi.flags &= ~FILE_FLAG_INLINE_DATA;
+}
+
+// Girdinin ismini değiştirir; satır içi veri varsa yeni ismin arkasına taşınır.
+// Çağıran, verinin yeni isimle sığdığından emin olmalıdır (bkz. spill_inline_data_to_blocks).
+void set_entry_name(FileInfo& fi, const char* new_name) {
+    char saved_data[INLINE_DATA_MAX_BYTES];
+    int64_t saved_size = 0;
+    if (is_inline_file(fi)) {
+        saved_size = fi.size;
+        memcpy(saved_data, inline_data_ptr(fi), saved_size);
     }
+    memset(fi.name, 0, sizeof(fi.name));
+    strncpy(fi.name, new_name, MAX_FILENAME_LENGTH);
+    if (saved_size > 0) {
+        memcpy(inline_data_ptr(fi), saved_data, saved_size);
+    }
+}
 
+// Satır içi veriyi yeni tahsis edilen veri bloklarına taşır ve FileInfo'yu diske yazar.
+// (Uzun bir isme yeniden adlandırma gibi, veri artık isimle birlikte sığmadığında kullanılır.)
+bool spill_inline_data_to_blocks(int file_index, FileInfo& fi, Superblock& sb) {
+    if (!is_inline_file(fi)) return true;
 
-    // Dosya adının mevcut olup olmadığını kontrol et
-    for (int i = 0; i < all_files.size(); ++i) { 
-        if (all_files[i].is_used && strcmp(all_files[i].name, filename) == 0) {
-            std::cerr << "Error: File '" << filename << "' already exists." << std::endl;
-            fs_log("fs_create failed: file already exists.");
-            return;
-        }
+    int64_t num_blocks = blocks_needed_for_size(fi.size);
+    int start_block = find_and_allocate_contiguous_data_blocks(static_cast<int>(num_blocks), fi.placement_goal);
+    if (start_block == -1) {
+        std::cerr << "Error: Could not allocate a data block to move inline data of '" << fi.name << "' out of its FileInfo." << std::endl;
+        return false;
     }
 
-    if (sb.num_active_files >= MAX_FILES_CALCULATED) {
-        std::cerr << "Error: Maximum number of files (" << MAX_FILES_CALCULATED << ") reached. Cannot create new file." << std::endl;
-        fs_log("fs_create failed: maximum files reached.");
-        return;
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    if (disk_file) {
+        disk_file.seekp(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(start_block) * BLOCK_SIZE_BYTES);
+        disk_file.write(inline_data_ptr(fi), fi.size);
+    }
+    if (!disk_file) {
+        std::cerr << "Error: Could not write inline data of '" << fi.name << "' to block " << start_block << "." << std::endl;
+        for (int64_t i = 0; i < num_blocks; ++i) {
+            free_data_block(start_block + static_cast<int>(i));
+        }
+        return false;
     }
+    disk_file.close();
 
-    int empty_slot_index = -1;
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) { 
-        // all_files vektörü MAX_FILES_CALCULATED boyutunda olmalı
-        // Eğer all_files[i] read_all_file_info içinde düzgün okunduysa ve kullanılmıyorsa
-        if (i < all_files.size() && !all_files[i].is_used) {
-            empty_slot_index = i;
-            break;
+    FileInfo updated = fi;
+    clear_inline_data(updated);
+    updated.start_data_block_index = start_block;
+    updated.num_data_blocks_used = static_cast<unsigned int>(num_blocks);
+    if (!write_file_info_at_index(file_index, updated, sb)) {
+        for (int64_t i = 0; i < num_blocks; ++i) {
+            free_data_block(start_block + static_cast<int>(i));
         }
+        return false;
     }
-    
+    fi = updated;
+    fs_log(("Inline data of '" + std::string(fi.name) + "' moved to block " + std::to_string(start_block) + ".").c_str());
+    return true;
+}
+
+// ------------- KUYRUK PAKETLEME (TAIL PACKING) YARDIMCI FONKSİYONLARI -------------
+// Kuyruk blokları için ayrı bir disk yapısı yoktur: Bir bloğun hangi aralıklarının dolu olduğu,
+// o bloğu tail_block_index olarak gösteren FileInfo'lardan çıkarılır. Bitmap'te kuyruk bloğu,
+// en az bir dosya kullandığı sürece dolu olarak işaretli kalır.
+
+bool has_packed_tail(const FileInfo& fi) {
+    return fi.tail_block_index >= 0;
+}
+
+// Dosyanın ardışık veri bloklarında duran byte sayısı (satır içi veri ve paketlenmiş kuyruk hariç).
+int64_t block_backed_bytes(const FileInfo& fi) {
+    if (is_inline_file(fi)) return 0;
+    return fi.size - (has_packed_tail(fi) ? static_cast<int64_t>(fi.tail_length) : 0);
+}
+
+// Bu boyuttaki bir içeriğin artığı paylaşılan bir kuyruk bloğuna konmalı mı?
+bool should_pack_tail(const FileInfo& fi, int64_t size) {
+    int64_t remainder = size % BLOCK_SIZE_BYTES;
+    return fi.type == FILE_TYPE_REGULAR && !(fi.flags & FILE_FLAG_PREALLOCATED) &&
+           remainder > 0 && remainder <= static_cast<int64_t>(TAIL_PACK_MAX_BYTES);
+}
+
+// Verilen uzunlukta bir kuyruk için yer bulur. Önce mevcut kuyruk bloklarındaki boşluklara bakar (first-fit),
+// yoksa yeni bir blok tahsis eder. Blok indeksini döndürür (bulunamazsa -1), ofseti offset_out'a yazar.
+int allocate_tail_slot(const std::vector<FileInfo>& all_files, unsigned int length, unsigned int& offset_out) {
+    std::lock_guard<std::recursive_mutex> allocator_guard(active_volume().allocator_lock); // Çağıran FileInfo'yu yazana kadar tutmalı
+    std::vector<int> tail_blocks;
+    for (const FileInfo& fi : all_files) {
+        if (fi.is_used && has_packed_tail(fi) &&
+            std::find(tail_blocks.begin(), tail_blocks.end(), fi.tail_block_index) == tail_blocks.end()) {
+            tail_blocks.push_back(fi.tail_block_index);
+        }
+    }
+
+    for (int block : tail_blocks) {
+        std::vector<std::pair<unsigned int, unsigned int> > used; // (ofset, uzunluk)
+        for (const FileInfo& fi : all_files) {
+            if (fi.is_used && fi.tail_block_index == block) {
+                used.push_back(std::make_pair(static_cast<unsigned int>(fi.tail_offset), static_cast<unsigned int>(fi.tail_length)));
+            }
+        }
+        std::sort(used.begin(), used.end());
+        unsigned int cursor = 0;
+        for (size_t i = 0; i <= used.size(); ++i) {
+            unsigned int gap_end = (i < used.size()) ? used[i].first : BLOCK_SIZE_BYTES;
+            if (gap_end >= cursor + length) {
+                offset_out = cursor;
+                return block;
+            }
+            if (i < used.size()) {
+                cursor = std::max(cursor, used[i].first + used[i].second);
+            }
+        }
+    }
+
+    int new_block = find_free_data_block();
+    if (new_block == -1) {
+        return -1;
+    }
+    offset_out = 0;
+    fs_log(("allocate_tail_slot: New shared tail block " + std::to_string(new_block) + " allocated.").c_str());
+    return new_block;
+}
+
+// Dosyanın kuyruğunu bırakır. Kuyruk bloğunu kullanan başka dosya kalmadıysa blok serbest bırakılır.
+// FileInfo'yu diske yazmak çağıranın sorumluluğundadır.
+void release_tail_slot(std::vector<FileInfo>& all_files, int file_index) {
+    std::lock_guard<std::recursive_mutex> allocator_guard(active_volume().allocator_lock);
+    FileInfo& fi = all_files[file_index];
+    if (!has_packed_tail(fi)) return;
+
+    int block = fi.tail_block_index;
+    fi.tail_block_index = -1;
+    fi.tail_offset = 0;
+    fi.tail_length = 0;
+
+    for (size_t i = 0; i < all_files.size(); ++i) {
+        if (all_files[i].is_used && all_files[i].tail_block_index == block) {
+            return; // Blok hâlâ başka bir dosyanın kuyruğunu tutuyor
+        }
+    }
+    free_data_block(block);
+    fs_log(("release_tail_slot: Shared tail block " + std::to_string(block) + " is empty and was freed.").c_str());
+}
+
+// ------------- DİZİN (DIRECTORY) YARDIMCI FONKSİYONLARI -------------
+
+// İsim bileşeni için 32-bit FNV-1a hash'i.
+uint32_t dir_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name); *p != '\0'; ++p) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Yolu '/' ile bileşenlere ayırır. Baştaki, sondaki ve ardışık ayraçlar yok sayılır
+// ("a.txt", "/a.txt" ve "//a.txt" aynı yoldur).
+void split_path(const char* path, std::vector<std::string>& components) {
+    components.clear();
+    std::string current;
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p == PATH_SEPARATOR) {
+            if (!current.empty()) {
+                components.push_back(current);
+                current.clear();
+            }
+        } else {
+            current += *p;
+        }
+    }
+    if (!current.empty()) {
+        components.push_back(current);
+    }
+}
+
+// Yeni bir dizin girdisine verilebilecek isim mi? ("." ve ".." yol çözümlemede özel anlam taşır.)
+bool is_valid_entry_name(const std::string& name) {
+    return !name.empty() && name != "." && name != ".." && name.size() <= static_cast<size_t>(MAX_FILENAME_LENGTH);
+}
+
+// Dizin tablosunun tamamını (ardışık veri bloklarından) belleğe okur.
+bool load_dir_table(const FileInfo& dir, std::vector<DirEntry>& table) {
+    table.assign(static_cast<size_t>(dir.num_data_blocks_used) * DIR_ENTRIES_PER_BLOCK, DirEntry{0, DIR_ENTRY_EMPTY});
+    if (dir.num_data_blocks_used == 0 || dir.start_data_block_index < 0) {
+        return true; // Henüz tablo tahsis edilmemiş boş dizin
+    }
+
+    DiskStream disk_file(std::ios::in);
+    if (!disk_file) {
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to read directory table of '" << dir.name << "'." << std::endl;
+        fs_log("load_dir_table failed: could not open disk file.");
+        return false;
+    }
+    disk_file.seekg(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(dir.start_data_block_index) * BLOCK_SIZE_BYTES);
+    disk_file.read(reinterpret_cast<char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(DirEntry)));
+    if (!disk_file) {
+        std::cerr << "Error: Could not read directory table of '" << dir.name << "'." << std::endl;
+        fs_log(("load_dir_table failed: read error for directory " + std::string(dir.name)).c_str());
+        return false;
+    }
+    return true;
+}
+
+// Dizin tablosunun tamamını dizinin veri bloklarına yazar.
+bool store_dir_table(const FileInfo& dir, const std::vector<DirEntry>& table) {
+    if (dir.num_data_blocks_used == 0 || dir.start_data_block_index < 0) {
+        return table.empty();
+    }
+
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    if (!disk_file) {
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to write directory table of '" << dir.name << "'." << std::endl;
+        fs_log("store_dir_table failed: could not open disk file.");
+        return false;
+    }
+    disk_file.seekp(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(dir.start_data_block_index) * BLOCK_SIZE_BYTES);
+    disk_file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(DirEntry)));
+    if (!disk_file) {
+        std::cerr << "Error: Could not write directory table of '" << dir.name << "'." << std::endl;
+        fs_log(("store_dir_table failed: write error for directory " + std::string(dir.name)).c_str());
+        return false;
+    }
+    return true;
+}
+
+// Girdiyi tablodaki ilk uygun slota (linear probing) yerleştirir. Tabloda en az bir boş slot olmalı.
+void dir_table_place(std::vector<DirEntry>& table, const DirEntry& entry) {
+    uint32_t mask = static_cast<uint32_t>(table.size()) - 1;
+    uint32_t slot = entry.name_hash & mask;
+    while (table[slot].file_index != DIR_ENTRY_EMPTY) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = entry;
+}
+
+// Dizinde isim arar. Sadece ismin hash'inin düştüğü blok (ve gerekirse takip eden bloklar) okunur,
+// bu yüzden arama maliyeti dizindeki girdi sayısından bağımsızdır.
+// Bulunursa çocuğun FileInfo indeksini, bulunamazsa -1 döndürür.
+int dir_lookup(const std::vector<FileInfo>& all_files, int dir_index, const char* name) {
+    const FileInfo& dir = all_files[dir_index];
+    if (dir.type != FILE_TYPE_DIRECTORY || dir.dir_entry_count == 0 ||
+        dir.num_data_blocks_used == 0 || dir.start_data_block_index < 0) {
+        return -1;
+    }
+
+    DiskStream disk_file(std::ios::in);
+    if (!disk_file) {
+        fs_log("dir_lookup failed: could not open disk file.");
+        return -1;
+    }
+
+    uint32_t hash = dir_name_hash(name);
+    uint32_t capacity = dir.num_data_blocks_used * DIR_ENTRIES_PER_BLOCK;
+    uint32_t mask = capacity - 1;
+    uint32_t slot = hash & mask;
+
+    DirEntry block_entries[DIR_ENTRIES_PER_BLOCK];
+    int64_t loaded_block = -1;
+
+    for (uint32_t probes = 0; probes < capacity; ++probes) {
+        int64_t block_in_table = slot / DIR_ENTRIES_PER_BLOCK;
+        if (block_in_table != loaded_block) {
+            disk_file.seekg(METADATA_AREA_SIZE_BYTES + (static_cast<std::streamoff>(dir.start_data_block_index) + block_in_table) * BLOCK_SIZE_BYTES);
+            disk_file.read(reinterpret_cast<char*>(block_entries), sizeof(block_entries));
+            if (!disk_file) {
+                fs_log(("dir_lookup failed: could not read directory block of " + std::string(dir.name)).c_str());
+                return -1;
+            }
+            loaded_block = block_in_table;
+        }
+
+        const DirEntry& entry = block_entries[slot % DIR_ENTRIES_PER_BLOCK];
+        if (entry.file_index == DIR_ENTRY_EMPTY) {
+            return -1; // Boş slota ulaşıldı, isim bu dizinde yok
+        }
+        if (entry.name_hash == hash && entry.file_index > ROOT_DIR_INDEX &&
+            entry.file_index < static_cast<int32_t>(all_files.size()) &&
+            all_files[entry.file_index].is_used && strcmp(all_files[entry.file_index].name, name) == 0) {
+            return entry.file_index;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Çocuğu dizinin hash tablosuna ekler. Doluluk 3/4'ü geçecekse tablo iki kat büyüklükte
+// yeni bir ardışık alana taşınır (rehash) ve eski bloklar serbest bırakılır.
+// Dizinin FileInfo'su (hem all_files içinde hem diskte) güncellenir.
+bool dir_insert(std::vector<FileInfo>& all_files, Superblock& sb, int dir_index, int child_index) {
+    FileInfo& dir = all_files[dir_index];
+    std::vector<DirEntry> table;
+    if (!load_dir_table(dir, table)) {
+        return false;
+    }
+
+    off_t old_start_block = dir.start_data_block_index;
+    unsigned int old_num_blocks = dir.num_data_blocks_used;
+    bool grew = false;
+
+    if ((static_cast<uint64_t>(dir.dir_entry_count) + 1) * 4 > static_cast<uint64_t>(table.size()) * 3) {
+        unsigned int new_num_blocks = (old_num_blocks == 0) ? 1 : old_num_blocks * 2;
+        int new_start_block = find_and_allocate_contiguous_data_blocks(new_num_blocks);
+        if (new_start_block == -1) {
+            std::cerr << "Error: Not enough contiguous space to grow directory '" << dir.name << "' to " << new_num_blocks << " blocks." << std::endl;
+            fs_log(("dir_insert failed: could not grow directory table of " + std::string(dir.name)).c_str());
+            return false;
+        }
+
+        std::vector<DirEntry> new_table(static_cast<size_t>(new_num_blocks) * DIR_ENTRIES_PER_BLOCK, DirEntry{0, DIR_ENTRY_EMPTY});
+        for (const DirEntry& entry : table) {
+            if (entry.file_index != DIR_ENTRY_EMPTY) {
+                dir_table_place(new_table, entry);
+            }
+        }
+        table.swap(new_table);
+
+        dir.start_data_block_index = new_start_block;
+        dir.num_data_blocks_used = new_num_blocks;
+        dir.size = static_cast<int64_t>(new_num_blocks) * BLOCK_SIZE_BYTES;
+        grew = true;
+        fs_log(("dir_insert: Directory '" + std::string(dir.name) + "' table grown to " + std::to_string(new_num_blocks) +
+                " blocks at block " + std::to_string(new_start_block) + ".").c_str());
+    }
+
+    DirEntry new_entry;
+    new_entry.name_hash = dir_name_hash(all_files[child_index].name);
+    new_entry.file_index = child_index;
+    dir_table_place(table, new_entry);
+
+    if (!store_dir_table(dir, table)) {
+        if (grew) {
+            for (unsigned int i = 0; i < dir.num_data_blocks_used; ++i) {
+                free_data_block(dir.start_data_block_index + i);
+            }
+            dir.start_data_block_index = old_start_block;
+            dir.num_data_blocks_used = old_num_blocks;
+            dir.size = static_cast<int64_t>(old_num_blocks) * BLOCK_SIZE_BYTES;
+        }
+        return false;
+    }
+
+    if (grew && old_num_blocks > 0) {
+        for (unsigned int i = 0; i < old_num_blocks; ++i) {
+            free_data_block(old_start_block + i);
+        }
+    }
+
+    dir.dir_entry_count++;
+    return write_file_info_at_index(dir_index, dir, sb);
+}
+
+// Çocuğu dizinin hash tablosundan çıkarır. Mezar taşı (tombstone) bırakmamak için
+// backward-shift silme kullanılır; böylece aramalar ilk boş slotta güvenle durabilir.
+bool dir_remove(std::vector<FileInfo>& all_files, Superblock& sb, int dir_index, int child_index) {
+    FileInfo& dir = all_files[dir_index];
+    std::vector<DirEntry> table;
+    if (!load_dir_table(dir, table) || table.empty()) {
+        return false;
+    }
+
+    uint32_t mask = static_cast<uint32_t>(table.size()) - 1;
+    uint32_t slot = dir_name_hash(all_files[child_index].name) & mask;
+    bool found = false;
+    for (uint32_t probes = 0; probes < table.size(); ++probes) {
+        if (table[slot].file_index == DIR_ENTRY_EMPTY) break;
+        if (table[slot].file_index == child_index) { found = true; break; }
+        slot = (slot + 1) & mask;
+    }
+    if (!found) {
+        std::cerr << "Error: Entry '" << all_files[child_index].name << "' not found in directory table of '" << dir.name << "'." << std::endl;
+        fs_log(("dir_remove failed: entry missing from directory table of " + std::string(dir.name)).c_str());
+        return false;
+    }
+
+    uint32_t hole = slot;
+    uint32_t next = (hole + 1) & mask;
+    while (table[next].file_index != DIR_ENTRY_EMPTY) {
+        uint32_t home = table[next].name_hash & mask;
+        // 'next' girdisi, ev slotu (home) döngüsel olarak (hole, next] aralığında değilse boşluğa kaydırılabilir.
+        bool home_in_range = (hole <= next) ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!home_in_range) {
+            table[hole] = table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table[hole].file_index = DIR_ENTRY_EMPTY;
+    table[hole].name_hash = 0;
+
+    if (!store_dir_table(dir, table)) {
+        return false;
+    }
+    if (dir.dir_entry_count > 0) {
+        dir.dir_entry_count--;
+    }
+    return write_file_info_at_index(dir_index, dir, sb);
+}
+
+// Bileşen listesini kökten başlayarak yürür. Başarılıysa ulaşılan FileInfo indeksini, değilse -1 döndürür.
+int walk_path_components(const std::vector<FileInfo>& all_files, const std::vector<std::string>& components, size_t count) {
+    if (all_files.size() <= static_cast<size_t>(ROOT_DIR_INDEX) || !all_files[ROOT_DIR_INDEX].is_used) {
+        return -1;
+    }
+    int current = ROOT_DIR_INDEX;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& component = components[i];
+        if (component == ".") continue;
+        if (component == "..") {
+            current = all_files[current].parent_index;
+            continue;
+        }
+        if (all_files[current].type != FILE_TYPE_DIRECTORY) {
+            return -1; // Ara bileşen bir dosya, dizin değil
+        }
+        current = dir_lookup(all_files, current, component.c_str());
+        if (current < 0) {
+            return -1;
+        }
+    }
+    return current;
+}
+
+int resolve_path(const std::vector<FileInfo>& all_files, const char* path) {
+    if (path == nullptr) return -1;
+    std::vector<std::string> components;
+    split_path(path, components);
+    return walk_path_components(all_files, components, components.size());
+}
+
+// Yolun üst dizinini çözer ve son bileşeni leaf_out'a yazar.
+// Üst dizin yoksa veya dizin değilse -1 döndürür.
+int resolve_parent(const std::vector<FileInfo>& all_files, const char* path, std::string& leaf_out) {
+    std::vector<std::string> components;
+    split_path(path, components);
+    if (components.empty()) {
+        return -1;
+    }
+    leaf_out = components.back();
+    int parent = walk_path_components(all_files, components, components.size() - 1);
+    if (parent < 0 || all_files[parent].type != FILE_TYPE_DIRECTORY) {
+        return -1;
+    }
+    return parent;
+}
+
+// FileInfo indeksinden tam yolu üretir (ör. "/docs/a.txt").
+std::string build_full_path(const std::vector<FileInfo>& all_files, int index) {
+    if (index == ROOT_DIR_INDEX) return "/";
+    std::string path;
+    int current = index;
+    int guard = 0; // Bozuk parent zincirine karşı sonsuz döngü koruması
+    while (current != ROOT_DIR_INDEX && current >= 0 && current < static_cast<int>(all_files.size()) && guard++ < MAX_FILES_CALCULATED) {
+        path = std::string(1, PATH_SEPARATOR) + all_files[current].name + path;
+        current = all_files[current].parent_index;
+    }
+    return path;
+}
+
+
+// fs_create ve fs_mkdir'in ortak gövdesi: yolun üst dizininde yeni bir girdi oluşturur.
+// 'what' mesajlarda kullanılır ("File" / "Directory").
+bool create_fs_entry(const char* path, unsigned char type, const char* caller, const char* what, int32_t placement_goal = -1) {
+    ensure_disk_initialized(); 
+
+    if (path == nullptr || strlen(path) == 0) {
+        std::cerr << "Error (" << caller << "): Filename cannot be empty." << std::endl;
+        fs_log((std::string(caller) + " failed: empty filename.").c_str());
+        return false;
+    }
+
+    if (strlen(path) > MAX_FILENAME_LENGTH) {
+        std::cerr << "Error (" << caller << "): Filename '" << path << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
+        fs_log((std::string(caller) + " failed: filename too long.").c_str());
+        return false;
+    }
+
+    Superblock sb; // Önce superblock'u okumak için
+    std::vector<FileInfo> all_files = read_all_file_info(sb); // sb referans ile güncellenecek
+
+    if (sb.num_active_files == -1) { // read_all_file_info'dan hata geldi
+        std::cerr << "Error (" << caller << "): Could not read metadata to create '" << path << "'." << std::endl;
+        fs_log((std::string(caller) + " failed: metadata read error.").c_str());
+        return false;
+    }
+
+    // Üst dizini çöz ve yeni girdinin adını al
+    std::string leaf_name;
+    int parent_index = resolve_parent(all_files, path, leaf_name);
+    if (parent_index == -1) {
+        std::cerr << "Error (" << caller << "): Parent directory of '" << path << "' does not exist or is not a directory." << std::endl;
+        fs_log((std::string(caller) + " failed: parent directory not found for " + std::string(path)).c_str());
+        return false;
+    }
+    if (!is_valid_entry_name(leaf_name)) {
+        std::cerr << "Error (" << caller << "): '" << leaf_name << "' is not a valid name." << std::endl;
+        fs_log((std::string(caller) + " failed: invalid name " + leaf_name).c_str());
+        return false;
+    }
+
+    // Aynı dizinde aynı isimde girdi var mı? (Hash tablosunda tek blok okuması)
+    if (dir_lookup(all_files, parent_index, leaf_name.c_str()) != -1) {
+        std::cerr << "Error (" << caller << "): '" << path << "' already exists." << std::endl;
+        fs_log((std::string(caller) + " failed: file already exists.").c_str());
+        return false;
+    }
+
+    // Kök dizin bir slot kullandığı için kullanıcıya MAX_FILES_CALCULATED - 1 slot kalır.
+    if (sb.num_active_files >= MAX_FILES_CALCULATED - 1) {
+        std::cerr << "Error (" << caller << "): Maximum number of files (" << MAX_FILES_CALCULATED - 1 << ") reached. Cannot create '" << path << "'." << std::endl;
+        fs_log((std::string(caller) + " failed: maximum files reached.").c_str());
+        return false;
+    }
+
+    int empty_slot_index = -1;
+    for (int i = ROOT_DIR_INDEX + 1; i < static_cast<int>(all_files.size()); ++i) { 
+        if (!all_files[i].is_used) {
+            empty_slot_index = i;
+            break;
+        }
+    }
+    
     if (empty_slot_index == -1) {
-        // Bu durum, eğer sb.num_active_files < MAX_FILES_CALCULATED ise, FileInfo'lar arasında
+        // Bu durum, eğer sb.num_active_files < MAX_FILES_CALCULATED - 1 ise, FileInfo'lar arasında
         // bir tutarsızlık olduğunu veya boş slotların 'is_used=true' olarak işaretlendiğini gösterir.
-        // Ya da tüm slotlar gerçekten dolu.
-        std::cerr << "Error: Could not find an empty slot for new file. Disk might be full or metadata inconsistent." << std::endl;
-        fs_log("fs_create failed: no empty slot found.");
-        return;
+        std::cerr << "Error (" << caller << "): Could not find an empty slot. Disk might be full or metadata inconsistent." << std::endl;
+        fs_log((std::string(caller) + " failed: no empty slot found.").c_str());
+        return false;
     }
 
-    FileInfo new_file_info;
-    strncpy(new_file_info.name, filename, MAX_FILENAME_LENGTH);
+    FileInfo& new_file_info = all_files[empty_slot_index];
+    new_file_info = FileInfo();
+    strncpy(new_file_info.name, leaf_name.c_str(), MAX_FILENAME_LENGTH);
     new_file_info.name[MAX_FILENAME_LENGTH] = '\0'; 
     new_file_info.size = 0;                         
     new_file_info.creation_time = time(nullptr);    
     new_file_info.is_used = true;
-    new_file_info.start_data_block_index = -1; // start_block -> start_data_block_index
-    new_file_info.num_data_blocks_used = 0;   // Yeni eklendi, başlangıçta 0
+    new_file_info.type = type;
+    new_file_info.start_data_block_index = -1;
+    new_file_info.num_data_blocks_used = 0;
+    new_file_info.parent_index = parent_index;
+    new_file_info.dir_entry_count = 0;
+    new_file_info.placement_goal = placement_goal;
+
+    // Önce üst dizine bağla; tablo büyütülemezse (disk dolu) slotu hiç yazmadan vazgeç.
+    if (!dir_insert(all_files, sb, parent_index, empty_slot_index)) {
+        std::cerr << "Error (" << caller << "): Could not add '" << leaf_name << "' to its parent directory." << std::endl;
+        fs_log((std::string(caller) + " failed: directory insert failed for " + std::string(path)).c_str());
+        return false;
+    }
 
     sb.num_active_files++; // Aktif dosya sayısını artır
     if (write_file_info_at_index(empty_slot_index, new_file_info, sb)) {
-        std::cout << "File '" << filename << "' created successfully." << std::endl;
-        fs_log(("File '" + std::string(filename) + "' created.").c_str());
-    } else {
-        std::cerr << "Error: Failed to write metadata for new file '" << filename << "'." << std::endl;
-        fs_log(("fs_create failed: could not write metadata for file '" + std::string(filename) + "' கோட்பਾஸ்").c_str());
-        // Hata durumunda num_active_files'ı geri almak gerekebilir, ama şimdilik basit tutalım.
+        std::cout << what << " '" << path << "' created successfully." << std::endl;
+        fs_log((std::string(what) + " '" + std::string(path) + "' created.").c_str());
+        return true;
+    }
+
+    std::cerr << "Error (" << caller << "): Failed to write metadata for '" << path << "'." << std::endl;
+    fs_log((std::string(caller) + " failed: could not write metadata for '" + std::string(path) + "'.").c_str());
+    // Girdiyi üst dizinden geri çıkar ki dizin tablosu var olmayan bir slotu göstermesin.
+    sb.num_active_files--;
+    dir_remove(all_files, sb, parent_index, empty_slot_index);
+    return false;
+}
+
+void fs_create(const char* filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    create_fs_entry(filename, FILE_TYPE_REGULAR, "fs_create", "File");
+}
+
+void fs_mkdir(const char* path) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    create_fs_entry(path, FILE_TYPE_DIRECTORY, "fs_mkdir", "Directory");
+}
+
+// Girdiyi üst dizininden çıkarır, veri bloklarını serbest bırakır ve FileInfo slotunu boşaltır.
+// fs_delete ve fs_rmdir tarafından kullanılır; tür kontrolleri çağıranın sorumluluğundadır.
+bool release_fs_entry(std::vector<FileInfo>& all_files, Superblock& sb, int file_index) {
+    FileInfo& entry = all_files[file_index];
+    discard_delayed_write(file_index); // Silinen dosyanın bekleyen verisi hiç yazılmaz
+    invalidate_file_handles(file_index); // İndeks yeni bir dosyaya verilebilir
+
+    // 1. Üst dizinin hash tablosundan çıkar (isim hâlâ FileInfo'da olduğu için hash hesaplanabilir)
+    if (!dir_remove(all_files, sb, entry.parent_index, file_index)) {
+        return false;
+    }
+
+    // 2. Veri bloklarını serbest bırak
+    if (entry.start_data_block_index != -1 && entry.num_data_blocks_used > 0) {
+        fs_log(("release_fs_entry: Freeing " + std::to_string(entry.num_data_blocks_used) + 
+                " data blocks for '" + std::string(entry.name) + 
+                "' starting from block " + std::to_string(entry.start_data_block_index)).c_str());
+        for (unsigned int i = 0; i < entry.num_data_blocks_used; ++i) {
+            free_data_block(entry.start_data_block_index + i);
+        }
+    }
+    release_tail_slot(all_files, file_index); // Paylaşılan kuyruk bloğundaki payını bırak
+
+    // 3. FileInfo'yu sıfırla (is_used = false ve diğer alanlar varsayılan değerlere)
+    entry = FileInfo();
+
+    // 4. Superblock'u güncelle (num_active_files azalt) ve diske yaz
+    if (sb.num_active_files > 0) { // Negatif olmasını engelle
+        sb.num_active_files--;
     }
+    return write_file_info_at_index(file_index, entry, sb);
 }
 
 void fs_delete(const char* filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     ensure_disk_initialized();
     fs_log(("fs_delete called for file: " + (filename ? std::string(filename) : "NULL")).c_str());
 
@@ -285,13 +2457,7 @@ void fs_delete(const char* filename) {
         return;
     }
 
-    int file_index = -1;
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
-        if (all_files[i].is_used && strcmp(all_files[i].name, filename) == 0) {
-            file_index = i;
-            break;
-        }
-    }
+    int file_index = resolve_path(all_files, filename);
 
     if (file_index == -1) {
         std::cerr << "Error (fs_delete): File '" << filename << "' not found." << std::endl;
@@ -299,33 +2465,13 @@ void fs_delete(const char* filename) {
         return;
     }
 
-    FileInfo& file_to_delete = all_files[file_index];
-
-    // 1. Veri bloklarını serbest bırak
-    if (file_to_delete.start_data_block_index != -1 && file_to_delete.num_data_blocks_used > 0) {
-        fs_log(("fs_delete: Freeing " + std::to_string(file_to_delete.num_data_blocks_used) + 
-                " data blocks for file '" + std::string(filename) + 
-                "' starting from block " + std::to_string(file_to_delete.start_data_block_index)).c_str());
-        for (unsigned int i = 0; i < file_to_delete.num_data_blocks_used; ++i) {
-            free_data_block(file_to_delete.start_data_block_index + i);
-        }
-    }
-
-    // 2. FileInfo'yu güncelle (is_used = false ve diğer alanları sıfırla)
-    file_to_delete.is_used = false;
-    file_to_delete.name[0] = '\0'; // İsmi temizle (isteğe bağlı ama iyi pratik)
-    file_to_delete.size = 0;
-    file_to_delete.creation_time = 0; // Zamanı sıfırla
-    file_to_delete.start_data_block_index = -1;
-    file_to_delete.num_data_blocks_used = 0;
-
-    // 3. Superblock'u güncelle (num_active_files azalt)
-    if (sb.num_active_files > 0) { // Negatif olmasını engelle
-        sb.num_active_files--;
+    if (all_files[file_index].type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_delete): '" << filename << "' is a directory. Use fs_rmdir instead." << std::endl;
+        fs_log(("fs_delete failed: target is a directory - " + std::string(filename)).c_str());
+        return;
     }
 
-    // 4. Güncellenmiş FileInfo ve Superblock'u diske yaz
-    if (write_file_info_at_index(file_index, file_to_delete, sb)) {
+    if (release_fs_entry(all_files, sb, file_index)) {
         std::cout << "File '" << filename << "' deleted successfully." << std::endl;
         fs_log(("File '" + std::string(filename) + "' deleted successfully. Active files: " + std::to_string(sb.num_active_files)).c_str());
     } else {
@@ -336,51 +2482,91 @@ void fs_delete(const char* filename) {
     }
 }
 
-int fs_write(const char* filename, const char* data, int size) {
-    ensure_disk_initialized();
-
-    if (filename == nullptr || strlen(filename) == 0) {
-        std::cerr << "Error (fs_write): Filename cannot be empty." << std::endl;
-        fs_log("fs_write failed: empty filename.");
-        return -1; 
-    }
+// ------------- ÖN TAHSİS (PREALLOCATION) -------------
+// fs_fallocate ile ayrılan ardışık bloklar FILE_FLAG_PREALLOCATED ile işaretlenir. İçerik bu alana sığdığı
+// sürece fs_write, fs_append ve fs_truncate blokları serbest bırakıp yeniden tahsis etmez; veri yerinde yazılır.
+// İçerik alanı aşarsa normal yeniden tahsis yoluna geçilir; fs_truncate ile küçültmede fazla bloklar bırakılır.
 
-    if (data == nullptr && size > 0) { 
-        std::cerr << "Error (fs_write): Data is null but size is positive." << std::endl;
-        fs_log("fs_write failed: null data with positive size.");
-        return -2; 
-    }
+// Dosyanın ayrılmış alanı size byte'lık içeriği tutabilir mi?
+bool has_reservation_for(const FileInfo& fi, int64_t size) {
+    return (fi.flags & FILE_FLAG_PREALLOCATED) && !is_inline_file(fi) && !has_packed_tail(fi) &&
+           blocks_needed_for_size(size) <= static_cast<int64_t>(fi.num_data_blocks_used);
+}
 
-    if (size < 0) {
-        std::cerr << "Error (fs_write): Size cannot be negative." << std::endl;
-        fs_log("fs_write failed: negative size.");
-        return -3; 
+// Ayrılmış alandaki [offset, offset + length) aralığını yerinde yazar (data nullptr ise sıfırlarla doldurur),
+// dosya boyutunu new_size yapar ve FileInfo'yu diske yazar. Blok tahsis etmez. Alanın tamamı kullanıldığında
+// bayrak kalkar; dosya bundan sonra normal bir dosya gibi davranır.
+bool write_into_reservation(int file_index, FileInfo& fi, Superblock& sb, int64_t offset, const char* data, int64_t length, int64_t new_size) {
+    if (length > 0) {
+        DiskStream disk_file(std::ios::in | std::ios::out);
+        if (!disk_file) {
+            return false;
+        }
+        // Alan ardışık olduğu için dosya içi ofset doğrudan disk ofsetine çevrilir.
+        std::streamoff extent_pos = METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(fi.start_data_block_index) * BLOCK_SIZE_BYTES;
+        disk_file.seekp(extent_pos + offset);
+        if (data != nullptr) {
+            disk_file.write(data, length);
+        } else {
+            char zero_block[BLOCK_SIZE_BYTES] = {0};
+            for (int64_t done = 0; done < length && disk_file; ) {
+                int64_t chunk = std::min(length - done, static_cast<int64_t>(BLOCK_SIZE_BYTES));
+                disk_file.write(zero_block, chunk);
+                done += chunk;
+            }
+        }
+        if (!disk_file) {
+            disk_file.close();
+            return false;
+        }
+        disk_file.close();
     }
 
-    Superblock sb;
-    std::vector<FileInfo> all_files = read_all_file_info(sb);
-    if (sb.num_active_files == -1) { 
-        std::cerr << "Error (fs_write): Could not read metadata to write file." << std::endl;
-        fs_log("fs_write failed: metadata read error.");
-        return -4; 
+    fi.size = new_size;
+    if (blocks_needed_for_size(new_size) == static_cast<int64_t>(fi.num_data_blocks_used)) {
+        fi.flags &= ~FILE_FLAG_PREALLOCATED; // Ayrılan alan tükendi
     }
+    return write_file_info_at_index(file_index, fi, sb);
+}
 
-    int file_index = -1;
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
-        if (all_files[i].is_used && strcmp(all_files[i].name, filename) == 0) {
-            file_index = i;
-            break;
+// write_file_now'ın isim çözümlemesinden sonraki kısmı: içeriği FileInfo indeksi bilinen dosyaya yazar (fs_hwrite
+// tutamacın önbellekteki indeksiyle buraya gelir, yol yeniden çözülmez). all_files/sb çağıranın okuduğu metadata,
+// filename yalnızca mesajlar içindir. Argümanlar doğrulanmış, dosya normal dosya ve dosya kilidi özel tutuluyordur.
+int64_t write_file_at_index(std::vector<FileInfo>& all_files, Superblock& sb, int file_index, const char* filename,
+                            const char* data, int64_t size) {
+    // Kuyruk yuvası seçimi ve bırakılması diğer dosyaların FileInfo'larına bakar: eski veya yeni içerik paylaşılan
+    // bir kuyruk bloğuna dokunuyorsa tahsis kilidi FileInfo yazılana kadar tutulur ve FileInfo'lar kilit altında
+    // yeniden okunur. Diğer yazmalar blokları kilitsiz tahsis eder ve birbirini beklemez.
+    // (Ön tahsis bayrağı aşağıda kalkabileceği için yeni içerik bayraksız haliyle değerlendirilir.)
+    std::unique_lock<std::recursive_mutex> tail_guard(active_volume().allocator_lock, std::defer_lock);
+    FileInfo without_reservation = all_files[file_index];
+    without_reservation.flags &= ~FILE_FLAG_PREALLOCATED;
+    if (has_packed_tail(all_files[file_index]) || should_pack_tail(without_reservation, size)) {
+        tail_guard.lock();
+        all_files = read_all_file_info(sb);
+        if (sb.num_active_files == -1 || file_index >= static_cast<int>(all_files.size())) {
+            std::cerr << "Error (fs_write): Could not read metadata to write file." << std::endl;
+            fs_log("fs_write failed: metadata read error.");
+            return -4;
         }
     }
 
-    if (file_index == -1) {
-        std::cerr << "Error (fs_write): File '" << filename << "' not found." << std::endl;
-        fs_log(("fs_write failed: file not found - " + std::string(filename)).c_str());
-        return -5; 
-    }
-
     FileInfo& current_file_info = all_files[file_index];
 
+    // Ön tahsisli dosya: İçerik ayrılan alana sığıyorsa bloklar serbest bırakılmadan yerinde yazılır.
+    if (has_reservation_for(current_file_info, size)) {
+        if (!write_into_reservation(file_index, current_file_info, sb, 0, data, size, size)) {
+            std::cerr << "Error (fs_write): Failed to write data into the preallocated blocks of '" << filename << "'." << std::endl;
+            fs_log(("fs_write failed: error writing into preallocated blocks for " + std::string(filename)).c_str());
+            return -8; // Hata kodu: Veri yazma hatası
+        }
+        fs_log(("fs_write completed successfully for file: " + std::string(filename) + ", new size: " + std::to_string(size) +
+                " (written in place into preallocated blocks starting at " + std::to_string(current_file_info.start_data_block_index) + ").").c_str());
+        return size;
+    }
+    // Ayrılan alan yetmiyor: Rezervasyon bırakılır ve aşağıdaki normal yeniden tahsis yoluna geçilir.
+    current_file_info.flags &= ~FILE_FLAG_PREALLOCATED;
+
     // Eğer size 0 ise, dosyayı boşalt (truncate)
     if (size == 0) {
         fs_log(("fs_write called with size 0 for file: " + std::string(filename) + " (truncating). ").c_str());
@@ -392,6 +2578,8 @@ int fs_write(const char* filename, const char* data, int size) {
                 free_data_block(current_file_info.start_data_block_index + i);
             }
         }
+        clear_inline_data(current_file_info);
+        release_tail_slot(all_files, file_index);
         current_file_info.size = 0;
         current_file_info.start_data_block_index = -1;
         current_file_info.num_data_blocks_used = 0;
@@ -408,10 +2596,15 @@ int fs_write(const char* filename, const char* data, int size) {
     // Buradan sonrası size > 0 durumu için.
 
     // 1. Gerekli blok sayısını hesapla.
-    unsigned int num_blocks_needed = 0;
-    if (size > 0) {
-        num_blocks_needed = (size + BLOCK_SIZE_BYTES - 1) / BLOCK_SIZE_BYTES;
+    int64_t num_blocks_needed_64 = blocks_needed_for_size(size);
+    if (num_blocks_needed_64 > static_cast<int64_t>(NUM_DATA_BLOCKS)) {
+        // Disk bu kadar bloğa hiç sahip değil; int'e daraltmadan önce reddet.
+        std::cerr << "Error (fs_write): Requested size " << size << " bytes needs " << num_blocks_needed_64
+                  << " blocks, but the disk only has " << NUM_DATA_BLOCKS << " data blocks." << std::endl;
+        fs_log(("fs_write failed: size " + std::to_string(size) + " exceeds data area capacity for " + std::string(filename)).c_str());
+        return -6; // Hata kodu: Disk dolu veya ardışık alan yok
     }
+    unsigned int num_blocks_needed = static_cast<unsigned int>(num_blocks_needed_64);
 
     // 2. Mevcut blokları serbest bırak (truncate and write mantığı).
     //    Mevcut FileInfo yapısı (start_data_block_index, num_data_blocks_used)
@@ -430,6 +2623,35 @@ int fs_write(const char* filename, const char* data, int size) {
         current_file_info.size = 0; // Boyutu da sıfırla, çünkü eski içerik gitti.
     }
 
+    // Önceki içerik satır içi tutuluyorduysa veya kuyruğu paylaşılan bir blokta duruyorsa o da eski içeriktir; bırak.
+    clear_inline_data(current_file_info);
+    release_tail_slot(all_files, file_index);
+
+    // 3. Küçük içerik FileInfo kaydına sığıyorsa veri bloğu tahsis etme (satır içi veri).
+    //    Okuma sadece metadata'dan yapılır; dosya büyüyünce bir sonraki yazma bloklara geçirir.
+    if (fits_inline(current_file_info, size)) {
+        memcpy(inline_data_ptr(current_file_info), data, static_cast<size_t>(size));
+        current_file_info.flags |= FILE_FLAG_INLINE_DATA;
+        current_file_info.size = size;
+        current_file_info.start_data_block_index = -1;
+        current_file_info.num_data_blocks_used = 0;
+        if (!write_file_info_at_index(file_index, current_file_info, sb)) {
+            std::cerr << "Error (fs_write): Failed to update FileInfo on disk for '" << filename << "'." << std::endl;
+            fs_log(("fs_write failed: error updating FileInfo (inline data) on disk for " + std::string(filename)).c_str());
+            return -9; // Hata kodu: FileInfo yazma hatası
+        }
+        fs_log(("fs_write completed successfully for file: " + std::string(filename) + ", new size: " + std::to_string(size) + " (stored inline, no data blocks).").c_str());
+        return size;
+    }
+
+    //    Satır içine sığmıyorsa ve son bloğa düşen artık küçükse, artık paylaşılan bir kuyruk bloğuna
+    //    konur; ardışık olarak sadece tam bloklar tahsis edilir (5 byte'lık artık için 512 byte harcanmaz).
+    unsigned int tail_bytes = 0;
+    if (should_pack_tail(current_file_info, size)) {
+        tail_bytes = static_cast<unsigned int>(size % BLOCK_SIZE_BYTES);
+        num_blocks_needed = static_cast<unsigned int>(size / BLOCK_SIZE_BYTES);
+    }
+
     // Eğer size=0 ile çağrıldıysa, yeni blok tahsisine gerek yok, sadece FileInfo güncellenmeli.
 
     // std::vector<int> newly_allocated_blocks; // Artık kullanılmıyor
@@ -438,7 +2660,7 @@ int fs_write(const char* filename, const char* data, int size) {
 
     if (num_blocks_needed > 0) {
         fs_log(("fs_write: Attempting to allocate " + std::to_string(num_blocks_needed) + " contiguous blocks for file: " + std::string(filename)).c_str());
-        int allocated_start_block = find_and_allocate_contiguous_data_blocks(num_blocks_needed);
+        int allocated_start_block = find_and_allocate_contiguous_data_blocks(num_blocks_needed, current_file_info.placement_goal);
 
         if (allocated_start_block == -1) {
             std::cerr << "Error (fs_write): Disk full or not enough contiguous space. Could not allocate " << num_blocks_needed
@@ -458,63 +2680,60 @@ int fs_write(const char* filename, const char* data, int size) {
         fs_log(("fs_write: Successfully allocated " + std::to_string(num_blocks_needed) + " blocks starting from " + std::to_string(allocated_start_block) + ".").c_str());
     }
 
-    // 4. Veriyi bloklara yaz.
-    if (current_file_info.num_data_blocks_used > 0 && current_file_info.start_data_block_index != -1) {
-        std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
-        if (!disk_file) {
-            std::cerr << "Error (fs_write): Could not open disk file to write data for '" << filename << "'." << std::endl;
-            // Tahsis edilen blokları geri serbest bırakmak GEREKİR çünkü veri yazılamadı.
-            fs_log(("fs_write failed: could not open disk to write data for " + std::string(filename) + ". Freeing allocated blocks.").c_str());
+    if (tail_bytes > 0) {
+        unsigned int tail_offset = 0;
+        int tail_block = allocate_tail_slot(all_files, tail_bytes, tail_offset);
+        if (tail_block == -1) {
+            std::cerr << "Error (fs_write): Disk full. Could not find room for the " << tail_bytes
+                      << "-byte tail of file '" << filename << "'." << std::endl;
+            fs_log(("fs_write failed: no room for packed tail of " + std::string(filename)).c_str());
             for (unsigned int i = 0; i < current_file_info.num_data_blocks_used; ++i) {
                 free_data_block(current_file_info.start_data_block_index + i);
             }
+            current_file_info.size = 0;
             current_file_info.start_data_block_index = -1;
             current_file_info.num_data_blocks_used = 0;
-            current_file_info.size = 0;
-            // Hatalı durumu FileInfo'ya yansıtmak için diske yaz
-            write_file_info_at_index(file_index, current_file_info, sb);
-            return -7; // Hata kodu: Disk açılamadı
+            write_file_info_at_index(file_index, current_file_info, sb); // Dosyayı boş olarak güncelle
+            return -6; // Hata kodu: Disk dolu veya ardışık alan yok
+        }
+        current_file_info.tail_block_index = tail_block;
+        current_file_info.tail_offset = static_cast<uint16_t>(tail_offset);
+        current_file_info.tail_length = static_cast<uint16_t>(tail_bytes);
+        fs_log(("fs_write: " + std::to_string(tail_bytes) + "-byte tail of " + std::string(filename) + " packed into block " +
+                std::to_string(tail_block) + " at offset " + std::to_string(tail_offset) + ".").c_str());
+    }
+
+    // 4. Veriyi bloklara (ve varsa kuyruğu kuyruk bloğuna) yaz.
+    if ((current_file_info.num_data_blocks_used > 0 && current_file_info.start_data_block_index != -1) || has_packed_tail(current_file_info)) {
+        // Ardışık blok kısmı tek istek, kuyruk (sadece kendi aralığımız; aynı bloktaki diğer dosyaların kuyruklarına
+        // dokunulmaz) ikinci istek olarak tek toplu G/Ç ile yazılır.
+        int64_t block_bytes_to_write = size - tail_bytes; // Kuyruk ayrıca yazılır
+        unsigned int actual_blocks_used_for_writing = static_cast<unsigned int>(blocks_needed_for_size(block_bytes_to_write));
+        std::vector<BlockIoRequest> batch;
+        if (block_bytes_to_write > 0 && current_file_info.start_data_block_index != -1) {
+            batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(current_file_info.start_data_block_index) * BLOCK_SIZE_BYTES,
+                                           const_cast<char*>(data), static_cast<size_t>(block_bytes_to_write)));
+        }
+        if (has_packed_tail(current_file_info)) {
+            batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(current_file_info.tail_block_index) * BLOCK_SIZE_BYTES +
+                                           current_file_info.tail_offset,
+                                           const_cast<char*>(data + block_bytes_to_write), tail_bytes));
         }
 
-        const char* data_ptr = data;
-        int bytes_remaining_to_write = size;
-        unsigned int actual_blocks_used_for_writing = 0;
-
-        for (unsigned int i = 0; i < current_file_info.num_data_blocks_used; ++i) {
-            if (bytes_remaining_to_write <= 0) {
-                 // Bu durum, num_blocks_needed'in size'dan biraz fazla hesaplandığı (örn. size tam blok katı değilse)
-                 // ve tüm verinin zaten yazıldığı anlamına gelir. Kalan tahsisli bloklara bir şey yazmaya gerek yok.
-                 // Ancak, num_data_blocks_used hala tüm tahsis edilen blok sayısını yansıtmalı.
-                break;
-            }
-            int block_idx_to_write = current_file_info.start_data_block_index + i;
-            
-            std::streampos write_pos = METADATA_AREA_SIZE_BYTES + (static_cast<std::streamoff>(block_idx_to_write) * BLOCK_SIZE_BYTES);
-            disk_file.seekp(write_pos);
-
-            int bytes_to_write_in_this_block = std::min(bytes_remaining_to_write, static_cast<int>(BLOCK_SIZE_BYTES));
-            
-            disk_file.write(data_ptr, bytes_to_write_in_this_block);
-            if (!disk_file) {
-                std::cerr << "Error (fs_write): Failed to write data to block " << block_idx_to_write << " for file '" << filename << "'." << std::endl;
-                fs_log(("fs_write failed: error writing data to block " + std::to_string(block_idx_to_write) + " for " + std::string(filename) + ". Freeing blocks.").c_str());
-                disk_file.close();
-                // Hata! Tahsis edilen tüm blokları geri serbest bırak ve FileInfo'yu sıfırla.
-                for (unsigned int k = 0; k < current_file_info.num_data_blocks_used; ++k) {
-                    free_data_block(current_file_info.start_data_block_index + k);
-                }
-                current_file_info.start_data_block_index = -1;
-                current_file_info.num_data_blocks_used = 0;
-                current_file_info.size = 0;
-                write_file_info_at_index(file_index, current_file_info, sb);
-                return -8; // Hata kodu: Veri yazma hatası
+        if (!disk_io_batch(batch, true)) {
+            std::cerr << "Error (fs_write): Failed to write data for file '" << filename << "' to disk file '" << disk_filename() << "'." << std::endl;
+            fs_log(("fs_write failed: error writing data blocks for " + std::string(filename) + ". Freeing blocks.").c_str());
+            // Hata! Tahsis edilen tüm blokları geri serbest bırak ve FileInfo'yu sıfırla.
+            for (unsigned int k = 0; k < current_file_info.num_data_blocks_used; ++k) {
+                free_data_block(current_file_info.start_data_block_index + k);
             }
-
-            data_ptr += bytes_to_write_in_this_block;
-            bytes_remaining_to_write -= bytes_to_write_in_this_block;
-            actual_blocks_used_for_writing++;
+            release_tail_slot(all_files, file_index);
+            current_file_info.start_data_block_index = -1;
+            current_file_info.num_data_blocks_used = 0;
+            current_file_info.size = 0;
+            write_file_info_at_index(file_index, current_file_info, sb);
+            return -8; // Hata kodu: Veri yazma hatası
         }
-        disk_file.close();
 
         // Eğer size > 0 iken hiç blok kullanılmadıysa (num_blocks_needed 0 idiyse ve sonra size > 0 olduysa bu mantıksız)
         // veya bir hata olduysa, actual_blocks_used_for_writing beklenen gibi olmayabilir.
@@ -554,6 +2773,7 @@ int fs_write(const char* filename, const char* data, int size) {
                 free_data_block(current_file_info.start_data_block_index + i);
             }
         }
+        release_tail_slot(all_files, file_index);
         return -9; // Hata kodu: FileInfo yazma hatası
     }
 
@@ -561,8 +2781,509 @@ int fs_write(const char* filename, const char* data, int size) {
     return size; // Başarıyla yazılan byte sayısını döndür.
 }
 
-void fs_read(const char* filename, int offset, int size, char* buffer) {
+// Veriyi hemen bloklara yazar (gecikmeli tahsis tamponunu atlar). fs_write'ın eski davranışıdır;
+// tampon boşaltılırken ve eşzamanlı kalması gereken işlemlerde (fs_truncate) kullanılır.
+// fs_write argümanlarını denetler: 0 veya fs_write'ın -1 (boş ad), -2 (veri yok), -3 (negatif boyut) kodları.
+int64_t check_write_arguments(const char* filename, const char* data, int64_t size) {
+    if (filename == nullptr || strlen(filename) == 0) {
+        std::cerr << "Error (fs_write): Filename cannot be empty." << std::endl;
+        fs_log("fs_write failed: empty filename.");
+        return -1; 
+    }
+
+    if (data == nullptr && size > 0) { 
+        std::cerr << "Error (fs_write): Data is null but size is positive." << std::endl;
+        fs_log("fs_write failed: null data with positive size.");
+        return -2; 
+    }
+
+    if (size < 0) {
+        std::cerr << "Error (fs_write): Size cannot be negative." << std::endl;
+        fs_log("fs_write failed: negative size.");
+        return -3; 
+    }
+    return 0;
+}
+
+int64_t write_file_now(const char* filename, const char* data, int64_t size) {
+    ensure_disk_initialized();
+
+    int64_t invalid = check_write_arguments(filename, data, size);
+    if (invalid != 0) return invalid;
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) { 
+        std::cerr << "Error (fs_write): Could not read metadata to write file." << std::endl;
+        fs_log("fs_write failed: metadata read error.");
+        return -4; 
+    }
+
+    int file_index = resolve_path(all_files, filename);
+
+    if (file_index == -1) {
+        std::cerr << "Error (fs_write): File '" << filename << "' not found." << std::endl;
+        fs_log(("fs_write failed: file not found - " + std::string(filename)).c_str());
+        return -5; 
+    }
+
+    if (all_files[file_index].type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_write): '" << filename << "' is a directory." << std::endl;
+        fs_log(("fs_write failed: target is a directory - " + std::string(filename)).c_str());
+        return -10; // Hata kodu: Hedef bir dizin
+    }
+
+    return write_file_at_index(all_files, sb, file_index, filename, data, size);
+}
+
+// ------------- GECİKMELİ TAHSİS (DELAYED ALLOCATION) -------------
+// fs_write ve fs_append veriyi hemen bloklara yazmaz, dosyanın FileInfo indeksine göre bellekte biriktirir.
+// Blok yerleşimi boşaltma anında, patlamanın son boyutu bilindiğinde bir kez seçilir: art arda gelen küçük
+// eklemeler her seferinde serbest bırak/yeniden tahsis et döngüsü yerine tek bir ardışık alana yazılır.
+// Boşaltma tetikleyicileri: tampon sınırı (DELAYED_ALLOC_MAX_BUFFERED_BYTES), fs_sync ve fs_unmount.
+// Dosyanın içeriğine veya yerleşimine bakan işlemler (fs_read, fs_ls, fs_truncate, fs_defragment, fs_backup...)
+// önce ilgili bekleyen yazmaları boşaltır; fs_size cevabı tampondan verir. İndeks isimden bağımsız olduğu için
+// fs_rename/fs_mv bekleyen veriyi etkilemez; silinen dosyanın bekleyen verisi hiç yazılmadan atılır.
+
+void discard_delayed_write(int file_index) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+    std::map<int, DelayedWrite>::iterator it = volume.delayed_writes.find(file_index);
+    if (it == volume.delayed_writes.end()) return;
+    volume.delayed_bytes_total -= static_cast<int64_t>(it->second.content.size());
+    volume.delayed_writes.erase(it);
+}
+
+bool has_delayed_write(int file_index) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+    return volume.delayed_writes.count(file_index) != 0;
+}
+
+void discard_all_delayed_writes() {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+    volume.delayed_writes.clear();
+    volume.delayed_bytes_total = 0;
+}
+
+// Bekleyen yazmayı diske uygular; write_file_now'ın dönüş değerini (yeni boyut veya negatif hata) döndürür.
+int64_t apply_delayed_write(int file_index, const DelayedWrite& pending) {
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        fs_log("apply_delayed_write failed: metadata read error.");
+        return -4;
+    }
+    if (file_index >= static_cast<int>(all_files.size()) || !all_files[file_index].is_used ||
+        all_files[file_index].type != FILE_TYPE_REGULAR) {
+        fs_log(("apply_delayed_write: slot " + std::to_string(file_index) + " no longer holds a regular file, buffered data dropped.").c_str());
+        return 0;
+    }
+    std::string path = build_full_path(all_files, file_index);
+    int64_t length = static_cast<int64_t>(pending.content.size());
+    if (pending.replace) {
+        return write_file_now(path.c_str(), pending.content.data(), length);
+    }
+
+    FileInfo& fi = all_files[file_index];
+    if (fi.size != pending.base_size) {
+        fs_log(("apply_delayed_write: '" + path + "' size changed from " + std::to_string(pending.base_size) + " to " +
+                std::to_string(fi.size) + " while appends were buffered; appending at the current end.").c_str());
+    }
+    int64_t new_size = 0;
+    if (!checked_add_size(fi.size, length, new_size)) {
+        return -3;
+    }
+    // Ön tahsisli alana sığıyorsa sadece eklenen kısım yerinde yazılır.
+    if (has_reservation_for(fi, new_size)) {
+        return write_into_reservation(file_index, fi, sb, fi.size, pending.content.data(), length, new_size) ? new_size : -8;
+    }
+    // Aksi halde eski içerik ve biriken eklemeler tek bir ardışık tahsisle yeniden yazılır.
+    std::vector<char> combined(static_cast<size_t>(new_size) + 1); // +1: fs_read null terminator ekler
+    if (fi.size > 0) {
+        fs_read(path.c_str(), 0, fi.size, &combined[0]);
+    }
+    memcpy(&combined[static_cast<size_t>(fi.size)], pending.content.data(), static_cast<size_t>(length));
+    return write_file_now(path.c_str(), &combined[0], new_size);
+}
+
+int64_t flush_delayed_write(int file_index) {
+    Volume& volume = active_volume();
+    DelayedWrite pending;
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        std::map<int, DelayedWrite>::iterator it = volume.delayed_writes.find(file_index);
+        if (it == volume.delayed_writes.end()) return 0;
+        pending.replace = it->second.replace;
+        pending.base_size = it->second.base_size;
+        pending.content.swap(it->second.content);
+        volume.delayed_bytes_total -= static_cast<int64_t>(pending.content.size());
+        volume.delayed_writes.erase(it);
+    }
+    int64_t result = apply_delayed_write(file_index, pending);
+    fs_log(("Delayed allocation: flushed " + std::to_string(pending.content.size()) + " buffered bytes of slot " +
+            std::to_string(file_index) + ", result " + std::to_string(result) + ".").c_str());
+    return result;
+}
+
+// Yol ile verilen dosyanın bekleyen yazmasını boşaltır (tampon boşsa metadata bile okunmaz).
+void flush_delayed_writes_for_path(const char* path) {
+    Volume& volume = active_volume();
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        if (volume.delayed_writes.empty()) return;
+    }
+    if (path == nullptr || strlen(path) == 0) return;
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) return;
+    int file_index = resolve_path(all_files, path);
+    if (file_index != -1) {
+        flush_delayed_write(file_index);
+    }
+}
+
+// Tüm bekleyen yazmaları indeks sırasıyla boşaltır. Biri bile başarısız olursa -1 döner.
+int flush_all_delayed_writes() {
+    Volume& volume = active_volume();
+    std::map<int, DelayedWrite> pending_writes;
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        if (volume.delayed_writes.empty()) return 0;
+        pending_writes.swap(volume.delayed_writes);
+        volume.delayed_bytes_total = 0;
+    }
+    int failures = 0;
+    for (std::map<int, DelayedWrite>::const_iterator it = pending_writes.begin(); it != pending_writes.end(); ++it) {
+        if (apply_delayed_write(it->first, it->second) < 0) {
+            failures++;
+        }
+    }
+    fs_log(("Delayed allocation: flushed " + std::to_string(pending_writes.size()) + " files, failures: " + std::to_string(failures) + ".").c_str());
+    return failures == 0 ? 0 : -1;
+}
+
+// Tampon sınırı aşıldığında: çağıranın kendi dosyası ve kilidi o an boşta olan dosyalar boşaltılır. Başka bir
+// iş parçacığının kilitlediği dosya atlanır (beklemek kilit sırasını bozardı); o dosyanın sahibi onu boşaltır.
+// Cilt kilidi özel tutuluyorsa hepsi boşaltılır. Biri bile başarısız olursa -1 döner.
+int flush_delayed_writes_over_limit(int own_file_index) {
+    Volume& volume = active_volume();
+    if (volume_lock_mode == LOCK_MODE_EXCLUSIVE) {
+        return flush_all_delayed_writes();
+    }
+    int failures = flush_delayed_write(own_file_index) < 0 ? 1 : 0;
+    std::vector<int> pending_files;
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        for (std::map<int, DelayedWrite>::const_iterator it = volume.delayed_writes.begin(); it != volume.delayed_writes.end(); ++it) {
+            pending_files.push_back(it->first);
+        }
+    }
+    int skipped = 0;
+    for (int file_index : pending_files) {
+        if (file_lock_modes[file_index] != LOCK_MODE_NONE || !volume.file_locks[file_index].try_lock()) {
+            skipped++;
+            continue;
+        }
+        file_lock_modes[file_index] = LOCK_MODE_EXCLUSIVE;
+        if (flush_delayed_write(file_index) < 0) failures++;
+        file_lock_modes[file_index] = LOCK_MODE_NONE;
+        volume.file_locks[file_index].unlock();
+    }
+    fs_log(("Delayed allocation: buffer limit flush, " + std::to_string(pending_files.size() - skipped) + " files written, " +
+            std::to_string(skipped) + " busy files skipped, failures: " + std::to_string(failures) + ".").c_str());
+    return failures == 0 ? 0 : -1;
+}
+
+// Tampona eklenecek verinin disk tarafından hiç karşılanamayacağı belli mi? (O(1) istatistiklerden; bekleyen
+// diğer yazmaların ihtiyacı da düşülür.) Öyleyse veri tamponlanmaz, hata hemen doğrudan yazma yolundan döner.
+bool delayed_write_cannot_fit(const FileInfo& fi, int64_t final_size) {
+    FsStatfs st;
+    if (fs_statfs(st) != 0) return false;
+    int64_t available = static_cast<int64_t>(st.free_blocks) + fi.num_data_blocks_used + (has_packed_tail(fi) ? 1 : 0)
+                        - blocks_needed_for_size(st.buffered_bytes);
+    return blocks_needed_for_size(final_size) > available;
+}
+
+// Bekleyen yazmalar dahil dosya boyutu (disk_size: diskteki kayıttaki boyut).
+int64_t buffered_file_size(int file_index, int64_t disk_size) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+    std::map<int, DelayedWrite>::const_iterator it = volume.delayed_writes.find(file_index);
+    if (it == volume.delayed_writes.end()) return disk_size;
+    return it->second.replace ? static_cast<int64_t>(it->second.content.size())
+                              : it->second.base_size + static_cast<int64_t>(it->second.content.size());
+}
+
+// Sona eklenecek veriyi tampona alır (fs_append, fs_hwrite). Eski içerik okunup yeniden yazılmaz; aynı dosyaya art
+// arda gelen eklemeler boşaltma anında tek bir ardışık tahsisle (veya ön tahsisli alana yerinde) yazılır. fi diskteki
+// kayıt, old_size bekleyen yazmalar dahil boyuttur. Yeni boyutu veya negatif hata döndürür; çağıran dosya kilidini
+// özel tutar.
+int64_t append_delayed(int file_index, const FileInfo& fi, int64_t old_size, const char* data, int64_t size) {
+    Volume& volume = active_volume();
+    int64_t new_size = old_size + size;
+    bool over_limit = false;
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        std::map<int, DelayedWrite>::iterator it = volume.delayed_writes.find(file_index);
+        if (it == volume.delayed_writes.end()) {
+            it = volume.delayed_writes.insert(std::make_pair(file_index, DelayedWrite())).first;
+            it->second.base_size = old_size; // Bekleyen yazma yoksa boyut diskteki boyuttur
+        }
+        it->second.content.append(data, static_cast<size_t>(size));
+        volume.delayed_bytes_total += size;
+        over_limit = volume.delayed_bytes_total > static_cast<int64_t>(DELAYED_ALLOC_MAX_BUFFERED_BYTES);
+    }
+
+    if (delayed_write_cannot_fit(fi, new_size)) {
+        return flush_delayed_write(file_index); // Hata hemen görünsün
+    }
+    if (over_limit) {
+        fs_log("Delayed allocation: buffer limit exceeded, flushing pending writes.");
+        if (flush_delayed_writes_over_limit(file_index) != 0) {
+            FileInfo current;
+            if (!read_file_info_at_index(file_index, current) || buffered_file_size(file_index, current.size) != new_size) return -1;
+        }
+    }
+    return new_size;
+}
+
+int64_t fs_write(const char* filename, const char* data, int64_t size) {
+    Volume& volume = active_volume();
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_EXCLUSIVE);
+    if (!file_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+
+    Superblock sb;
+    std::vector<FileInfo> all_files;
+    int file_index = -1;
+    if (filename != nullptr && strlen(filename) > 0) {
+        all_files = read_all_file_info(sb);
+        if (sb.num_active_files != -1) {
+            file_index = resolve_path(all_files, filename);
+        }
+    }
+
+    // Geçersiz argümanlar, boşaltma (size 0), tamponu tek başına aşan veya diske sığmayacak yazmalar
+    // doğrudan yazılır; hata kodları ve truncate davranışı write_file_now'dan gelir.
+    bool bufferable = file_index != -1 && all_files[file_index].type == FILE_TYPE_REGULAR && data != nullptr &&
+                      size > 0 && size <= static_cast<int64_t>(DELAYED_ALLOC_MAX_BUFFERED_BYTES) &&
+                      !delayed_write_cannot_fit(all_files[file_index], size);
+    if (!bufferable) {
+        if (file_index != -1) {
+            discard_delayed_write(file_index); // Yeni içerik bekleyen yazmanın yerine geçer
+        }
+        return write_file_now(filename, data, size);
+    }
+
+    bool over_limit = false;
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        DelayedWrite& pending = volume.delayed_writes[file_index];
+        volume.delayed_bytes_total -= static_cast<int64_t>(pending.content.size());
+        pending.replace = true;
+        pending.base_size = 0;
+        pending.content.assign(data, static_cast<size_t>(size));
+        volume.delayed_bytes_total += size;
+        over_limit = volume.delayed_bytes_total > static_cast<int64_t>(DELAYED_ALLOC_MAX_BUFFERED_BYTES);
+    }
+    fs_log(("fs_write: buffered " + std::to_string(size) + " bytes for '" + std::string(filename) + "' (delayed allocation).").c_str());
+    if (over_limit) {
+        fs_log("Delayed allocation: buffer limit exceeded, flushing pending writes.");
+        flush_delayed_writes_over_limit(file_index);
+    }
+    return size;
+}
+
+// ------------- YERLEŞİM İPUÇLARI (PLACEMENT HINTS) -------------
+// Birlikte okunan dosyalar (ör. veri dosyası ve indeksi) ipucuyla yan yana yerleştirilir; ikisine dokunan
+// taramalar sıralı kalır. İpucu FileInfo::placement_goal'da bir hedef blok olarak saklanır ve tahsis
+// (find_and_allocate_contiguous_data_blocks) bu bloğa en yakın boş alanı seçer.
+
+// Bir dosyanın "hemen arkası" olan blok: ardışık alanın veya kuyruk bloğunun bir sonrası. Dosyanın henüz
+// bloğu yoksa kendi ipucu devralınır (zincir halinde oluşturulan dosyalar aynı bölgeye yığılır).
+int32_t placement_goal_after(const FileInfo& fi) {
+    int64_t goal = -1;
+    if (fi.start_data_block_index != -1 && fi.num_data_blocks_used > 0) {
+        goal = fi.start_data_block_index + fi.num_data_blocks_used;
+    } else if (fi.tail_block_index != -1) {
+        goal = fi.tail_block_index + 1;
+    } else {
+        goal = fi.placement_goal;
+    }
+    if (goal >= static_cast<int64_t>(NUM_DATA_BLOCKS)) goal = NUM_DATA_BLOCKS - 1; // Diskin sonundaysa en yakını oradan aranır
+    return static_cast<int32_t>(goal);
+}
+
+// İpucunu hedef bloğa çevirir. Geçersiz ipucunda -2 döner (hata mesajını çağıran verir).
+int32_t resolve_placement_hint(const AllocationHint& hint, const char* caller) {
+    if (hint.near_file != nullptr) {
+        // Komşunun bekleyen verisi önce yerleşsin. Çağıran başka dosya kilidi tutmamalı (kilit sırası).
+        FileLockGuard near_guard(hint.near_file, LOCK_MODE_SHARED, true);
+        Superblock sb;
+        std::vector<FileInfo> all_files = read_all_file_info(sb);
+        int near_index = (sb.num_active_files == -1) ? -1 : resolve_path(all_files, hint.near_file);
+        if (near_index == -1 || all_files[near_index].type != FILE_TYPE_REGULAR) {
+            std::cerr << "Error (" << caller << "): Placement hint file '" << hint.near_file << "' is not a regular file." << std::endl;
+            fs_log((std::string(caller) + " failed: placement hint file not found - " + std::string(hint.near_file)).c_str());
+            return -2;
+        }
+        return placement_goal_after(all_files[near_index]);
+    }
+    if (hint.goal_block < -1 || hint.goal_block >= static_cast<int64_t>(NUM_DATA_BLOCKS)) {
+        std::cerr << "Error (" << caller << "): Goal block " << hint.goal_block << " is outside the data area (0-" << NUM_DATA_BLOCKS - 1 << ")." << std::endl;
+        fs_log((std::string(caller) + " failed: goal block out of range: " + std::to_string(hint.goal_block)).c_str());
+        return -2;
+    }
+    return static_cast<int32_t>(hint.goal_block);
+}
+
+// Çözülmüş hedefi dosyanın FileInfo'suna yazar; previous_goal verilirse eski hedef oraya konur. Dönüş kodları
+// fs_set_placement_hint'inkiler: -2 metadata okunamadı, -3 dosya yok, -4 dizin, -5 FileInfo yazılamadı.
+int store_placement_goal(const char* filename, int32_t goal, int32_t* previous_goal, const char* caller) {
+    FileLockGuard file_guard(filename, LOCK_MODE_EXCLUSIVE); // İpucu çözüldükten sonra: komşunun kilidi bırakıldı
+    if (!file_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (" << caller << "): Could not read metadata." << std::endl;
+        fs_log((std::string(caller) + " failed: metadata read error.").c_str());
+        return -2;
+    }
+    int file_index = resolve_path(all_files, filename);
+    if (file_index == -1) {
+        std::cerr << "Error (" << caller << "): File '" << filename << "' not found." << std::endl;
+        fs_log((std::string(caller) + " failed: file not found - " + std::string(filename)).c_str());
+        return -3;
+    }
+    FileInfo& fi = all_files[file_index];
+    if (fi.type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (" << caller << "): '" << filename << "' is a directory." << std::endl;
+        fs_log((std::string(caller) + " failed: target is a directory - " + std::string(filename)).c_str());
+        return -4;
+    }
+    if (previous_goal != nullptr) *previous_goal = fi.placement_goal;
+    if (fi.placement_goal == goal) {
+        return 0;
+    }
+    fi.placement_goal = goal;
+    if (!write_file_info_at_index(file_index, fi, sb)) {
+        std::cerr << "Error (" << caller << "): Failed to update FileInfo for '" << filename << "'." << std::endl;
+        fs_log((std::string(caller) + " failed: FileInfo write error for " + std::string(filename)).c_str());
+        return -5;
+    }
+    fs_log((std::string(caller) + ": '" + std::string(filename) + "' now prefers blocks near " + std::to_string(goal) + ".").c_str());
+    return 0;
+}
+
+int fs_set_placement_hint(const char* filename, const AllocationHint& hint) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    if (filename == nullptr || strlen(filename) == 0) {
+        std::cerr << "Error (fs_set_placement_hint): Filename cannot be empty." << std::endl;
+        fs_log("fs_set_placement_hint failed: empty filename.");
+        return -1;
+    }
+    int32_t goal = resolve_placement_hint(hint, "fs_set_placement_hint");
+    if (goal == -2) {
+        return -1;
+    }
+    return store_placement_goal(filename, goal, nullptr, "fs_set_placement_hint");
+}
+
+void fs_create(const char* filename, const AllocationHint& hint) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    int32_t goal = resolve_placement_hint(hint, "fs_create");
+    if (goal == -2) {
+        return;
+    }
+    create_fs_entry(filename, FILE_TYPE_REGULAR, "fs_create", "File", goal);
+}
+
+// İpucu bu yazmanın tahsisinde (ve gecikmeli boşaltmada) kullanılacağından yazmadan önce FileInfo'ya konur;
+// yazma başarısız olursa eski hedef geri yazılır. Hata kodları ipuçsuz fs_write'ınkilerdir, -11 yalnızca ipucunun
+// kendisi geçersizse döner.
+int64_t fs_write(const char* filename, const char* data, int64_t size, const AllocationHint& hint) {
+    ensure_disk_initialized(); // İç çağrılar paylaşımlı kilit altında diski oluşturamaz
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED); // Dosya kilidini çağrılar ayrı ayrı alır (ipucu komşuyu kilitler)
+    int64_t invalid = check_write_arguments(filename, data, size);
+    if (invalid != 0) return invalid;
+    int32_t goal = resolve_placement_hint(hint, "fs_write");
+    if (goal == -2) {
+        return -11; // Hata kodu: Geçersiz yerleşim ipucu
+    }
+    int32_t previous_goal = -1;
+    int stored = store_placement_goal(filename, goal, &previous_goal, "fs_write");
+    switch (stored) {
+        case 0: break;
+        case -2: return -4;  // Metadata okunamadı
+        case -3: return -5;  // Dosya bulunamadı
+        case -4: return -10; // Hedef bir dizin
+        case -5: return -9;  // FileInfo yazma hatası
+        default: return stored; // FS_ERROR_LOCK_UPGRADE
+    }
+    int64_t written = fs_write(filename, data, size);
+    if (written < 0 && previous_goal != goal) {
+        store_placement_goal(filename, previous_goal, nullptr, "fs_write");
+    }
+    return written;
+}
+
+// Dosyanın [offset, offset + size) aralığını dosya sonunda kırparak buffer'a okur (NUL eklemez). Okunan byte
+// sayısını, blok yoksa -9, G/Ç hatasında -8 döndürür. offset < fi.size ve size > 0 olmalı; çağıran dosya kilidini
+// tutar. fs_read ve tutamaç okumaları (fs_hread) ortak kullanır.
+int64_t read_file_extent(const FileInfo& fi, int64_t offset, int64_t size, char* buffer) {
+    // (offset + size taşabileceği için karşılaştırma kalan boyut üzerinden yapılır; offset < size burada garanti.)
+    int64_t bytes_to_read = std::min(size, fi.size - offset);
+
+    // Satır içi dosya: veri zaten okunan FileInfo kaydında, veri alanına hiç erişilmez.
+    if (is_inline_file(fi)) {
+        memcpy(buffer, inline_data_ptr(fi) + offset, static_cast<size_t>(bytes_to_read));
+        return bytes_to_read;
+    }
+
+    if ((fi.start_data_block_index == -1 || fi.num_data_blocks_used == 0) && !has_packed_tail(fi)) {
+        return -9; // Boyut > 0 ama veri bloğu yok: tutarsız kayıt
+    }
+
+    // Dosyanın veri blokları ardışık olduğu için blok kısmı tek bir istek, paylaşılan kuyruk bloğundaki artık
+    // ikinci bir istek olur; ikisi tek toplu G/Ç olarak gönderilir.
+    int64_t block_bytes_available = static_cast<int64_t>(fi.num_data_blocks_used) * BLOCK_SIZE_BYTES;
+    if (fi.start_data_block_index == -1) block_bytes_available = 0;
+    int64_t bytes_from_blocks = 0;
+    if (offset < block_bytes_available) {
+        bytes_from_blocks = std::min(bytes_to_read, block_bytes_available - offset);
+    }
+    int64_t bytes_from_tail = 0;
+    std::vector<BlockIoRequest> batch;
+    if (bytes_from_blocks > 0) {
+        batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(fi.start_data_block_index) * BLOCK_SIZE_BYTES + offset,
+                                       buffer, static_cast<size_t>(bytes_from_blocks)));
+    }
+    // Tam bloklardan sonra kalan kısım paylaşılan kuyruk bloğundan okunur.
+    if (bytes_from_blocks < bytes_to_read && has_packed_tail(fi)) {
+        int64_t offset_in_tail = offset + bytes_from_blocks - block_backed_bytes(fi);
+        bytes_from_tail = bytes_to_read - bytes_from_blocks;
+        batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(fi.tail_block_index) * BLOCK_SIZE_BYTES +
+                                       fi.tail_offset + offset_in_tail,
+                                       buffer + bytes_from_blocks, static_cast<size_t>(bytes_from_tail)));
+    }
+
+    if (!disk_io_batch(batch, false)) {
+        return -8;
+    }
+    return bytes_from_blocks + bytes_from_tail;
+}
+
+// fs_read'in gövdesi: okunan byte sayısını (0 dahil) veya negatif hata kodunu döndürür (fs_read_async sonucu).
+int64_t read_file_range(const char* filename, int64_t offset, int64_t size, char* buffer) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED, true); // Bekleyen yazma önce diske iner
     fs_log(("fs_read called for file: " + (filename ? std::string(filename) : "NULL") + 
             ", offset: " + std::to_string(offset) + 
             ", size: " + std::to_string(size)).c_str());
@@ -573,37 +3294,37 @@ void fs_read(const char* filename, int offset, int size, char* buffer) {
         // Hata durumunda buffer'ı temizlemek iyi bir pratik olabilir, ancak
         // çağıran tarafın buffer'ı nasıl yönettiğine bağlı.
         // Şimdilik sadece return ediyoruz.
-        return;
+        return -1;
     }
 
     if (strlen(filename) > MAX_FILENAME_LENGTH) {
         std::cerr << "Error (fs_read): Filename '" << filename << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
         fs_log("fs_read failed: filename too long.");
-        return;
+        return -1;
     }
 
     if (offset < 0) {
         std::cerr << "Error (fs_read): Offset cannot be negative (" << offset << ")." << std::endl;
         fs_log("fs_read failed: negative offset.");
-        return;
+        return -2;
     }
 
     if (size < 0) {
         std::cerr << "Error (fs_read): Size cannot be negative (" << size << ")." << std::endl;
         fs_log("fs_read failed: negative size.");
-        return;
+        return -2;
     }
 
     if (size == 0) {
         fs_log("fs_read: Requested size is 0. Nothing to read.");
         if (buffer != nullptr) buffer[0] = '\0'; // İsteğe bağlı: buffer'ı boş string yap
-        return; // Okunacak bir şey yok
+        return 0; // Okunacak bir şey yok
     }
 
     if (buffer == nullptr) { // size > 0 ise buffer null olmamalı
         std::cerr << "Error (fs_read): Buffer is null, cannot read data." << std::endl;
         fs_log("fs_read failed: null buffer with positive size.");
-        return;
+        return -2;
     }
 
     Superblock sb;
@@ -612,22 +3333,23 @@ void fs_read(const char* filename, int offset, int size, char* buffer) {
         std::cerr << "Error (fs_read): Could not read metadata to read file '" << filename << "'." << std::endl;
         fs_log("fs_read failed: metadata read error.");
         buffer[0] = '\0'; // Hata durumunda buffer'ı temizle
-        return;
+        return -4;
     }
 
-    int file_index = -1;
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
-        if (all_files[i].is_used && strcmp(all_files[i].name, filename) == 0) {
-            file_index = i;
-            break;
-        }
-    }
+    int file_index = resolve_path(all_files, filename);
 
     if (file_index == -1) {
         std::cerr << "Error (fs_read): File '" << filename << "' not found." << std::endl;
         fs_log(("fs_read failed: file not found - " + std::string(filename)).c_str());
         buffer[0] = '\0';
-        return;
+        return -5;
+    }
+
+    if (all_files[file_index].type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_read): '" << filename << "' is a directory." << std::endl;
+        fs_log(("fs_read failed: target is a directory - " + std::string(filename)).c_str());
+        buffer[0] = '\0';
+        return -10;
     }
 
     const FileInfo& current_file_info = all_files[file_index];
@@ -635,121 +3357,47 @@ void fs_read(const char* filename, int offset, int size, char* buffer) {
     if (offset >= current_file_info.size && current_file_info.size == 0) { // Dosya boşsa ve offset 0 ise sorun yok, 0 byte okunur
          fs_log(("fs_read: File '" + std::string(filename) + "' is empty and offset is 0. Reading 0 bytes.").c_str());
          buffer[0] = '\0';
-         return;
+         return 0;
     }
 
     if (offset >= current_file_info.size ) { // Dosya boş değilken offset dosya boyutunun dışında
         std::cerr << "Error (fs_read): Offset (" << offset << ") is beyond file size (" << current_file_info.size << ") for file '" << filename << "'." << std::endl;
         fs_log("fs_read failed: offset out of bounds.");
         buffer[0] = '\0';
-        return;
+        return -6;
     }
 
-    if (current_file_info.start_data_block_index == -1 || current_file_info.num_data_blocks_used == 0) {
-        // Bu durum dosya boyutu > 0 ise tutarsızlık anlamına gelir, ama FileInfo doğruysa (size=0)
-        // ve offset=0 ise buraya offset kontrolünden önce takılmaması lazım.
-        // Eğer offset=0, size>0 ve dosya boşsa (start_data_block_index = -1), bu da bir sorun.
+    int64_t bytes_read_so_far = read_file_extent(current_file_info, offset, size, buffer);
+    if (bytes_read_so_far == -9) {
         std::cerr << "Error (fs_read): File '" << filename << "' has no data blocks allocated but size is " << current_file_info.size << "." << std::endl;
         fs_log("fs_read failed: file has no data blocks but reports size > 0 or attempting to read from empty file.");
         buffer[0] = '\0';
-        return;
-    }
-
-    // Okunacak gerçek byte sayısını hesapla
-    int bytes_to_actually_read = size;
-    if (offset + size > current_file_info.size) {
-        bytes_to_actually_read = current_file_info.size - offset;
-    }
-
-    if (bytes_to_actually_read <= 0) {
-        fs_log(("fs_read: Calculated bytes to read is " + std::to_string(bytes_to_actually_read) + ". Nothing to read for file '" + std::string(filename) + "'.").c_str());
-        buffer[0] = '\0';
-        return;
+        return -9;
     }
-
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in);
-    if (!disk_file) {
-        std::cerr << "Error (fs_read): Could not open disk file '" << DISK_FILENAME << "' to read data for '" << filename << "'." << std::endl;
-        fs_log("fs_read failed: could not open disk file for reading data.");
+    if (bytes_read_so_far < 0) {
+        std::cerr << "Error (fs_read): Failed to read " << std::min(size, current_file_info.size - offset) << " bytes of data for file '" << filename
+                  << "' from disk file '" << disk_filename() << "'." << std::endl;
+        fs_log("fs_read failed: read error or unexpected EOF during data read.");
         buffer[0] = '\0';
-        return;
-    }
-
-    int bytes_read_so_far = 0;
-    char* current_buffer_pos = buffer;
-    unsigned int current_file_offset = static_cast<unsigned int>(offset);
-
-    // Dosyanın veri blokları ardışık olduğu için okuma daha basit.
-    // İlk okunacak blok ve o blok içindeki offset:
-    unsigned int first_block_offset_in_file = current_file_offset / BLOCK_SIZE_BYTES;
-    unsigned int first_byte_offset_in_first_block = current_file_offset % BLOCK_SIZE_BYTES;
-
-    // Kaç tane bloğa yayılıyor okuma işlemi?
-    // Bu hesaplama, blokların ardışık olduğu varsayımına dayanır.
-    // unsigned int last_byte_offset_in_file = current_file_offset + bytes_to_actually_read - 1;
-    // unsigned int last_block_offset_in_file = last_byte_offset_in_file / BLOCK_SIZE_BYTES;
-    // unsigned int num_blocks_to_span = last_block_offset_in_file - first_block_offset_in_file + 1;
-
-    // Daha basit bir döngü kuralım:
-    unsigned int data_block_cursor_in_file = first_block_offset_in_file;
-    unsigned int internal_block_offset = first_byte_offset_in_first_block;
-
-    while (bytes_read_so_far < bytes_to_actually_read && data_block_cursor_in_file < current_file_info.num_data_blocks_used) {
-        unsigned int actual_disk_block_index = current_file_info.start_data_block_index + data_block_cursor_in_file;
-        
-        std::streampos disk_read_pos = METADATA_AREA_SIZE_BYTES + 
-                                       (static_cast<std::streamoff>(actual_disk_block_index) * BLOCK_SIZE_BYTES) + 
-                                       internal_block_offset;
-        
-        disk_file.seekg(disk_read_pos);
-        if (!disk_file) {
-            std::cerr << "Error (fs_read): Failed to seek to position " << disk_read_pos 
-                      << " in block " << actual_disk_block_index << " for file '" << filename << "'." << std::endl;
-            fs_log("fs_read failed: seekg error during data read.");
-            buffer[0] = '\0';
-            disk_file.close();
-            return;
-        }
-
-        unsigned int bytes_to_read_from_this_disk_block = std::min(
-            static_cast<unsigned int>(BLOCK_SIZE_BYTES) - internal_block_offset, 
-            static_cast<unsigned int>(bytes_to_actually_read - bytes_read_so_far)
-        );
-
-        disk_file.read(current_buffer_pos, bytes_to_read_from_this_disk_block);
-        std::streamsize gcount = disk_file.gcount();
-
-        if (!disk_file && gcount != static_cast<std::streamsize>(bytes_to_read_from_this_disk_block)) {
-            // EOF normal olabilir eğer dosyanın sonuna ulaşıldıysa ve beklenen kadar okunamadıysa,
-            // ama bytes_to_actually_read zaten bunu hesaba katmalı.
-            // Yine de, gcount kontrolü önemli.
-            std::cerr << "Error (fs_read): Failed to read " << bytes_to_read_from_this_disk_block 
-                      << " bytes from block " << actual_disk_block_index << " for file '" << filename 
-                      << "'. Read " << gcount << " bytes." << std::endl;
-            fs_log("fs_read failed: read error or unexpected EOF during data read.");
-            buffer[bytes_read_so_far] = '\0'; // O ana kadar okunanı null terminate et
-            disk_file.close();
-            return;
-        }
-        
-        current_buffer_pos += gcount;
-        bytes_read_so_far += gcount;
-        
-        data_block_cursor_in_file++; // Bir sonraki dosya bloğuna geç
-        internal_block_offset = 0; // Sonraki bloklar için offset her zaman 0'dan başlar
+        return bytes_read_so_far;
     }
 
-    disk_file.close();
     buffer[bytes_read_so_far] = '\0'; // Okunan veriyi null-terminate et.
 
     fs_log(("fs_read: Successfully read " + std::to_string(bytes_read_so_far) + 
-            " bytes from file '" + std::string(filename) + 
+            " bytes from " + (is_inline_file(current_file_info) ? "inline " : "") + "file '" + std::string(filename) + 
             "' (requested: " + std::to_string(size) + ", offset: " + std::to_string(offset) + ").").c_str());
+    return bytes_read_so_far;
+}
 
+void fs_read(const char* filename, int64_t offset, int64_t size, char* buffer) {
+    read_file_range(filename, offset, size, buffer);
 }
 
 void fs_cat(const char* filename) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED, true);
     fs_log(("fs_cat called for file: " + (filename ? std::string(filename) : "NULL")).c_str());
 
     if (filename == nullptr || strlen(filename) == 0) {
@@ -770,7 +3418,7 @@ void fs_cat(const char* filename) {
         return;
     }
 
-    int file_size = fs_size(filename);
+    int64_t file_size = fs_size(filename);
     if (file_size < 0) {
         // fs_size zaten hata mesajını loglamış olmalı (örn: metadata okuma hatası veya dosya bulunamadı - ama exists kontrolü yaptık)
         std::cerr << "Error (fs_cat): Could not determine size for file '" << filename << "' (fs_size returned " << file_size << ")." << std::endl;
@@ -808,7 +3456,10 @@ void fs_cat(const char* filename) {
 }
 
 void fs_ls() {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     ensure_disk_initialized();
+    flush_all_delayed_writes(); // Boyut ve blok sütunları diskteki yerleşimi gösterir
     std::cout << "\n--- Listing Files ---" << std::endl;
 
     Superblock sb;
@@ -823,13 +3474,14 @@ void fs_ls() {
     if (sb.num_active_files == 0) {
         std::cout << "No files found on the disk." << std::endl;
     } else {
-        std::cout << "Files on disk (Active: " << sb.num_active_files << " / Max Slots: " << MAX_FILES_CALCULATED << "):" << std::endl;
+        std::cout << "Files on disk (Active: " << sb.num_active_files << " / Max Slots: " << MAX_FILES_CALCULATED - 1 << "):" << std::endl;
         std::cout << "-------------------------------------------------------------------------------" << std::endl;
         std::cout << "Name			Size (B)	StartBlk	NumBlks	Creation Time" << std::endl; 
         std::cout << "-------------------------------------------------------------------------------" << std::endl;
         
         int listed_count = 0;
-        for (const auto& fi : all_files) {
+        for (int i = ROOT_DIR_INDEX + 1; i < static_cast<int>(all_files.size()); ++i) {
+            const FileInfo& fi = all_files[i];
             if (fi.is_used) {
                 char time_buffer[30];
                 time_t creation_t = fi.creation_time; 
@@ -839,10 +3491,11 @@ void fs_ls() {
                     time_buffer[strlen(time_buffer) - 1] = '\0';
                 }
                 
-                std::cout << fi.name 
+                // Tam yol gösterilir; dizinler '/' ile biter
+                std::cout << build_full_path(all_files, i) << (fi.type == FILE_TYPE_DIRECTORY ? "/" : "")
                           << "		" << fi.size 
-                          << "		" << fi.start_data_block_index
-                          << "		" << fi.num_data_blocks_used
+                          << "		" << (is_inline_file(fi) ? std::string("inline") : std::to_string(fi.start_data_block_index))
+                          << "		" << fi.num_data_blocks_used << (has_packed_tail(fi) ? "+t" : "") << ((fi.flags & FILE_FLAG_PREALLOCATED) ? "p" : "")
                           << "		" << time_buffer << std::endl;
                 listed_count++;
             }
@@ -855,92 +3508,171 @@ void fs_ls() {
         }
         std::cout << "-------------------------------------------------------------------------------" << std::endl;
     }
+
+    // Boş alan özeti süperbloktaki sayaçlardan gelir (bitmap taranmaz)
+    FsStatfs st;
+    if (fs_statfs(st) == 0) {
+        std::cout << "Free: " << st.free_blocks << " / " << st.total_blocks << " blocks (" << st.free_bytes << " B)"
+                  << ", largest free extent <= " << st.largest_free_extent_hint << " blocks"
+                  << ", free extents: " << st.free_extent_count
+                  << ", fragmentation: " << st.fragmentation_percent << "%" << std::endl;
+        std::cout << "Used: " << st.used_bytes << " B in files, slack: " << st.slack_bytes << " B"
+                  << ", fragmented files: " << st.fragmented_files << std::endl;
+    }
     fs_log("fs_ls executed.");
 }
 
-void fs_rename(const char* old_name, const char* new_name) {
+// Girdiyi yeni üst dizine ve/veya yeni isme bağlar. Sadece iki dizin tablosu ve girdinin kendi
+// FileInfo'su değişir; alt ağaçtaki girdiler parent_index ile bağlı olduğu için taşınan dizinin
+// içeriği ne kadar büyük olursa olsun işlem O(1)'dir.
+bool relink_fs_entry(std::vector<FileInfo>& all_files, Superblock& sb, int file_index, int new_parent_index, const std::string& new_leaf) {
+    FileInfo& entry = all_files[file_index];
+    int old_parent_index = entry.parent_index;
+    char old_leaf[MAX_FILENAME_LENGTH + 1];
+    strcpy(old_leaf, entry.name);
+
+    // Satır içi veri, isimden artan baytlarda durur; yeni isim daha uzunsa ve veri artık sığmıyorsa
+    // önce bloklara taşınır. (Taşıma kendi başına tutarlıdır, isim değişikliği başarısız olsa da geri alınmaz.)
+    if (is_inline_file(entry) && entry.size > inline_capacity_for_name(new_leaf.c_str())) {
+        if (!spill_inline_data_to_blocks(file_index, entry, sb)) {
+            return false;
+        }
+    }
+
+    if (!dir_remove(all_files, sb, old_parent_index, file_index)) {
+        return false;
+    }
+
+    set_entry_name(entry, new_leaf.c_str());
+    entry.parent_index = new_parent_index;
+
+    if (!dir_insert(all_files, sb, new_parent_index, file_index)) {
+        // Yeni dizine eklenemedi (ör. tablo büyütmek için yer yok): eski yerine geri bağla.
+        set_entry_name(entry, old_leaf);
+        entry.parent_index = old_parent_index;
+        dir_insert(all_files, sb, old_parent_index, file_index);
+        return false;
+    }
+
+    return write_file_info_at_index(file_index, entry, sb);
+}
+
+// fs_rename ve fs_mv'nin ortak gövdesi.
+// fs_rename: new_path '/' içermiyorsa girdinin bulunduğu dizinde yeni isim olarak yorumlanır.
+// fs_mv: new_path var olan bir dizinse girdi aynı isimle o dizinin içine taşınır.
+void move_fs_entry(const char* old_path, const char* new_path, bool mv_semantics, const char* caller) {
     ensure_disk_initialized();
-    fs_log(("fs_rename called for file: '" + (old_name ? std::string(old_name) : "NULL") +
-            "' to new name: '" + (new_name ? std::string(new_name) : "NULL") + "'.").c_str());
+    fs_log((std::string(caller) + " called for file: '" + (old_path ? std::string(old_path) : "NULL") +
+            "' to new name: '" + (new_path ? std::string(new_path) : "NULL") + "'.").c_str());
 
-    if (old_name == nullptr || strlen(old_name) == 0) {
-        std::cerr << "Error (fs_rename): Old filename cannot be empty." << std::endl;
-        fs_log("fs_rename failed: old_name is empty.");
+    if (old_path == nullptr || strlen(old_path) == 0) {
+        std::cerr << "Error (" << caller << "): Old filename cannot be empty." << std::endl;
+        fs_log((std::string(caller) + " failed: old_name is empty.").c_str());
         return;
     }
-    if (new_name == nullptr || strlen(new_name) == 0) {
-        std::cerr << "Error (fs_rename): New filename cannot be empty." << std::endl;
-        fs_log("fs_rename failed: new_name is empty.");
+    if (new_path == nullptr || strlen(new_path) == 0) {
+        std::cerr << "Error (" << caller << "): New filename cannot be empty." << std::endl;
+        fs_log((std::string(caller) + " failed: new_name is empty.").c_str());
         return;
     }
 
-    if (strlen(old_name) > MAX_FILENAME_LENGTH) {
-        std::cerr << "Error (fs_rename): Old filename '" << old_name << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
-        fs_log("fs_rename failed: old_name too long.");
+    if (strlen(old_path) > MAX_FILENAME_LENGTH) {
+        std::cerr << "Error (" << caller << "): Old filename '" << old_path << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
+        fs_log((std::string(caller) + " failed: old_name too long.").c_str());
         return;
     }
-    if (strlen(new_name) > MAX_FILENAME_LENGTH) {
-        std::cerr << "Error (fs_rename): New filename '" << new_name << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
-        fs_log("fs_rename failed: new_name too long.");
+    if (strlen(new_path) > MAX_FILENAME_LENGTH) {
+        std::cerr << "Error (" << caller << "): New filename '" << new_path << "' is too long. Max length is " << MAX_FILENAME_LENGTH << "." << std::endl;
+        fs_log((std::string(caller) + " failed: new_name too long.").c_str());
         return;
     }
 
-    if (strcmp(old_name, new_name) == 0) {
-        std::cout << "Info (fs_rename): Old name and new name are the same ('" << old_name << "'). No action taken." << std::endl;
-        fs_log("fs_rename: old and new names are identical. No change.");
+    if (strcmp(old_path, new_path) == 0) {
+        std::cout << "Info (" << caller << "): Old name and new name are the same ('" << old_path << "'). No action taken." << std::endl;
+        fs_log((std::string(caller) + ": old and new names are identical. No change.").c_str());
         return;
     }
 
     Superblock sb;
     std::vector<FileInfo> all_files = read_all_file_info(sb);
     if (sb.num_active_files == -1) { 
-        std::cerr << "Error (fs_rename): Could not read metadata." << std::endl;
-        fs_log("fs_rename failed: metadata read error.");
+        std::cerr << "Error (" << caller << "): Could not read metadata." << std::endl;
+        fs_log((std::string(caller) + " failed: metadata read error.").c_str());
         return;
     }
 
-    int old_file_index = -1;
-    bool new_name_exists = false;
+    int old_file_index = resolve_path(all_files, old_path);
+    if (old_file_index == -1) {
+        std::cerr << "Error (" << caller << "): Source file '" << old_path << "' not found." << std::endl;
+        fs_log((std::string(caller) + " failed: source file '" + std::string(old_path) + "' not found.").c_str());
+        return;
+    }
+    if (old_file_index == ROOT_DIR_INDEX) {
+        std::cerr << "Error (" << caller << "): The root directory cannot be renamed or moved." << std::endl;
+        fs_log((std::string(caller) + " failed: attempted to move root directory.").c_str());
+        return;
+    }
 
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
-        if (all_files[i].is_used) {
-            if (strcmp(all_files[i].name, old_name) == 0) {
-                old_file_index = i;
-            }
-            if (strcmp(all_files[i].name, new_name) == 0) {
-                new_name_exists = true;
-            }
-        }
+    // Hedef üst dizini ve yeni ismi belirle
+    int new_parent_index = -1;
+    std::string new_leaf;
+    int existing_target = resolve_path(all_files, new_path);
+    if (mv_semantics && existing_target != -1 && all_files[existing_target].type == FILE_TYPE_DIRECTORY) {
+        new_parent_index = existing_target;
+        new_leaf = all_files[old_file_index].name;
+    } else if (!mv_semantics && strchr(new_path, PATH_SEPARATOR) == nullptr) {
+        new_parent_index = all_files[old_file_index].parent_index;
+        new_leaf = new_path;
+    } else {
+        new_parent_index = resolve_parent(all_files, new_path, new_leaf);
     }
 
-    if (old_file_index == -1) {
-        std::cerr << "Error (fs_rename): Source file '" << old_name << "' not found." << std::endl;
-        fs_log(("fs_rename failed: source file '" + std::string(old_name) + "' not found.").c_str());
+    if (new_parent_index == -1) {
+        std::cerr << "Error (" << caller << "): Target directory for '" << new_path << "' does not exist." << std::endl;
+        fs_log((std::string(caller) + " failed: target directory not found for '" + std::string(new_path) + "'.").c_str());
+        return;
+    }
+    if (!is_valid_entry_name(new_leaf)) {
+        std::cerr << "Error (" << caller << "): '" << new_leaf << "' is not a valid name." << std::endl;
+        fs_log((std::string(caller) + " failed: invalid target name " + new_leaf).c_str());
         return;
     }
 
-    if (new_name_exists) {
-        std::cerr << "Error (fs_rename): Target filename '" << new_name << "' already exists." << std::endl;
-        fs_log(("fs_rename failed: target filename '" + std::string(new_name) + "' already exists.").c_str());
+    if (dir_lookup(all_files, new_parent_index, new_leaf.c_str()) != -1) {
+        std::cerr << "Error (" << caller << "): Target filename '" << new_path << "' already exists." << std::endl;
+        fs_log((std::string(caller) + " failed: target filename '" + std::string(new_path) + "' already exists.").c_str());
         return;
     }
 
-    // FileInfo'da ismi güncelle
-    strncpy(all_files[old_file_index].name, new_name, MAX_FILENAME_LENGTH);
-    all_files[old_file_index].name[MAX_FILENAME_LENGTH] = '\0'; // Null-terminate
+    // Bir dizin kendi alt ağacının içine taşınamaz (döngü oluşur).
+    for (int ancestor = new_parent_index, guard = 0; guard < MAX_FILES_CALCULATED; ++guard) {
+        if (ancestor == old_file_index) {
+            std::cerr << "Error (" << caller << "): Cannot move '" << old_path << "' into its own subtree." << std::endl;
+            fs_log((std::string(caller) + " failed: target is inside the source subtree.").c_str());
+            return;
+        }
+        if (ancestor == ROOT_DIR_INDEX) break;
+        ancestor = all_files[ancestor].parent_index;
+    }
 
-    // Güncellenmiş FileInfo'yu ve (değişmemiş) Superblock'u diske yaz
-    if (write_file_info_at_index(old_file_index, all_files[old_file_index], sb)) {
-        std::cout << "File '" << old_name << "' renamed to '" << new_name << "' successfully." << std::endl;
-        fs_log(("File '" + std::string(old_name) + "' renamed to '" + std::string(new_name) + "' successfully.").c_str());
+    if (relink_fs_entry(all_files, sb, old_file_index, new_parent_index, new_leaf)) {
+        std::cout << "File '" << old_path << "' renamed to '" << build_full_path(all_files, old_file_index) << "' successfully." << std::endl;
+        fs_log(("File '" + std::string(old_path) + "' renamed to '" + build_full_path(all_files, old_file_index) + "' successfully.").c_str());
     } else {
-        std::cerr << "Error (fs_rename): Failed to write updated metadata to disk for renaming '" << old_name << "' to '" << new_name << "'." << std::endl;
-        fs_log(("fs_rename failed: metadata write error while renaming '" + std::string(old_name) + "' to '" + std::string(new_name) + "'.")  .c_str());
+        std::cerr << "Error (" << caller << "): Failed to write updated metadata to disk for renaming '" << old_path << "' to '" << new_path << "'." << std::endl;
+        fs_log((std::string(caller) + " failed: metadata write error while renaming '" + std::string(old_path) + "' to '" + std::string(new_path) + "'.").c_str());
     }
 }
 
-bool fs_exists(const char* filename) {
-    ensure_disk_initialized();
+void fs_rename(const char* old_name, const char* new_name) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    move_fs_entry(old_name, new_name, false, "fs_rename");
+}
+
+bool fs_exists(const char* filename) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
 
     if (filename == nullptr || strlen(filename) == 0) {
         fs_log("fs_exists check for empty filename -> false.");
@@ -960,19 +3692,19 @@ bool fs_exists(const char* filename) {
         return false; 
     }
 
-    for (const auto& fi : all_files) {
-        if (fi.is_used && strcmp(fi.name, filename) == 0) {
-            fs_log(("fs_exists check for '" + std::string(filename) + "' -> true.").c_str());
-            return true;
-        }
+    if (resolve_path(all_files, filename) != -1) {
+        fs_log(("fs_exists check for '" + std::string(filename) + "' -> true.").c_str());
+        return true;
     }
 
     fs_log(("fs_exists check for '" + std::string(filename) + "' -> false.").c_str());
     return false;
 }
 
-int fs_size(const char* filename) {
+int64_t fs_size(const char* filename) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED);
 
     if (filename == nullptr || strlen(filename) == 0) {
         fs_log("fs_size check for empty filename -> returning -1.");
@@ -992,19 +3724,25 @@ int fs_size(const char* filename) {
         return -1; 
     }
 
-    for (const auto& fi : all_files) {
-        if (fi.is_used && strcmp(fi.name, filename) == 0) {
-            fs_log(("fs_size for '" + std::string(filename) + "' -> " + std::to_string(fi.size) + ".").c_str());
-            return fi.size;
+    int file_index = resolve_path(all_files, filename);
+    if (file_index != -1) {
+        const FileInfo& fi = all_files[file_index];
+        if (has_delayed_write(file_index)) {
+            return buffered_file_size(file_index, fi.size); // Boşaltmaya gerek yok
         }
+        fs_log(("fs_size for '" + std::string(filename) + "' -> " + std::to_string(fi.size) + ".").c_str());
+        return fi.size;
     }
 
     fs_log(("fs_size: File '" + std::string(filename) + "' not found. Returning -1.").c_str());
     return -1; // Dosya bulunamadı
 }
 
-void fs_append(const char* filename, const char* data, int size) {
+void fs_append(const char* filename, const char* data, int64_t size) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_EXCLUSIVE);
+    if (!file_guard.held()) return;
     fs_log(("fs_append called for file: " + (filename ? std::string(filename) : "NULL") + 
             ", data_size: " + std::to_string(size)).c_str());
 
@@ -1037,61 +3775,53 @@ void fs_append(const char* filename, const char* data, int size) {
         return; // Appending 0 bytes doesn't change the file.
     }
 
-    if (!fs_exists(filename)) {
+    // Yol bir kez çözülür; boyut ve kayıt aynı okumadan gelir.
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (fs_append): Could not read metadata to append to file \'" << filename << "\'." << std::endl;
+        fs_log("fs_append failed: metadata read error.");
+        return;
+    }
+    int file_index = resolve_path(all_files, filename);
+    if (file_index == -1) {
         std::cerr << "Error (fs_append): File \'" << filename << "\' not found. Cannot append." << std::endl;
         fs_log(("fs_append failed: file not found - " + std::string(filename)).c_str());
         return;
     }
-
-    int old_size = fs_size(filename);
-    if (old_size < 0) {
-        // fs_size would have logged an error
-        std::cerr << "Error (fs_append): Could not determine current size of file \'" << filename << "\'." << std::endl;
-        fs_log(("fs_append failed: could not get old size of file - " + std::string(filename)).c_str());
+    if (all_files[file_index].type != FILE_TYPE_REGULAR) {
+        std::cerr << "Error (fs_append): \'" << filename << "\' is not a regular file." << std::endl;
+        fs_log(("fs_append failed: not a regular file - " + std::string(filename)).c_str());
         return;
     }
 
-    int new_size = old_size + size;
-
-    // Allocate buffer for combined data
-    char* combined_data = new (std::nothrow) char[new_size];
-    if (combined_data == nullptr) {
-        std::cerr << "Error (fs_append): Failed to allocate memory for combined data." << std::endl;
-        fs_log("fs_append failed: memory allocation error for combined_data.");
+    int64_t old_size = buffered_file_size(file_index, all_files[file_index].size);
+    int64_t new_size = 0;
+    if (!checked_add_size(old_size, size, new_size)) {
+        std::cerr << "Error (fs_append): Appending " << size << " bytes to file \'" << filename << "\' (size " << old_size << ") would overflow the 64-bit file size." << std::endl;
+        fs_log(("fs_append failed: size overflow for file - " + std::string(filename)).c_str());
         return;
     }
 
-    // Read old content
-    if (old_size > 0) {
-        fs_read(filename, 0, old_size, combined_data);
-        // Check if fs_read was successful by checking if the buffer was filled as expected.
-        // A more robust check might involve fs_read returning a status or bytes read.
-        // For now, we assume fs_read populates combined_data correctly if old_size > 0.
-        // If fs_read had an internal error, it would print to cerr and log.
-    }
-
-    // Append new data
-    memcpy(combined_data + old_size, data, size);
-
-    // Write the combined data back using fs_write
-    fs_log(("fs_append: Attempting to write " + std::to_string(new_size) + " bytes (old: " + std::to_string(old_size) + ", new_to_add: " + std::to_string(size) + ") to file \'" + std::string(filename) + "\'.").c_str());
-    int bytes_written = fs_write(filename, combined_data, new_size);
-
-    delete[] combined_data;
+    int64_t result = append_delayed(file_index, all_files[file_index], old_size, data, size);
 
-    if (bytes_written == new_size) {
+    if (result == new_size) {
         std::cout << "Data appended successfully to file \'" << filename << "\'. New size: " << new_size << " bytes." << std::endl;
         fs_log(("fs_append completed successfully for file: " + std::string(filename) + ". New total size: " + std::to_string(new_size)).c_str());
     } else {
-        // fs_write would have logged specific errors
-        std::cerr << "Error (fs_append): Failed to write appended data to file \'" << filename << "\'. fs_write returned " << bytes_written << "." << std::endl;
-        fs_log(("fs_append failed: fs_write error for file - " + std::string(filename) + ". Expected to write " + std::to_string(new_size) + " but wrote " + std::to_string(bytes_written)).c_str());
-        // Potentially, the file might be in an inconsistent state or truncated if fs_write failed partially.
+        std::cerr << "Error (fs_append): Failed to write appended data to file \'" << filename << "\'. Write returned " << result << "." << std::endl;
+        fs_log(("fs_append failed: write error for file - " + std::string(filename) + ". Expected size " + std::to_string(new_size) +
+                " but write returned " + std::to_string(result)).c_str());
     }
 }
 
-void fs_truncate(const char* filename, int new_size) {
+void fs_truncate(const char* filename, int64_t new_size) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_EXCLUSIVE);
+    if (!file_guard.held()) return;
+    std::lock_guard<std::recursive_mutex> allocator_guard(active_volume().allocator_lock);
+    flush_delayed_writes_for_path(filename); // Aşağıdaki yollar diskteki içerik ve yerleşimle çalışır
     fs_log(("fs_truncate called for file: " + (filename ? std::string(filename) : "NULL") + 
             ", new_size: " + std::to_string(new_size)).c_str());
 
@@ -1119,7 +3849,7 @@ void fs_truncate(const char* filename, int new_size) {
         return;
     }
 
-    int current_size = fs_size(filename);
+    int64_t current_size = fs_size(filename);
     if (current_size < 0) {
         std::cerr << "Error (fs_truncate): Could not determine current size of file \'" << filename << "\'." << std::endl;
         fs_log(("fs_truncate failed: could not get current_size of file - " + std::string(filename)).c_str());
@@ -1132,9 +3862,36 @@ void fs_truncate(const char* filename, int new_size) {
         return;
     }
 
+    // Ön tahsisli dosyayı küçültme: Veri yerinde kalır, yeni boyutun ötesindeki ayrılmış bloklar bırakılır.
+    if (new_size < current_size) {
+        Superblock sb;
+        std::vector<FileInfo> all_files = read_all_file_info(sb);
+        int file_index = (sb.num_active_files == -1) ? -1 : resolve_path(all_files, filename);
+        if (file_index != -1 && has_reservation_for(all_files[file_index], current_size)) {
+            FileInfo& fi = all_files[file_index];
+            unsigned int keep_blocks = static_cast<unsigned int>(blocks_needed_for_size(new_size));
+            for (unsigned int i = keep_blocks; i < fi.num_data_blocks_used; ++i) {
+                free_data_block(fi.start_data_block_index + i);
+            }
+            fi.num_data_blocks_used = keep_blocks;
+            if (keep_blocks == 0) fi.start_data_block_index = -1;
+            fi.flags &= ~FILE_FLAG_PREALLOCATED;
+            fi.size = new_size;
+            if (write_file_info_at_index(file_index, fi, sb)) {
+                std::cout << "File \'" << filename << "\' truncated to " << new_size << " bytes successfully." << std::endl;
+                fs_log(("fs_truncate: Truncated preallocated file " + std::string(filename) + " to " + std::to_string(new_size) +
+                        " in place, keeping " + std::to_string(keep_blocks) + " blocks.").c_str());
+            } else {
+                std::cerr << "Error (fs_truncate): Failed to update FileInfo of \'" << filename << "\'." << std::endl;
+                fs_log(("fs_truncate: Error updating FileInfo of preallocated file " + std::string(filename)).c_str());
+            }
+            return;
+        }
+    }
+
     if (new_size == 0) {
         fs_log(("fs_truncate: New size is 0. Emptying file \'" + std::string(filename) + "\'.").c_str());
-        int written = fs_write(filename, "", 0);
+        int64_t written = write_file_now(filename, "", 0);
         if (written == 0) {
             std::cout << "File \'" << filename << "\' truncated to 0 bytes successfully." << std::endl;
             fs_log(("fs_truncate: Successfully emptied file " + std::string(filename)).c_str());
@@ -1148,7 +3905,7 @@ void fs_truncate(const char* filename, int new_size) {
     // new_size > 0 durumu
     if (new_size < current_size) { // Küçültme
         fs_log(("fs_truncate: Truncating file \'" + std::string(filename) + "\' from " + std::to_string(current_size) + " to " + std::to_string(new_size) + " bytes.").c_str());
-        char* buffer = new (std::nothrow) char[new_size];
+        char* buffer = new (std::nothrow) char[new_size + 1]; // +1: fs_read okuduğu verinin sonuna null terminator ekler
         if (!buffer) {
             std::cerr << "Error (fs_truncate): Memory allocation failed for shrink buffer." << std::endl;
             fs_log("fs_truncate failed: memory allocation for shrink buffer.");
@@ -1158,7 +3915,7 @@ void fs_truncate(const char* filename, int new_size) {
         // fs_read hata durumunda buffer'ı boşaltabilir veya loglayabilir.
         // Burada fs_read'in başarılı olduğunu varsayıyoruz, çünkü kritik bir hata yoksa devam eder.
         
-        int written = fs_write(filename, buffer, new_size);
+        int64_t written = write_file_now(filename, buffer, new_size);
         delete[] buffer;
 
         if (written == new_size) {
@@ -1169,34 +3926,157 @@ void fs_truncate(const char* filename, int new_size) {
             fs_log(("fs_truncate: Error truncating (shrink) " + std::string(filename) + ". fs_write returned: " + std::to_string(written)).c_str());
         }
     } else { // new_size > current_size (Büyütme)
+        // Yeni boyut için ardışık alan fs_fallocate ile ayrılır (gerekirse mevcut içerik oraya taşınır),
+        // sonra sadece eklenen aralık yerinde sıfırlanır. Tüm dosya bir tampon üzerinden yeniden yazılmaz.
         fs_log(("fs_truncate: Expanding file \'" + std::string(filename) + "\' from " + std::to_string(current_size) + " to " + std::to_string(new_size) + " bytes.").c_str());
-        char* buffer = new (std::nothrow) char[new_size];
-        if (!buffer) {
-            std::cerr << "Error (fs_truncate): Memory allocation failed for expand buffer." << std::endl;
-            fs_log("fs_truncate failed: memory allocation for expand buffer.");
+        if (fs_fallocate(filename, new_size) != 0) {
+            std::cerr << "Error (fs_truncate): Could not reserve space to expand file \'" << filename << "\' to " << new_size << " bytes." << std::endl;
+            fs_log(("fs_truncate: Error expanding " + std::string(filename) + ": fs_fallocate failed.").c_str());
             return;
         }
 
-        if (current_size > 0) {
-            fs_read(filename, 0, current_size, buffer); // Mevcut içeriği buffer'ın başına oku
-        }
-        // Kalan kısmı sıfırla (new_size - current_size kadar)
-        memset(buffer + current_size, 0, new_size - current_size);
-
-        int written = fs_write(filename, buffer, new_size);
-        delete[] buffer;
+        Superblock sb;
+        std::vector<FileInfo> all_files = read_all_file_info(sb);
+        int file_index = (sb.num_active_files == -1) ? -1 : resolve_path(all_files, filename);
+        bool expanded = file_index != -1 && has_reservation_for(all_files[file_index], new_size) &&
+                        write_into_reservation(file_index, all_files[file_index], sb, current_size, nullptr, new_size - current_size, new_size);
 
-        if (written == new_size) {
+        if (expanded) {
             std::cout << "File \'" << filename << "\' expanded to " << new_size << " bytes successfully." << std::endl;
             fs_log(("fs_truncate: Successfully expanded " + std::string(filename) + " to " + std::to_string(new_size)).c_str());
         } else {
-            std::cerr << "Error (fs_truncate): Failed to write expanded data to file \'" << filename << "\'. fs_write returned " << written << std::endl;
-            fs_log(("fs_truncate: Error expanding " + std::string(filename) + ". fs_write returned: " + std::to_string(written)).c_str());
+            std::cerr << "Error (fs_truncate): Failed to zero-fill the expanded part of file \'" << filename << "\'." << std::endl;
+            fs_log(("fs_truncate: Error expanding " + std::string(filename) + ": could not write zeros into reserved blocks.").c_str());
+        }
+    }
+}
+
+int fs_fallocate(const char* filename, int64_t size) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_EXCLUSIVE);
+    if (!file_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    std::lock_guard<std::recursive_mutex> allocator_guard(active_volume().allocator_lock);
+    fs_log(("fs_fallocate called for file: " + (filename ? std::string(filename) : "NULL") +
+            ", size: " + std::to_string(size)).c_str());
+
+    if (filename == nullptr || strlen(filename) == 0) {
+        std::cerr << "Error (fs_fallocate): Filename cannot be empty." << std::endl;
+        fs_log("fs_fallocate failed: empty filename.");
+        return -1;
+    }
+
+    if (size < 0) {
+        std::cerr << "Error (fs_fallocate): Size cannot be negative." << std::endl;
+        fs_log("fs_fallocate failed: negative size.");
+        return -1;
+    }
+
+    flush_delayed_writes_for_path(filename); // Yeni alan, bekleyen veri dahil son içeriğe göre ayrılır
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (fs_fallocate): Could not read metadata." << std::endl;
+        fs_log("fs_fallocate failed: metadata read error.");
+        return -2;
+    }
+
+    int file_index = resolve_path(all_files, filename);
+    if (file_index == -1) {
+        std::cerr << "Error (fs_fallocate): File '" << filename << "' not found." << std::endl;
+        fs_log(("fs_fallocate failed: file not found - " + std::string(filename)).c_str());
+        return -3;
+    }
+    FileInfo& fi = all_files[file_index];
+    if (fi.type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_fallocate): '" << filename << "' is a directory." << std::endl;
+        fs_log(("fs_fallocate failed: target is a directory - " + std::string(filename)).c_str());
+        return -4;
+    }
+
+    int64_t num_blocks_needed_64 = blocks_needed_for_size(size);
+    if (num_blocks_needed_64 > static_cast<int64_t>(NUM_DATA_BLOCKS)) {
+        std::cerr << "Error (fs_fallocate): Requested size " << size << " bytes needs " << num_blocks_needed_64
+                  << " blocks, but the disk only has " << NUM_DATA_BLOCKS << " data blocks." << std::endl;
+        fs_log(("fs_fallocate failed: size " + std::to_string(size) + " exceeds data area capacity for " + std::string(filename)).c_str());
+        return -5;
+    }
+    unsigned int num_blocks_needed = static_cast<unsigned int>(num_blocks_needed_64);
+
+    // Mevcut içerik zaten bu boyutu kapsıyorsa yapılacak bir şey yok.
+    if (size <= fi.size) {
+        fs_log(("fs_fallocate: '" + std::string(filename) + "' already holds " + std::to_string(fi.size) + " bytes.").c_str());
+        return 0;
+    }
+    // Ardışık bloklar yeterliyse (ör. son bloğun boş kısmı) yeni tahsis gerekmez; mevcut alan rezervasyon sayılır.
+    if (!is_inline_file(fi) && !has_packed_tail(fi) && num_blocks_needed <= fi.num_data_blocks_used) {
+        if (!(fi.flags & FILE_FLAG_PREALLOCATED)) {
+            fi.flags |= FILE_FLAG_PREALLOCATED;
+            if (!write_file_info_at_index(file_index, fi, sb)) {
+                std::cerr << "Error (fs_fallocate): Failed to update FileInfo on disk for '" << filename << "'." << std::endl;
+                fs_log(("fs_fallocate failed: error updating FileInfo for " + std::string(filename)).c_str());
+                return -8;
+            }
         }
+        fs_log(("fs_fallocate: '" + std::string(filename) + "' already has room for " + std::to_string(size) + " bytes.").c_str());
+        return 0;
     }
+
+    // Mevcut içeriği (bloklar, paylaşılan kuyruk veya satır içi veri) yeni ardışık alana taşımak için oku.
+    std::vector<char> content(static_cast<size_t>(fi.size) + 1); // +1: fs_read null terminator ekler
+    if (fi.size > 0) {
+        fs_read(filename, 0, fi.size, &content[0]);
+    }
+
+    int new_start = find_and_allocate_contiguous_data_blocks(num_blocks_needed, fi.placement_goal);
+    if (new_start == -1) {
+        std::cerr << "Error (fs_fallocate): Not enough contiguous space to reserve " << num_blocks_needed
+                  << " blocks for file '" << filename << "'." << std::endl;
+        fs_log(("fs_fallocate failed: no contiguous space for " + std::string(filename)).c_str());
+        return -6;
+    }
+
+    if (fi.size > 0) {
+        DiskStream disk_file(std::ios::in | std::ios::out);
+        if (disk_file) {
+            disk_file.seekp(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(new_start) * BLOCK_SIZE_BYTES);
+            disk_file.write(&content[0], fi.size);
+        }
+        if (!disk_file) {
+            std::cerr << "Error (fs_fallocate): Could not copy the content of '" << filename << "' into the reserved blocks." << std::endl;
+            fs_log(("fs_fallocate failed: error copying content for " + std::string(filename) + ". Freeing reserved blocks.").c_str());
+            for (unsigned int i = 0; i < num_blocks_needed; ++i) {
+                free_data_block(new_start + i);
+            }
+            return -7;
+        }
+    }
+
+    // Eski yerleşimi bırak
+    for (unsigned int i = 0; i < fi.num_data_blocks_used; ++i) {
+        free_data_block(fi.start_data_block_index + i);
+    }
+    release_tail_slot(all_files, file_index);
+    clear_inline_data(fi);
+
+    fi.start_data_block_index = new_start;
+    fi.num_data_blocks_used = num_blocks_needed;
+    fi.flags |= FILE_FLAG_PREALLOCATED;
+    if (!write_file_info_at_index(file_index, fi, sb)) {
+        std::cerr << "Error (fs_fallocate): Failed to update FileInfo on disk for '" << filename << "'." << std::endl;
+        fs_log(("fs_fallocate failed: error updating FileInfo for " + std::string(filename)).c_str());
+        return -8;
+    }
+
+    fs_log(("fs_fallocate: Reserved " + std::to_string(num_blocks_needed) + " contiguous blocks starting at " +
+            std::to_string(new_start) + " for '" + std::string(filename) + "' (size stays " + std::to_string(fi.size) + ").").c_str());
+    return 0;
 }
 
 void fs_copy(const char* src_filename, const char* dest_filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     ensure_disk_initialized();
     fs_log(("fs_copy called from: \'" + (src_filename ? std::string(src_filename) : "NULL") +
             "\' to: \'" + (dest_filename ? std::string(dest_filename) : "NULL") + "\'.").c_str());
@@ -1235,13 +4115,19 @@ void fs_copy(const char* src_filename, const char* dest_filename) {
         return;
     }
 
+    if (fs_is_directory(src_filename)) {
+        std::cerr << "Error (fs_copy): Source \'" << src_filename << "\' is a directory. Only regular files can be copied." << std::endl;
+        fs_log(("fs_copy failed: source is a directory - " + std::string(src_filename)).c_str());
+        return;
+    }
+
     if (fs_exists(dest_filename)) {
         std::cerr << "Error (fs_copy): Destination file \'" << dest_filename << "\' already exists." << std::endl;
         fs_log(("fs_copy failed: destination file already exists - " + std::string(dest_filename)).c_str());
         return;
     }
 
-    int src_size = fs_size(src_filename);
+    int64_t src_size = fs_size(src_filename);
     if (src_size < 0) {
         std::cerr << "Error (fs_copy): Could not determine size of source file \'" << src_filename << "\'." << std::endl;
         fs_log(("fs_copy failed: could not get size of source file - " + std::string(src_filename)).c_str());
@@ -1263,7 +4149,7 @@ void fs_copy(const char* src_filename, const char* dest_filename) {
         return;
     }
 
-    char* buffer = new (std::nothrow) char[src_size];
+    char* buffer = new (std::nothrow) char[src_size + 1]; // +1: fs_read null terminator ekler
     if (buffer == nullptr) {
         std::cerr << "Error (fs_copy): Failed to allocate memory to read source file \'" << src_filename << "\'." << std::endl;
         fs_log("fs_copy failed: memory allocation error for reading source.");
@@ -1282,7 +4168,7 @@ void fs_copy(const char* src_filename, const char* dest_filename) {
         return;
     }
 
-    int bytes_written = fs_write(dest_filename, buffer, src_size);
+    int64_t bytes_written = fs_write(dest_filename, buffer, src_size);
     delete[] buffer;
 
     if (bytes_written == src_size) {
@@ -1297,7 +4183,119 @@ void fs_copy(const char* src_filename, const char* dest_filename) {
 }
 
 void fs_mv(const char* old_path, const char* new_path) {
-    fs_rename(old_path, new_path); // Dizin yapımız olmadığı için şimdilik aynı işlev
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    move_fs_entry(old_path, new_path, true, "fs_mv");
+}
+
+void fs_rmdir(const char* path) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
+    ensure_disk_initialized();
+    fs_log(("fs_rmdir called for: " + (path ? std::string(path) : "NULL")).c_str());
+
+    if (path == nullptr || strlen(path) == 0 || strlen(path) > MAX_FILENAME_LENGTH) {
+        std::cerr << "Error (fs_rmdir): Invalid directory path." << std::endl;
+        fs_log("fs_rmdir failed: invalid path.");
+        return;
+    }
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (fs_rmdir): Could not read metadata." << std::endl;
+        fs_log("fs_rmdir failed: metadata read error.");
+        return;
+    }
+
+    int dir_index = resolve_path(all_files, path);
+    if (dir_index == -1) {
+        std::cerr << "Error (fs_rmdir): Directory '" << path << "' not found." << std::endl;
+        fs_log(("fs_rmdir failed: directory not found - " + std::string(path)).c_str());
+        return;
+    }
+    if (dir_index == ROOT_DIR_INDEX) {
+        std::cerr << "Error (fs_rmdir): The root directory cannot be removed." << std::endl;
+        fs_log("fs_rmdir failed: attempted to remove root directory.");
+        return;
+    }
+    if (all_files[dir_index].type != FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_rmdir): '" << path << "' is not a directory. Use fs_delete instead." << std::endl;
+        fs_log(("fs_rmdir failed: not a directory - " + std::string(path)).c_str());
+        return;
+    }
+    if (all_files[dir_index].dir_entry_count != 0) {
+        std::cerr << "Error (fs_rmdir): Directory '" << path << "' is not empty (" << all_files[dir_index].dir_entry_count << " entries)." << std::endl;
+        fs_log(("fs_rmdir failed: directory not empty - " + std::string(path)).c_str());
+        return;
+    }
+
+    if (release_fs_entry(all_files, sb, dir_index)) {
+        std::cout << "Directory '" << path << "' removed successfully." << std::endl;
+        fs_log(("Directory '" + std::string(path) + "' removed. Active files: " + std::to_string(sb.num_active_files)).c_str());
+    } else {
+        std::cerr << "Error (fs_rmdir): Failed to update metadata while removing '" << path << "'." << std::endl;
+        fs_log(("fs_rmdir failed: metadata write error for " + std::string(path)).c_str());
+    }
+}
+
+int fs_readdir(const char* path, std::vector<std::string>& entries_out) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    entries_out.clear();
+
+    if (path == nullptr || strlen(path) > MAX_FILENAME_LENGTH) {
+        fs_log("fs_readdir failed: invalid path.");
+        return -1;
+    }
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        fs_log("fs_readdir failed: metadata read error.");
+        return -2;
+    }
+
+    int dir_index = resolve_path(all_files, path);
+    if (dir_index == -1) {
+        fs_log(("fs_readdir failed: directory not found - " + std::string(path)).c_str());
+        return -3;
+    }
+    if (all_files[dir_index].type != FILE_TYPE_DIRECTORY) {
+        fs_log(("fs_readdir failed: not a directory - " + std::string(path)).c_str());
+        return -4;
+    }
+
+    std::vector<DirEntry> table;
+    if (!load_dir_table(all_files[dir_index], table)) {
+        return -5;
+    }
+    for (const DirEntry& entry : table) {
+        if (entry.file_index != DIR_ENTRY_EMPTY && entry.file_index < static_cast<int32_t>(all_files.size()) &&
+            all_files[entry.file_index].is_used) {
+            const FileInfo& child = all_files[entry.file_index];
+            entries_out.push_back(std::string(child.name) + (child.type == FILE_TYPE_DIRECTORY ? "/" : ""));
+        }
+    }
+    // Hash sırası kullanıcı için anlamsız; isim sırasına göre döndür.
+    std::sort(entries_out.begin(), entries_out.end());
+    fs_log(("fs_readdir: " + std::to_string(entries_out.size()) + " entries in '" + std::string(path) + "'.").c_str());
+    return 0;
+}
+
+bool fs_is_directory(const char* path) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    if (path == nullptr || strlen(path) > MAX_FILENAME_LENGTH) {
+        return false;
+    }
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        return false;
+    }
+    int file_index = resolve_path(all_files, path);
+    return file_index != -1 && all_files[file_index].type == FILE_TYPE_DIRECTORY;
 }
 
 // Bitmap Yönetimi Yardımcı Fonksiyonları
@@ -1309,59 +4307,992 @@ inline unsigned char bit_to_char_mask(int bit_num_in_byte) {
     return 1 << bit_num_in_byte;
 }
 
+// ------------- BUDDY ALLOCATOR -------------
+// Kalıcı kayıt her iki modda da bitmap'tir. Buddy modunda mertebe (order) başına boş listeler sadece
+// bellekte tutulur ve ilk tahsiste bitmap'ten yeniden kurulur (bitmap'i toptan yeniden yazan
+// fs_format / fs_defragment / fs_restore listeleri geçersiz kılar). Listeler std::set olduğu için
+// bölme ve birleştirme O(log N) adımda yapılır.
+//
+// n bloklu bir istek için 2^k >= n olan k mertebesinde hizalı bir parça alınır; parçanın kullanılmayan
+// sonu (2^k - n blok) hemen listelere geri verilir, böylece dosya sadece gerçekten kullandığı blokları tutar.
+// Blok serbest bırakma tek tek yapılır (free_data_block), her blok kardeşi boşsa yukarı doğru birleştirilir.
+
+void buddy_invalidate_free_lists() {
+    active_volume().buddy_state.valid = false;
+}
+
+// [start, start + count) boş aralığını, hizalı en büyük parçalara bölerek listelere ekler.
+// Aralığın komşularıyla birleştirme yapılmaz (çağıranlar komşuların dolu olduğunu bilir).
+void buddy_add_free_range(int start, int count) {
+    while (count > 0) {
+        int order = 0;
+        while (order < BUDDY_MAX_ORDER && start % (2 << order) == 0 && (2 << order) <= count) {
+            order++;
+        }
+        active_volume().buddy_state.lists[order].insert(start);
+        start += (1 << order);
+        count -= (1 << order);
+    }
+}
+
+// Bitmap'teki boş aralıklardan listeleri yeniden kurar ("mount" anında bir kez, O(N)).
+void buddy_rebuild_free_lists(const char* bitmap) {
+    Volume& volume = active_volume();
+    for (size_t k = 0; k < volume.buddy_state.lists.size(); ++k) {
+        volume.buddy_state.lists[k].clear();
+    }
+    int run_start = -1;
+    for (int block_idx = 0; block_idx <= static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+        bool is_free = block_idx < static_cast<int>(NUM_DATA_BLOCKS) && !(bitmap[block_idx / 8] & bit_to_char_mask(block_idx % 8));
+        if (is_free && run_start == -1) {
+            run_start = block_idx;
+        } else if (!is_free && run_start != -1) {
+            buddy_add_free_range(run_start, block_idx - run_start);
+            run_start = -1;
+        }
+    }
+    volume.buddy_state.valid = true;
+    fs_log("Buddy allocator free lists rebuilt from bitmap.");
+}
+
+// n blok için hizalı bir parça bulur, bitmap'te işaretler ve başlangıç indeksini döndürür.
+// En büyük mertebeden büyük istekler veya uygun parça yoksa -1 döner (çağıran bitmap taramasına düşer).
+int buddy_allocate(char* bitmap, int num_blocks) {
+    Volume& volume = active_volume();
+    int order = 0;
+    while ((1 << order) < num_blocks) order++;
+    if (order > BUDDY_MAX_ORDER) return -1;
+
+    int found_order = order;
+    while (found_order <= BUDDY_MAX_ORDER && volume.buddy_state.lists[found_order].empty()) found_order++;
+    if (found_order > BUDDY_MAX_ORDER) return -1;
+
+    int start = *volume.buddy_state.lists[found_order].begin();
+    volume.buddy_state.lists[found_order].erase(volume.buddy_state.lists[found_order].begin());
+    while (found_order > order) { // Böl: üst yarı bir alt mertebenin listesine gider
+        found_order--;
+        volume.buddy_state.lists[found_order].insert(start + (1 << found_order));
+    }
+
+    for (int i = 0; i < num_blocks; ++i) {
+        bitmap[(start + i) / 8] |= bit_to_char_mask((start + i) % 8);
+    }
+    buddy_add_free_range(start + num_blocks, (1 << order) - num_blocks); // Kullanılmayan sonu geri ver
+    return start;
+}
+
+// Serbest bırakılan bloğu listelere ekler, kardeşi boş oldukça birleştirir.
+void buddy_free_block(int block_index) {
+    Volume& volume = active_volume();
+    int start = block_index;
+    int order = 0;
+    while (order < BUDDY_MAX_ORDER) {
+        int buddy = start ^ (1 << order);
+        std::set<int>::iterator it = volume.buddy_state.lists[order].find(buddy);
+        if (it == volume.buddy_state.lists[order].end()) break;
+        volume.buddy_state.lists[order].erase(it);
+        start = std::min(start, buddy);
+        order++;
+    }
+    volume.buddy_state.lists[order].insert(start);
+}
+
+// Diskteki süperbloktan tahsis motorunu okur (açık dosya üzerinden).
+int read_allocator_mode(DiskStream& disk_file) {
+    Superblock sb;
+    disk_file.seekg(0, std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
+    if (!disk_file) {
+        disk_file.clear();
+        return ALLOCATOR_BITMAP_FIRST_FIT;
+    }
+    return sb.allocator_mode;
+}
+
+// ------------- ALAN İSTATİSTİKLERİ (SPACE STATISTICS) -------------
+// Superblock::stats artımlı olarak güncellenir: blok tahsisi/serbest bırakma account_block_range'den,
+// dosya boyutu değişiklikleri write_file_info_at_index'ten geçer. Sayaçlar bellekte tutulur ve ilk kullanımda
+// süperbloktan yüklenir; diske bitmap ve grup özetleriyle birlikte fs_sync/fs_unmount yazar
+// (persist_allocation_state). fs_statfs bitmap'i hiç taramaz.
+
+// Çağıran space_stats_lock'u tutmalıdır.
+bool load_space_stats(DiskStream& disk_file, SpaceStats& stats_out) {
+    Volume& volume = active_volume();
+    if (volume.space_stats_cache.valid) {
+        stats_out = volume.space_stats_cache.stats;
+        return true;
+    }
+    disk_file.seekg(offsetof(Superblock, stats), std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&stats_out), sizeof(SpaceStats));
+    if (!disk_file) {
+        disk_file.clear();
+        return false;
+    }
+    volume.space_stats_cache.stats = stats_out;
+    volume.space_stats_cache.valid = true;
+    return true;
+}
+
+// Sadece bellekteki kopyayı günceller. Çağıran space_stats_lock'u tutmalıdır.
+void store_space_stats(const SpaceStats& stats) {
+    Volume& volume = active_volume();
+    volume.space_stats_cache.stats = stats;
+    volume.space_stats_cache.valid = true;
+    volume.allocation_state_dirty.store(true, std::memory_order_relaxed);
+}
+
+bool bitmap_block_is_free(const char* bitmap, int block_index) {
+    return block_index >= 0 && block_index < static_cast<int>(NUM_DATA_BLOCKS) &&
+           !(bitmap[block_index / 8] & bit_to_char_mask(block_index % 8));
+}
+
+int group_of_block(int block_index);
+int group_block_count(int group);
+
+// [start, start + count) aralığını içeren boş parçanın uzunluğu (aralığın kendisi boş kabul edilir). Bitmap'in
+// sadece [lo, hi) bölgesi (çağıranın kilitlediği gruplar) okunur; parça bölgenin sınırına dayanıyorsa kilitsiz
+// komşu grupların boş blok sayaçlarıyla uzatılır, sonuç yine bir üst sınırdır.
+uint32_t free_run_length_around(const char* bitmap, int start, int count, int lo, int hi) {
+    Volume& volume = active_volume();
+    int left = start;
+    while (left > lo && bitmap_block_is_free(bitmap, left - 1)) left--;
+    int right = start + count;
+    while (right < hi && bitmap_block_is_free(bitmap, right)) right++;
+    uint32_t length = static_cast<uint32_t>(right - left);
+    for (int g = group_of_block(lo) - 1; left == lo && g >= 0; --g) {
+        uint32_t free_in_group = volume.group_free_blocks[g].load(std::memory_order_relaxed);
+        length += free_in_group;
+        if (free_in_group < static_cast<uint32_t>(group_block_count(g))) break; // Parça bu grupta bitiyor
+    }
+    for (int g = group_of_block(hi - 1) + 1; right == hi && g < static_cast<int>(NUM_ALLOCATION_GROUPS); ++g) {
+        uint32_t free_in_group = volume.group_free_blocks[g].load(std::memory_order_relaxed);
+        length += free_in_group;
+        if (free_in_group < static_cast<uint32_t>(group_block_count(g))) break;
+    }
+    return length;
+}
+
+// Bitmap'i tarayarak boş blok, boş parça sayısı ve en büyük boş parçayı hesaplar.
+void scan_free_space(const char* bitmap, SpaceStats& stats) {
+    stats.free_blocks = 0;
+    stats.free_extent_count = 0;
+    stats.largest_free_extent_hint = 0;
+    uint32_t run = 0;
+    for (int block_idx = 0; block_idx < static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+        if (bitmap_block_is_free(bitmap, block_idx)) {
+            if (run == 0) stats.free_extent_count++;
+            run++;
+            stats.free_blocks++;
+            stats.largest_free_extent_hint = std::max(stats.largest_free_extent_hint, run);
+        } else {
+            run = 0;
+        }
+    }
+}
+
+// Tek bir FileInfo'nun kullanım sayaçlarına katkısı. Sadece normal dosyalar sayılır.
+void file_space_usage(const FileInfo& fi, int64_t& bytes_out, int64_t& slack_out, uint32_t& fragmented_out) {
+    bytes_out = 0;
+    slack_out = 0;
+    fragmented_out = 0;
+    if (!fi.is_used || fi.type != FILE_TYPE_REGULAR) return;
+    bytes_out = fi.size;
+    if (!is_inline_file(fi)) {
+        slack_out = static_cast<int64_t>(fi.num_data_blocks_used) * BLOCK_SIZE_BYTES - block_backed_bytes(fi);
+        fragmented_out = (fi.num_data_blocks_used > 0 && has_packed_tail(fi)) ? 1 : 0;
+    }
+}
+
+// Bitmap ve FileInfo listesinden tüm sayaçları sıfırdan hesaplar (fs_defragment, fs_check_integrity).
+SpaceStats compute_space_stats(const char* bitmap, const std::vector<FileInfo>& all_files) {
+    SpaceStats stats;
+    scan_free_space(bitmap, stats);
+    for (const FileInfo& fi : all_files) {
+        int64_t bytes, slack;
+        uint32_t fragmented;
+        file_space_usage(fi, bytes, slack, fragmented);
+        stats.used_bytes += bytes;
+        stats.slack_bytes += slack;
+        stats.fragmented_files += fragmented;
+    }
+    return stats;
+}
+
+void account_file_info_change(DiskStream& disk_file, const FileInfo& old_fi, const FileInfo& new_fi) {
+    int64_t old_bytes, old_slack, new_bytes, new_slack;
+    uint32_t old_fragmented, new_fragmented;
+    file_space_usage(old_fi, old_bytes, old_slack, old_fragmented);
+    file_space_usage(new_fi, new_bytes, new_slack, new_fragmented);
+    if (old_bytes == new_bytes && old_slack == new_slack && old_fragmented == new_fragmented) return;
+
+    std::lock_guard<std::mutex> lock(active_volume().space_stats_lock);
+    SpaceStats stats;
+    if (!load_space_stats(disk_file, stats)) return;
+    stats.used_bytes += new_bytes - old_bytes;
+    stats.slack_bytes += new_slack - old_slack;
+    stats.fragmented_files = stats.fragmented_files + new_fragmented - old_fragmented;
+    store_space_stats(stats);
+}
+
+// İşlenmiş bitmap'te [start, start + count) aralığı değiştikten sonra boş alan sayaçlarını günceller
+// (sign: -1 tahsis, +1 serbest). Boş parça sayısı sadece aralığın iki komşusuna bakılarak bulunur.
+// En büyük boş parça bir üst sınırdır: serbest bırakmada birleşen parçanın boyuna yükselir, tahsiste
+// sadece boş blok sayısıyla sınırlanır. [lo, hi): çağıranın kilitlediği grupların blokları; tüm gruplar
+// kilitliyse kesin değer hesaplanır. Sayaçlar atomik bitmap'le birlikte yüklenmiş olmalıdır (atomic_bitmap_ensure_loaded).
+void account_free_space_change(int start, int count, int sign, int lo, int hi) {
+    Volume& volume = active_volume();
+    const char* bitmap = volume.committed_bitmap;
+    std::lock_guard<std::mutex> lock(volume.space_stats_lock);
+    if (!volume.space_stats_cache.valid) return;
+    SpaceStats stats = volume.space_stats_cache.stats;
+
+    bool left_free = bitmap_block_is_free(bitmap, start - 1);
+    bool right_free = bitmap_block_is_free(bitmap, start + count);
+    int64_t extents = stats.free_extent_count;
+    if (sign < 0) {
+        stats.free_blocks -= count;
+        if (left_free && right_free) extents++;        // Parçanın ortasından alındı: ikiye bölündü
+        else if (!left_free && !right_free) extents--; // Parçanın tamamı alındı
+    } else {
+        stats.free_blocks += count;
+        if (!left_free && !right_free) extents++;      // Yeni, tek başına bir boş parça
+        else if (left_free && right_free) extents--;   // İki boş parça birleşti
+    }
+    stats.free_extent_count = static_cast<uint32_t>(std::max<int64_t>(extents, 0));
+
+    if (lo == 0 && hi == static_cast<int>(NUM_DATA_BLOCKS)) {
+        SpaceStats scanned;
+        scan_free_space(bitmap, scanned);
+        stats.largest_free_extent_hint = scanned.largest_free_extent_hint;
+    } else if (sign > 0) {
+        stats.largest_free_extent_hint = std::max(stats.largest_free_extent_hint, free_run_length_around(bitmap, start, count, lo, hi));
+    }
+    stats.largest_free_extent_hint = std::min(stats.largest_free_extent_hint, stats.free_blocks);
+    store_space_stats(stats);
+}
+
+int fs_statfs(FsStatfs& stats_out) {
+    Volume& volume = active_volume();
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    if (!disk_file) {
+        std::cerr << "Error (fs_statfs): Could not open disk file '" << disk_filename() << "'." << std::endl;
+        return -1;
+    }
+    Superblock sb;
+    disk_file.seekg(0, std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
+    if (!disk_file) {
+        std::cerr << "Error (fs_statfs): Could not read superblock." << std::endl;
+        return -2;
+    }
+    SpaceStats stats;
+    {
+        std::lock_guard<std::mutex> lock(volume.space_stats_lock);
+        if (!load_space_stats(disk_file, stats)) {
+            std::cerr << "Error (fs_statfs): Could not read space statistics." << std::endl;
+            return -2;
+        }
+    }
+
+    stats_out.total_blocks = NUM_DATA_BLOCKS;
+    stats_out.free_blocks = stats.free_blocks;
+    stats_out.used_blocks = NUM_DATA_BLOCKS - stats.free_blocks;
+    stats_out.largest_free_extent_hint = stats.largest_free_extent_hint;
+    stats_out.free_extent_count = stats.free_extent_count;
+    stats_out.fragmented_files = stats.fragmented_files;
+    stats_out.free_bytes = static_cast<int64_t>(stats.free_blocks) * BLOCK_SIZE_BYTES;
+    stats_out.used_bytes = stats.used_bytes;
+    stats_out.slack_bytes = stats.slack_bytes;
+    stats_out.num_active_files = sb.num_active_files;
+    stats_out.max_files = MAX_FILES_CALCULATED - 1;
+    stats_out.fragmentation_percent = stats.free_blocks == 0 ? 0 :
+        100 - static_cast<int>(static_cast<int64_t>(stats.largest_free_extent_hint) * 100 / stats.free_blocks);
+    {
+        std::lock_guard<std::mutex> lock(volume.delayed_write_lock);
+        stats_out.buffered_bytes = volume.delayed_bytes_total;
+        stats_out.buffered_files = static_cast<int>(volume.delayed_writes.size());
+    }
+    return 0;
+}
+
+int fs_sync() {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    ensure_disk_initialized();
+    int result = flush_all_delayed_writes();
+    if (result != 0) {
+        std::cerr << "Error (fs_sync): Some buffered writes could not be written to disk." << std::endl;
+    }
+    if (!persist_allocation_state()) {
+        std::cerr << "Error (fs_sync): The bitmap, group summaries or space statistics could not be written to disk." << std::endl;
+        result = -1;
+    }
+    BlockDevice* device = block_device();
+    if (device != nullptr && !device->flush()) {
+        std::cerr << "Error (fs_sync): The block device could not be flushed." << std::endl;
+        result = -1;
+    }
+    fs_log(("fs_sync completed, result: " + std::to_string(result)).c_str());
+    return result;
+}
+
+int fs_async_drain();
+int fs_unmount() {
+    // Bu cildin kuyruktaki asenkron işleri de kilit tutulmadan tamamlanır; havuz iş parçacığı kendini bekleyemez.
+    if (fs_async_drain() != 0) {
+        std::cerr << "Error (fs_unmount): Cannot unmount from an async I/O worker or completion callback." << std::endl;
+        fs_log("fs_unmount refused: called on an async I/O pool thread.");
+        return FS_ERROR_ASYNC_WORKER;
+    }
+    fs_defrag_stop_background(); // İş parçacığı adım için volume kilidini bekliyor olabilir; kilidi tutmadan durdur
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    int result = fs_sync();
+    buddy_invalidate_free_lists();
+    allocation_state_invalidate();
+    release_block_device(true); // Dosya tabanlı aygıtlar kapanır ve sonraki G/Ç'de yeniden açılır
+    fs_log("File system unmounted.");
+    return result;
+}
+
+// Blok aygıtını değiştirir: Mevcut aygıt fs_unmount ile boşaltılıp kapatılır (RAM diski de bırakılır), yenisi hemen
+// açılır. Dosya tabanlı aygıtlar disk.sim'i kullanır (yoksa oluşturup formatlar). prepared verilmişse (önceden
+// kurulmuş RAM diski) o bağlanır; format_after ise bağlandıktan sonra formatlanır. Aygıt açılamazsa önceki tür
+// geri yüklenir.
+int mount_block_device(int device_type, BlockDevice* prepared, bool format_after, const StripedDeviceOptions* striped = nullptr) {
+    Volume& volume = active_volume();
+    // Henüz disk yoksa boşaltılacak bir şey de yok (disk.sim boşuna oluşturulmaz)
+    int unmounted = disk_exists() ? fs_unmount() : 0;
+    if (unmounted == FS_ERROR_ASYNC_WORKER || unmounted == FS_ERROR_LOCK_UPGRADE) {
+        delete prepared;
+        return unmounted;
+    }
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) {
+        delete prepared;
+        return FS_ERROR_LOCK_UPGRADE;
+    }
+    int previous_type = volume.mounted_device_type.load();
+    StripedDeviceOptions previous_striped = volume.striped_options;
+    release_block_device(false);
+    if (striped != nullptr) volume.striped_options = *striped;
+    volume.mounted_device_type.store(device_type);
+    if (prepared != nullptr) volume.mounted_device.store(prepared, std::memory_order_release);
+    if (format_after) volume.allocation_state_reconciled.store(true); // Boş görüntü uzlaştırılmaz, fs_format baştan yazar
+    ensure_disk_initialized();
+    if (block_device() == nullptr) {
+        std::cerr << "Error (fs_mount): Could not open block device type " << device_type << " on '" << disk_filename() << "'." << std::endl;
+        fs_log(("fs_mount failed: could not open block device type " + std::to_string(device_type) + ", keeping type " +
+                std::to_string(previous_type)).c_str());
+        volume.mounted_device_type.store(previous_type);
+        volume.striped_options = previous_striped;
+        ensure_disk_initialized();
+        return -2;
+    }
+    invalidate_file_handles(-1); // Yeni aygıt başka bir görüntü olabilir (RAM diski, farklı şerit üyeleri)
+    if (format_after) fs_format();
+    fs_log(("File system mounted on block device type " + std::to_string(device_type) + ".").c_str());
+    return 0;
+}
+
+int fs_mount(int device_type) {
+    if (device_type < BLOCK_DEVICE_BUFFERED_FILE || device_type > BLOCK_DEVICE_STRIPED) {
+        std::cerr << "Error (fs_mount): Unknown block device type " << device_type << "." << std::endl;
+        fs_log(("fs_mount failed: unknown block device type " + std::to_string(device_type)).c_str());
+        return -1;
+    }
+    if (device_type == BLOCK_DEVICE_RAM) return fs_mount_ram(RamDiskOptions());
+    if (device_type == BLOCK_DEVICE_STRIPED) {
+        StripedDeviceOptions options;
+        {
+            VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+            options = active_volume().striped_options;
+        }
+        return fs_mount_striped(options);
+    }
+    return mount_block_device(device_type, nullptr, false);
+}
+
+// Şeritli cildi bağlar. Hiçbir üye yoksa üyeler oluşturulur ve cilt formatlanır; var olan üyeler aynı birim ve üye
+// sayısıyla oluşturulmuş olmalıdır (boyut kontrolü).
+int fs_mount_striped(const StripedDeviceOptions& options) {
+    std::set<std::string> distinct(options.members.begin(), options.members.end());
+    uint32_t unit = options.stripe_unit_bytes;
+    if (options.members.empty() || options.members.size() > STRIPE_MAX_MEMBERS || distinct.size() != options.members.size() ||
+        distinct.count("") != 0 || unit == 0 || unit % BLOCK_SIZE_BYTES != 0 || unit > DISK_SIZE_BYTES) {
+        std::cerr << "Error (fs_mount_striped): Need 1-" << STRIPE_MAX_MEMBERS << " distinct member files and a stripe unit that is a "
+                  << "multiple of " << BLOCK_SIZE_BYTES << " bytes (at most " << DISK_SIZE_BYTES << ")." << std::endl;
+        fs_log("fs_mount_striped failed: invalid options.");
+        return -1;
+    }
+    int result = mount_block_device(BLOCK_DEVICE_STRIPED, nullptr, false, &options);
+    if (result == 0) {
+        fs_log(("Striped device mounted for parallel I/O: " + std::to_string(options.members.size()) + " members, stripe unit " +
+                std::to_string(unit) + " bytes, capacity " + std::to_string(DISK_SIZE_BYTES) + " bytes (one image).").c_str());
+    }
+    return result;
+}
+
+// RAM diski bağlar. Görüntü kilit dışında ayrılıp yüklenir; yükleme başarısızsa bağlı aygıta hiç dokunulmaz.
+int fs_mount_ram(const RamDiskOptions& options) {
+    RamDevice* device = new RamDevice(options);
+    if (!device->opened()) {
+        delete device;
+        std::cerr << "Error (fs_mount_ram): Could not set up the RAM disk"
+                  << (options.load_image != nullptr ? " from image '" + std::string(options.load_image) + "'" : std::string())
+                  << " (image must exist and be exactly " << DISK_SIZE_BYTES << " bytes)." << std::endl;
+        fs_log("fs_mount_ram failed: RAM disk could not be allocated or loaded.");
+        return -2;
+    }
+    bool format_after = !device->loaded();
+    int result = mount_block_device(BLOCK_DEVICE_RAM, device, format_after);
+    if (result == 0) {
+        fs_log(("RAM disk mounted (" + std::string(options.anonymous_mmap ? "anonymous mmap" : "heap") +
+                (options.load_image != nullptr ? ", loaded from " + std::string(options.load_image) : std::string(", formatted")) +
+                (options.dump_image != nullptr ? ", dumps to " + std::string(options.dump_image) : std::string()) + ").").c_str());
+    }
+    return result;
+}
+
+// ------------- ÇOKLU CİLT (FileSystem) -------------
+// FileSystem nesneleri birer Volume sahiplenir (bkz. CİLT DURUMU); varsayılan örnek varsayılan cildi sarar ve onu
+// sahiplenmez. Cilt ilk G/Ç'de diski oluşturur/formatlar, yani yalnızca kurulan bir nesne diske dokunmaz.
+
+FileSystem::FileSystem(const char* disk_filename, const char* log_filename)
+    : volume_(new Volume(disk_filename != nullptr ? disk_filename : DISK_FILENAME, log_filename)), owns_volume_(true) {}
+
+FileSystem::FileSystem(Volume* volume) : volume_(volume), owns_volume_(false) {}
+
+FileSystem::~FileSystem() {
+    if (!owns_volume_) return;
+    {
+        Scope scope(*this);
+        if (fs_async_drain() != 0) {
+            // Kuyruktaki işler cildi hâlâ kullanabilir: serbest bırakmak yerine bırakılır (sızıntı), kapanış yapılmaz.
+            std::cerr << "Error (~FileSystem): Cannot destroy a volume from an async I/O worker or completion callback; volume leaked." << std::endl;
+            fs_log("~FileSystem refused: called on an async I/O pool thread, volume not released.");
+            return;
+        }
+        fs_defrag_stop_background();
+        if (disk_exists()) fs_unmount(); // Bekleyen yazmalar diske gider
+        release_block_device(false);     // RAM diski de bırakılır (dump_image varsa yazılır)
+    }
+    delete volume_;
+}
+
+FileSystem& FileSystem::default_instance() {
+    static FileSystem* instance = new FileSystem(&default_volume());
+    return *instance;
+}
+
+const char* FileSystem::disk_filename() const {
+    return volume_->disk_path.c_str();
+}
+
+// ------------- TAHSİS GRUPLARI (ALLOCATION GROUPS) -------------
+// Her grubun işlenmiş bitmap dilimi grubun kilidiyle korunur; özet tablosunun bellekteki kopyasındaki
+// free_blocks sayacı aynı kilit altında güncellenir (diske fs_sync yazar). Tek bir gruba sığmayan işlemler
+// (büyük tahsisler, buddy modu, gruplar arası ardışık aralıklar) tüm grup kilitlerini artan sırayla alarak
+// bitmap'in tamamı üzerinde çalışır.
+
+
+int group_of_block(int block_index) {
+    return block_index / static_cast<int>(ALLOCATION_GROUP_BLOCKS);
+}
+
+int group_first_block(int group) {
+    return group * static_cast<int>(ALLOCATION_GROUP_BLOCKS);
+}
+
+int group_block_count(int group) {
+    return std::min(static_cast<int>(ALLOCATION_GROUP_BLOCKS), static_cast<int>(NUM_DATA_BLOCKS) - group_first_block(group));
+}
+
+std::vector<std::unique_lock<std::mutex> > lock_all_allocation_groups() {
+    std::vector<std::unique_lock<std::mutex> > locks;
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        locks.push_back(std::unique_lock<std::mutex>(active_volume().allocation_group_locks[g]));
+    }
+    return locks;
+}
+
+bool read_group_summaries(DiskStream& disk_file, std::vector<AllocationGroupSummary>& summaries) {
+    summaries.resize(NUM_ALLOCATION_GROUPS);
+    disk_file.seekg(GROUP_SUMMARY_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&summaries[0]), GROUP_SUMMARY_TABLE_SIZE_BYTES);
+    return static_cast<bool>(disk_file);
+}
+
+// [start, start + count) aralığını kapsayan grupların sayaçlarını ve alan istatistiklerini bellekte günceller
+// (sign: -1 tahsis, +1 serbest). [lo, hi): çağıranın kilitlediği grupların blokları.
+void account_block_range(int start, int count, int sign, int lo, int hi) {
+    Volume& volume = active_volume();
+    account_free_space_change(start, count, sign, lo, hi);
+    while (count > 0) {
+        int group = group_of_block(start);
+        int in_group = std::min(count, group_first_block(group) + group_block_count(group) - start);
+        volume.group_free_blocks[group].fetch_add(static_cast<uint32_t>(sign * in_group), std::memory_order_relaxed);
+        start += in_group;
+        count -= in_group;
+    }
+}
+
+bool write_group_summaries(DiskStream& disk_file, const std::vector<AllocationGroupSummary>& summaries) {
+    disk_file.seekp(GROUP_SUMMARY_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&summaries[0]), GROUP_SUMMARY_TABLE_SIZE_BYTES);
+    return static_cast<bool>(disk_file);
+}
+
+// Tüm grup özetlerini bitmap'ten yeniden hesaplayıp yazar (fs_format, fs_defragment).
+bool rebuild_group_summaries(DiskStream& disk_file, const char* bitmap) {
+    std::vector<AllocationGroupSummary> summaries(NUM_ALLOCATION_GROUPS);
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        uint32_t free_count = 0;
+        for (int b = group_first_block(g); b < group_first_block(g) + group_block_count(g); ++b) {
+            if (!(bitmap[b / 8] & bit_to_char_mask(b % 8))) free_count++;
+        }
+        summaries[g].free_blocks = free_count;
+    }
+    return write_group_summaries(disk_file, summaries);
+}
+
+// ------------- ATOMİK BİTMAP (KİLİTSİZ TAHSİS) -------------
+// Bitmap modunda boş aralık arama ve sahiplenme kilitsizdir: bitmap'in bellekteki kopyası std::atomic<uint64_t>
+// kelimeleri olarak tutulur ve aralık compare-and-swap ile sahiplenilir. CAS'ı kaybeden iş parçacığı taramaya
+// devam eder. Sahiplenilen aralık sonra kısa bir grup kilidi altında işlenmiş (committed) bitmap'e işlenir ve
+// sayaçlar güncellenir (commit_bitmap_range); ikisi de bellektedir, tahsis yolu diske hiç yazmaz. Atomik kopya
+// işlenmiş kopyanın her zaman üst kümesidir: tahsiste önce atomik kopyada sahiplenilir, serbest bırakmada önce
+// işlenir, sonra atomik kopyada bırakılır. Kopyalar, grup özetleri ve alan sayaçları ilk kullanımda diskten
+// birlikte yüklenir; diske fs_sync/fs_unmount yazar (persist_allocation_state). Bitmap'i toptan yazan işlemler
+// (format, birleştirme, geri yükleme) cilt kilidini özel tutarken bellekteki durumu düşürür. Her iş parçacığının bir ev grubu vardır ve aramaya oradan
+// başlar, böylece eşzamanlı yazanlar aynı kelimeler üzerinde çarpışmaz. Buradan yalnızca küçük tahsisler geçer;
+// boyut sınıfı ayrımı (küçükler başta, büyükler sondan) bozulmasın diye ev grupları diskin ön yarısındaki
+// gruplarla (SMALL_CLASS_GROUPS) sınırlıdır. O bölge dolunca arka gruplara sırayla (öne yakın olandan) geçilir.
+// Ev grupları ilk tahsis sırasıyla dağıtılır; tek iş parçacıklı kullanımda grup 0'dan başlanır ve yerleşim
+// first-fit olarak kalır.
+
+const unsigned int SMALL_CLASS_GROUPS = NUM_ALLOCATION_GROUPS > 1 ? NUM_ALLOCATION_GROUPS / 2 : 1;
+static std::atomic<unsigned int> next_home_group(0);
+static thread_local int home_group = -1;
+
+// Bellekteki tahsis durumunu diske yazmadan düşürür; sonraki tahsis diskten yeniden yükler.
+void allocation_state_invalidate() {
+    Volume& volume = active_volume();
+    volume.atomic_bitmap_loaded.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(volume.space_stats_lock);
+        volume.space_stats_cache.valid = false;
+    }
+    volume.allocation_state_dirty.store(false, std::memory_order_relaxed);
+}
+
+// Kopyalar yüklü değilse bitmap'i, grup özetlerini ve alan sayaçlarını diskten yükler. Diskin sonundaki
+// kullanılmayan bitler atomik kopyada dolu sayılır, hiç sahiplenilmez.
+bool atomic_bitmap_ensure_loaded(DiskStream& disk_file) {
+    Volume& volume = active_volume();
+    if (volume.atomic_bitmap_loaded.load(std::memory_order_acquire)) return true;
+    std::lock_guard<std::mutex> lock(volume.atomic_bitmap_load_lock);
+    if (volume.atomic_bitmap_loaded.load(std::memory_order_relaxed)) return true;
+
+    char* bitmap = volume.committed_bitmap;
+    std::vector<AllocationGroupSummary> summaries;
+    disk_file.seekg(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.read(bitmap, BITMAP_SIZE_BYTES);
+    if (!disk_file || !read_group_summaries(disk_file, summaries)) {
+        disk_file.clear();
+        fs_log("atomic_bitmap_ensure_loaded failed: could not read bitmap or group summaries.");
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> stats_lock(volume.space_stats_lock);
+        SpaceStats stats;
+        if (!load_space_stats(disk_file, stats)) {
+            fs_log("atomic_bitmap_ensure_loaded failed: could not read space statistics.");
+            return false;
+        }
+    }
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        volume.group_free_blocks[g].store(summaries[g].free_blocks, std::memory_order_relaxed);
+    }
+    for (int w = 0; w < ATOMIC_BITMAP_WORDS; ++w) {
+        uint64_t word = 0;
+        for (int bit = 0; bit < 64; ++bit) {
+            int block = w * 64 + bit;
+            if (block >= static_cast<int>(NUM_DATA_BLOCKS) || (bitmap[block / 8] & bit_to_char_mask(block % 8))) {
+                word |= uint64_t(1) << bit;
+            }
+        }
+        volume.atomic_bitmap[w].store(word, std::memory_order_relaxed);
+    }
+    volume.atomic_bitmap_loaded.store(true, std::memory_order_release);
+    fs_log("Atomic bitmap loaded from disk.");
+    return true;
+}
+
+// İşlenmiş bitmap'in tutarlı bir kopyası (tüm grup kilitleri kısa süre alınır). Bitmap'in tamamını okuyan
+// rapor ve birleştirme yolları diskteki (fs_sync'ten beri eskimiş olabilecek) kopya yerine bunu kullanır.
+bool read_committed_bitmap(DiskStream& disk_file, char* bitmap_out) {
+    if (!atomic_bitmap_ensure_loaded(disk_file)) return false;
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+    memcpy(bitmap_out, active_volume().committed_bitmap, BITMAP_SIZE_BYTES);
+    return true;
+}
+
+// Bellekteki bitmap'i, grup özetlerini ve alan sayaçlarını diske yazar (fs_sync, fs_unmount, fs_backup,
+// fs_check_integrity). Çağıran cilt kilidini özel tutar, yani bekleyen sahiplenme yoktur ve işlenmiş kopya
+// atomik kopyayla aynıdır.
+bool persist_allocation_state() {
+    Volume& volume = active_volume();
+    if (!volume.allocation_state_dirty.load(std::memory_order_relaxed)) return true;
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    if (!disk_file) {
+        fs_log("persist_allocation_state failed: could not open disk file.");
+        return false;
+    }
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+    std::lock_guard<std::mutex> stats_lock(volume.space_stats_lock);
+    if (volume.atomic_bitmap_loaded.load(std::memory_order_acquire)) {
+        std::vector<AllocationGroupSummary> summaries(NUM_ALLOCATION_GROUPS);
+        for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+            summaries[g].free_blocks = volume.group_free_blocks[g].load(std::memory_order_relaxed);
+        }
+        disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
+        disk_file.write(volume.committed_bitmap, BITMAP_SIZE_BYTES);
+        write_group_summaries(disk_file, summaries);
+    }
+    if (volume.space_stats_cache.valid) {
+        disk_file.seekp(offsetof(Superblock, stats), std::ios::beg);
+        disk_file.write(reinterpret_cast<const char*>(&volume.space_stats_cache.stats), sizeof(SpaceStats));
+    }
+    disk_file.flush();
+    if (!disk_file) {
+        fs_log("persist_allocation_state failed: could not write bitmap, group summaries or space statistics.");
+        return false;
+    }
+    volume.allocation_state_dirty.store(false, std::memory_order_relaxed);
+    fs_log("Allocation state written to disk.");
+    return true;
+}
+
+// Tahsisler yalnızca bellekte tutulup fs_sync'te yazıldığı için fs_unmount'suz bir çıkıştan (çökme, Ctrl-C) sonra
+// diskteki bitmap, FileInfo'ların zaten gösterdiği blokları boş sayabilir (ya da bırakılmış blokları dolu). FileInfo
+// tablosu yetkilidir: aygıt açıldıktan sonraki ilk üst düzey çağrıda bitmap kullanılan FileInfo'ların ardışık
+// alanlarından ve kuyruk bloklarından yeniden kurulur; grup özetleri ve alan sayaçları da yeniden hesaplanır. Fark
+// varsa hepsi hemen diske yazılır. Çağıran cilt kilidini özel tutar. Diskin sonundaki kullanılmayan bitlere dokunulmaz.
+bool reconcile_allocation_state() {
+    Volume& volume = active_volume();
+    volume.allocation_state_reconciled.store(true); // Aşağıdaki çağrılar ensure_disk_initialized'a dönerse tekrar girilmez
+    if (!persist_allocation_state()) return false;
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    char on_disk[BITMAP_SIZE_BYTES];
+    std::vector<AllocationGroupSummary> summaries;
+    if (sb.num_active_files == -1 || !disk_file) {
+        fs_log("reconcile_allocation_state failed: could not read metadata.");
+        return false;
+    }
+    disk_file.seekg(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.read(on_disk, BITMAP_SIZE_BYTES);
+    if (!disk_file || !read_group_summaries(disk_file, summaries)) {
+        fs_log("reconcile_allocation_state failed: could not read bitmap or group summaries.");
+        return false;
+    }
+
+    char bitmap[BITMAP_SIZE_BYTES];
+    memcpy(bitmap, on_disk, BITMAP_SIZE_BYTES);
+    for (int b = 0; b < static_cast<int>(NUM_DATA_BLOCKS); ++b) bitmap[b / 8] &= ~bit_to_char_mask(b % 8);
+    for (const FileInfo& fi : all_files) {
+        if (!fi.is_used || is_inline_file(fi)) continue;
+        for (int64_t b = fi.start_data_block_index; fi.start_data_block_index >= 0 &&
+                                                   b < static_cast<int64_t>(fi.start_data_block_index) + fi.num_data_blocks_used; ++b) {
+            if (b < static_cast<int64_t>(NUM_DATA_BLOCKS)) bitmap[b / 8] |= bit_to_char_mask(b % 8);
+        }
+        if (has_packed_tail(fi) && fi.tail_block_index < static_cast<int32_t>(NUM_DATA_BLOCKS)) {
+            bitmap[fi.tail_block_index / 8] |= bit_to_char_mask(fi.tail_block_index % 8);
+        }
+    }
+    bool summaries_match = true;
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        uint32_t free_count = 0;
+        for (int b = group_first_block(g); b < group_first_block(g) + group_block_count(g); ++b) {
+            if (bitmap_block_is_free(bitmap, b)) free_count++;
+        }
+        if (summaries[g].free_blocks != free_count) summaries_match = false;
+    }
+    SpaceStats expected = compute_space_stats(bitmap, all_files);
+    bool stats_match = sb.stats.free_blocks == expected.free_blocks && sb.stats.free_extent_count == expected.free_extent_count &&
+                       sb.stats.used_bytes == expected.used_bytes && sb.stats.slack_bytes == expected.slack_bytes &&
+                       sb.stats.fragmented_files == expected.fragmented_files &&
+                       sb.stats.largest_free_extent_hint >= expected.largest_free_extent_hint;
+    bool bitmap_match = memcmp(bitmap, on_disk, BITMAP_SIZE_BYTES) == 0;
+    if (bitmap_match && summaries_match && stats_match) return true;
+
+    disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.write(bitmap, BITMAP_SIZE_BYTES);
+    if (disk_file) rebuild_group_summaries(disk_file, bitmap);
+    disk_file.seekp(offsetof(Superblock, stats), std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&expected), sizeof(SpaceStats));
+    disk_file.flush();
+    buddy_invalidate_free_lists();
+    allocation_state_invalidate();
+    if (!disk_file) {
+        fs_log("reconcile_allocation_state failed: could not write the rebuilt allocation state.");
+        return false;
+    }
+    fs_log(("Allocation state did not match the FileInfo table (unclean shutdown?); rebuilt bitmap" +
+            std::string(bitmap_match ? " (unchanged)" : "") + ", group summaries and space statistics.").c_str());
+    return true;
+}
+
+// Kelime içinde bit'ten başlayan n bitlik maske (1 <= n <= 64 - bit).
+uint64_t word_run_mask(int bit, int n) {
+    return (n == 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1)) << bit;
+}
+
+bool atomic_bitmap_block_is_free(int block_index) {
+    return !((active_volume().atomic_bitmap[block_index / 64].load(std::memory_order_relaxed) >> (block_index % 64)) & 1);
+}
+
+void atomic_bitmap_release(int start, int count) {
+    Volume& volume = active_volume();
+    for (int block = start; block < start + count; ) {
+        int n = std::min(64 - block % 64, start + count - block);
+        volume.atomic_bitmap[block / 64].fetch_and(~word_run_mask(block % 64, n), std::memory_order_release);
+        block += n;
+    }
+}
+
+// [start, start + count) aralığını kelime kelime CAS ile sahiplenir. Aralıktaki bir blok başka bir iş parçacığı
+// tarafından alınmışsa o ana kadar sahiplenilen kelimeler geri bırakılır ve false döner.
+bool atomic_bitmap_try_claim(int start, int count) {
+    Volume& volume = active_volume();
+    for (int block = start; block < start + count; ) {
+        int n = std::min(64 - block % 64, start + count - block);
+        uint64_t mask = word_run_mask(block % 64, n);
+        std::atomic<uint64_t>& word = volume.atomic_bitmap[block / 64];
+        uint64_t expected = word.load(std::memory_order_relaxed);
+        do {
+            if (expected & mask) {
+                atomic_bitmap_release(start, block - start);
+                return false;
+            }
+        } while (!word.compare_exchange_weak(expected, expected | mask, std::memory_order_acq_rel, std::memory_order_relaxed));
+        block += n;
+    }
+    return true;
+}
+
+// [first, first + count) içinde num_blocks ardışık boş blok arar ve sahiplenir (first-fit). Tamamen dolu
+// kelimeler tek okumayla atlanır. Sahiplenme yarışı kaybedilirse aynı aralıktan yeniden taranır. Yoksa -1.
+int atomic_bitmap_claim_first_fit(int first, int count, int num_blocks) {
+    Volume& volume = active_volume();
+    int end = first + count;
+    int run_start = first;
+    for (int block = first; block < end; ++block) {
+        if (block % 64 == 0 && block + 64 <= end && volume.atomic_bitmap[block / 64].load(std::memory_order_relaxed) == ~uint64_t(0)) {
+            block += 63;
+            run_start = block + 1;
+            continue;
+        }
+        if (!atomic_bitmap_block_is_free(block)) {
+            run_start = block + 1;
+            continue;
+        }
+        if (block - run_start + 1 == num_blocks) {
+            if (atomic_bitmap_try_claim(run_start, num_blocks)) return run_start;
+            block = run_start - 1; // Başka bir iş parçacığı araya girdi; aralığı yeniden tara
+        }
+    }
+    return -1;
+}
+
+// Bitmap'in tamamının o anki kopyası (bitmap'in tamamını tarayan tahsisler için).
+void atomic_bitmap_snapshot(char* bitmap_out) {
+    Volume& volume = active_volume();
+    for (unsigned int byte = 0; byte < BITMAP_SIZE_BYTES; ++byte) {
+        bitmap_out[byte] = static_cast<char>(volume.atomic_bitmap[byte / 8].load(std::memory_order_relaxed) >> ((byte % 8) * 8));
+    }
+}
+
+// [start, start + count) aralığını işlenmiş bitmap'e işler (sign: -1 tahsis, +1 serbest) ve sayaçları günceller;
+// hepsi bellektedir. Sadece aralığın kendi bitleri değiştirilir; başka iş parçacıklarının henüz işlenmemiş
+// sahiplenmeleri taşınmaz, böylece sayaçlar her zaman işlenmiş durumu izler. Aralığın grupları ve iki komşu
+// bloğun grupları artan sırayla kilitlenir: boş parça sayacı komşulara baktığı için grup sınırındaki iki işlem
+// sırayla işlenir. all_groups_locked: çağıran tüm grup kilitlerini zaten tutuyor (bitmap'in tamamı üzerinde
+// çalışan yollar); sayaçlar o zaman kesin değerlerle güncellenir. Kopyalar yüklenmiş olmalıdır.
+void commit_bitmap_range(int start, int count, int sign, bool all_groups_locked = false) {
+    Volume& volume = active_volume();
+    std::vector<std::unique_lock<std::mutex> > group_locks;
+    int first_group = 0;
+    int last_group = static_cast<int>(NUM_ALLOCATION_GROUPS) - 1;
+    if (!all_groups_locked) {
+        first_group = group_of_block(std::max(start - 1, 0));
+        last_group = group_of_block(std::min(start + count, static_cast<int>(NUM_DATA_BLOCKS) - 1));
+        for (int g = first_group; g <= last_group; ++g) {
+            group_locks.push_back(std::unique_lock<std::mutex>(volume.allocation_group_locks[g]));
+        }
+    }
+
+    char* bitmap = volume.committed_bitmap;
+    for (int block = start; block < start + count; ++block) {
+        if (sign < 0) {
+            bitmap[block / 8] |= bit_to_char_mask(block % 8);
+        } else {
+            bitmap[block / 8] &= ~bit_to_char_mask(block % 8);
+        }
+    }
+    account_block_range(start, count, sign, group_first_block(first_group), group_first_block(last_group) + group_block_count(last_group));
+    volume.allocation_state_dirty.store(true, std::memory_order_relaxed);
+}
+
+// Tahsis gruplarında num_blocks ardışık boş blok arar (first-fit), iş parçacığının ev grubundan başlayarak.
+// Arama ve sahiplenme kilitsizdir; sadece işleme (commit) grup kilidi alır. Özet, grubun yeterli boş bloğu
+// olmadığını söylüyorsa grup taranmadan atlanır. Bulunamazsa -1 döner.
+int allocate_within_groups(DiskStream& disk_file, int num_blocks) {
+    Volume& volume = active_volume();
+    if (!atomic_bitmap_ensure_loaded(disk_file)) {
+        return -1;
+    }
+    if (home_group == -1) {
+        home_group = static_cast<int>(next_home_group.fetch_add(1) % SMALL_CLASS_GROUPS);
+    }
+
+    // Önce küçük sınıf bölgesi ev grubundan başlayarak (dairesel), sonra kalan gruplar baştan sona
+    for (unsigned int i = 0; i < NUM_ALLOCATION_GROUPS; ++i) {
+        int g = static_cast<int>(i < SMALL_CLASS_GROUPS ? (home_group + i) % SMALL_CLASS_GROUPS : i);
+        if (volume.group_free_blocks[g].load(std::memory_order_relaxed) < static_cast<uint32_t>(num_blocks)) continue;
+
+        int run_start = atomic_bitmap_claim_first_fit(group_first_block(g), group_block_count(g), num_blocks);
+        if (run_start == -1) continue;
+        commit_bitmap_range(run_start, num_blocks, -1);
+        return run_start;
+    }
+    return -1;
+}
+
+bool fs_get_group_summaries(std::vector<AllocationGroupSummary>& summaries_out) {
+    Volume& volume = active_volume();
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    DiskStream disk_file(std::ios::in);
+    if (!disk_file || !atomic_bitmap_ensure_loaded(disk_file)) return false;
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups(); // Tutarlı bir anlık görüntü
+    summaries_out.resize(NUM_ALLOCATION_GROUPS);
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        summaries_out[g].free_blocks = volume.group_free_blocks[g].load(std::memory_order_relaxed);
+    }
+    return true;
+}
+
 void free_data_block(int block_index) {
+    Volume& volume = active_volume();
     if (block_index < 0 || block_index >= NUM_DATA_BLOCKS) {
         std::cerr << "Error (free_data_block): Invalid data block index " << block_index << ". Valid range is 0-" << NUM_DATA_BLOCKS - 1 << std::endl;
         fs_log(("free_data_block failed: invalid block index " + std::to_string(block_index)).c_str());
         return;
     }
 
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' to free data block." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to free data block." << std::endl;
         fs_log("free_data_block failed: could not open disk file.");
         return;
     }
-
-    std::streampos bitmap_byte_offset = BITMAP_START_OFFSET_IN_METADATA + (block_index / 8);
-    int bit_in_byte = block_index % 8;
-    unsigned char byte_val;
-
-    disk_file.seekg(bitmap_byte_offset);
-    disk_file.read(reinterpret_cast<char*>(&byte_val), 1);
-
-    if (!disk_file) {
-        std::cerr << "Error: Could not read bitmap byte for block " << block_index << std::endl;
+    if (!atomic_bitmap_ensure_loaded(disk_file)) {
+        std::cerr << "Error: Could not read bitmap to free block " << block_index << std::endl;
         fs_log(("free_data_block failed: could not read bitmap for block " + std::to_string(block_index)).c_str());
-        disk_file.close();
         return;
     }
 
-    if (!(byte_val & bit_to_char_mask(bit_in_byte))) {
+    // Bitmap modunda serbest bırakma kilitsizdir (işleme sadece ilgili grupları kilitler). Buddy listeleri tüm
+    // diske ait olduğu için buddy modunda tahsis kilidi ve tüm grup kilitleri alınır.
+    bool buddy_mode = (read_allocator_mode(disk_file) == ALLOCATOR_BUDDY);
+    std::unique_lock<std::recursive_mutex> allocator_guard(volume.allocator_lock, std::defer_lock);
+    std::vector<std::unique_lock<std::mutex> > group_locks;
+    if (buddy_mode) {
+        allocator_guard.lock();
+        group_locks = lock_all_allocation_groups();
+    }
+
+    if (atomic_bitmap_block_is_free(block_index)) {
         std::cout << "Warning (free_data_block): Data block " << block_index << " is already free." << std::endl;
         fs_log(("free_data_block warning: block " + std::to_string(block_index) + " already free.").c_str());
-        disk_file.close();
         return; // Zaten boşsa bir şey yapma
     }
 
-    byte_val &= ~bit_to_char_mask(bit_in_byte); // Biti sıfırla (boşalt)
+    // Önce işlenir, sonra blok atomik kopyada bırakılır: bırakılana kadar başka bir iş parçacığı bloğu alamaz.
+    commit_bitmap_range(block_index, 1, +1, buddy_mode);
+    atomic_bitmap_release(block_index, 1);
+    // fs_log(("Data block " + std::to_string(block_index) + " freed successfully.").c_str());
+    if (volume.buddy_state.valid && buddy_mode) {
+        buddy_free_block(block_index); // Kardeşiyle birleştir (listeler geçersizse sonraki tahsiste bitmap'ten kurulur)
+    }
+}
 
-    disk_file.seekp(bitmap_byte_offset);
-    disk_file.write(reinterpret_cast<const char*>(&byte_val), 1);
 
-    if (!disk_file) {
-        std::cerr << "Error: Could not write updated bitmap byte for block " << block_index << std::endl;
-        fs_log(("free_data_block failed: could not write bitmap for block " + std::to_string(block_index)).c_str());
-    } else {
-        // fs_log(("Data block " + std::to_string(block_index) + " freed successfully.").c_str());
+// goal_block'a en yakın num_blocks uzunluğunda boş aralığın başlangıcını bulur (yoksa -1). Her boş parça
+// içinde hedefe en yakın başlangıç seçilir: hedef parçanın içindeyse tam hedeften, değilse parçanın hedefe
+// bakan ucundan. Eşit uzaklıkta hedefin arkası (daha büyük indeks) tercih edilir; okuma ileri doğru akar.
+int find_free_run_near(const char* bitmap, int num_blocks, int goal_block) {
+    int best_start = -1;
+    int best_distance = 0;
+    int run_start = -1;
+    for (int block_idx = 0; block_idx <= static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+        bool is_free = block_idx < static_cast<int>(NUM_DATA_BLOCKS) && !(bitmap[block_idx / 8] & bit_to_char_mask(block_idx % 8));
+        if (is_free) {
+            if (run_start == -1) run_start = block_idx;
+            continue;
+        }
+        if (run_start != -1 && block_idx - run_start >= num_blocks) {
+            int candidate = std::max(run_start, std::min(goal_block, block_idx - num_blocks));
+            int distance = std::abs(candidate - goal_block);
+            if (best_start == -1 || distance < best_distance || (distance == best_distance && candidate > best_start)) {
+                best_start = candidate;
+                best_distance = distance;
+            }
+        }
+        run_start = -1;
     }
-    disk_file.close();
+    return best_start;
+}
+
+// Diskin sonundan geriye doğru num_blocks uzunluğunda ilk boş aralığın başlangıcını bulur (yoksa -1).
+// Aralık boş parçanın en üstteki num_blocks bloğudur.
+int find_free_run_from_end(const char* bitmap, int num_blocks) {
+    int run_length = 0;
+    for (int block_idx = NUM_DATA_BLOCKS - 1; block_idx >= 0; --block_idx) {
+        if (!bitmap_block_is_free(bitmap, block_idx)) {
+            run_length = 0;
+            continue;
+        }
+        if (++run_length == num_blocks) return block_idx;
+    }
+    return -1;
 }
 
+// Diskin başından num_blocks uzunluğunda ilk boş aralığın başlangıcını bulur (first-fit, yoksa -1).
+int find_free_run_first_fit(const char* bitmap, int num_blocks) {
+    int run_length = 0;
+    for (int block_idx = 0; block_idx < static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+        if (!bitmap_block_is_free(bitmap, block_idx)) {
+            run_length = 0;
+            continue;
+        }
+        if (++run_length == num_blocks) return block_idx - num_blocks + 1;
+    }
+    return -1;
+}
 
 // Belirtilen sayıda ardışık boş veri bloğu bulur, onları bitmap'te meşgul olarak işaretler
 // ve ilk bulunan bloğun indeksini döndürür. Bulamazsa -1 döndürür.
-int find_and_allocate_contiguous_data_blocks(int num_blocks_to_find) {
+// SMALL_ALLOCATION_MAX_BLOCKS'tan büyük istekler diskin sonundan başlayarak yerleştirilir.
+// goal_block verilirse (bitmap modunda) boyut sınıfı yerine hedefe en yakın boş aralık seçilir.
+int find_and_allocate_contiguous_data_blocks(int num_blocks_to_find, int goal_block) {
+    Volume& volume = active_volume();
     if (num_blocks_to_find <= 0) {
         std::cerr << "Error (find_and_allocate_contiguous_data_blocks): Number of blocks to find must be positive. Requested: " << num_blocks_to_find << std::endl;
         fs_log(("find_and_allocate_contiguous_data_blocks failed: non-positive num_blocks_to_find: " + std::to_string(num_blocks_to_find)).c_str());
@@ -1373,119 +5304,139 @@ int find_and_allocate_contiguous_data_blocks(int num_blocks_to_find) {
         return -1;
     }
 
-
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' for find_and_allocate_contiguous_data_blocks." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' for find_and_allocate_contiguous_data_blocks." << std::endl;
         fs_log("find_and_allocate_contiguous_data_blocks failed: could not open disk file.");
         return -1;
     }
 
+    // Küçük tahsisler (bitmap modunda) önce tahsis gruplarında kilitsiz yapılır (bkz. allocate_within_groups).
+    // Buddy modu, büyük tahsisler, hedefli yerleşim ve gruplar arası aralıklar aşağıda bitmap'in tamamı
+    // üzerinde, tahsis kilidi ve tüm grup kilitleri tutularak yapılır.
+    int allocator_mode = read_allocator_mode(disk_file);
+    if (goal_block >= static_cast<int>(NUM_DATA_BLOCKS) || allocator_mode == ALLOCATOR_BUDDY) {
+        goal_block = -1; // Buddy parçaları hizalıdır; yerleşimi mertebe belirler, ipucu yok sayılır
+    }
+    if (goal_block < 0 && allocator_mode != ALLOCATOR_BUDDY && num_blocks_to_find <= static_cast<int>(SMALL_ALLOCATION_MAX_BLOCKS)) {
+        int group_start = allocate_within_groups(disk_file, num_blocks_to_find);
+        if (group_start != -1) {
+            return group_start;
+        }
+    }
+    std::lock_guard<std::recursive_mutex> allocator_guard(volume.allocator_lock);
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+
+    // Tarama bitmap'in bellekteki kopyası üzerinde yapılır: henüz diske işlenmemiş kilitsiz sahiplenmeler de görünür.
     char bitmap_buffer[BITMAP_SIZE_BYTES];
-    disk_file.seekg(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
-    disk_file.read(bitmap_buffer, BITMAP_SIZE_BYTES);
-    if (!disk_file) {
+    if (!atomic_bitmap_ensure_loaded(disk_file)) {
         std::cerr << "Error: Could not read bitmap from disk (find_and_allocate_contiguous_data_blocks)." << std::endl;
         fs_log("find_and_allocate_contiguous_data_blocks failed: could not read bitmap.");
-        disk_file.close();
         return -1;
     }
+    atomic_bitmap_snapshot(bitmap_buffer);
 
-    for (int start_block_idx = 0; start_block_idx <= NUM_DATA_BLOCKS - num_blocks_to_find; ++start_block_idx) {
-        bool all_free = true;
-        for (int i = 0; i < num_blocks_to_find; ++i) {
-            int current_block_idx = start_block_idx + i;
-            int byte_index_in_bitmap = current_block_idx / 8;
-            int bit_index_in_byte = current_block_idx % 8;
-
-            if (bitmap_buffer[byte_index_in_bitmap] & bit_to_char_mask(bit_index_in_byte)) {
-                all_free = false; // Bu blok dolu, sonraki başlangıçtan devam et
-                start_block_idx = current_block_idx; // Optimizasyon: Direkt dolu bloğun sonrasından başla
-                break;
-            }
+    // Buddy modunda önce hizalı bir buddy parçası denenir. En büyük mertebeyi aşan istekler veya
+    // uygun parça olmaması durumunda aşağıdaki bitmap taramasına düşülür; tarama bitmap'i listelerden
+    // habersiz değiştireceği için listeler geçersiz kılınır ve sonraki tahsiste yeniden kurulur.
+    // Buddy modunda tüm tahsisler bu kilitler altında yapıldığı için bellekteki sahiplenme hep başarılıdır.
+    if (allocator_mode == ALLOCATOR_BUDDY) {
+        if (!volume.buddy_state.valid) {
+            buddy_rebuild_free_lists(bitmap_buffer);
         }
-
-        if (all_free) {
-            // İstenen sayıda ardışık boş blok bulundu. Şimdi bunları işaretleyelim.
-            for (int i = 0; i < num_blocks_to_find; ++i) {
-                int block_to_allocate = start_block_idx + i;
-                int byte_idx = block_to_allocate / 8;
-                int bit_idx = block_to_allocate % 8;
-                bitmap_buffer[byte_idx] |= bit_to_char_mask(bit_idx); // Biti 1 yap (meşgul)
-            }
-            // Güncellenmiş bitmap'i diske yaz
-            disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
-            disk_file.write(bitmap_buffer, BITMAP_SIZE_BYTES);
-            if (!disk_file) {
-                std::cerr << "Error: Could not write updated bitmap to disk after allocating blocks (find_and_allocate_contiguous_data_blocks)." << std::endl;
-                fs_log("find_and_allocate_contiguous_data_blocks failed: could not write updated bitmap.");
-                disk_file.close();
-                return -1; // Yazma hatası
-            }
-            disk_file.close();
-            // fs_log(("Allocated " + std::to_string(num_blocks_to_find) + " contiguous blocks starting from " + std::to_string(start_block_idx)).c_str());
-            return start_block_idx;
+        int buddy_start = buddy_allocate(bitmap_buffer, num_blocks_to_find);
+        if (buddy_start != -1 && atomic_bitmap_try_claim(buddy_start, num_blocks_to_find)) {
+            commit_bitmap_range(buddy_start, num_blocks_to_find, -1, true);
+            return buddy_start;
+        }
+        buddy_invalidate_free_lists();
+        atomic_bitmap_snapshot(bitmap_buffer); // buddy_allocate kopyayı işaretlemiş olabilir
+        fs_log(("find_and_allocate_contiguous_data_blocks: No buddy block for " + std::to_string(num_blocks_to_find) +
+                " blocks, falling back to bitmap scan.").c_str());
+    }
+
+    // Boyut sınıfına göre yerleşim: Küçük tahsisler diskin başından (first-fit), büyük tahsisler diskin
+    // sonundan geriye doğru yapılır. Böylece kısa ömürlü küçük dosyaların bıraktığı delikler büyük
+    // dosyaların önünü kesmez ve büyük ardışık alanlar korunur. Seçilen aralığı kilitsiz bir tahsis
+    // bu arada almışsa yeni bir kopyayla yeniden taranır.
+    int start_block_idx = -1;
+    for (;;) {
+        if (goal_block >= 0) {
+            start_block_idx = find_free_run_near(bitmap_buffer, num_blocks_to_find, goal_block);
+        } else if (num_blocks_to_find > static_cast<int>(SMALL_ALLOCATION_MAX_BLOCKS)) {
+            start_block_idx = find_free_run_from_end(bitmap_buffer, num_blocks_to_find);
+        } else {
+            start_block_idx = find_free_run_first_fit(bitmap_buffer, num_blocks_to_find);
+        }
+        if (start_block_idx == -1) {
+            // fs_log(("Could not find " + std::to_string(num_blocks_to_find) + " contiguous free data blocks.").c_str());
+            return -1; // Tüm bitmap tarandı, yeterli ardışık boş blok yok
         }
+        if (atomic_bitmap_try_claim(start_block_idx, num_blocks_to_find)) break;
+        atomic_bitmap_snapshot(bitmap_buffer);
+    }
+    if (goal_block >= 0) {
+        fs_log(("find_and_allocate_contiguous_data_blocks: " + std::to_string(num_blocks_to_find) + " blocks placed at " +
+                std::to_string(start_block_idx) + " for goal block " + std::to_string(goal_block) + ".").c_str());
     }
 
-    disk_file.close();
-    // fs_log(("Could not find " + std::to_string(num_blocks_to_find) + " contiguous free data blocks.").c_str());
-    return -1; // Yeterli ardışık boş blok bulunamadı
+    commit_bitmap_range(start_block_idx, num_blocks_to_find, -1, true);
+    // fs_log(("Allocated " + std::to_string(num_blocks_to_find) + " contiguous blocks starting from " + std::to_string(start_block_idx)).c_str());
+    return start_block_idx;
 }
 
-// Bitmap'i tarar, ilk boş veri bloğunu bulur, onu meşgul olarak işaretler
-// ve blok indeksini döndürür. Boş blok yoksa -1 döndürür.
+// İlk boş veri bloğunu bulur, onu meşgul olarak işaretler ve blok indeksini döndürür. Boş blok yoksa -1 döndürür.
+// Bitmap modunda tahsis grupları iş parçacığının ev grubundan başlayarak kilitsiz taranır (bkz. allocate_within_groups).
 int find_free_data_block() {
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    Volume& volume = active_volume();
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error: Could not open disk file '" << DISK_FILENAME << "' to find free data block." << std::endl;
+        std::cerr << "Error: Could not open disk file '" << disk_filename() << "' to find free data block." << std::endl;
         fs_log("find_free_data_block failed: could not open disk file.");
         return -1;
     }
 
-    // Bitmap'i oku
-    char bitmap[BITMAP_SIZE_BYTES];
-    disk_file.seekg(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
-    disk_file.read(bitmap, BITMAP_SIZE_BYTES);
+    if (read_allocator_mode(disk_file) != ALLOCATOR_BUDDY) {
+        int block = allocate_within_groups(disk_file, 1);
+        // if (block == -1) fs_log("No free data block found.");
+        return block;
+    }
 
-    if (!disk_file) {
+    // Buddy modu: listeler tüm diske ait olduğu için tahsis kilidi ve tüm grup kilitleri alınır.
+    std::lock_guard<std::recursive_mutex> allocator_guard(volume.allocator_lock);
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+
+    char bitmap[BITMAP_SIZE_BYTES];
+    if (!atomic_bitmap_ensure_loaded(disk_file)) {
         std::cerr << "Error: Could not read bitmap from metadata (find_free_data_block)." << std::endl;
         fs_log("find_free_data_block failed: could not read bitmap.");
-        disk_file.close();
         return -1;
     }
+    atomic_bitmap_snapshot(bitmap);
 
-    for (int i = 0; i < NUM_DATA_BLOCKS; ++i) {
-        int byte_index = i / 8;
-        int bit_index_in_byte = i % 8; // Düzeltildi: bit_in_byte -> bit_index_in_byte
-
-        if (!(bitmap[byte_index] & bit_to_char_mask(bit_index_in_byte))) {
-            // Boş blok bulundu (bit 0). Onu 1 yap (meşgul) ve diske yaz.
-            bitmap[byte_index] |= bit_to_char_mask(bit_index_in_byte);
-            
-            disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA + byte_index, std::ios::beg);
-            disk_file.write(&bitmap[byte_index], 1); // Sadece değişen byte'ı yaz
-
-            if (!disk_file) {
-                std::cerr << "Error: Could not write updated bitmap to metadata (find_free_data_block)." << std::endl;
-                fs_log("find_free_data_block failed: could not write updated bitmap.");
-                disk_file.close();
-                return -1; // Yazma hatası
-            }
-            disk_file.close();
-            // fs_log(("Data block " + std::to_string(i) + " allocated.").c_str());
-            return i; // Bulunan boş bloğun indeksini döndür
-        }
+    if (!volume.buddy_state.valid) {
+        buddy_rebuild_free_lists(bitmap);
     }
-
-    disk_file.close();
-    // fs_log("No free data block found.");
-    return -1; // Boş blok bulunamadı
+    int block = buddy_allocate(bitmap, 1); // Boş blok varsa listelerde mutlaka onu içeren bir parça vardır
+    if (block != -1) {
+        atomic_bitmap_try_claim(block, 1); // Buddy modunda tüm tahsisler bu kilitler altında; sahiplenme hep başarılı
+        commit_bitmap_range(block, 1, -1, true);
+    }
+    return block;
 }
 
 // ------------- LOGLAMA YARDIMCI FONKSİYONU -------------
+void fs_set_log_file(const char* path) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.log_lock);
+    volume.log_path = (path != nullptr) ? path : "";
+}
+
 void fs_log(const char* message) {
-    std::ofstream log_file(LOG_FILENAME, std::ios_base::app); // Append modunda aç
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.log_lock);
+    if (volume.log_path.empty()) return;
+    std::ofstream log_file(volume.log_path.c_str(), std::ios_base::app); // Append modunda aç
     if (log_file.is_open()) {
         // Zaman damgası ekleyebiliriz (isteğe bağlı)
         // time_t now = time(0);
@@ -1495,13 +5446,14 @@ void fs_log(const char* message) {
         log_file << message << std::endl;
         log_file.close();
     } else {
-        std::cerr << "Warning: Unable to open log file: " << LOG_FILENAME << std::endl;
+        std::cerr << "Warning: Unable to open log file: " << volume.log_path << std::endl;
     }
 }
 
 // Superblock'tan aktif dosya sayısını okumak için yardımcı fonksiyon
 int fs_count_active_files() {
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in);
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    DiskStream disk_file(std::ios::in);
     if (!disk_file) {
         // Hata durumunda -1 veya başka bir belirteç döndürülebilir.
         // fs_ls ve diğerleri zaten metadata okuma hatasını ele alıyor.
@@ -1519,6 +5471,8 @@ int fs_count_active_files() {
 
 // Bir dosyanın kullandığı blok sayısını FileInfo'dan okur
 int fs_get_num_blocks_used(const char* filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED, true);
     if (!fs_exists(filename)) {
         return -1; // Dosya yok
     }
@@ -1527,26 +5481,73 @@ int fs_get_num_blocks_used(const char* filename) {
     // read_all_file_info hata durumunda boş vektör veya sb_dummy.num_active_files = -1 yapabilir
     // fs_exists zaten bunu kontrol etmiş olmalı.
 
-    for (const auto& fi : all_files) {
-        if (fi.is_used && strcmp(fi.name, filename) == 0) {
-            return static_cast<int>(fi.num_data_blocks_used);
-        }
+    int file_index = resolve_path(all_files, filename);
+    if (file_index != -1) {
+        return static_cast<int>(all_files[file_index].num_data_blocks_used);
     }
     return -2; // Dosya bulundu (fs_exists geçti) ama FileInfo'da bulunamadı (tutarsızlık)
 }
 
+// ------------- TOPLU BLOK TAŞIMA (BULK BLOCK MOVES) -------------
+// Birleştirme blokları imajın içinde büyük parçalarla taşır; dosya başına tampon ayrılmaz, 512 byte'lık
+// okuma/yazma döngüsü yoktur. Taşıma aygıtın move_range'ine verilir: pread/pwrite aygıtında kaynak ve hedef
+// çakışmıyorsa copy_file_range kullanılır (veri kullanıcı alanına hiç çıkmaz), bellek tabanlı aygıtlarda memmove
+// yapılır, diğerlerinde ortak ara tampon üzerinden yöne göre sıralı parçalar kopyalanır.
+
+bool pread_full(int fd, char* buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t got = pread(fd, buffer, length, offset);
+        if (got <= 0) return false;
+        buffer += got;
+        length -= static_cast<size_t>(got);
+        offset += got;
+    }
+    return true;
+}
+
+bool pwrite_full(int fd, const char* buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t put = pwrite(fd, buffer, length, offset);
+        if (put <= 0) return false;
+        buffer += put;
+        length -= static_cast<size_t>(put);
+        offset += put;
+    }
+    return true;
+}
+
+bool move_blocks_in_image(int from_block, int to_block, int num_blocks) {
+    if (num_blocks <= 0 || from_block == to_block) return true;
+    BlockDevice* device = block_device();
+    if (device == nullptr) {
+        fs_log("move_blocks_in_image failed: no block device could be opened.");
+        return false;
+    }
+    off_t source = METADATA_AREA_SIZE_BYTES + static_cast<off_t>(from_block) * BLOCK_SIZE_BYTES;
+    off_t destination = METADATA_AREA_SIZE_BYTES + static_cast<off_t>(to_block) * BLOCK_SIZE_BYTES;
+    bool ok = device->move_range(source, destination, static_cast<off_t>(num_blocks) * BLOCK_SIZE_BYTES);
+    if (!ok) {
+        fs_log(("move_blocks_in_image failed: I/O error moving " + std::to_string(num_blocks) + " blocks from " +
+                std::to_string(from_block) + " to " + std::to_string(to_block) + ".").c_str());
+    }
+    return ok;
+}
+
 // read_all_file_info fonksiyonunun (eğer varsa) static olmadığından emin olun.
 // Zaten static değildi, bu satır sadece kontrol amaçlı bir yorum.
 // std::vector<FileInfo> read_all_file_info(Superblock& sb_out) { ... } 
 // fonksiyonu zaten fs.cpp'de mevcut.
 
 void fs_defragment() {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     ensure_disk_initialized();
+    flush_all_delayed_writes(); // Bekleyen veriler önce yerleşsin, sonra sıkıştırılsın
     fs_log("Defragmentation process started.");
 
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    DiskStream disk_file(std::ios::in | std::ios::out);
     if (!disk_file) {
-        std::cerr << "Error (fs_defragment): Could not open disk file '\" << DISK_FILENAME << \"'." << std::endl;
+        std::cerr << "Error (fs_defragment): Could not open disk file '\" << disk_filename() << \"'." << std::endl;
         fs_log("fs_defragment failed: could not open disk file.");
         return;
     }
@@ -1588,155 +5589,901 @@ void fs_defragment() {
         return;
     }
 
+    // Dosyaları mevcut başlangıç bloklarına göre sırala. Sıkıştırma hedefi hiçbir zaman bir dosyanın
+    // mevcut konumunun ötesine geçmez; böylece henüz taşınmamış bir dosyanın verisinin üzerine yazılmaz.
+    // (Dizin tabloları büyüdükçe yeni yere taşındığı için slot sırası artık disk sırasıyla aynı değildir.)
+    std::stable_sort(active_file_indices.begin(), active_file_indices.end(), [&all_files_info](int a, int b) {
+        return all_files_info[a].start_data_block_index < all_files_info[b].start_data_block_index;
+    });
+
+    // Paketlenmiş kuyrukları önce belleğe al. Kuyruk blokları sıkıştırma sırasında boş alan gibi ele alınır
+    // (üzerlerine başka dosyaların blokları yazılabilir); kuyruklar en sonda yoğun biçimde yeniden paketlenir.
+    std::vector<std::string> tail_contents(MAX_FILES_CALCULATED);
+    for (int file_idx : active_file_indices) {
+        const FileInfo& fi = all_files_info[file_idx];
+        if (!has_packed_tail(fi)) continue;
+        tail_contents[file_idx].resize(fi.tail_length);
+        disk_file.seekg(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(fi.tail_block_index) * BLOCK_SIZE_BYTES + fi.tail_offset);
+        disk_file.read(&tail_contents[file_idx][0], fi.tail_length);
+        if (!disk_file) {
+            std::cerr << "Error (fs_defragment): Failed to read packed tail of file '" << fi.name << "'." << std::endl;
+            fs_log("fs_defragment failed: error reading packed tails.");
+            disk_file.close();
+            return;
+        }
+    }
+
     char new_bitmap[BITMAP_SIZE_BYTES];
     memset(new_bitmap, 0, BITMAP_SIZE_BYTES); // All blocks initially free
 
     unsigned int next_target_data_block = 0; 
-    char* file_content_buffer = nullptr; 
+    disk_file.flush(); // Taşımalar imaja ayrı bir tanımlayıcıdan yazılır
 
     for (int file_idx : active_file_indices) {
         FileInfo& current_fi = all_files_info[file_idx];
 
-        if (current_fi.num_data_blocks_used == 0 || current_fi.size == 0) {
+        // Boş dosyaların blokları bırakılır; ön tahsisli boş dosyanın ayrılmış alanı ise korunur.
+        if (current_fi.num_data_blocks_used == 0 || (current_fi.size == 0 && !(current_fi.flags & FILE_FLAG_PREALLOCATED))) {
             current_fi.start_data_block_index = -1; 
             current_fi.num_data_blocks_used = 0;
             continue;
         }
 
-        file_content_buffer = new (std::nothrow) char[current_fi.size];
-        if (!file_content_buffer) {
-            std::cerr << "Error (fs_defragment): Failed to allocate memory for file '" << current_fi.name << "' content." << std::endl;
-            fs_log("fs_defragment failed: memory allocation error for reading file content.");
-            disk_file.close();
-            return;
-        }
-
         fs_log(("Defragmenting file: " + std::string(current_fi.name) +
                 ", size: " + std::to_string(current_fi.size) +
                 ", old_start_block: " + std::to_string(current_fi.start_data_block_index) +
                 ", num_blocks: " + std::to_string(current_fi.num_data_blocks_used)).c_str());
 
-        // Direct Read Logic
-        if (current_fi.start_data_block_index != -1 && current_fi.num_data_blocks_used > 0) {
-            char* temp_buffer_ptr = file_content_buffer;
-            int bytes_remaining_to_read_for_file = current_fi.size;
-            
-            for (unsigned int k = 0; k < current_fi.num_data_blocks_used; ++k) {
-                if (bytes_remaining_to_read_for_file <= 0) break;
+        bool needs_move = (current_fi.start_data_block_index != next_target_data_block);
 
-                unsigned int actual_disk_block_to_read = current_fi.start_data_block_index + k;
-                std::streampos read_pos = METADATA_AREA_SIZE_BYTES +
-                                          (static_cast<std::streamoff>(actual_disk_block_to_read) * BLOCK_SIZE_BYTES);
-                disk_file.seekg(read_pos);
+        if (needs_move) {
+             fs_log(("Moving data for file " + std::string(current_fi.name) + " from block " + 
+                    std::to_string(current_fi.start_data_block_index) + " to " + std::to_string(next_target_data_block)).c_str());
+            // Hedef her zaman kaynağın önündedir (dosyalar başlangıç bloğuna göre sıralı); çakışsa da güvenli.
+            if (!move_blocks_in_image(static_cast<int>(current_fi.start_data_block_index), static_cast<int>(next_target_data_block),
+                                      static_cast<int>(current_fi.num_data_blocks_used))) {
+                std::cerr << "Error (fs_defragment): Failed to move data for file '" << current_fi.name
+                          << "' to block " << next_target_data_block << std::endl;
+                fs_log("fs_defragment error: failed moving file data.");
+                disk_file.close();
+                return;
+            }
+        } else {
+            fs_log(("File " + std::string(current_fi.name) + " is already in its defragmented position (block " + 
+                   std::to_string(current_fi.start_data_block_index) + "). No data move needed.").c_str());
+        }
 
-                int bytes_to_read_in_this_block = std::min(bytes_remaining_to_read_for_file, static_cast<int>(BLOCK_SIZE_BYTES));
-                
-                disk_file.read(temp_buffer_ptr, bytes_to_read_in_this_block);
-                if (!disk_file) {
-                    std::cerr << "Error (fs_defragment): Failed to read data for file '" << current_fi.name 
-                              << "' from block " << actual_disk_block_to_read << std::endl;
-                    fs_log("fs_defragment error: failed reading file data during move.");
-                    delete[] file_content_buffer;
-                    disk_file.close();
-                    return;
-                }
-                temp_buffer_ptr += bytes_to_read_in_this_block;
-                bytes_remaining_to_read_for_file -= bytes_to_read_in_this_block;
+        current_fi.start_data_block_index = next_target_data_block;
+
+        for (unsigned int k = 0; k < current_fi.num_data_blocks_used; ++k) {
+            unsigned int block_to_mark = next_target_data_block + k;
+            unsigned int byte_idx = block_to_mark / 8;
+            unsigned int bit_idx = block_to_mark % 8;
+            if (byte_idx < BITMAP_SIZE_BYTES) {
+                new_bitmap[byte_idx] |= bit_to_char_mask(bit_idx); // Use helper
+            } else {
+                 std::cerr << "Error (fs_defragment): Bitmap index out of bounds for block " << block_to_mark << std::endl;
+                 fs_log("fs_defragment error: bitmap index out of bounds during new bitmap creation.");
+                 disk_file.close();
+                 return;
+            }
+        }
+        
+        next_target_data_block += current_fi.num_data_blocks_used;
+    }
+
+    // Kuyrukları tam blokların hemen arkasındaki bloklara sırayla, boşluk bırakmadan yeniden paketle.
+    int current_tail_block = -1;
+    unsigned int current_tail_offset = 0;
+    for (int file_idx : active_file_indices) {
+        FileInfo& current_fi = all_files_info[file_idx];
+        if (!has_packed_tail(current_fi)) continue;
+
+        if (current_tail_block == -1 || current_tail_offset + current_fi.tail_length > BLOCK_SIZE_BYTES) {
+            current_tail_block = static_cast<int>(next_target_data_block++);
+            current_tail_offset = 0;
+            new_bitmap[current_tail_block / 8] |= bit_to_char_mask(current_tail_block % 8);
+        }
+        disk_file.seekp(METADATA_AREA_SIZE_BYTES + static_cast<std::streamoff>(current_tail_block) * BLOCK_SIZE_BYTES + current_tail_offset);
+        disk_file.write(tail_contents[file_idx].data(), current_fi.tail_length);
+        if (!disk_file) {
+            std::cerr << "Error (fs_defragment): Failed to write packed tail of file '" << current_fi.name << "'." << std::endl;
+            fs_log("fs_defragment error: failed writing packed tail during repack.");
+            disk_file.close();
+            return;
+        }
+        current_fi.tail_block_index = current_tail_block;
+        current_fi.tail_offset = static_cast<uint16_t>(current_tail_offset);
+        current_tail_offset += current_fi.tail_length;
+    }
+
+    disk_file.seekp(FILE_INFO_ARRAY_START_OFFSET_IN_METADATA, std::ios::beg);
+    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
+        disk_file.write(reinterpret_cast<const char*>(&all_files_info[i]), FILE_INFO_ENTRY_SIZE);
+        active_volume().file_info_generation[i].fetch_add(1); // Yerleşim değişti; tutamaçlar kaydı yeniden okur
+        if (!disk_file) {
+            std::cerr << "Error (fs_defragment): Could not write updated FileInfo entry " << i << "." << std::endl;
+            fs_log("fs_defragment failed: error writing updated FileInfo entries.");
+            disk_file.close();
+            return;
+        }
+    }
+
+    disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
+    disk_file.write(new_bitmap, BITMAP_SIZE_BYTES);
+    buddy_invalidate_free_lists(); // Bitmap toptan değişti; buddy listeleri sonraki tahsiste yeniden kurulur
+    allocation_state_invalidate(); // Özetler ve sayaçlar da aşağıda yeni bitmap'ten yeniden yazılır
+    if (disk_file) {
+        rebuild_group_summaries(disk_file, new_bitmap);
+    }
+    if (!disk_file) {
+        std::cerr << "Error (fs_defragment): Could not write new bitmap to disk." << std::endl;
+        fs_log("fs_defragment failed: error writing new bitmap.");
+        disk_file.close();
+        return;
+    }
+
+    // Yerleşim toptan değişti: alan istatistikleri yeni bitmap'ten kesin olarak yeniden hesaplanır.
+    sb.stats = compute_space_stats(new_bitmap, all_files_info);
+    sb.defrag.cursor = 0; // Yarım kalmış artımlı geçiş varsa bu tam geçiş onu da bitirdi
+    sb.defrag.pass_active = 0;
+    disk_file.seekp(0, std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
+     if (!disk_file) {
+        std::cerr << "Error (fs_defragment): Could not rewrite superblock." << std::endl;
+        fs_log("fs_defragment failed: could not rewrite superblock.");
+    }
+
+    disk_file.close();
+    fs_log("Defragmentation process completed successfully.");
+}
+
+// ------------- ARTIMLI (ÇEVRİMİÇİ) BİRLEŞTİRME -------------
+// fs_defragment tüm dosyaları belleğe okuyup yerleşimi tek seferde yeniden yazar; canlı bir birimde uzun bir
+// duraklama demektir. fs_defragment_step ise aynı sıkıştırmayı extent extent yapar: imleçten (cursor) sonraki
+// ilk boş bloğu bulur, onun arkasındaki ilk extent'i oraya kaydırır ve imleci extent'in sonuna taşır.
+// Adım, taşınan byte veya süre bütçesi dolunca biter; imleç süperblokta saklandığı için sonraki adım (veya
+// yeniden açılıştan sonraki adım) kaldığı yerden devam eder. Her adım volume kilidini tuttuğu için normal
+// işlemlerle iç içe geçmez; duraklama tek bir adımın bütçesiyle sınırlıdır.
+// Kuyruk blokları yerinde kalır ve engel sayılır: engelden önceki delik sıradaki extent'e yetmiyorsa atlanır
+// (kuyrukları da paketleyen tam geçiş için fs_defragment).
+
+bool load_defrag_progress(DiskStream& disk_file, DefragProgress& progress_out) {
+    disk_file.seekg(offsetof(Superblock, defrag), std::ios::beg);
+    disk_file.read(reinterpret_cast<char*>(&progress_out), sizeof(DefragProgress));
+    if (!disk_file) {
+        disk_file.clear();
+        return false;
+    }
+    return true;
+}
+
+bool store_defrag_progress(DiskStream& disk_file, const DefragProgress& progress) {
+    disk_file.seekp(offsetof(Superblock, defrag), std::ios::beg);
+    disk_file.write(reinterpret_cast<const char*>(&progress), sizeof(DefragProgress));
+    disk_file.flush();
+    if (!disk_file) {
+        disk_file.clear();
+        return false;
+    }
+    return true;
+}
+
+// [start, start + count) aralığını atomik ve işlenmiş bitmap'te birlikte işaretler (sign: -1 tahsis, +1 serbest).
+// Çağıranlar cilt kilidini özel ve tüm grup kilitlerini tutar; taşıma hedefi boş olduğu için sahiplenme hep başarılıdır.
+void mark_bitmap_range(int start, int count, int sign) {
+    if (count <= 0) return;
+    if (sign < 0) {
+        atomic_bitmap_try_claim(start, count);
+        commit_bitmap_range(start, count, -1, true);
+    } else {
+        commit_bitmap_range(start, count, +1, true);
+        atomic_bitmap_release(start, count);
+    }
+}
+
+// [a_start, a_start + n) aralığının [b_start, b_start + n) ile çakışmayan kısmı (eşit uzunluklu iki aralıkta tek parçadır).
+void range_minus_equal_length(int a_start, int b_start, int n, int& out_start, int& out_end) {
+    if (a_start + n <= b_start || b_start + n <= a_start) {
+        out_start = a_start;
+        out_end = a_start + n;
+    } else if (a_start < b_start) {
+        out_start = a_start;
+        out_end = b_start;
+    } else {
+        out_start = b_start + n;
+        out_end = a_start + n;
+    }
+}
+
+// Dosyanın extent'ini target bloğuna taşır (target, bloklar ya boş ya da dosyanın kendisine ait olacak şekilde
+// seçilmiş olmalıdır; kaydırma her iki yöne de olabilir). Sıra: yeni bloklar ayrılır, veri
+// kopyalanır, FileInfo yeni yeri gösterir, en son eski bloklar bırakılır. Alanlar çakışmıyorsa araya giren
+// bir hata eski kopyayı bozmaz; çakışıyorsa (dosya kendi üstüne kayıyorsa) fs_defragment kadar güvenlidir.
+bool defrag_move_extent(char* bitmap, std::vector<FileInfo>& all_files, Superblock& sb, int file_index, int target) {
+    FileInfo& fi = all_files[file_index];
+    int old_start = static_cast<int>(fi.start_data_block_index);
+    int num_blocks = static_cast<int>(fi.num_data_blocks_used);
+
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+
+    // 1. Sadece yeni alana ait bloklar (çakışan kısım zaten bu dosyanın)
+    int new_only_start, new_only_end;
+    range_minus_equal_length(target, old_start, num_blocks, new_only_start, new_only_end);
+    for (int b = new_only_start; b < new_only_end; ++b) {
+        bitmap[b / 8] |= bit_to_char_mask(b % 8);
+    }
+    mark_bitmap_range(new_only_start, new_only_end - new_only_start, -1);
+
+    // 2. Veri
+    if (!move_blocks_in_image(old_start, target, num_blocks)) {
+        fs_log(("defrag_move_extent: could not move extent of '" + std::string(fi.name) + "' to block " + std::to_string(target) + ".").c_str());
+        return false;
+    }
+
+    // 3. FileInfo
+    fi.start_data_block_index = target;
+    if (!write_file_info_at_index(file_index, fi, sb)) {
+        fi.start_data_block_index = old_start;
+        fs_log(("defrag_move_extent: could not update FileInfo of '" + std::string(fi.name) + "'.").c_str());
+        return false;
+    }
+
+    // 4. Eski alanın artık kullanılmayan kısmı
+    int old_only_start, old_only_end;
+    range_minus_equal_length(old_start, target, num_blocks, old_only_start, old_only_end);
+    for (int b = old_only_start; b < old_only_end; ++b) {
+        bitmap[b / 8] &= ~bit_to_char_mask(b % 8);
+    }
+    mark_bitmap_range(old_only_start, old_only_end - old_only_start, +1);
+    buddy_invalidate_free_lists(); // Taşınan extent buddy hizasını bozabilir; listeler sonraki tahsiste yeniden kurulur
+    return true;
+}
+
+int fs_defragment_step(int64_t max_bytes_moved, int max_millis) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    ensure_disk_initialized();
+    std::chrono::steady_clock::time_point step_started = std::chrono::steady_clock::now();
+
+    if (max_bytes_moved < 0 || max_millis < 0) {
+        std::cerr << "Error (fs_defragment_step): Budgets cannot be negative." << std::endl;
+        fs_log("fs_defragment_step failed: negative budget.");
+        return -1;
+    }
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (fs_defragment_step): Could not read metadata." << std::endl;
+        fs_log("fs_defragment_step failed: metadata read error.");
+        return -2;
+    }
+
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    if (!disk_file) {
+        std::cerr << "Error (fs_defragment_step): Could not open disk file '" << disk_filename() << "'." << std::endl;
+        fs_log("fs_defragment_step failed: could not open disk file.");
+        return -2;
+    }
+    DefragProgress progress;
+    char bitmap[BITMAP_SIZE_BYTES];
+    if (!read_committed_bitmap(disk_file, bitmap) || !load_defrag_progress(disk_file, progress)) {
+        std::cerr << "Error (fs_defragment_step): Could not read bitmap or defragmentation progress." << std::endl;
+        fs_log("fs_defragment_step failed: could not read bitmap or progress.");
+        return -2;
+    }
+
+    if (!progress.pass_active || progress.cursor > NUM_DATA_BLOCKS) {
+        progress.pass_active = 1;
+        progress.cursor = 0;
+        fs_log("fs_defragment_step: starting a new incremental pass.");
+    }
+
+    // Extent'i olan girdiler (dosyalar ve dizin tabloları) başlangıç bloğuna göre sıralı
+    std::vector<std::pair<int, int> > extents; // (başlangıç bloğu, FileInfo indeksi)
+    for (int i = 0; i < static_cast<int>(all_files.size()); ++i) {
+        const FileInfo& fi = all_files[i];
+        if (fi.is_used && fi.start_data_block_index != -1 && fi.num_data_blocks_used > 0) {
+            extents.push_back(std::make_pair(static_cast<int>(fi.start_data_block_index), i));
+        }
+    }
+    std::sort(extents.begin(), extents.end());
+
+    int64_t bytes_this_step = 0;
+    int moves_this_step = 0;
+    bool pass_done = false;
+    bool failed = false;
+    while (true) {
+        int free_start = static_cast<int>(progress.cursor);
+        while (free_start < static_cast<int>(NUM_DATA_BLOCKS) && !bitmap_block_is_free(bitmap, free_start)) free_start++;
+        std::vector<std::pair<int, int> >::iterator next =
+            std::lower_bound(extents.begin(), extents.end(), std::make_pair(free_start, -1));
+        if (free_start >= static_cast<int>(NUM_DATA_BLOCKS) || next == extents.end()) {
+            pass_done = true; // İmleçten sonra taşınacak extent kalmadı
+            break;
+        }
+
+        int file_index = next->second;
+        int old_start = next->first;
+        int num_blocks = static_cast<int>(all_files[file_index].num_data_blocks_used);
+        int gap_end = free_start;
+        while (gap_end < old_start && bitmap_block_is_free(bitmap, gap_end)) gap_end++;
+        if (gap_end != old_start && gap_end - free_start < num_blocks) {
+            progress.cursor = gap_end; // Delik bir kuyruk bloğuyla kapanıyor ve extent'e yetmiyor: atla
+            continue;
+        }
+
+        int64_t move_bytes = static_cast<int64_t>(num_blocks) * BLOCK_SIZE_BYTES;
+        if (max_bytes_moved > 0 && moves_this_step > 0 && bytes_this_step + move_bytes > max_bytes_moved) {
+            break; // Bütçe doldu; ilk taşıma her zaman yapılır ki tek bir büyük extent ilerlemeyi durdurmasın
+        }
+        if (!defrag_move_extent(bitmap, all_files, sb, file_index, free_start)) {
+            std::cerr << "Error (fs_defragment_step): Failed to move '" << all_files[file_index].name << "'." << std::endl;
+            failed = true;
+            break;
+        }
+        fs_log(("fs_defragment_step: moved '" + std::string(all_files[file_index].name) + "' (" + std::to_string(num_blocks) +
+                " blocks) from block " + std::to_string(old_start) + " to " + std::to_string(free_start) + ".").c_str());
+        next->first = free_start; // Öncekiler imlecin gerisinde kaldığı için sıralama bozulmaz
+        progress.cursor = static_cast<uint32_t>(free_start + num_blocks);
+        progress.files_moved++;
+        progress.bytes_moved += move_bytes;
+        bytes_this_step += move_bytes;
+        moves_this_step++;
+
+        if (max_bytes_moved > 0 && bytes_this_step >= max_bytes_moved) break;
+        if (max_millis > 0 && std::chrono::steady_clock::now() - step_started >= std::chrono::milliseconds(max_millis)) break;
+    }
+
+    if (pass_done) {
+        progress.pass_active = 0;
+        progress.cursor = 0;
+        progress.passes_completed++;
+    }
+    if (!store_defrag_progress(disk_file, progress)) {
+        std::cerr << "Error (fs_defragment_step): Could not persist defragmentation progress." << std::endl;
+        fs_log("fs_defragment_step failed: could not store progress.");
+        return -3;
+    }
+    disk_file.close();
+
+    long long elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - step_started).count();
+    fs_log(("fs_defragment_step: moved " + std::to_string(moves_this_step) + " extents (" + std::to_string(bytes_this_step) + " bytes) in " +
+            std::to_string(elapsed_ms) + " ms, cursor " + std::to_string(progress.cursor) + (pass_done ? ", pass completed." : ".")).c_str());
+    if (failed) return -4;
+    return pass_done ? 1 : 0;
+}
+
+bool fs_get_defrag_progress(DefragProgress& progress_out) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    DiskStream disk_file(std::ios::in);
+    if (!disk_file) return false;
+    return load_defrag_progress(disk_file, progress_out);
+}
+
+// Arka plan birleştirme: adımları aralarında pause_millis bekleyerek, geçiş bitene veya durdurulana kadar çalıştırır.
+void defrag_background_loop(Volume* volume, int64_t bytes_per_step, int max_millis_per_step, int pause_millis) {
+    VolumeBinding binding(*volume);
+    int steps = 0;
+    int result = 0;
+    while (true) {
+        result = fs_defragment_step(bytes_per_step, max_millis_per_step);
+        steps++;
+        if (result != 0) break; // Geçiş bitti veya hata
+        std::unique_lock<std::mutex> lock(volume->defrag_thread_lock);
+        if (volume->defrag_thread_cv.wait_for(lock, std::chrono::milliseconds(pause_millis), [volume] { return volume->defrag_thread_stop_requested; })) {
+            break;
+        }
+    }
+    fs_log(("Background defragmentation stopped after " + std::to_string(steps) + " steps, last result: " + std::to_string(result) + ".").c_str());
+    std::lock_guard<std::mutex> lock(volume->defrag_thread_lock);
+    volume->defrag_thread_running = false;
+}
+
+int fs_defrag_start_background(int64_t bytes_per_step, int max_millis_per_step, int pause_millis) {
+    if (bytes_per_step < 0 || max_millis_per_step < 0 || pause_millis < 0) {
+        std::cerr << "Error (fs_defrag_start_background): Budgets and pause cannot be negative." << std::endl;
+        return -1;
+    }
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.defrag_thread_lock);
+    if (volume.defrag_thread_running) {
+        std::cerr << "Error (fs_defrag_start_background): Background defragmentation is already running." << std::endl;
+        return -2;
+    }
+    if (volume.defrag_thread.joinable()) {
+        volume.defrag_thread.join(); // Kendi kendine bitmiş önceki iş parçacığı (kilide artık ihtiyacı yok)
+    }
+    volume.defrag_thread_stop_requested = false;
+    volume.defrag_thread_running = true;
+    volume.defrag_thread = std::thread(defrag_background_loop, &volume, bytes_per_step, max_millis_per_step, pause_millis);
+    fs_log(("Background defragmentation started: " + std::to_string(bytes_per_step) + " bytes / " + std::to_string(max_millis_per_step) +
+            " ms per step, " + std::to_string(pause_millis) + " ms pause.").c_str());
+    return 0;
+}
+
+void fs_defrag_stop_background() {
+    Volume& volume = active_volume();
+    {
+        std::lock_guard<std::mutex> lock(volume.defrag_thread_lock);
+        volume.defrag_thread_stop_requested = true;
+    }
+    volume.defrag_thread_cv.notify_all();
+    if (volume.defrag_thread.joinable()) {
+        volume.defrag_thread.join();
+    }
+}
+
+bool fs_defrag_background_running() {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.defrag_thread_lock);
+    return volume.defrag_thread_running;
+}
+
+// ------------- EN AZ TAŞIMALI BİRLEŞTİRME PLANLAYICISI -------------
+// fs_defragment her şeyi blok 0'a doğru sıkıştırır; neredeyse düzenli bir diskte istenen boş alanı açmak için
+// tek bir küçük dosyayı taşımak yeterliyken tüm veriyi kopyalayabilir. Planlayıcı hedefe (en az N bloklu boş alan
+// veya tek parça boş alan) ulaşan ve en az byte kopyalayan taşıma listesini hesaplar. Adaylar:
+//  - Pencere: N bloklu bir pencere seçilir; pencereye değen birimler pencere dışındaki deliklere (büyükten küçüğe,
+//    en iyi uyan delik) taşınır. Maliyet pencereye değen birimlerin boyutudur; en ucuz yerleşebilen pencere seçilir.
+//  - Başa / sona sıkıştırma: yerinde olmayan her birim sırayla kaydırılır (her zaman yerleşebilir).
+// Birim bir dosya extent'i veya paylaşılan bir kuyruk bloğudur; sahibi olmayan dolu bloklar taşınmaz, engel sayılır.
+
+struct DefragUnit {
+    int start;
+    int num_blocks;
+    int file_index; // -1: paylaşılan kuyruk bloğu
+};
+
+// Birimleri başlangıç bloğuna göre sıralı toplar. Bitmap'te dolu olup hiçbir birime ait olmayan blok varsa
+// has_unowned_out true olur (sıkıştırma adayları o zaman kullanılmaz).
+std::vector<DefragUnit> collect_defrag_units(const std::vector<FileInfo>& all_files, const char* bitmap, bool& has_unowned_out) {
+    std::vector<DefragUnit> units;
+    std::vector<bool> owned(NUM_DATA_BLOCKS, false);
+    std::set<int> tail_blocks;
+    for (int i = 0; i < static_cast<int>(all_files.size()); ++i) {
+        const FileInfo& fi = all_files[i];
+        if (!fi.is_used) continue;
+        if (fi.start_data_block_index != -1 && fi.num_data_blocks_used > 0) {
+            DefragUnit unit = { static_cast<int>(fi.start_data_block_index), static_cast<int>(fi.num_data_blocks_used), i };
+            units.push_back(unit);
+            for (int b = unit.start; b < unit.start + unit.num_blocks && b < static_cast<int>(NUM_DATA_BLOCKS); ++b) owned[b] = true;
+        }
+        if (has_packed_tail(fi)) tail_blocks.insert(fi.tail_block_index);
+    }
+    for (int tail_block : tail_blocks) {
+        DefragUnit unit = { tail_block, 1, -1 };
+        units.push_back(unit);
+        owned[tail_block] = true;
+    }
+    std::sort(units.begin(), units.end(), [](const DefragUnit& a, const DefragUnit& b) { return a.start < b.start; });
+
+    has_unowned_out = false;
+    for (int b = 0; b < static_cast<int>(NUM_DATA_BLOCKS); ++b) {
+        if (!bitmap_block_is_free(bitmap, b) && !owned[b]) has_unowned_out = true;
+    }
+    return units;
+}
+
+int64_t moves_byte_cost(const std::vector<DefragMove>& moves) {
+    int64_t bytes = 0;
+    for (const DefragMove& move : moves) bytes += static_cast<int64_t>(move.num_blocks) * BLOCK_SIZE_BYTES;
+    return bytes;
+}
+
+// Başa (toward_front) veya sona sıkıştırma planı; yerinde olan birimler taşınmaz.
+std::vector<DefragMove> plan_compaction(const std::vector<DefragUnit>& units, bool toward_front) {
+    std::vector<DefragMove> moves;
+    if (toward_front) {
+        int cursor = 0;
+        for (const DefragUnit& unit : units) {
+            if (unit.start != cursor) {
+                DefragMove move = { unit.file_index, unit.start, cursor, unit.num_blocks };
+                moves.push_back(move);
+            }
+            cursor += unit.num_blocks;
+        }
+    } else {
+        int cursor = NUM_DATA_BLOCKS;
+        for (std::vector<DefragUnit>::const_reverse_iterator it = units.rbegin(); it != units.rend(); ++it) {
+            cursor -= it->num_blocks;
+            if (it->start != cursor) {
+                DefragMove move = { it->file_index, it->start, cursor, it->num_blocks };
+                moves.push_back(move);
+            }
+        }
+    }
+    return moves;
+}
+
+// [window_start, window_start + window_blocks) penceresini boşaltan taşımaları bulur. Pencerede sahibi olmayan
+// dolu blok varsa veya birimler dışarıdaki deliklere sığmıyorsa false döner.
+bool plan_window(const std::vector<DefragUnit>& units, const char* bitmap, int window_start, int window_blocks,
+                 std::vector<DefragMove>& moves_out) {
+    int window_end = window_start + window_blocks;
+    std::vector<DefragUnit> to_move;
+    int owned_in_window = 0;
+    for (const DefragUnit& unit : units) {
+        if (unit.start < window_end && unit.start + unit.num_blocks > window_start) {
+            to_move.push_back(unit);
+            owned_in_window += std::min(unit.start + unit.num_blocks, window_end) - std::max(unit.start, window_start);
+        }
+    }
+    int used_in_window = 0;
+    for (int b = window_start; b < window_end; ++b) {
+        if (!bitmap_block_is_free(bitmap, b)) used_in_window++;
+    }
+    if (used_in_window != owned_in_window) return false; // Taşınamayan bir engel var
+
+    // Pencere dışındaki boş parçalar (başlangıç, uzunluk)
+    std::vector<std::pair<int, int> > holes;
+    int run_start = -1;
+    for (int b = 0; b <= static_cast<int>(NUM_DATA_BLOCKS); ++b) {
+        bool usable = b < static_cast<int>(NUM_DATA_BLOCKS) && (b < window_start || b >= window_end) && bitmap_block_is_free(bitmap, b);
+        if (usable) {
+            if (run_start == -1) run_start = b;
+        } else if (run_start != -1) {
+            holes.push_back(std::make_pair(run_start, b - run_start));
+            run_start = -1;
+        }
+    }
+
+    std::sort(to_move.begin(), to_move.end(), [](const DefragUnit& a, const DefragUnit& b) { return a.num_blocks > b.num_blocks; });
+    moves_out.clear();
+    for (const DefragUnit& unit : to_move) {
+        int best = -1;
+        for (int h = 0; h < static_cast<int>(holes.size()); ++h) {
+            if (holes[h].second >= unit.num_blocks && (best == -1 || holes[h].second < holes[best].second)) best = h;
+        }
+        if (best == -1) return false;
+        DefragMove move = { unit.file_index, unit.start, holes[best].first, unit.num_blocks };
+        moves_out.push_back(move);
+        holes[best].first += unit.num_blocks;
+        holes[best].second -= unit.num_blocks;
+    }
+    return true;
+}
+
+// Taşımaları bitmap kopyasına uygular (planın sonucunu raporlamak için).
+void apply_moves_to_bitmap(char* bitmap, const std::vector<DefragMove>& moves) {
+    for (const DefragMove& move : moves) {
+        for (int b = move.from_block; b < move.from_block + move.num_blocks; ++b) bitmap[b / 8] &= ~bit_to_char_mask(b % 8);
+        for (int b = move.to_block; b < move.to_block + move.num_blocks; ++b) bitmap[b / 8] |= bit_to_char_mask(b % 8);
+    }
+}
+
+int fs_plan_defrag(int target, uint32_t min_free_extent_blocks, DefragPlan& plan_out) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    ensure_disk_initialized();
+    flush_all_delayed_writes(); // Plan son yerleşime göre yapılmalı
+
+    plan_out = DefragPlan();
+    plan_out.target = target;
+    if (target != DEFRAG_TARGET_FREE_EXTENT && target != DEFRAG_TARGET_ZERO_FRAGMENTATION) {
+        std::cerr << "Error (fs_plan_defrag): Unknown target " << target << "." << std::endl;
+        fs_log("fs_plan_defrag failed: unknown target.");
+        return -1;
+    }
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    char bitmap[BITMAP_SIZE_BYTES];
+    DiskStream disk_file(std::ios::in);
+    if (sb.num_active_files == -1 || !disk_file) {
+        std::cerr << "Error (fs_plan_defrag): Could not read metadata." << std::endl;
+        fs_log("fs_plan_defrag failed: metadata read error.");
+        return -2;
+    }
+    if (!read_committed_bitmap(disk_file, bitmap)) {
+        std::cerr << "Error (fs_plan_defrag): Could not read bitmap." << std::endl;
+        fs_log("fs_plan_defrag failed: bitmap read error.");
+        return -2;
+    }
+    disk_file.close();
+
+    SpaceStats before;
+    scan_free_space(bitmap, before);
+    plan_out.largest_free_extent_before = before.largest_free_extent_hint;
+    plan_out.largest_free_extent_after = before.largest_free_extent_hint;
+    uint32_t needed = (target == DEFRAG_TARGET_ZERO_FRAGMENTATION) ? before.free_blocks : min_free_extent_blocks;
+    plan_out.min_free_extent_blocks = needed;
+    if (target == DEFRAG_TARGET_FREE_EXTENT && (needed == 0 || needed > before.free_blocks)) {
+        std::cerr << "Error (fs_plan_defrag): A free extent of " << needed << " blocks cannot be formed (" << before.free_blocks << " blocks free)." << std::endl;
+        fs_log(("fs_plan_defrag failed: unreachable free extent of " + std::to_string(needed) + " blocks.").c_str());
+        return -3;
+    }
+
+    bool has_unowned = false;
+    std::vector<DefragUnit> units = collect_defrag_units(all_files, bitmap, has_unowned);
+    std::vector<DefragMove> front = plan_compaction(units, true);
+    plan_out.full_compaction_bytes = moves_byte_cost(front);
+
+    if (before.largest_free_extent_hint >= needed) {
+        plan_out.strategy = "none"; // Hedef zaten sağlanıyor
+        fs_log("fs_plan_defrag: target already satisfied, no moves needed.");
+        return 0;
+    }
+
+    bool found = false;
+    int64_t best_cost = 0;
+    if (!has_unowned) {
+        std::vector<DefragMove> back = plan_compaction(units, false);
+        plan_out.moves = front;
+        plan_out.strategy = "compact-front";
+        best_cost = moves_byte_cost(front);
+        if (moves_byte_cost(back) < best_cost) {
+            plan_out.moves = back;
+            plan_out.strategy = "compact-back";
+            best_cost = moves_byte_cost(back);
+        }
+        found = true;
+    }
+
+    // Pencereler maliyete göre sıralanır; ilk yerleşebilen pencere o sınıfın en ucuzudur.
+    std::vector<std::pair<int64_t, int> > windows; // (maliyet, pencere başlangıcı)
+    for (int w = 0; w + static_cast<int>(needed) <= static_cast<int>(NUM_DATA_BLOCKS); ++w) {
+        int64_t cost = 0;
+        for (const DefragUnit& unit : units) {
+            if (unit.start < w + static_cast<int>(needed) && unit.start + unit.num_blocks > w) {
+                cost += static_cast<int64_t>(unit.num_blocks) * BLOCK_SIZE_BYTES;
             }
         }
-        // End Direct Read
+        windows.push_back(std::make_pair(cost, w));
+    }
+    std::sort(windows.begin(), windows.end());
+    for (const std::pair<int64_t, int>& window : windows) {
+        if (found && window.first >= best_cost) break;
+        std::vector<DefragMove> moves;
+        if (plan_window(units, bitmap, window.second, static_cast<int>(needed), moves)) {
+            plan_out.moves = moves;
+            plan_out.strategy = "window";
+            best_cost = window.first;
+            found = true;
+            break;
+        }
+    }
 
-        bool needs_move = (current_fi.start_data_block_index != next_target_data_block);
+    if (!found) {
+        std::cerr << "Error (fs_plan_defrag): No move set reaches the target (unowned blocks are in the way)." << std::endl;
+        fs_log("fs_plan_defrag failed: no feasible plan.");
+        return -4;
+    }
+    plan_out.bytes_to_move = best_cost;
+    apply_moves_to_bitmap(bitmap, plan_out.moves);
+    SpaceStats after;
+    scan_free_space(bitmap, after);
+    plan_out.largest_free_extent_after = after.largest_free_extent_hint;
+    fs_log(("fs_plan_defrag: strategy " + plan_out.strategy + ", " + std::to_string(plan_out.moves.size()) + " moves, " +
+            std::to_string(plan_out.bytes_to_move) + " bytes (full compaction: " + std::to_string(plan_out.full_compaction_bytes) + ").").c_str());
+    return 0;
+}
 
-        if (needs_move) {
-             fs_log(("Moving data for file " + std::string(current_fi.name) + " from block " + 
-                    std::to_string(current_fi.start_data_block_index) + " to " + std::to_string(next_target_data_block)).c_str());
-            // Direct Write Logic
-            const char* data_to_write_ptr = file_content_buffer;
-            int bytes_remaining_to_write_for_file = current_fi.size;
-
-            for (unsigned int k = 0; k < current_fi.num_data_blocks_used; ++k) {
-                if (bytes_remaining_to_write_for_file <= 0) break;
-
-                unsigned int actual_disk_block_to_write = next_target_data_block + k;
-                 std::streampos write_pos = METADATA_AREA_SIZE_BYTES +
-                                           (static_cast<std::streamoff>(actual_disk_block_to_write) * BLOCK_SIZE_BYTES);
-                disk_file.seekp(write_pos);
-
-                int bytes_to_write_in_this_block = std::min(bytes_remaining_to_write_for_file, static_cast<int>(BLOCK_SIZE_BYTES));
-
-                disk_file.write(data_to_write_ptr, bytes_to_write_in_this_block);
-                if (!disk_file) {
-                    std::cerr << "Error (fs_defragment): Failed to write data for file '" << current_fi.name 
-                              << "' to new block " << actual_disk_block_to_write << std::endl;
-                    fs_log("fs_defragment error: failed writing file data during move.");
-                    delete[] file_content_buffer;
-                    disk_file.close();
-                    return;
-                }
-                data_to_write_ptr += bytes_to_write_in_this_block;
-                bytes_remaining_to_write_for_file -= bytes_to_write_in_this_block;
-            }
-            // End Direct Write
-        } else {
-            fs_log(("File " + std::string(current_fi.name) + " is already in its defragmented position (block " + 
-                   std::to_string(current_fi.start_data_block_index) + "). No data move needed.").c_str());
+// Paylaşılan kuyruk bloğunu target'a taşır ve kuyruğu orada olan tüm dosyaların FileInfo'sunu günceller.
+bool defrag_move_tail_block(char* bitmap, std::vector<FileInfo>& all_files, Superblock& sb, int old_block, int target) {
+    std::vector<std::unique_lock<std::mutex> > group_locks = lock_all_allocation_groups();
+    bitmap[target / 8] |= bit_to_char_mask(target % 8);
+    mark_bitmap_range(target, 1, -1);
+    if (!move_blocks_in_image(old_block, target, 1)) {
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(all_files.size()); ++i) {
+        FileInfo& fi = all_files[i];
+        if (!fi.is_used || !has_packed_tail(fi) || fi.tail_block_index != old_block) continue;
+        fi.tail_block_index = target;
+        if (!write_file_info_at_index(i, fi, sb)) {
+            fs_log(("defrag_move_tail_block: could not update FileInfo of '" + std::string(fi.name) + "'.").c_str());
+            return false;
         }
+    }
+    bitmap[old_block / 8] &= ~bit_to_char_mask(old_block % 8);
+    mark_bitmap_range(old_block, 1, +1);
+    buddy_invalidate_free_lists();
+    return true;
+}
 
-        current_fi.start_data_block_index = next_target_data_block;
+int fs_defragment_to_target(int target, uint32_t min_free_extent_blocks, bool dry_run) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    DefragPlan plan;
+    int plan_result = fs_plan_defrag(target, min_free_extent_blocks, plan);
+    if (plan_result != 0) {
+        return plan_result;
+    }
 
-        for (unsigned int k = 0; k < current_fi.num_data_blocks_used; ++k) {
-            unsigned int block_to_mark = next_target_data_block + k;
-            unsigned int byte_idx = block_to_mark / 8;
-            unsigned int bit_idx = block_to_mark % 8;
-            if (byte_idx < BITMAP_SIZE_BYTES) {
-                new_bitmap[byte_idx] |= bit_to_char_mask(bit_idx); // Use helper
-            } else {
-                 std::cerr << "Error (fs_defragment): Bitmap index out of bounds for block " << block_to_mark << std::endl;
-                 fs_log("fs_defragment error: bitmap index out of bounds during new bitmap creation.");
-                 delete[] file_content_buffer;
-                 disk_file.close();
-                 return;
-            }
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    std::cout << "Defragmentation plan" << (dry_run ? " (dry run)" : "") << ": target "
+              << (target == DEFRAG_TARGET_ZERO_FRAGMENTATION ? "zero fragmentation" : "free extent >= " + std::to_string(plan.min_free_extent_blocks) + " blocks")
+              << std::endl;
+    std::cout << "  Strategy: " << plan.strategy << ", moves: " << plan.moves.size() << ", bytes to copy: " << plan.bytes_to_move
+              << " (full compaction: " << plan.full_compaction_bytes << ")" << std::endl;
+    std::cout << "  Largest free extent: " << plan.largest_free_extent_before << " -> " << plan.largest_free_extent_after << " blocks" << std::endl;
+    for (const DefragMove& move : plan.moves) {
+        std::string what = move.file_index >= 0 ? "'" + build_full_path(all_files, move.file_index) + "'" : std::string("shared tail block");
+        std::cout << "    move " << what << " blocks " << move.from_block << "-" << move.from_block + move.num_blocks - 1
+                  << " -> " << move.to_block << "-" << move.to_block + move.num_blocks - 1 << std::endl;
+    }
+    if (dry_run || plan.moves.empty()) {
+        fs_log(("fs_defragment_to_target: " + std::string(dry_run ? "dry run, " : "") + std::to_string(plan.moves.size()) + " moves planned.").c_str());
+        return 0;
+    }
+
+    DiskStream disk_file(std::ios::in | std::ios::out);
+    char bitmap[BITMAP_SIZE_BYTES];
+    if (!disk_file || !read_committed_bitmap(disk_file, bitmap)) {
+        std::cerr << "Error (fs_defragment_to_target): Could not read bitmap." << std::endl;
+        fs_log("fs_defragment_to_target failed: bitmap read error.");
+        return -2;
+    }
+    for (const DefragMove& move : plan.moves) {
+        bool moved = move.file_index >= 0
+            ? defrag_move_extent(bitmap, all_files, sb, move.file_index, move.to_block)
+            : defrag_move_tail_block(bitmap, all_files, sb, move.from_block, move.to_block);
+        if (!moved) {
+            std::cerr << "Error (fs_defragment_to_target): Move from block " << move.from_block << " to " << move.to_block << " failed." << std::endl;
+            fs_log("fs_defragment_to_target failed: a planned move failed.");
+            return -5;
         }
-        
-        next_target_data_block += current_fi.num_data_blocks_used;
-        delete[] file_content_buffer;
-        file_content_buffer = nullptr; 
     }
+    disk_file.close();
+    fs_log(("fs_defragment_to_target: executed " + std::to_string(plan.moves.size()) + " moves, " + std::to_string(plan.bytes_to_move) + " bytes copied.").c_str());
+    return 0;
+}
 
-    disk_file.seekp(FILE_INFO_ARRAY_START_OFFSET_IN_METADATA, std::ios::beg);
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
-        disk_file.write(reinterpret_cast<const char*>(&all_files_info[i]), FILE_INFO_ENTRY_SIZE);
-        if (!disk_file) {
-            std::cerr << "Error (fs_defragment): Could not write updated FileInfo entry " << i << "." << std::endl;
-            fs_log("fs_defragment failed: error writing updated FileInfo entries.");
-            disk_file.close();
-            return;
+// ------------- PARÇALANMA RAPORU (FRAGMENTATION REPORT) -------------
+// Birleştirmenin gerekip gerekmediğine karar vermek için: boş alan bitmap'ten, dosya başına bilgiler
+// FileInfo tablosundan, ikisi de tek geçişte hesaplanır. Sayaçlar (fs_statfs) kullanılmaz; en büyük boş
+// parça ve histogram kesin olmalı.
+
+int frag_histogram_bucket(uint32_t run_length) {
+    int bucket = 0;
+    while (bucket < FRAG_HISTOGRAM_BUCKETS - 1 && (run_length >> (bucket + 1)) != 0) bucket++;
+    return bucket;
+}
+
+std::string json_escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+            escaped += code;
+        } else {
+            escaped += c;
         }
     }
+    return escaped;
+}
 
-    disk_file.seekp(BITMAP_START_OFFSET_IN_METADATA, std::ios::beg);
-    disk_file.write(new_bitmap, BITMAP_SIZE_BYTES);
-    if (!disk_file) {
-        std::cerr << "Error (fs_defragment): Could not write new bitmap to disk." << std::endl;
-        fs_log("fs_defragment failed: error writing new bitmap.");
-        disk_file.close();
-        return;
-    }
+void print_frag_report_text(const FragReport& report) {
+    std::cout << "Fragmentation report" << std::endl;
+    std::cout << "  Free space: " << report.free_blocks << "/" << report.total_blocks << " blocks in " << report.free_extent_count
+              << " extents, largest " << report.largest_free_extent << " blocks" << std::endl;
+    std::cout << "  Free extent sizes (blocks):" << std::endl;
+    for (int bucket = 0; bucket < FRAG_HISTOGRAM_BUCKETS; ++bucket) {
+        if (report.free_extent_histogram[bucket] == 0) continue;
+        std::cout << "    " << (1u << bucket) << "-" << ((1u << (bucket + 1)) - 1) << ": " << report.free_extent_histogram[bucket] << std::endl;
+    }
+    std::cout << "  Files (path / size / blocks / extents / wasted tail bytes):" << std::endl;
+    for (const FileFragInfo& file : report.files) {
+        bool mark_directory = file.type == FILE_TYPE_DIRECTORY && file.path != "/";
+        std::cout << "    " << file.path << (mark_directory ? "/" : "") << "\t" << file.size << "\t" << file.data_blocks
+                  << "\t" << file.extent_count << "\t" << file.wasted_tail_bytes << std::endl;
+    }
+    std::cout << "  Fragmented files: " << report.fragmented_files << ", wasted tail bytes: " << report.wasted_tail_bytes << std::endl;
+    std::cout << "  Score: " << report.score << "/100 (free space " << report.free_space_fragmentation << ", files "
+              << report.file_fragmentation << ") - " << (report.defrag_recommended ? "defragmentation recommended" : "defragmentation not needed")
+              << std::endl;
+}
 
-    disk_file.seekp(0, std::ios::beg);
-    disk_file.write(reinterpret_cast<const char*>(&sb), SUPERBLOCK_ACTUAL_SIZE);
-     if (!disk_file) {
-        std::cerr << "Error (fs_defragment): Could not rewrite superblock." << std::endl;
-        fs_log("fs_defragment failed: could not rewrite superblock.");
+void print_frag_report_json(const FragReport& report) {
+    std::cout << "{\"total_blocks\":" << report.total_blocks << ",\"free_blocks\":" << report.free_blocks
+              << ",\"free_extent_count\":" << report.free_extent_count << ",\"largest_free_extent\":" << report.largest_free_extent
+              << ",\"free_extent_histogram\":[";
+    for (int bucket = 0; bucket < FRAG_HISTOGRAM_BUCKETS; ++bucket) {
+        std::cout << (bucket ? "," : "") << "{\"min_blocks\":" << (1u << bucket) << ",\"max_blocks\":" << ((1u << (bucket + 1)) - 1)
+                  << ",\"count\":" << report.free_extent_histogram[bucket] << "}";
+    }
+    std::cout << "],\"files\":[";
+    for (size_t i = 0; i < report.files.size(); ++i) {
+        const FileFragInfo& file = report.files[i];
+        std::cout << (i ? "," : "") << "{\"path\":\"" << json_escape(file.path) << "\",\"type\":\""
+                  << (file.type == FILE_TYPE_DIRECTORY ? "directory" : "file") << "\",\"size\":" << file.size
+                  << ",\"blocks\":" << file.data_blocks << ",\"extents\":" << file.extent_count
+                  << ",\"wasted_tail_bytes\":" << file.wasted_tail_bytes << "}";
+    }
+    std::cout << "],\"fragmented_files\":" << report.fragmented_files << ",\"wasted_tail_bytes\":" << report.wasted_tail_bytes
+              << ",\"free_space_fragmentation\":" << report.free_space_fragmentation << ",\"file_fragmentation\":" << report.file_fragmentation
+              << ",\"score\":" << report.score << ",\"defrag_recommended\":" << (report.defrag_recommended ? "true" : "false") << "}" << std::endl;
+}
+
+int fs_frag_report(FragReport& report_out, int output_format) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    ensure_disk_initialized();
+    report_out = FragReport();
+    if (output_format != FRAG_REPORT_NONE && output_format != FRAG_REPORT_TEXT && output_format != FRAG_REPORT_JSON) {
+        std::cerr << "Error (fs_frag_report): Unknown output format " << output_format << "." << std::endl;
+        return -1;
     }
+    flush_all_delayed_writes(); // Rapor diskteki son yerleşimi göstermeli
 
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    char bitmap[BITMAP_SIZE_BYTES];
+    DiskStream disk_file(std::ios::in);
+    if (sb.num_active_files == -1 || !disk_file) {
+        std::cerr << "Error (fs_frag_report): Could not read metadata." << std::endl;
+        fs_log("fs_frag_report failed: metadata read error.");
+        return -2;
+    }
+    if (!read_committed_bitmap(disk_file, bitmap)) {
+        std::cerr << "Error (fs_frag_report): Could not read bitmap." << std::endl;
+        fs_log("fs_frag_report failed: bitmap read error.");
+        return -2;
+    }
     disk_file.close();
-    fs_log("Defragmentation process completed successfully.");
+
+    // Boş alan: tek geçiş, her boş parça bittiğinde histograma eklenir
+    report_out.total_blocks = NUM_DATA_BLOCKS;
+    uint32_t run = 0;
+    for (int block_idx = 0; block_idx <= static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+        if (block_idx < static_cast<int>(NUM_DATA_BLOCKS) && bitmap_block_is_free(bitmap, block_idx)) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            report_out.free_blocks += run;
+            report_out.free_extent_count++;
+            report_out.largest_free_extent = std::max(report_out.largest_free_extent, run);
+            report_out.free_extent_histogram[frag_histogram_bucket(run)]++;
+            run = 0;
+        }
+    }
+
+    // Dosyalar: tek geçiş
+    uint32_t files_with_blocks = 0;
+    for (int i = 0; i < static_cast<int>(all_files.size()); ++i) {
+        const FileInfo& fi = all_files[i];
+        if (!fi.is_used) continue;
+        FileFragInfo file;
+        file.path = build_full_path(all_files, i);
+        file.type = fi.type;
+        file.size = fi.size;
+        file.data_blocks = is_inline_file(fi) ? 0 : fi.num_data_blocks_used;
+        file.extent_count = (file.data_blocks > 0 ? 1 : 0) + (has_packed_tail(fi) ? 1 : 0);
+        file.wasted_tail_bytes = file.data_blocks == 0 ? 0 :
+            std::max<int64_t>(0, static_cast<int64_t>(file.data_blocks) * BLOCK_SIZE_BYTES - block_backed_bytes(fi));
+        if (file.extent_count > 0) files_with_blocks++;
+        if (file.extent_count > 1) report_out.fragmented_files++;
+        report_out.wasted_tail_bytes += file.wasted_tail_bytes;
+        report_out.files.push_back(file);
+    }
+
+    report_out.free_space_fragmentation = report_out.free_blocks == 0 ? 0 :
+        100 - static_cast<int>(static_cast<int64_t>(report_out.largest_free_extent) * 100 / report_out.free_blocks);
+    report_out.file_fragmentation = files_with_blocks == 0 ? 0 :
+        static_cast<int>(static_cast<int64_t>(report_out.fragmented_files) * 100 / files_with_blocks);
+    report_out.score = (3 * report_out.free_space_fragmentation + report_out.file_fragmentation) / 4;
+    report_out.defrag_recommended = report_out.score >= FRAG_DEFRAG_RECOMMENDED_SCORE && report_out.free_extent_count > 1;
+
+    if (output_format == FRAG_REPORT_TEXT) print_frag_report_text(report_out);
+    else if (output_format == FRAG_REPORT_JSON) print_frag_report_json(report_out);
+    fs_log(("fs_frag_report: score " + std::to_string(report_out.score) + ", " + std::to_string(report_out.free_extent_count) +
+            " free extents (largest " + std::to_string(report_out.largest_free_extent) + "), " +
+            std::to_string(report_out.fragmented_files) + " fragmented files.").c_str());
+    return 0;
 }
 
 FileInfo fs_get_file_info_debug(const char* filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED, true);
     FileInfo not_found_fi; // Varsayılan olarak is_used=false, name boş vb.
     not_found_fi.is_used = false;
     not_found_fi.start_data_block_index = -2; // Hata kodu olarak kullanılabilir
@@ -1757,10 +6504,9 @@ FileInfo fs_get_file_info_debug(const char* filename) {
         return not_found_fi;
     }
 
-    for (const auto& fi : all_files) {
-        if (fi.is_used && strcmp(fi.name, filename) == 0) {
-            return fi; // Bulunan FileInfo'nun kopyasını döndür
-        }
+    int file_index = resolve_path(all_files, filename);
+    if (file_index != -1) {
+        return all_files[file_index]; // Bulunan FileInfo'nun kopyasını döndür
     }
 
     fs_log(("fs_get_file_info_debug: File '" + std::string(filename) + "' not found.").c_str());
@@ -1768,15 +6514,22 @@ FileInfo fs_get_file_info_debug(const char* filename) {
 }
 
 void fs_check_integrity() {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     ensure_disk_initialized();
     fs_log("File system integrity check started.");
     bool is_consistent = true;
     int issues_found = 0;
+    // Kontroller diskteki kopya üzerinde yapılır; bellekteki tahsis durumu önce diske yazılır.
+    if (!persist_allocation_state()) {
+        fs_log("fs_check_integrity ERROR: Could not write the in-memory allocation state to disk.");
+        is_consistent = false; issues_found++;
+    }
 
-    std::fstream disk_file(DISK_FILENAME, std::ios::binary | std::ios::in);
+    DiskStream disk_file(std::ios::in);
     if (!disk_file) {
         fs_log("fs_check_integrity CRITICAL: Could not open disk file.");
-        std::cerr << "CRITICAL (fs_check_integrity): Could not open disk file '" << DISK_FILENAME << "'." << std::endl;
+        std::cerr << "CRITICAL (fs_check_integrity): Could not open disk file '" << disk_filename() << "'." << std::endl;
         return;
     }
 
@@ -1813,11 +6566,21 @@ void fs_check_integrity() {
         disk_file.close();
         return;
     }
+
+    // Tahsis grubu özetleri
+    std::vector<AllocationGroupSummary> group_summaries;
+    if (!read_group_summaries(disk_file, group_summaries)) {
+        fs_log("fs_check_integrity ERROR: Could not read allocation group summaries.");
+        is_consistent = false; issues_found++;
+        disk_file.close();
+        return;
+    }
     disk_file.close(); // Disk okumaları tamamlandı.
 
     // Kontrol 1: Superblock'taki aktif dosya sayısı ile FileInfo'lardaki sayının tutarlılığı
+    // (Kök dizin num_active_files'a dahil değildir.)
     int active_files_in_fileinfo = 0;
-    for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
+    for (int i = ROOT_DIR_INDEX + 1; i < MAX_FILES_CALCULATED; ++i) {
         if (all_files_info[i].is_used) {
             active_files_in_fileinfo++;
         }
@@ -1828,31 +6591,71 @@ void fs_check_integrity() {
         is_consistent = false; issues_found++;
     }
 
+    if (sb.defrag.cursor > NUM_DATA_BLOCKS || sb.defrag.pass_active > 1) {
+        fs_log(("fs_check_integrity WARNING: Incremental defragmentation progress is invalid (cursor: " + std::to_string(sb.defrag.cursor) +
+               ", pass_active: " + std::to_string(sb.defrag.pass_active) + ").").c_str());
+        is_consistent = false; issues_found++;
+    }
+
     // Kontrol 2: Her aktif FileInfo'nun kendi iç tutarlılığı ve Bitmap ile tutarlılığı
     std::vector<bool> block_usage_tracker(NUM_DATA_BLOCKS, false); // Hangi blokların FileInfo'lar tarafından kullanıldığını izler
+    std::vector<std::pair<int, std::pair<int, int> > > tail_ranges; // (kuyruk bloğu, (ofset, FileInfo indeksi))
 
     for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
         if (all_files_info[i].is_used) {
             const FileInfo& fi = all_files_info[i];
             std::string filename_str(fi.name);
 
+            if (fi.placement_goal < -1 || fi.placement_goal >= static_cast<int32_t>(NUM_DATA_BLOCKS)) {
+                fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' has an out-of-range placement goal " +
+                       std::to_string(fi.placement_goal) + ".").c_str());
+                is_consistent = false; issues_found++;
+            }
+
             // a. Boyut ve blok kullanımı
-            if (fi.size > 0 && (fi.num_data_blocks_used == 0 || fi.start_data_block_index == -1)) {
+            if (is_inline_file(fi)) {
+                // Satır içi dosya: blok kullanmamalı ve verisi isimden artan alana sığmalı.
+                if (fi.type != FILE_TYPE_REGULAR || fi.size <= 0 || fi.size > inline_capacity_for_name(fi.name) ||
+                    fi.num_data_blocks_used != 0 || fi.start_data_block_index != -1) {
+                    fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' is marked inline but has size " + std::to_string(fi.size) +
+                           " (capacity " + std::to_string(inline_capacity_for_name(fi.name)) + "), num_blocks: " +
+                           std::to_string(fi.num_data_blocks_used) + ", start_block: " + std::to_string(fi.start_data_block_index) + ".").c_str());
+                    is_consistent = false; issues_found++;
+                }
+                continue; // Bitmap ile karşılaştırılacak bloğu yok
+            }
+            if (block_backed_bytes(fi) > 0 && (fi.num_data_blocks_used == 0 || fi.start_data_block_index == -1)) {
                 fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' has size " + std::to_string(fi.size) +
                        " but no data blocks allocated (num_blocks: " + std::to_string(fi.num_data_blocks_used) +
                        ", start_block: " + std::to_string(fi.start_data_block_index) + ").").c_str());
                 is_consistent = false; issues_found++;
             }
-            if (fi.size == 0 && (fi.num_data_blocks_used != 0 || fi.start_data_block_index != -1)) {
+            bool preallocated = (fi.flags & FILE_FLAG_PREALLOCATED) != 0;
+            if (fi.size == 0 && !preallocated && (fi.num_data_blocks_used != 0 || fi.start_data_block_index != -1)) {
                  fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' has size 0 but data blocks seem allocated (num_blocks: " +
                         std::to_string(fi.num_data_blocks_used) + ", start_block: " + std::to_string(fi.start_data_block_index) + "). Should be 0 and -1.").c_str());
                 is_consistent = false; issues_found++;
             }
 
             // b. Gerekli blok sayısı ile tahsis edilen blok sayısının tutarlılığı
-            if (fi.size > 0) {
-                unsigned int expected_blocks = (fi.size + BLOCK_SIZE_BYTES - 1) / BLOCK_SIZE_BYTES;
-                if (fi.num_data_blocks_used != expected_blocks) {
+            //    (Kuyruğu paketlenmiş dosyalarda ardışık bloklar sadece tam blokları tutar.)
+            if (has_packed_tail(fi)) {
+                if (fi.tail_length == 0 || fi.tail_block_index >= static_cast<int32_t>(NUM_DATA_BLOCKS) ||
+                    static_cast<unsigned int>(fi.tail_offset) + fi.tail_length > BLOCK_SIZE_BYTES ||
+                    fi.size % BLOCK_SIZE_BYTES != fi.tail_length) {
+                    fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' has an invalid packed tail (block: " +
+                           std::to_string(fi.tail_block_index) + ", offset: " + std::to_string(fi.tail_offset) +
+                           ", length: " + std::to_string(fi.tail_length) + ", size: " + std::to_string(fi.size) + ").").c_str());
+                    is_consistent = false; issues_found++;
+                } else {
+                    tail_ranges.push_back(std::make_pair(fi.tail_block_index, std::make_pair(static_cast<int>(fi.tail_offset), i)));
+                }
+            }
+            if (block_backed_bytes(fi) > 0) {
+                // Ön tahsisli dosyalarda ayrılan alan içerikten büyük olabilir.
+                int64_t expected_blocks = blocks_needed_for_size(block_backed_bytes(fi));
+                if (preallocated ? static_cast<int64_t>(fi.num_data_blocks_used) < expected_blocks
+                                 : static_cast<int64_t>(fi.num_data_blocks_used) != expected_blocks) {
                     fs_log(("fs_check_integrity WARNING: File '" + filename_str + "' size " + std::to_string(fi.size) +
                            " requires " + std::to_string(expected_blocks) + " blocks, but FileInfo states " +
                            std::to_string(fi.num_data_blocks_used) + " blocks are used.").c_str());
@@ -1890,6 +6693,34 @@ void fs_check_integrity() {
         }
     }
 
+    // Kontrol 2.d: Paylaşılan kuyruk blokları. Kuyruklar aynı blokta çakışmamalı, kuyruk bloğu bir dosyanın
+    // ardışık blokları arasında olmamalı ve bitmap'te dolu görünmeli.
+    std::sort(tail_ranges.begin(), tail_ranges.end());
+    for (size_t t = 0; t < tail_ranges.size(); ++t) {
+        int block_idx = tail_ranges[t].first;
+        const FileInfo& fi = all_files_info[tail_ranges[t].second.second];
+        bool first_in_block = (t == 0 || tail_ranges[t - 1].first != block_idx);
+        if (first_in_block) {
+            if (block_usage_tracker[block_idx]) {
+                fs_log(("fs_check_integrity WARNING: Block " + std::to_string(block_idx) +
+                       " is used both as a shared tail block and as part of a file's contiguous blocks.").c_str());
+                is_consistent = false; issues_found++;
+            }
+            if (!(bitmap[block_idx / 8] & bit_to_char_mask(block_idx % 8))) {
+                fs_log(("fs_check_integrity WARNING: Shared tail block " + std::to_string(block_idx) + " is marked as free in the bitmap.").c_str());
+                is_consistent = false; issues_found++;
+            }
+            block_usage_tracker[block_idx] = true;
+        } else {
+            const FileInfo& prev = all_files_info[tail_ranges[t - 1].second.second];
+            if (prev.tail_offset + prev.tail_length > fi.tail_offset) {
+                fs_log(("fs_check_integrity WARNING: Tails of '" + std::string(prev.name) + "' and '" + std::string(fi.name) +
+                       "' overlap in shared block " + std::to_string(block_idx) + ".").c_str());
+                is_consistent = false; issues_found++;
+            }
+        }
+    }
+
     // Kontrol 3: Bitmap'teki "dolu" blokların FileInfo'lar tarafından kullanılıp kullanılmadığı
     for (unsigned int block_idx = 0; block_idx < NUM_DATA_BLOCKS; ++block_idx) {
         unsigned int byte_idx = block_idx / 8;
@@ -1910,6 +6741,96 @@ void fs_check_integrity() {
         }
     }
 
+    // Kontrol 3.a: Her tahsis grubunun özetindeki boş blok sayısı, grubun bitmap dilimiyle uyuşmalı.
+    for (unsigned int g = 0; g < NUM_ALLOCATION_GROUPS; ++g) {
+        uint32_t free_in_bitmap = 0;
+        for (int b = group_first_block(g); b < group_first_block(g) + group_block_count(g); ++b) {
+            if (!(bitmap[b / 8] & bit_to_char_mask(b % 8))) free_in_bitmap++;
+        }
+        if (group_summaries[g].free_blocks != free_in_bitmap) {
+            fs_log(("fs_check_integrity WARNING: Allocation group " + std::to_string(g) + " summary says " +
+                   std::to_string(group_summaries[g].free_blocks) + " free blocks, bitmap has " + std::to_string(free_in_bitmap) + ".").c_str());
+            is_consistent = false; issues_found++;
+        }
+    }
+
+    // Kontrol 3.b: Kilitsiz tahsisin bellekteki bitmap kopyası yüklüyse diskteki bitmap'le birebir aynı olmalı
+    // (cilt kilidi özel tutulduğu için işlenmemiş sahiplenme yoktur).
+    if (active_volume().atomic_bitmap_loaded.load(std::memory_order_acquire)) {
+        char in_memory[BITMAP_SIZE_BYTES];
+        atomic_bitmap_snapshot(in_memory);
+        for (int block_idx = 0; block_idx < static_cast<int>(NUM_DATA_BLOCKS); ++block_idx) {
+            if (bitmap_block_is_free(in_memory, block_idx) != bitmap_block_is_free(bitmap, block_idx)) {
+                fs_log(("fs_check_integrity WARNING: In-memory atomic bitmap disagrees with the on-disk bitmap at block " +
+                       std::to_string(block_idx) + ".").c_str());
+                is_consistent = false; issues_found++;
+                break;
+            }
+        }
+    }
+
+    // Kontrol 3.c: Süperbloktaki artımlı alan istatistikleri, bitmap ve FileInfo'lardan hesaplananla uyuşmalı.
+    // En büyük boş parça bir üst sınır olduğu için sadece gerçek değerden küçük olmaması beklenir.
+    SpaceStats expected_stats = compute_space_stats(bitmap, all_files_info);
+    if (sb.stats.free_blocks != expected_stats.free_blocks || sb.stats.free_extent_count != expected_stats.free_extent_count ||
+        sb.stats.used_bytes != expected_stats.used_bytes || sb.stats.slack_bytes != expected_stats.slack_bytes ||
+        sb.stats.fragmented_files != expected_stats.fragmented_files ||
+        sb.stats.largest_free_extent_hint < expected_stats.largest_free_extent_hint) {
+        fs_log(("fs_check_integrity WARNING: Superblock space statistics (free " + std::to_string(sb.stats.free_blocks) +
+               ", extents " + std::to_string(sb.stats.free_extent_count) + ", largest<=" + std::to_string(sb.stats.largest_free_extent_hint) +
+               ", used " + std::to_string(sb.stats.used_bytes) + ", slack " + std::to_string(sb.stats.slack_bytes) +
+               ", fragmented " + std::to_string(sb.stats.fragmented_files) + ") do not match recomputed values (free " +
+               std::to_string(expected_stats.free_blocks) + ", extents " + std::to_string(expected_stats.free_extent_count) +
+               ", largest " + std::to_string(expected_stats.largest_free_extent_hint) + ", used " + std::to_string(expected_stats.used_bytes) +
+               ", slack " + std::to_string(expected_stats.slack_bytes) + ", fragmented " + std::to_string(expected_stats.fragmented_files) + ").").c_str());
+        is_consistent = false; issues_found++;
+    }
+
+    // Kontrol 4: Dizin ağacı. Kök dizin var olmalı, her girdinin üst dizini kullanılan bir dizin olmalı
+    // ve üst dizinin hash tablosu girdiyi tam olarak bir kez içermeli.
+    if (!all_files_info[ROOT_DIR_INDEX].is_used || all_files_info[ROOT_DIR_INDEX].type != FILE_TYPE_DIRECTORY) {
+        fs_log("fs_check_integrity WARNING: Root directory entry is missing or is not a directory.");
+        is_consistent = false; issues_found++;
+    } else {
+        std::vector<int> referenced_count(MAX_FILES_CALCULATED, 0);
+        for (int i = 0; i < MAX_FILES_CALCULATED; ++i) {
+            const FileInfo& dir = all_files_info[i];
+            if (!dir.is_used || dir.type != FILE_TYPE_DIRECTORY) continue;
+            std::vector<DirEntry> table;
+            if (!load_dir_table(dir, table)) {
+                fs_log(("fs_check_integrity WARNING: Could not read directory table of '" + std::string(dir.name) + "'.").c_str());
+                is_consistent = false; issues_found++;
+                continue;
+            }
+            unsigned int live_entries = 0;
+            for (const DirEntry& entry : table) {
+                if (entry.file_index == DIR_ENTRY_EMPTY) continue;
+                live_entries++;
+                if (entry.file_index <= ROOT_DIR_INDEX || entry.file_index >= MAX_FILES_CALCULATED ||
+                    !all_files_info[entry.file_index].is_used || all_files_info[entry.file_index].parent_index != i ||
+                    entry.name_hash != dir_name_hash(all_files_info[entry.file_index].name)) {
+                    fs_log(("fs_check_integrity WARNING: Directory '" + std::string(dir.name) + "' has a stale entry pointing to slot " +
+                           std::to_string(entry.file_index) + ".").c_str());
+                    is_consistent = false; issues_found++;
+                    continue;
+                }
+                referenced_count[entry.file_index]++;
+            }
+            if (live_entries != dir.dir_entry_count) {
+                fs_log(("fs_check_integrity WARNING: Directory '" + std::string(dir.name) + "' entry count is " +
+                       std::to_string(dir.dir_entry_count) + " but its table holds " + std::to_string(live_entries) + " entries.").c_str());
+                is_consistent = false; issues_found++;
+            }
+        }
+        for (int i = ROOT_DIR_INDEX + 1; i < MAX_FILES_CALCULATED; ++i) {
+            if (all_files_info[i].is_used && referenced_count[i] != 1) {
+                fs_log(("fs_check_integrity WARNING: File '" + std::string(all_files_info[i].name) + "' is referenced by " +
+                       std::to_string(referenced_count[i]) + " directory entries (expected 1).").c_str());
+                is_consistent = false; issues_found++;
+            }
+        }
+    }
+
     if (is_consistent) {
         fs_log("File system integrity check passed. No issues found.");
     } else {
@@ -1919,7 +6840,11 @@ void fs_check_integrity() {
 }
 
 int fs_backup(const char* backup_filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return FS_ERROR_LOCK_UPGRADE;
     ensure_disk_initialized(); // Ana diskimizin var olduğundan emin olalım
+    flush_all_delayed_writes(); // Yedek, tamponda bekleyen yazmaları da içermeli
+    persist_allocation_state(); // ...ve bellekteki bitmap, grup özetleri ve alan sayaçlarını
     fs_log(("Backup process started. Target backup file: '" + std::string(backup_filename) + "'").c_str());
 
     if (backup_filename == nullptr || strlen(backup_filename) == 0) {
@@ -1928,10 +6853,10 @@ int fs_backup(const char* backup_filename) {
         return -1; // Hata kodu: Geçersiz backup dosya adı
     }
 
-    std::ifstream source_disk(DISK_FILENAME, std::ios::binary);
+    DiskStream source_disk(std::ios::in);
     if (!source_disk) {
-        fs_log(("fs_backup CRITICAL: Could not open source disk file '" + std::string(DISK_FILENAME) + "' for reading.").c_str());
-        std::cerr << "Error (fs_backup): Could not open source disk file '" << DISK_FILENAME << "' for reading." << std::endl;
+        fs_log(("fs_backup CRITICAL: Could not open source disk file '" + std::string(disk_filename()) + "' for reading.").c_str());
+        std::cerr << "Error (fs_backup): Could not open source disk file '" << disk_filename() << "' for reading." << std::endl;
         return -2; // Hata kodu: Kaynak disk açılamadı
     }
 
@@ -1958,12 +6883,12 @@ int fs_backup(const char* backup_filename) {
 
     int return_code = 0; // Başarılı varsayalım
     if (source_disk.eof()) { 
-        fs_log(("Backup of '" + std::string(DISK_FILENAME) + "' to '" + std::string(backup_filename) + "' completed successfully.").c_str());
+        fs_log(("Backup of '" + std::string(disk_filename()) + "' to '" + std::string(backup_filename) + "' completed successfully.").c_str());
         std::cout << "Disk backup completed successfully to '" << backup_filename << "'." << std::endl;
         // return_code = 0; // Zaten 0
     } else if (source_disk.fail()) { 
-        fs_log(("fs_backup ERROR: Failed to read from source disk '" + std::string(DISK_FILENAME) + "' before EOF.").c_str());
-        std::cerr << "Error (fs_backup): Failed to read from source disk '" << DISK_FILENAME << "'." << std::endl;
+        fs_log(("fs_backup ERROR: Failed to read from source disk '" + std::string(disk_filename()) + "' before EOF.").c_str());
+        std::cerr << "Error (fs_backup): Failed to read from source disk '" << disk_filename() << "'." << std::endl;
         // remove(backup_filename); // İsteğe bağlı, yarım dosyayı sil
         return_code = -5; // Hata kodu: Kaynak diskten okuma hatası
     }
@@ -1975,6 +6900,8 @@ int fs_backup(const char* backup_filename) {
 
 // Geri yükleme fonksiyonu
 void fs_restore(const char* backup_filename) {
+    VolumeLockGuard volume_guard(LOCK_MODE_EXCLUSIVE);
+    if (!volume_guard.held()) return;
     if (backup_filename == nullptr || strlen(backup_filename) == 0) {
         fs_log("fs_restore ERROR: Backup filename cannot be null or empty.");
         std::cerr << "Error (fs_restore): Backup filename cannot be null or empty." << std::endl;
@@ -1997,30 +6924,37 @@ void fs_restore(const char* backup_filename) {
         return;
     }
 
-    // Hedef disk dosyasını (disk.sim) yazmak üzere aç (truncate etmeli)
-    std::ofstream target_disk(DISK_FILENAME, std::ios::binary | std::ios::trunc);
+    // Hedef: bağlı blok aygıtı (disk.sim veya RAM diski). Görüntü sabit boyutlu olduğu için yedek baştan yazılır.
+    DiskStream target_disk(std::ios::out);
     if (!target_disk) {
-        fs_log(("fs_restore CRITICAL: Could not open/create target disk file '" + std::string(DISK_FILENAME) + "' for writing.").c_str());
-        std::cerr << "Error (fs_restore): Could not open/create target disk file '" << DISK_FILENAME << "' for writing." << std::endl;
+        fs_log(("fs_restore CRITICAL: Could not open the block device of '" + std::string(disk_filename()) + "' for writing.").c_str());
+        std::cerr << "Error (fs_restore): Could not open the block device of '" << disk_filename() << "' for writing." << std::endl;
         backup_source.close();
         return;
     }
 
-    target_disk << backup_source.rdbuf(); // Tüm içeriği kopyala
+    char buffer[4096];
+    while (backup_source.read(buffer, sizeof(buffer)) || backup_source.gcount() > 0) {
+        if (!target_disk.write(buffer, backup_source.gcount())) break; // Yedek görüntüden büyükse burada durur
+    }
 
     bool success_restore = true;
     if (!target_disk.good()) {
-        fs_log(("fs_restore ERROR: Error occurred while writing to target disk file '" + std::string(DISK_FILENAME) + "'.").c_str());
-        std::cerr << "Error (fs_restore): Error occurred while writing to target disk file '" << DISK_FILENAME << "'." << std::endl;
+        fs_log(("fs_restore ERROR: Error occurred while writing to target disk file '" + std::string(disk_filename()) + "'.").c_str());
+        std::cerr << "Error (fs_restore): Error occurred while writing to target disk file '" << disk_filename() << "'." << std::endl;
         success_restore = false;
     }
 
     backup_source.close();
     target_disk.close();
+    buddy_invalidate_free_lists(); // Disk görüntüsü tamamen değişti
+    allocation_state_invalidate();
+    discard_all_delayed_writes(); // Bekleyen yazmalar ve açık tutamaçlar eski görüntüye aitti
+    invalidate_file_handles(-1);
 
     if (success_restore) {
-        fs_log(("Restore process completed successfully from '" + std::string(backup_filename) + "' to '" + std::string(DISK_FILENAME) + "'.").c_str());
-        std::cout << "Disk restore successful from: " << backup_filename << " to: " << DISK_FILENAME << std::endl;
+        fs_log(("Restore process completed successfully from '" + std::string(backup_filename) + "' to '" + std::string(disk_filename()) + "'.").c_str());
+        std::cout << "Disk restore successful from: " << backup_filename << " to: " << disk_filename() << std::endl;
         // Geri yükleme sonrası FS'nin tutarlı olması için ek kontroller veya fs_check_integrity() çağrılabilir.
         // Örneğin, superblock'taki dosya sayısı ve bitmap tutarlı mı?
         fs_log("Running integrity check after restore...");
@@ -2028,13 +6962,18 @@ void fs_restore(const char* backup_filename) {
     } else {
         // Hata durumunda, disk.sim dosyası bozulmuş olabilir. Eski haline getirmek zor.
         // Kullanıcıya bilgi verilmeli.
-        fs_log(("fs_restore CRITICAL ERROR: Restore failed. Disk file \\\'" + std::string(DISK_FILENAME) + "\\\' may be corrupted.").c_str());
-        std::cerr << "CRITICAL ERROR (fs_restore): Restore failed. Disk file \\\'" << DISK_FILENAME << "\\\' may be corrupted." << std::endl;
+        fs_log(("fs_restore CRITICAL ERROR: Restore failed. Disk file \\\'" + std::string(disk_filename()) + "\\\' may be corrupted.").c_str());
+        std::cerr << "CRITICAL ERROR (fs_restore): Restore failed. Disk file \\\'" << disk_filename() << "\\\' may be corrupted." << std::endl;
     }
 }
 
 int fs_diff(const char* filename1, const char* filename2) {
     ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    int first_index = resolve_file_index(filename1);
+    int second_index = resolve_file_index(filename2);
+    FileLockGuard first_guard(std::min(first_index, second_index), LOCK_MODE_SHARED, true); // İndeks sırası: kilitlenme olmaz
+    FileLockGuard second_guard(std::max(first_index, second_index), LOCK_MODE_SHARED, true);
     fs_log(("fs_diff called for files: \\\'" + (filename1 ? std::string(filename1) : "NULL") + "\\\' and \\\'" + (filename2 ? std::string(filename2) : "NULL") + "\\\'.").c_str());
 
     if (filename1 == nullptr || strlen(filename1) == 0 || filename2 == nullptr || strlen(filename2) == 0) {
@@ -2048,25 +6987,34 @@ int fs_diff(const char* filename1, const char* filename2) {
         return 0; // Aynı dosya adları, aynı kabul edilir.
     }
 
-    if (!fs_exists(filename1)) {
+    // İndeksler kilitler için zaten çözüldü; kayıtlar tek bir metadata okumasından gelir. Kilitler bekleyen
+    // yazmaları boşalttığı için diskteki boyutlar günceldir.
+    if (first_index == -1) {
         std::cerr << "Error (fs_diff): File \\\'" << filename1 << "\\\' not found." << std::endl;
         fs_log(("fs_diff failed: file1 not found - " + std::string(filename1)).c_str());
         return -2; // Hata kodu: İlk dosya yok
     }
-    if (!fs_exists(filename2)) {
+    if (second_index == -1) {
         std::cerr << "Error (fs_diff): File \\\'" << filename2 << "\\\' not found." << std::endl;
         fs_log(("fs_diff failed: file2 not found - " + std::string(filename2)).c_str());
         return -3; // Hata kodu: İkinci dosya yok
     }
+    if (first_index == second_index) {
+        fs_log("fs_diff: Both paths name the same file. Files are considered the same.");
+        return 0;
+    }
 
-    int size1 = fs_size(filename1);
-    int size2 = fs_size(filename2);
-
-    if (size1 < 0 || size2 < 0) {
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1 || all_files[first_index].type != FILE_TYPE_REGULAR || all_files[second_index].type != FILE_TYPE_REGULAR) {
         std::cerr << "Error (fs_diff): Could not determine size of one or both files." << std::endl;
         fs_log("fs_diff failed: could not get size for one or both files.");
-        return -4; // Hata kodu: Boyut okuma hatası
+        return -4; // Hata kodu: Boyut okuma hatası (veya dizin)
     }
+    const FileInfo& first_file = all_files[first_index];
+    const FileInfo& second_file = all_files[second_index];
+    int64_t size1 = first_file.size;
+    int64_t size2 = second_file.size;
 
     if (size1 != size2) {
         fs_log("fs_diff: Files have different sizes. Considered different.");
@@ -2091,12 +7039,13 @@ int fs_diff(const char* filename1, const char* filename2) {
         return -5; // Hata kodu: Bellek hatası
     }
 
-    fs_read(filename1, 0, size1, buffer1);
-    // fs_read kendi hatalarını loglar. Eğer buffer1 boş gelirse, bu bir okuma hatasıdır.
-    // Ancak fs_read void olduğu için dönüş değerinden kontrol edemiyoruz.
-    // fs_size kontrolü sonrası buraya gelindiği için dosya var ve boyutu biliniyor.
-
-    fs_read(filename2, 0, size2, buffer2); // size1 == size2
+    if (read_file_extent(first_file, 0, size1, buffer1) != size1 || read_file_extent(second_file, 0, size2, buffer2) != size2) {
+        std::cerr << "Error (fs_diff): Could not read the contents of one or both files." << std::endl;
+        fs_log("fs_diff failed: read error.");
+        delete[] buffer1;
+        delete[] buffer2;
+        return -4;
+    }
 
     int diff_result = memcmp(buffer1, buffer2, size1);
 
@@ -2111,3 +7060,554 @@ int fs_diff(const char* filename1, const char* filename2) {
         return 1; // İçerikler farklı
     }
 }
+
+// ------------- TUTAMAÇ TABANLI G/Ç (FILE HANDLES) -------------
+// fs_open yolu bir kez çözer; tutamaç FileInfo indeksini, kaydın kopyasını ve konumu tutar. İndeks dosyanın ömrü
+// boyunca sabittir (fs_rename/fs_mv yalnızca isim ve üst dizin alanlarını değiştirir), bu yüzden sonraki çağrılar
+// yol çözmez. Kayıt her diske yazıldığında cildin file_info_generation sayacı artar; tutamaç kopyayı aldığı andaki
+// değeri saklar ve değer değiştiyse yalnızca o kaydı yeniden okur (birleştirme blokları taşıdı, başka bir yazma
+// içeriği değiştirdi...). Sayaç kaydı yazanın özel kilidi altında artar, tutamaç işlemleri dosya kilidini tuttuğu
+// için karşılaştırma tutarlıdır. Silme, format, geri yükleme ve yeniden bağlama tutamacı geçersiz kılar: indeks
+// başka bir dosyaya verilebilir. Tablo kilidi yalnızca tablo alanları kopyalanırken tutulur.
+
+// file_index < 0: cildin tüm tutamaçları (görüntü değişti)
+void invalidate_file_handles(int file_index) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+    for (int handle = 0; handle < FS_MAX_OPEN_FILES; ++handle) {
+        FileHandleSlot& slot = volume.file_handles[handle];
+        if (slot.in_use && (file_index < 0 || slot.file_index == file_index)) {
+            slot.stale = true;
+        }
+    }
+}
+
+// Tutamacın dosya indeksini ve konumunu verir; tutamaç açık değilse veya geçersizleştiyse false.
+bool lookup_file_handle(int handle, int& file_index_out, int64_t& position_out) {
+    if (handle < 0 || handle >= FS_MAX_OPEN_FILES) return false;
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+    const FileHandleSlot& slot = volume.file_handles[handle];
+    if (!slot.in_use || slot.stale) return false;
+    file_index_out = slot.file_index;
+    position_out = slot.position;
+    return true;
+}
+
+// Çağıran cilt ve dosya kilitlerini tutar. Tutamacın kaydını önbellekten verir; kayıt o günden beri yazıldıysa
+// diskten tazeler. Tutamaç bu arada geçersizleştiyse -12, kayıt okunamazsa -4.
+int load_handle_file_info(int handle, int file_index, FileInfo& fi_out) {
+    Volume& volume = active_volume();
+    uint64_t generation = volume.file_info_generation[file_index].load();
+    {
+        std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+        const FileHandleSlot& slot = volume.file_handles[handle];
+        if (!slot.in_use || slot.stale || slot.file_index != file_index) return -12;
+        if (slot.generation == generation) {
+            fi_out = slot.cached;
+            return 0;
+        }
+    }
+    if (!read_file_info_at_index(file_index, fi_out)) return -4;
+    if (!fi_out.is_used || fi_out.type != FILE_TYPE_REGULAR) return -12;
+    std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+    FileHandleSlot& slot = volume.file_handles[handle];
+    if (!slot.in_use || slot.stale || slot.file_index != file_index) return -12;
+    slot.cached = fi_out;
+    slot.generation = generation;
+    return 0;
+}
+
+void set_file_handle_position(int handle, int file_index, int64_t position) {
+    Volume& volume = active_volume();
+    std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+    FileHandleSlot& slot = volume.file_handles[handle];
+    if (slot.in_use && !slot.stale && slot.file_index == file_index) {
+        slot.position = position;
+    }
+}
+
+int fs_open(const char* filename) {
+    Volume& volume = active_volume();
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    FileLockGuard file_guard(filename, LOCK_MODE_SHARED, true); // Önbelleğe alınan kayıt bekleyen yazmayı da içersin
+    fs_log(("fs_open called for file: " + (filename ? std::string(filename) : "NULL")).c_str());
+
+    if (filename == nullptr || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME_LENGTH) {
+        std::cerr << "Error (fs_open): Filename is empty or longer than " << MAX_FILENAME_LENGTH << " characters." << std::endl;
+        fs_log("fs_open failed: invalid filename.");
+        return -1;
+    }
+
+    Superblock sb;
+    std::vector<FileInfo> all_files = read_all_file_info(sb);
+    if (sb.num_active_files == -1) {
+        std::cerr << "Error (fs_open): Could not read metadata to open file '" << filename << "'." << std::endl;
+        fs_log("fs_open failed: metadata read error.");
+        return -4;
+    }
+
+    int file_index = resolve_path(all_files, filename);
+    if (file_index == -1) {
+        std::cerr << "Error (fs_open): File '" << filename << "' not found." << std::endl;
+        fs_log(("fs_open failed: file not found - " + std::string(filename)).c_str());
+        return -5;
+    }
+    if (all_files[file_index].type == FILE_TYPE_DIRECTORY) {
+        std::cerr << "Error (fs_open): '" << filename << "' is a directory." << std::endl;
+        fs_log(("fs_open failed: target is a directory - " + std::string(filename)).c_str());
+        return -10;
+    }
+
+    // Cilt kilidi paylaşımlı tutulduğu sürece yol aynı indekse çözülür ve dosya kilidi kaydı sabit tutar:
+    // sayaç kayıt okunduktan sonra alınabilir.
+    uint64_t generation = volume.file_info_generation[file_index].load();
+    int handle = -1;
+    {
+        std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+        for (int candidate = 0; candidate < FS_MAX_OPEN_FILES; ++candidate) {
+            if (!volume.file_handles[candidate].in_use) {
+                handle = candidate;
+                break;
+            }
+        }
+        if (handle != -1) {
+            FileHandleSlot& slot = volume.file_handles[handle];
+            slot = FileHandleSlot();
+            slot.in_use = true;
+            slot.file_index = file_index;
+            slot.generation = generation;
+            slot.cached = all_files[file_index];
+        }
+    }
+    if (handle == -1) {
+        std::cerr << "Error (fs_open): Too many open files (max " << FS_MAX_OPEN_FILES << "), cannot open '" << filename << "'." << std::endl;
+        fs_log("fs_open failed: handle table full.");
+        return -13;
+    }
+
+    fs_log(("fs_open: '" + std::string(filename) + "' opened as handle " + std::to_string(handle) +
+            " (slot " + std::to_string(file_index) + ").").c_str());
+    return handle;
+}
+
+int fs_close(int handle) {
+    Volume& volume = active_volume();
+    bool closed = false;
+    if (handle >= 0 && handle < FS_MAX_OPEN_FILES) {
+        std::lock_guard<std::mutex> lock(volume.file_handle_lock);
+        if (volume.file_handles[handle].in_use) {
+            volume.file_handles[handle] = FileHandleSlot(); // Geçersizleşmiş tutamaç da kapatılır
+            closed = true;
+        }
+    }
+    if (!closed) {
+        std::cerr << "Error (fs_close): Invalid file handle " << handle << "." << std::endl;
+        fs_log(("fs_close failed: invalid handle " + std::to_string(handle)).c_str());
+        return -12;
+    }
+    fs_log(("fs_close: handle " + std::to_string(handle) + " closed.").c_str());
+    return 0;
+}
+
+int64_t fs_hseek(int handle, int64_t offset, int whence) {
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    int file_index = -1;
+    int64_t position = 0;
+    if (!lookup_file_handle(handle, file_index, position)) {
+        std::cerr << "Error (fs_hseek): Invalid file handle " << handle << "." << std::endl;
+        fs_log(("fs_hseek failed: invalid handle " + std::to_string(handle)).c_str());
+        return -12;
+    }
+
+    int64_t base = 0;
+    if (whence == FS_SEEK_CUR) {
+        base = position;
+    } else if (whence == FS_SEEK_END) {
+        // Sadece boyut gerektiğinde dosyaya dokunulur: bekleyen yazma boyuttan hesaplanır, boşaltılmaz.
+        FileLockGuard file_guard(file_index, LOCK_MODE_SHARED);
+        FileInfo fi;
+        int status = load_handle_file_info(handle, file_index, fi);
+        if (status != 0) {
+            std::cerr << "Error (fs_hseek): File behind handle " << handle << " is no longer available." << std::endl;
+            fs_log(("fs_hseek failed: handle " + std::to_string(handle) + ", status " + std::to_string(status)).c_str());
+            return status;
+        }
+        base = buffered_file_size(file_index, fi.size);
+    } else if (whence != FS_SEEK_SET) {
+        std::cerr << "Error (fs_hseek): Unknown whence value " << whence << "." << std::endl;
+        fs_log("fs_hseek failed: unknown whence.");
+        return -2;
+    }
+
+    int64_t new_position = base + (offset < 0 ? offset : 0); // base >= 0: negatif ofset taşmaz
+    if ((offset > 0 && !checked_add_size(base, offset, new_position)) || new_position < 0) {
+        std::cerr << "Error (fs_hseek): Resulting position is out of range (base " << base << ", offset " << offset << ")." << std::endl;
+        fs_log("fs_hseek failed: position out of range.");
+        return -2;
+    }
+    set_file_handle_position(handle, file_index, new_position);
+    fs_log(("fs_hseek: handle " + std::to_string(handle) + " -> position " + std::to_string(new_position) + ".").c_str());
+    return new_position;
+}
+
+int64_t fs_hread(int handle, char* buffer, int64_t size) {
+    if (size < 0 || (buffer == nullptr && size > 0)) {
+        std::cerr << "Error (fs_hread): Invalid buffer or negative size (" << size << ")." << std::endl;
+        fs_log("fs_hread failed: invalid arguments.");
+        return -2;
+    }
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    int file_index = -1;
+    int64_t position = 0;
+    if (!lookup_file_handle(handle, file_index, position)) {
+        std::cerr << "Error (fs_hread): Invalid file handle " << handle << "." << std::endl;
+        fs_log(("fs_hread failed: invalid handle " + std::to_string(handle)).c_str());
+        return -12;
+    }
+    FileLockGuard file_guard(file_index, LOCK_MODE_SHARED, true); // Bekleyen yazma önce diske iner
+    FileInfo fi;
+    int status = load_handle_file_info(handle, file_index, fi);
+    if (status != 0) {
+        std::cerr << "Error (fs_hread): File behind handle " << handle << " is no longer available." << std::endl;
+        fs_log(("fs_hread failed: handle " + std::to_string(handle) + ", status " + std::to_string(status)).c_str());
+        return status;
+    }
+    if (size == 0 || position >= fi.size) {
+        return 0; // Dosya sonu
+    }
+
+    int64_t bytes_read = read_file_extent(fi, position, size, buffer);
+    if (bytes_read < 0) {
+        std::cerr << "Error (fs_hread): Failed to read " << size << " bytes at offset " << position << " through handle " << handle << "." << std::endl;
+        fs_log(("fs_hread failed: read error " + std::to_string(bytes_read) + " on handle " + std::to_string(handle)).c_str());
+        return bytes_read;
+    }
+    set_file_handle_position(handle, file_index, position + bytes_read);
+    fs_log(("fs_hread: handle " + std::to_string(handle) + " read " + std::to_string(bytes_read) + " bytes at offset " +
+            std::to_string(position) + ".").c_str());
+    return bytes_read;
+}
+
+// Dosyanın mevcut boyutu içindeki [offset, offset + length) aralığını yerinde yazar: ardışık bloklara düşen kısım ve
+// paketlenmiş kuyruğun kendi yuvasına düşen kısım tek toplu G/Ç ile, satır içi veri FileInfo kaydına. Yerleşim ve
+// boyut değişmez. Çağıran dosya kilidini özel tutar.
+bool overwrite_file_range(int file_index, FileInfo& fi, int64_t offset, const char* data, int64_t length) {
+    if (is_inline_file(fi)) {
+        Superblock sb;
+        read_all_file_info(sb);
+        if (sb.num_active_files == -1) return false;
+        memcpy(inline_data_ptr(fi) + offset, data, static_cast<size_t>(length));
+        return write_file_info_at_index(file_index, fi, sb);
+    }
+    int64_t block_bytes = block_backed_bytes(fi);
+    int64_t end = offset + length;
+    std::vector<BlockIoRequest> batch;
+    if (offset < block_bytes) {
+        batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(fi.start_data_block_index) * BLOCK_SIZE_BYTES + offset,
+                                       const_cast<char*>(data), static_cast<size_t>(std::min(end, block_bytes) - offset)));
+    }
+    if (end > block_bytes && has_packed_tail(fi)) {
+        int64_t from = std::max(offset, block_bytes);
+        batch.push_back(BlockIoRequest(METADATA_AREA_SIZE_BYTES + static_cast<off_t>(fi.tail_block_index) * BLOCK_SIZE_BYTES +
+                                       fi.tail_offset + (from - block_bytes),
+                                       const_cast<char*>(data + (from - offset)), static_cast<size_t>(end - from)));
+    }
+    return disk_io_batch(batch, true);
+}
+
+// Konumdaki yazma, ucuzdan pahalıya şu yollardan biriyle yapılır:
+//   - Konum dosya sonundaysa veri gecikmeli tahsis tamponuna eklenir (fs_append gibi; sıralı yazmalar birikir).
+//   - Aralık dosyanın mevcut boyutu içindeyse veri yerinde yazılır (bloklar, kuyruk yuvası veya satır içi kayıt).
+//   - Ön tahsisli alana sığıyorsa yerinde yazılır ve yalnızca boyut güncellenir.
+//   - Aksi halde (dosya büyüyor) içerik birleştirilip tutamacın indeksiyle yeniden yazılır.
+int64_t fs_hwrite(int handle, const char* data, int64_t size) {
+    if (data == nullptr && size > 0) {
+        std::cerr << "Error (fs_hwrite): Data is null but size is positive." << std::endl;
+        fs_log("fs_hwrite failed: null data with positive size.");
+        return -2;
+    }
+    if (size < 0) {
+        std::cerr << "Error (fs_hwrite): Size cannot be negative." << std::endl;
+        fs_log("fs_hwrite failed: negative size.");
+        return -3;
+    }
+    ensure_disk_initialized();
+    VolumeLockGuard volume_guard(LOCK_MODE_SHARED);
+    int file_index = -1;
+    int64_t position = 0;
+    if (!lookup_file_handle(handle, file_index, position)) {
+        std::cerr << "Error (fs_hwrite): Invalid file handle " << handle << "." << std::endl;
+        fs_log(("fs_hwrite failed: invalid handle " + std::to_string(handle)).c_str());
+        return -12;
+    }
+    FileLockGuard file_guard(file_index, LOCK_MODE_EXCLUSIVE);
+    if (!file_guard.held()) return FS_ERROR_LOCK_UPGRADE;
+    FileInfo fi;
+    int status = load_handle_file_info(handle, file_index, fi);
+    if (status != 0) {
+        std::cerr << "Error (fs_hwrite): File behind handle " << handle << " is no longer available." << std::endl;
+        fs_log(("fs_hwrite failed: handle " + std::to_string(handle) + ", status " + std::to_string(status)).c_str());
+        return status;
+    }
+    if (size == 0) return 0;
+
+    int64_t end = 0;
+    if (!checked_add_size(position, size, end)) {
+        std::cerr << "Error (fs_hwrite): Writing " << size << " bytes at offset " << position << " would overflow the 64-bit file size." << std::endl;
+        fs_log("fs_hwrite failed: size overflow.");
+        return -3;
+    }
+
+    if (blocks_needed_for_size(end) > static_cast<int64_t>(NUM_DATA_BLOCKS)) {
+        std::cerr << "Error (fs_hwrite): Writing up to offset " << end << " exceeds the volume size." << std::endl;
+        fs_log("fs_hwrite failed: write beyond volume capacity.");
+        return -3;
+    }
+
+    int64_t current_size = buffered_file_size(file_index, fi.size);
+    int64_t result = 0;
+    const char* path_taken = "append";
+    if (position == current_size) {
+        result = append_delayed(file_index, fi, current_size, data, size) == end ? size : -8;
+    } else {
+        // Diğer yollar diskteki içerik ve yerleşimle çalışır
+        if (has_delayed_write(file_index)) {
+            flush_delayed_write(file_index);
+            status = load_handle_file_info(handle, file_index, fi);
+            if (status != 0) return status;
+        }
+        int64_t new_size = std::max(fi.size, end);
+        if (end <= fi.size) {
+            path_taken = "in place";
+            result = overwrite_file_range(file_index, fi, position, data, size) ? size : -8;
+        } else if (position <= fi.size && has_reservation_for(fi, new_size)) {
+            path_taken = "preallocated";
+            Superblock sb;
+            std::vector<FileInfo> all_files = read_all_file_info(sb);
+            result = (sb.num_active_files != -1 && write_into_reservation(file_index, fi, sb, position, data, size, new_size)) ? size : -8;
+        } else {
+            // Dosya büyüyor: yeni yerleşim ardışık olduğu için içeriğin tamamı yeni alana yazılır.
+            path_taken = "rewrite";
+            Superblock sb;
+            std::vector<FileInfo> all_files = read_all_file_info(sb);
+            std::vector<char> combined(static_cast<size_t>(new_size)); // Dosya sonunun ötesindeki boşluk sıfır kalır
+            if (sb.num_active_files == -1 || (fi.size > 0 && read_file_extent(fi, 0, fi.size, &combined[0]) != fi.size)) {
+                result = -8;
+            } else {
+                memcpy(&combined[static_cast<size_t>(position)], data, static_cast<size_t>(size));
+                std::string path = build_full_path(all_files, file_index); // Yalnızca mesajlar için
+                result = write_file_at_index(all_files, sb, file_index, path.c_str(), &combined[0], new_size) == new_size ? size : -8;
+            }
+        }
+    }
+
+    if (result < 0) {
+        std::cerr << "Error (fs_hwrite): Failed to write " << size << " bytes at offset " << position << " through handle " << handle << "." << std::endl;
+        fs_log(("fs_hwrite failed: " + std::string(path_taken) + " write error on handle " + std::to_string(handle)).c_str());
+        return result;
+    }
+    set_file_handle_position(handle, file_index, end);
+    fs_log(("fs_hwrite: handle " + std::to_string(handle) + " wrote " + std::to_string(size) + " bytes at offset " +
+            std::to_string(position) + " (" + path_taken + ").").c_str());
+    return size;
+}
+
+// ------------- ASENKRON G/Ç (ASYNC I/O) -------------
+// fs_*_async çağrıları işi iç havuzdaki iş parçacıklarına bırakır ve hemen döner; sonuç bir future veya
+// tamamlanma geri çağrısıyla (havuz iş parçacığında) teslim edilir. İşler senkron fonksiyonları çağırır, yani
+// aynı kilit kuralları geçerlidir: farklı dosyaların (veya aynı dosyanın) okumaları üst üste biner, aynı
+// dosyaya yazmalar sırayla işlenir. Dosya adı kopyalanır; data/buffer ise iş tamamlanana kadar geçerli kalmalıdır.
+// Havuz tüm ciltlerde ortaktır: her iş gönderildiği cildi bağlayarak çalışır, bekleyen işler cilt başına sayılır.
+// Havuz ilk işte başlatılır; fs_unmount (ve FileSystem yıkıcısı) yalnızca kendi cildinin işlerinin bitmesini bekler.
+// Tamamlanma geri çağrıları G/Ç iş parçacıklarında değil, ayrı bir tamamlanma iş parçacığında sırayla çalışır: bir
+// geri çağrının başka bir işin future'ını beklemesi sabit sayıdaki G/Ç iş parçacıklarını tıkamaz. Havuzun herhangi
+// bir iş parçacığından cildin işlerini beklemek (fs_async_drain, fs_unmount) kendini beklemek olacağı için reddedilir.
+// Havuz dosyanın sonunda tanımlıdır: statikler ters sırada yok edildiği için kullandığı kilitlerden önce kapanır.
+
+static thread_local bool on_async_worker = false;
+
+class IoThreadPool {
+public:
+    IoThreadPool() : stopping_(false), workers_stopped_(false) {}
+    ~IoThreadPool() { shutdown(); }
+
+    // completion boş değilse iş bittikten sonra tamamlanma iş parçacığında çalışır; iş ancak o da bitince sayılmaz.
+    void submit(Volume& volume, const std::function<void()>& task, const std::function<void()>& completion = std::function<void()>()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (workers_.empty()) {
+            for (unsigned int i = 0; i < ASYNC_IO_THREADS; ++i) {
+                workers_.push_back(std::thread(&IoThreadPool::worker_loop, this));
+            }
+            completion_thread_ = std::thread(&IoThreadPool::completion_loop, this);
+            fs_log(("Async I/O pool started with " + std::to_string(ASYNC_IO_THREADS) + " threads.").c_str());
+        }
+        tasks_.push_back(PoolTask(&volume, task, completion));
+        pending_[&volume]++;
+        work_cv_.notify_one();
+    }
+
+    // Cildin kuyruktaki ve çalışan tüm işleri (geri çağrılar dahil) bitene kadar bekler. Havuz iş parçacığından
+    // çağrılırsa kendini bekleyeceği için false döner.
+    bool drain(Volume& volume) {
+        if (on_async_worker) return false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this, &volume] { return pending_.count(&volume) == 0; });
+        return true;
+    }
+
+    // Kuyruktaki işleri bitirir ve iş parçacıklarını durdurur (program çıkışı). Havuz iş parçacığından çağrılırsa bir şey yapmaz.
+    void shutdown() {
+        std::vector<std::thread> workers;
+        std::thread completion_thread;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (on_async_worker) return;
+            stopping_ = true;
+            workers.swap(workers_);
+            completion_thread.swap(completion_thread_);
+        }
+        work_cv_.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        // G/Ç iş parçacıkları durdu; tamamlanma iş parçacığı kalan geri çağrıları bitirip çıkar.
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers_stopped_ = true;
+        }
+        completion_cv_.notify_all();
+        if (completion_thread.joinable()) completion_thread.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        workers_stopped_ = false;
+        if (!workers.empty()) fs_log("Async I/O pool stopped.");
+    }
+
+private:
+    struct PoolTask {
+        PoolTask() : volume(nullptr) {}
+        PoolTask(Volume* v, const std::function<void()>& t, const std::function<void()>& c) : volume(v), task(t), completion(c) {}
+        Volume* volume;
+        std::function<void()> task;
+        std::function<void()> completion;
+    };
+
+    void worker_loop() {
+        on_async_worker = true;
+        while (true) {
+            PoolTask task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) return; // Durduruluyor ve kuyruk boş
+                std::swap(task, tasks_.front());
+                tasks_.pop_front();
+            }
+            {
+                VolumeBinding binding(*task.volume);
+                task.task();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (task.completion) {
+                completions_.push_back(task);
+                completion_cv_.notify_one();
+            } else {
+                finish(task.volume);
+            }
+        }
+    }
+
+    void completion_loop() {
+        on_async_worker = true;
+        while (true) {
+            PoolTask task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                completion_cv_.wait(lock, [this] { return workers_stopped_ || !completions_.empty(); });
+                if (completions_.empty()) return; // G/Ç iş parçacıkları durdu ve geri çağrı kalmadı
+                std::swap(task, completions_.front());
+                completions_.pop_front();
+            }
+            {
+                VolumeBinding binding(*task.volume);
+                task.completion();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            finish(task.volume);
+        }
+    }
+
+    // mutex_ tutulurken çağrılır.
+    void finish(Volume* volume) {
+        std::map<Volume*, int>::iterator it = pending_.find(volume);
+        if (--it->second == 0) {
+            pending_.erase(it);
+            idle_cv_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::condition_variable completion_cv_;
+    std::deque<PoolTask> tasks_;
+    std::deque<PoolTask> completions_; // İşi bitmiş, geri çağrısı bekleyenler
+    std::vector<std::thread> workers_;
+    std::thread completion_thread_;
+    bool stopping_;
+    bool workers_stopped_;
+    std::map<Volume*, int> pending_; // Cilt -> kuyruktaki ve çalışan iş sayısı
+};
+
+static IoThreadPool async_io_pool;
+
+// Sonucu bir future'a bağlanan işi havuza verir (std::function kopyalanabilir olmalı, packaged_task değil).
+template <typename Result>
+std::future<Result> submit_async(const std::function<Result()>& work) {
+    std::shared_ptr<std::packaged_task<Result()> > task = std::make_shared<std::packaged_task<Result()> >(work);
+    std::future<Result> result = task->get_future();
+    async_io_pool.submit(active_volume(), [task]() { (*task)(); });
+    return result;
+}
+
+std::future<int64_t> fs_read_async(const char* filename, int64_t offset, int64_t size, char* buffer) {
+    std::string path = filename ? filename : "";
+    return submit_async<int64_t>([path, offset, size, buffer]() { return read_file_range(path.c_str(), offset, size, buffer); });
+}
+
+std::future<int64_t> fs_write_async(const char* filename, const char* data, int64_t size) {
+    std::string path = filename ? filename : "";
+    return submit_async<int64_t>([path, data, size]() { return fs_write(path.c_str(), data, size); });
+}
+
+std::future<int> fs_sync_async() {
+    return submit_async<int>([]() { return fs_sync(); });
+}
+
+// İşi havuza, geri çağrıyı tamamlanma iş parçacığına verir; sonuç ikisi arasında paylaşılır.
+void submit_with_completion(const std::function<int64_t()>& work, const FsCompletion& on_complete) {
+    std::shared_ptr<int64_t> result = std::make_shared<int64_t>(0);
+    std::function<void()> completion;
+    if (on_complete) completion = [result, on_complete]() { on_complete(*result); };
+    async_io_pool.submit(active_volume(), [result, work]() { *result = work(); }, completion);
+}
+
+void fs_read_async(const char* filename, int64_t offset, int64_t size, char* buffer, const FsCompletion& on_complete) {
+    std::string path = filename ? filename : "";
+    submit_with_completion([path, offset, size, buffer]() { return read_file_range(path.c_str(), offset, size, buffer); }, on_complete);
+}
+
+void fs_write_async(const char* filename, const char* data, int64_t size, const FsCompletion& on_complete) {
+    std::string path = filename ? filename : "";
+    submit_with_completion([path, data, size]() { return fs_write(path.c_str(), data, size); }, on_complete);
+}
+
+int fs_async_drain() {
+    if (!async_io_pool.drain(active_volume())) {
+        fs_log("fs_async_drain refused: called on an async I/O pool thread.");
+        return FS_ERROR_ASYNC_WORKER;
+    }
+    return 0;
+}
@@ -3,8 +3,12 @@
 
 #include <string>
 #include <vector>
+#include <fstream> // Tahsis grubu yardımcılarının imzaları için
 #include <ctime> // Zaman bilgisi için
+#include <cstdint> // int64_t için (64-bit boyut ve offsetler)
 #include <sys/types.h> // off_t için
+#include <future> // Asenkron G/Ç sonuçları için
+#include <functional>
 
 // Disk ve Blok Sabitleri
 const unsigned int BLOCK_SIZE_BYTES = 512;           // Örnek: 512 Bytes
@@ -23,82 +27,473 @@ const unsigned int NUM_DATA_BLOCKS = TOTAL_DATA_AREA_SIZE / BLOCK_SIZE_BYTES;
 // Bitmap Hesaplamaları (Veri blokları için)
 const unsigned int BITMAP_SIZE_BYTES = (NUM_DATA_BLOCKS + 7) / 8; // Her bit bir veri bloğunu temsil eder, yukarı yuvarla.
 
+// Tahsis grupları (allocation groups): Veri alanı, her biri kendi bitmap dilimi, boş blok sayacı ve kilidi olan
+// gruplara bölünür. Küçük tahsisler tek bir grup içinde yapılır; farklı gruplardaki yazıcılar birbirini beklemez.
+const unsigned int ALLOCATION_GROUP_BLOCKS = 256; // 8'in katı olmalı: her grubun bitmap dilimi tam byte'lardan oluşur
+const unsigned int NUM_ALLOCATION_GROUPS = (NUM_DATA_BLOCKS + ALLOCATION_GROUP_BLOCKS - 1) / ALLOCATION_GROUP_BLOCKS;
+static_assert(ALLOCATION_GROUP_BLOCKS % 8 == 0, "ALLOCATION_GROUP_BLOCKS must be a multiple of 8");
+
+// Kalıcı grup özeti (metadata'da bitmap'ten hemen sonra, grup başına bir kayıt). Dolu grupları
+// bitmap'i taramadan atlamak için kullanılır.
+struct AllocationGroupSummary {
+    uint32_t free_blocks; // Gruptaki boş blok sayısı
+};
+const unsigned int GROUP_SUMMARY_TABLE_SIZE_BYTES = NUM_ALLOCATION_GROUPS * sizeof(AllocationGroupSummary);
+
+// Boyut sınıfları: Bu kadar veya daha az bloklu ardışık tahsisler veri alanının başından,
+// daha büyükleri sonundan yerleştirilir (bkz. find_and_allocate_contiguous_data_blocks).
+const unsigned int SMALL_ALLOCATION_MAX_BLOCKS = 8; // 8 * 512 B = 4 KB
+
+// Blok tahsis motorları (format sırasında seçilir, Superblock::allocator_mode'da saklanır)
+const int ALLOCATOR_BITMAP_FIRST_FIT = 0; // Bitmap taraması (boyut sınıfına göre baştan/sondan)
+const int ALLOCATOR_BUDDY = 1;            // Buddy sistemi: 2'nin kuvveti boyutlu, hizalı parçalar
+
+// Buddy allocator'ın en büyük mertebesi: 2^BUDDY_MAX_ORDER <= NUM_DATA_BLOCKS olan en büyük değer.
+constexpr int buddy_max_order_for(unsigned int num_blocks, int order = 0) {
+    return (2u << order) <= num_blocks ? buddy_max_order_for(num_blocks, order + 1) : order;
+}
+const int BUDDY_MAX_ORDER = buddy_max_order_for(NUM_DATA_BLOCKS);
+
 // Süperblok Yapısı (Basit)
+// Boş alan ve kullanım sayaçları. Tahsis, serbest bırakma ve FileInfo yazımlarında artımlı olarak
+// güncellenir; böylece boş alan sorgusu bitmap'i taramadan cevaplanır (bkz. fs_statfs).
+struct SpaceStats {
+    int64_t used_bytes;                 // Normal dosyaların toplam boyutu (mantıksal byte)
+    int64_t slack_bytes;                // İç parçalanma: dosya bloklarında kullanılmayan byte'lar
+    uint32_t free_blocks;               // Bitmap'teki boş blok sayısı
+    uint32_t largest_free_extent_hint;  // En büyük boş ardışık alan için üst sınır (tam taramalarda kesinleşir)
+    uint32_t free_extent_count;         // Dış parçalanma: boş ardışık alan sayısı
+    uint32_t fragmented_files;          // Verisi birden fazla yerde duran dosyalar (extent + paylaşılan kuyruk)
+
+    SpaceStats() : used_bytes(0), slack_bytes(0), free_blocks(0), largest_free_extent_hint(0),
+                   free_extent_count(0), fragmented_files(0) {}
+};
+
+// Artımlı birleştirmenin (fs_defragment_step) kalıcı ilerlemesi. Adımlar arasında ve yeniden açılışta
+// geçiş kaldığı yerden devam eder.
+struct DefragProgress {
+    uint32_t cursor;            // Bu bloğun öncesi bu geçişte sıkıştırıldı
+    uint32_t pass_active;       // 1: yarım kalmış bir geçiş var
+    uint32_t passes_completed;  // Tamamlanan geçiş sayısı
+    uint32_t files_moved;       // Toplam taşınan extent sayısı
+    int64_t bytes_moved;        // Toplam taşınan byte
+
+    DefragProgress() : cursor(0), pass_active(0), passes_completed(0), files_moved(0), bytes_moved(0) {}
+};
+
 struct Superblock {
     // int total_fileinfo_slots; // MAX_FILES_CALCULATED ile aynı olacak, belki gereksiz
     int num_active_files;       // Aktif (silinmemiş) dosya sayısı
+    int allocator_mode;         // ALLOCATOR_BITMAP_FIRST_FIT veya ALLOCATOR_BUDDY
+    SpaceStats stats;           // Sadece alan istatistiği yardımcıları tarafından yazılır
+    DefragProgress defrag;      // Sadece artımlı birleştirme tarafından yazılır
     // Gelecekte eklenebilir: unsigned int disk_size_total; unsigned int block_size_actual; 
     // unsigned int num_total_data_blocks; unsigned int actual_bitmap_size_bytes;
     // unsigned int file_info_array_offset_in_metadata; unsigned int max_file_entries;
 
-    Superblock() : num_active_files(0) {}
+    Superblock() : num_active_files(0), allocator_mode(ALLOCATOR_BITMAP_FIRST_FIT) {}
 };
 const unsigned int SUPERBLOCK_ACTUAL_SIZE = sizeof(Superblock); 
 
 // FileInfo ve Maksimum Dosya Sayısı Hesaplamaları
-const int MAX_FILENAME_LENGTH = 255; 
+const int MAX_FILENAME_LENGTH = 255; // Hem tam yol (path) hem de tek bir isim bileşeni için üst sınır
+
+// Dosya türleri (FileInfo::type)
+const unsigned char FILE_TYPE_REGULAR = 0;
+const unsigned char FILE_TYPE_DIRECTORY = 1;
+
+// Dizin ağacı sabitleri
+const char PATH_SEPARATOR = '/';
+const int ROOT_DIR_INDEX = 0; // Kök dizin her zaman FileInfo dizisinin ilk slotunda tutulur (fs_format oluşturur)
+
+// FileInfo::flags bitleri
+const unsigned char FILE_FLAG_INLINE_DATA = 0x01; // Veri, bloklarda değil FileInfo::name içindeki ismin arkasında (satır içi)
+const unsigned char FILE_FLAG_PREALLOCATED = 0x02; // Ardışık bloklar fs_fallocate ile ayrıldı; yazmalar bu alanı yerinde doldurur
+
+// Satır içi (inline) veri eşiği: Bu boyuta kadar olan normal dosyalar, isimden artan baytlara sığdığı sürece
+// veri bloğu kullanmaz. Böylece okuma sadece metadata okumasıyla biter. Dosya büyüyünce bloklara taşınır.
+const unsigned int INLINE_DATA_MAX_BYTES = 192;
+
+// Kuyruk paketleme (tail packing): Satır içine sığmayan dosyaların son bloğa düşen artığı (size % BLOCK_SIZE_BYTES)
+// bu eşikten küçükse tam bir blok yerine birden çok dosyanın paylaştığı bir kuyruk bloğunda (blok, ofset, uzunluk) tutulur.
+const unsigned int TAIL_PACK_MAX_BYTES = BLOCK_SIZE_BYTES / 2;
 
 struct FileInfo {
-    char name[MAX_FILENAME_LENGTH + 1]; 
-    int size;                           // Dosya boyutu (byte cinsinden)
+    char name[MAX_FILENAME_LENGTH + 1]; // Dizin içindeki isim (tam yol değil, sadece son bileşen). Satır içi dosyalarda NUL sonrası veri tutar.
+    int64_t size;                       // Dosya boyutu (byte cinsinden, 64-bit: 2 GB sınırı yok). Dizinlerde hash tablosunun boyutu.
     time_t creation_time;               
     bool is_used;                       
+    unsigned char type;                 // FILE_TYPE_REGULAR veya FILE_TYPE_DIRECTORY
+    unsigned char flags;                // FILE_FLAG_* bitleri (ör. FILE_FLAG_INLINE_DATA)
     
     off_t start_data_block_index;       // Veri alanındaki ilk bloğun indeksi (-1 ise blok yok)
     unsigned int num_data_blocks_used;  // Bu dosyanın kullandığı veri bloğu sayısı
 
-    FileInfo() : size(0), creation_time(0), is_used(false), 
-                 start_data_block_index(-1), num_data_blocks_used(0) {
+    int parent_index;                   // Üst dizinin FileInfo indeksi (kök için kendisi)
+    unsigned int dir_entry_count;       // Sadece dizinler: hash tablosundaki canlı girdi sayısı
+
+    // Paylaşılan kuyruk bloğundaki artık veri. Varsa dosyanın son tail_length byte'ı buradadır;
+    // ardışık bloklar (start_data_block_index, num_data_blocks_used) sadece tam blokları tutar.
+    int32_t tail_block_index;           // Kuyruk bloğunun indeksi (-1 ise kuyruk yok)
+    uint16_t tail_offset;               // Kuyruğun blok içindeki başlangıç ofseti
+    uint16_t tail_length;               // Kuyruk uzunluğu (byte)
+
+    // Yerleşim ipucu: Dosyanın blokları tahsis edilirken bu bloğa en yakın boş alan tercih edilir
+    // (-1 ise ipucu yok, boyut sınıfına göre normal yerleşim). Yapının sonundaki hizalama boşluğunu kullanır.
+    int32_t placement_goal;
+
+    FileInfo() : size(0), creation_time(0), is_used(false), type(FILE_TYPE_REGULAR), flags(0),
+                 start_data_block_index(-1), num_data_blocks_used(0),
+                 parent_index(ROOT_DIR_INDEX), dir_entry_count(0),
+                 tail_block_index(-1), tail_offset(0), tail_length(0), placement_goal(-1) {
         name[0] = '\0';
     }
 };
+
+// Dizin blokları: Her dizinin veri blokları, açık adresli (linear probing) bir hash tablosu tutar.
+// Girdi sadece isim hash'i ve çocuk FileInfo indeksini saklar; isim karşılaştırması FileInfo::name üzerinden yapılır.
+// Tablo kapasitesi her zaman 2'nin kuvveti kadar bloktur, doluluk 3/4'ü geçince iki katına büyütülür.
+struct DirEntry {
+    uint32_t name_hash; // FNV-1a (isim bileşeni üzerinden)
+    int32_t file_index; // Çocuğun FileInfo indeksi, DIR_ENTRY_EMPTY ise slot boş
+};
+const int32_t DIR_ENTRY_EMPTY = -1;
+const unsigned int DIR_ENTRIES_PER_BLOCK = BLOCK_SIZE_BYTES / sizeof(DirEntry);
 const unsigned int FILE_INFO_ENTRY_SIZE = sizeof(FileInfo);
 
 // Metadata içindeki elemanların başlangıç ofsetleri (metadata alanı başına göre relative)
 const unsigned int BITMAP_START_OFFSET_IN_METADATA = SUPERBLOCK_ACTUAL_SIZE;
-const unsigned int FILE_INFO_ARRAY_START_OFFSET_IN_METADATA = SUPERBLOCK_ACTUAL_SIZE + BITMAP_SIZE_BYTES;
+const unsigned int GROUP_SUMMARY_START_OFFSET_IN_METADATA = SUPERBLOCK_ACTUAL_SIZE + BITMAP_SIZE_BYTES;
+const unsigned int FILE_INFO_ARRAY_START_OFFSET_IN_METADATA = GROUP_SUMMARY_START_OFFSET_IN_METADATA + GROUP_SUMMARY_TABLE_SIZE_BYTES;
 
 // Kalan metadata alanını FileInfo'lar için hesapla
 // Önce FILE_INFO_ARRAY_START_OFFSET_IN_METADATA'nın METADATA_AREA_SIZE_BYTES'ı aşmadığından emin olmalıyız.
 const unsigned int FILE_INFO_ARRAY_USABLE_SIZE = (METADATA_AREA_SIZE_BYTES > FILE_INFO_ARRAY_START_OFFSET_IN_METADATA) ? (METADATA_AREA_SIZE_BYTES - FILE_INFO_ARRAY_START_OFFSET_IN_METADATA) : 0;
 const int MAX_FILES_CALCULATED = (FILE_INFO_ARRAY_USABLE_SIZE > 0 && FILE_INFO_ENTRY_SIZE > 0) ? (FILE_INFO_ARRAY_USABLE_SIZE / FILE_INFO_ENTRY_SIZE) : 0;
 
+// Gecikmeli tahsis: fs_write/fs_append verisi bellekte biriktirilir, bloklar sadece boşaltma (flush) anında,
+// son boyut bilindiğinde seçilir. Tüm dosyalardaki bekleyen veri bu sınırı aşınca hepsi diske yazılır.
+const unsigned int DELAYED_ALLOC_MAX_BUFFERED_BYTES = 64 * 1024;
+
+// Birleştirmede blok taşıma parçası: Taşımalar imaj içinde bu boyutta parçalarla (çakışmıyorsa çekirdek içi
+// copy_file_range, çakışıyorsa tek bir ortak ara tampon üzerinden pread/pwrite) yapılır.
+const unsigned int BLOCK_MOVE_CHUNK_BYTES = 4 * 1024 * 1024;
+
+// Asenkron G/Ç: fs_*_async işlerini yürüten iç havuzun iş parçacığı sayısı.
+const unsigned int ASYNC_IO_THREADS = 4;
+typedef std::function<void(int64_t)> FsCompletion; // Sonuç: byte sayısı veya negatif hata kodu
+
+// Blok G/Ç arka ucu: Veri bloklarının okuma/yazmaları toplu olarak io_uring ile (tek sistem çağrısı, kayıtlı
+// disk tanımlayıcısı ve ara tampon) veya pread/pwrite ile yapılır. io_uring kurulamazsa pread/pwrite'a düşülür.
+const int IO_BACKEND_PREAD = 0;
+const int IO_BACKEND_IO_URING = 1;
+const unsigned int URING_QUEUE_DEPTH = 32; // İş parçacığı başına halka derinliği
+const size_t URING_FIXED_BUFFER_BYTES = 64 * 1024; // Kayıtlı ara tampon; daha büyük toplu istekler çağıranın tamponunu kullanır
+
+// Blok aygıtı türleri: Tüm disk G/Ç'si fs_mount ile seçilen aygıttan geçer.
+const int BLOCK_DEVICE_BUFFERED_FILE = 0; // disk.sim üzerinde tamponlu std::fstream
+const int BLOCK_DEVICE_PREAD = 1;         // pread/pwrite, toplu veri G/Ç'si io_uring ile (varsayılan)
+const int BLOCK_DEVICE_MMAP = 2;          // disk.sim bellek eşlemeli
+const int BLOCK_DEVICE_DIRECT = 3;        // O_DIRECT, sayfa önbelleği atlanır
+const int BLOCK_DEVICE_RAM = 4;           // Görüntü yalnızca bellekte
+const int BLOCK_DEVICE_STRIPED = 5;       // Görüntü birden çok üye dosyaya şeritlenir, yalnızca paralel G/Ç için (fs_mount_striped)
+const size_t DIRECT_IO_ALIGNMENT = 4096;  // O_DIRECT ofset/boyut/tampon hizası (aynı zamanda önbellek sayfa boyutu)
+const size_t DIRECT_IO_CACHE_PAGES = 64;  // O_DIRECT aygıtının kendi sayfa önbelleği (çerçeve sayısı)
+const size_t DIRECT_IO_STAGING_BYTES = 64 * 1024; // Çok sayfalı O_DIRECT aktarımları için hizalı ara tampon
+
+// O_DIRECT aygıtının önbellek sayaçları (bağlandığından beri).
+struct DirectIoStats {
+    uint64_t cache_hits;     // Önbellekten karşılanan sayfa okumaları
+    uint64_t cache_misses;   // Diskten okunup önbelleğe alınan sayfalar
+    uint64_t rmw_reads;      // Kısmi yazma için diskten okunan sayfalar (önbellekte yoktu)
+    uint64_t pages_written;  // Diske yazılan sayfalar
+
+    DirectIoStats() : cache_hits(0), cache_misses(0), rmw_reads(0), pages_written(0) {}
+};
+
+// fs_mount_ram seçenekleri: RAM diski disk.sim yerine bellekteki bir tamponda çalışır.
+struct RamDiskOptions {
+    const char* load_image;  // Başlangıç görüntüsü (tam DISK_SIZE_BYTES, örn. fs_backup çıktısı); nullptr: boş formatlanır
+    const char* dump_image;  // fs_sync/fs_unmount/aygıt değişiminde görüntünün yazılacağı dosya (nullptr: yazılmaz)
+    bool anonymous_mmap;     // true: tampon anonim mmap ile, false: heap'ten ayrılır
+
+    RamDiskOptions() : load_image(nullptr), dump_image(nullptr), anonymous_mmap(false) {}
+};
+
+// fs_mount_striped seçenekleri: Şeritli aygıt yalnızca paralel G/Ç içindir, kapasite artırmaz. Tek bir disk görüntüsü
+// (DISK_SIZE_BYTES; yerleşim derleme zamanında sabittir) ayrı disklerde durabilen üye dosyalara şerit birimleri
+// halinde dağıtılır (s. birim s % N. üyede); her üye görüntünün yaklaşık 1/N'ini tutar ve büyük istekler üyelere
+// paralel gider. Üye sırası ve birim yerleşimi belirler: aygıt aynı liste ve birimle yeniden bağlanmalıdır.
+const unsigned int STRIPE_MAX_MEMBERS = 16;
+const uint32_t STRIPE_UNIT_DEFAULT_BYTES = 64 * 1024;
+struct StripedDeviceOptions {
+    std::vector<std::string> members;  // Üye görüntü dosyaları (hiçbiri yoksa oluşturulup cilt formatlanır)
+    uint32_t stripe_unit_bytes;        // Şerit birimi; BLOCK_SIZE_BYTES'ın katı, en fazla DISK_SIZE_BYTES
+
+    StripedDeviceOptions() : stripe_unit_bytes(STRIPE_UNIT_DEFAULT_BYTES) {}
+};
+
 // Kullanıcı arayüzü için tampon boyutları
 const int MAX_FILE_SIZE_FOR_USER_INPUT = 4 * 1024; // Kullanıcının tek seferde girebileceği/okuyabileceği maks. veri (4KB)
 
+// fs_statfs sonucu: Süperbloktaki sayaçlardan türetilir, bitmap taranmaz.
+struct FsStatfs {
+    uint32_t total_blocks;
+    uint32_t free_blocks;
+    uint32_t used_blocks;
+    uint32_t largest_free_extent_hint;  // Üst sınır; fs_defragment ve büyük tahsislerden sonra kesindir
+    uint32_t free_extent_count;
+    uint32_t fragmented_files;
+    int64_t free_bytes;
+    int64_t used_bytes;                 // Normal dosyaların mantıksal boyutlarının toplamı
+    int64_t slack_bytes;
+    int num_active_files;
+    int max_files;                      // Kök dizin hariç kullanılabilir FileInfo slotu
+    int fragmentation_percent;          // 100 - (en büyük boş alan / toplam boş alan) * 100
+    int64_t buffered_bytes;             // Gecikmeli tahsis tamponunda bekleyen, henüz diske yazılmamış byte
+    int buffered_files;                 // Bekleyen yazması olan dosya sayısı
+};
+
+// En az taşımalı birleştirme planlayıcısı hedefleri (fs_plan_defrag / fs_defragment_to_target)
+const int DEFRAG_TARGET_FREE_EXTENT = 0;        // En büyük boş alan en az min_free_extent_blocks blok olsun
+const int DEFRAG_TARGET_ZERO_FRAGMENTATION = 1; // Tüm boş alan tek bir parça olsun
+
+// Planın tek bir taşıması. file_index -1 ise taşınan, birden çok dosyanın kuyruğunu tutan paylaşılan kuyruk bloğudur.
+struct DefragMove {
+    int file_index;
+    int from_block;
+    int to_block;
+    int num_blocks;
+};
+
+struct DefragPlan {
+    int target;
+    uint32_t min_free_extent_blocks;     // DEFRAG_TARGET_FREE_EXTENT için istenen; sıfır parçalanmada toplam boş blok
+    std::string strategy;                // "none", "window", "compact-front" veya "compact-back"
+    std::vector<DefragMove> moves;
+    int64_t bytes_to_move;               // Planın kopyalayacağı byte
+    int64_t full_compaction_bytes;       // Her şeyi başa sıkıştırmanın (fs_defragment) kopyalayacağı byte, karşılaştırma için
+    uint32_t largest_free_extent_before;
+    uint32_t largest_free_extent_after;
+
+    DefragPlan() : target(DEFRAG_TARGET_ZERO_FRAGMENTATION), min_free_extent_blocks(0), bytes_to_move(0),
+                   full_compaction_bytes(0), largest_free_extent_before(0), largest_free_extent_after(0) {}
+};
+
+// Parçalanma raporu (fs_frag_report): Bitmap ve dosya tablosu üzerinden tek geçişte hesaplanır.
+// Boş parça histogramında kova i, uzunluğu [2^i, 2^(i+1)) blok olan boş parçaları sayar.
+const int FRAG_HISTOGRAM_BUCKETS = 16;
+const int FRAG_REPORT_NONE = 0; // Sadece report_out doldurulur
+const int FRAG_REPORT_TEXT = 1; // Okunabilir tablo (std::cout)
+const int FRAG_REPORT_JSON = 2; // Tek satır JSON (std::cout), betikler/izleme için
+const int FRAG_DEFRAG_RECOMMENDED_SCORE = 30; // Skor bu değer ve üstündeyse birleştirme önerilir
+
+struct FileFragInfo {
+    std::string path;
+    unsigned char type;            // FILE_TYPE_REGULAR veya FILE_TYPE_DIRECTORY
+    int64_t size;
+    uint32_t data_blocks;
+    uint32_t extent_count;         // Ardışık blok grubu + varsa paylaşılan kuyruk bloğu (satır içi dosya: 0)
+    int64_t wasted_tail_bytes;     // Son tam bloğun kullanılmayan kısmı (fs_statfs'teki slack ile aynı tanım)
+};
+
+struct FragReport {
+    uint32_t total_blocks;
+    uint32_t free_blocks;
+    uint32_t free_extent_count;
+    uint32_t largest_free_extent;  // Kesin değer (bitmap taranır), fs_statfs'teki gibi bir üst sınır değil
+    uint32_t free_extent_histogram[FRAG_HISTOGRAM_BUCKETS];
+    std::vector<FileFragInfo> files;
+    uint32_t fragmented_files;     // Birden fazla extent'e bölünmüş dosya sayısı
+    int64_t wasted_tail_bytes;
+    int free_space_fragmentation;  // 0-100: 100 - (en büyük boş alan / toplam boş alan) * 100
+    int file_fragmentation;        // 0-100: blok kullanan dosyalar içinde bölünmüş olanların oranı
+    int score;                     // 0-100: (3 * boş alan + dosya) / 4; birleştirme ağırlıkla boş alanı düzeltir
+    bool defrag_recommended;       // score >= FRAG_DEFRAG_RECOMMENDED_SCORE ve birden fazla boş parça var
+
+    FragReport() : total_blocks(0), free_blocks(0), free_extent_count(0), largest_free_extent(0), fragmented_files(0),
+                   wasted_tail_bytes(0), free_space_fragmentation(0), file_fragmentation(0), score(0), defrag_recommended(false) {
+        for (int i = 0; i < FRAG_HISTOGRAM_BUCKETS; ++i) free_extent_histogram[i] = 0;
+    }
+};
+
+// Yerleşim ipucu (fs_create/fs_write/fs_set_placement_hint). near_file verilirse dosya o dosyanın hemen
+// arkasına yerleştirilmeye çalışılır (birlikte okunan veri + indeks dosyası gibi); verilmezse goal_block kullanılır.
+// İpucu dosyanın FileInfo'sunda saklanır ve sonraki tüm tahsislerde (ekleme, gecikmeli boşaltma) geçerlidir.
+struct AllocationHint {
+    int64_t goal_block;     // Tercih edilen veri bloğu (-1: yok)
+    const char* near_file;  // Yakınına yerleştirilecek dosyanın yolu (nullptr: yok)
+
+    AllocationHint() : goal_block(-1), near_file(nullptr) {}
+};
+
 // Fonksiyon Bildirimleri
+// Tüm fs_* fonksiyonları thread-safe: ad alanı/birim işlemleri birim kilidini özel,
+// dosya içi işlemler paylaşımlı birim kilidi + dosya başına okuyucu/yazıcı kilidi alır.
+// Paylaşımlı kilit tutulurken (ör. bir fs_* çağrısının içinden) özel kilit isteyen çağrı reddedilir: hata loglanır,
+// int döndürenler FS_ERROR_LOCK_UPGRADE döndürür.
+const int FS_ERROR_LOCK_UPGRADE = -20;
+// Asenkron havuzun iş parçacığında (iş veya geri çağrı içinde) cildin işlerini beklemesi gereken çağrılar
+// (fs_async_drain, fs_unmount, fs_mount*) kendilerini bekleyeceklerinden reddedilir ve bu kodu döndürür.
+const int FS_ERROR_ASYNC_WORKER = -21;
 void fs_init(); // Diski başlatır, yoksa oluşturur
-void fs_format();
+void fs_format(int allocator_mode = ALLOCATOR_BITMAP_FIRST_FIT); // Tahsis motoru format sırasında seçilir
+int fs_get_allocator_mode(); // Superblock'taki tahsis motoru, okunamazsa -1
 void fs_create(const char* filename);
+void fs_create(const char* filename, const AllocationHint& hint); // İpuçlu oluşturma
 void fs_delete(const char* filename);
-int fs_write(const char* filename, const char* data, int size);
-void fs_read(const char* filename, int offset, int size, char* buffer);
+int64_t fs_write(const char* filename, const char* data, int64_t size);
+int64_t fs_write(const char* filename, const char* data, int64_t size, const AllocationHint& hint); // Kodlar fs_write ile aynı, ipucu geçersizse -11; yazma başarısızsa ipucu geri alınır
+int fs_set_placement_hint(const char* filename, const AllocationHint& hint); // 0: başarılı, <0: hata
+void fs_read(const char* filename, int64_t offset, int64_t size, char* buffer);
 void fs_ls();
 void fs_rename(const char* old_name, const char* new_name);
 bool fs_exists(const char* filename);
-int fs_size(const char* filename);
-void fs_append(const char* filename, const char* data, int size);
-void fs_truncate(const char* filename, int new_size);
+int64_t fs_size(const char* filename);
+void fs_append(const char* filename, const char* data, int64_t size);
+void fs_truncate(const char* filename, int64_t new_size);
+int fs_fallocate(const char* filename, int64_t size); // size byte için ardışık blok ayırır (dosya boyutu değişmez). 0: başarılı, <0: hata
 void fs_copy(const char* src_filename, const char* dest_filename);
 void fs_mv(const char* old_path, const char* new_path);
+void fs_mkdir(const char* path);
+void fs_rmdir(const char* path);
+int fs_readdir(const char* path, std::vector<std::string>& entries_out); // 0: başarılı, <0: hata
+bool fs_is_directory(const char* path);
 void fs_defragment();
+// Artımlı (çevrimiçi) birleştirme: extent'leri sırayla diskin başına kaydırır; adım, taşınan byte veya süre
+// bütçesi dolunca biter (0: sınırsız). 1: geçiş tamamlandı, 0: devam edecek iş var, <0: hata
+int fs_defragment_step(int64_t max_bytes_moved, int max_millis);
+int fs_defrag_start_background(int64_t bytes_per_step, int max_millis_per_step, int pause_millis); // 0: başladı, <0: hata
+void fs_defrag_stop_background(); // Arka plan iş parçacığını durdurur ve bekler (çalışmıyorsa bir şey yapmaz)
+bool fs_defrag_background_running();
+bool fs_get_defrag_progress(DefragProgress& progress_out);
+int fs_plan_defrag(int target, uint32_t min_free_extent_blocks, DefragPlan& plan_out); // 0: plan hazır, <0: hedef ulaşılamaz/hata
+int fs_defragment_to_target(int target, uint32_t min_free_extent_blocks, bool dry_run); // Planı raporlar, dry_run değilse uygular. 0: başarılı
+int fs_frag_report(FragReport& report_out, int output_format = FRAG_REPORT_NONE); // 0: başarılı, <0: hata
 void fs_check_integrity();
+int fs_statfs(FsStatfs& stats_out); // 0: başarılı, <0: hata. Boş alan izleme için ucuz (O(1)) sorgu
+int fs_sync(); // Bekleyen (gecikmeli tahsisli) yazmaları ve bellekteki tahsis durumunu (bitmap, grup özetleri, alan sayaçları) diske yazar. 0: başarılı, <0: en az biri yazılamadı
+int fs_unmount(); // fs_sync + bellekteki tahsis durumunu bırakır (programdan çıkmadan önce çağrılmalı)
 int fs_backup(const char* backup_filename);
 void fs_restore(const char* backup_filename);
 void fs_cat(const char* filename);
 int fs_diff(const char* filename1, const char* filename2);
 void fs_log(const char* message); // Loglama için basit bir fonksiyon
+void fs_set_log_file(const char* path); // Cildin log dosyasını değiştirir; nullptr veya "" loglamayı kapatır
+
+// Tutamaç tabanlı G/Ç: fs_open yolu bir kez çözer ve küçük bir tamsayı tutamaç döndürür. Tutamaç FileInfo indeksini,
+// kaydın önbellekteki kopyasını (ardışık bloklar, kuyruk, satır içi veri) ve konumu tutar; fs_hread, fs_hwrite ve
+// fs_hseek yol çözmez. Önbellek yalnızca dosyanın kaydı başka bir işlemle değiştiyse o tek kayıttan tazelenir.
+// Tutamaçlar cilde aittir ve fs_rename/fs_mv sonrasında geçerli kalır. Dosya silinirse veya cilt formatlanır, geri
+// yüklenir ya da yeniden bağlanırsa tutamaç geçersizleşir (-12); yine de fs_close ile kapatılmalıdır.
+const int FS_MAX_OPEN_FILES = 64; // Cilt başına açık tutamaç sayısı
+const int FS_SEEK_SET = 0;
+const int FS_SEEK_CUR = 1;
+const int FS_SEEK_END = 2;
+int fs_open(const char* filename); // Tutamaç (>= 0); -1 geçersiz ad, -4 metadata okunamadı, -5 yok, -10 dizin, -13 tablo dolu
+int fs_close(int handle); // 0: başarılı, -12: geçersiz tutamaç
+int64_t fs_hread(int handle, char* buffer, int64_t size); // Konumdan okur ve ilerletir; okunan byte, dosya sonunda 0. NUL eklenmez
+int64_t fs_hwrite(int handle, const char* data, int64_t size); // Konuma yazar ve ilerletir; dosya sonunun ötesindeki boşluk sıfırlanır
+int64_t fs_hseek(int handle, int64_t offset, int whence); // Yeni konum; -2: geçersiz whence veya negatif konum, -12: geçersiz tutamaç
+
+// Asenkron G/Ç: iş havuza verilir, çağrı hemen döner. Dosya adı kopyalanır; buffer/data iş bitene kadar geçerli
+// kalmalıdır. Sonuç senkron karşılığınınkidir (okumada okunan byte sayısı, 0 dahil). Geri çağrılar G/Ç iş
+// parçacıklarını tutmamak için ayrı bir tamamlanma iş parçacığında sırayla çalışır; içinde başka bir async işin
+// future'ı beklenebilir, ama o sırada diğer geri çağrılar bekler.
+std::future<int64_t> fs_read_async(const char* filename, int64_t offset, int64_t size, char* buffer);
+std::future<int64_t> fs_write_async(const char* filename, const char* data, int64_t size);
+std::future<int> fs_sync_async();
+void fs_read_async(const char* filename, int64_t offset, int64_t size, char* buffer, const FsCompletion& on_complete);
+void fs_write_async(const char* filename, const char* data, int64_t size, const FsCompletion& on_complete);
+int fs_async_drain(); // Cildin kuyruktaki ve çalışan asenkron işleri (geri çağrılar dahil) bitene kadar bekler; 0 veya FS_ERROR_ASYNC_WORKER
+
+// Cildin blok G/Ç arka ucu seçimi. fs_get_io_backend, cildin (hangi iş parçacığından yapılmış olursa olsun) son toplu
+// veri G/Ç'sinde fiilen kullanılan yolu döndürür (io_uring istenip kurulamadıysa IO_BACKEND_PREAD).
+void fs_set_io_backend(int backend);
+int fs_get_io_backend();
+
+// Blok aygıtı seçimi. fs_mount mevcut aygıtı boşaltıp kapatır ve istenen türü bağlar; 0 veya negatif hata kodu
+// döndürür (-1 bilinmeyen tür, -2 aygıt açılamadı; bu durumda önceki tür kalır). BLOCK_DEVICE_STRIPED son
+// fs_mount_striped seçenekleriyle yeniden bağlanır (hiç yapılandırılmadıysa -1).
+int fs_mount(int device_type);
+int fs_mount_ram(const RamDiskOptions& options); // -2: tampon ayrılamadı veya görüntü yüklenemedi (bağlı aygıt değişmez)
+int fs_mount_striped(const StripedDeviceOptions& options); // -1: geçersiz seçenek, -2: üyeler açılamadı (eksik üye, yanlış boyut)
+int fs_get_block_device();
+bool fs_get_direct_io_stats(DirectIoStats& stats_out); // false: bağlı aygıt BLOCK_DEVICE_DIRECT değil (veya henüz açılmadı)
+
+// ------------- ÇOKLU CİLT (FileSystem) -------------
+// Her FileSystem kendi disk görüntüsünü ve log dosyasını, blok aygıtını, kilitlerini, önbelleklerini ve tahsis
+// durumunu sahiplenir; bir süreç birbirinden bağımsız çok sayıda cilde hizmet verebilir. fs_* fonksiyonları çağıran
+// iş parçacığının bağlı olduğu cilt üzerinde çalışır; bağlama yoksa varsayılan cilt (DISK_FILENAME, LOG_FILENAME,
+// FileSystem::default_instance()) kullanılır. Bir cilt üzerinde çalışmak için:
+//     FileSystem tenant("tenant1.sim", "tenant1.log");
+//     tenant.call([] { fs_create("/a.txt"); });                   // Tek çağrı
+//     { FileSystem::Scope scope(tenant); fs_write(...); ... }      // Blok boyunca
+// Asenkron G/Ç havuzu tüm ciltlerde ortaktır; işler gönderildikleri cilde bağlı çalışır. Ciltler ayrı görüntü
+// dosyaları kullanmalıdır.
+class Volume; // fs.cpp
+class FileSystem {
+public:
+    explicit FileSystem(const char* disk_filename, const char* log_filename = nullptr); // log_filename nullptr: log kapalı
+    // Arka plan birleştirmesini durdurur, cildin asenkron işlerini bekler, bekleyenleri yazıp aygıtı kapatır. Havuz
+    // iş parçacığında yok edilirse bekleyemez: hata loglanır ve cilt (kuyruktaki işler kullanabileceği için) serbest
+    // bırakılmaz.
+    ~FileSystem();
+    static FileSystem& default_instance();
+    const char* disk_filename() const;
+
+    // İş parçacığını yaşam süresi boyunca cilde bağlar; iç içe kullanılabilir, yıkıcı önceki bağlamayı geri yükler.
+    class Scope {
+    public:
+        explicit Scope(FileSystem& file_system);
+        explicit Scope(Volume& volume);
+        ~Scope();
+
+    private:
+        void bind(Volume& volume);
+        Volume* previous_;
+        int saved_volume_mode_;               // Başka bir cildin kilitleri tutulurken bağlandıysa, tutulan kipler
+        std::vector<int> saved_file_modes_;
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    // Fonksiyonu (fs_* çağıran bir lambda) bu cilde bağlı çalıştırır ve sonucunu döndürür.
+    template <typename Function>
+    auto call(Function function) -> decltype(function()) {
+        Scope scope(*this);
+        return function();
+    }
+
+private:
+    explicit FileSystem(Volume* volume); // Varsayılan cildi saran, sahiplenmeyen örnek
+    Volume* volume_;
+    bool owns_volume_;
+    FileSystem(const FileSystem&);
+    FileSystem& operator=(const FileSystem&);
+};
 
 // Debug/Test için yardımcı fonksiyon
 FileInfo fs_get_file_info_debug(const char* filename);
 
 // Bitmap Yönetimi Yardımcı Fonksiyonları
+class DiskStream; // Bağlı blok aygıtı üzerinde fstream benzeri akış (fs.cpp)
 int find_free_data_block();
 void free_data_block(int block_index);
-int find_and_allocate_contiguous_data_blocks(int num_blocks_to_find);
+int find_and_allocate_contiguous_data_blocks(int num_blocks_to_find, int goal_block = -1); // goal_block: en yakın boş alan tercih edilir
+void buddy_invalidate_free_lists(); // Bitmap toptan yeniden yazıldığında bellekteki buddy listelerini düşürür
+void allocation_state_invalidate(); // Aynısı, bellekteki bitmap kopyaları, grup özetleri ve alan sayaçları için (diske yazmaz; cilt kilidi özel tutulmalı)
+bool persist_allocation_state(); // Bellekteki bitmap, grup özetleri ve alan sayaçlarını diske yazar (fs_sync; cilt kilidi özel tutulmalı)
+bool rebuild_group_summaries(DiskStream& disk_file, const char* bitmap); // Grup özetlerini bitmap'ten yeniden yazar
+bool fs_get_group_summaries(std::vector<AllocationGroupSummary>& summaries_out); // Grup özetlerinin güncel (bellekteki) değerleri
+void account_file_info_change(DiskStream& disk_file, const FileInfo& old_fi, const FileInfo& new_fi); // Kullanım sayaçlarını günceller
+void discard_delayed_write(int file_index); // Dosyanın bekleyen (gecikmeli tahsisli) yazmasını diske yazmadan atar
+void discard_all_delayed_writes(); // Disk görüntüsü değiştiğinde (format/restore) tüm bekleyen yazmaları atar
+bool move_blocks_in_image(int from_block, int to_block, int num_blocks); // Çakışmaya dayanıklı toplu blok kopyalama (birleştirme)
 
 // Diğer Yardımcı Fonksiyonlar (Metadata okuma vb.)
 std::vector<FileInfo> read_all_file_info(Superblock& sb_out); // Superblock bilgisini de döndürür/günceller
+int resolve_path(const std::vector<FileInfo>& all_files, const char* path); // Yolu FileInfo indeksine çözer, yoksa -1
 int fs_count_active_files(); // Aktif dosya sayısını Superblock'tan okur
 int fs_get_num_blocks_used(const char* filename); // Dosyanın kullandığı blok sayısını FileInfo'dan okur
 
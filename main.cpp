@@ -5,6 +5,11 @@
 #include <set>      // Benzersiz blokları saymak için
 #include <fstream>  // std::fstream için eklendi
 #include <cstdio>   // std::remove için eklendi (backup dosyasını silmek için)
+#include <cstring>  // strlen, strcmp, memset vb. için
+#include <limits>   // std::numeric_limits için (cin.ignore)
+#include <thread>   // Eşzamanlı erişim testi için
+#include <atomic>
+#include <iterator> // std::istreambuf_iterator (disk görüntüsünü karşılaştırmak için)
 
 // Bitmap testleri için fs.hpp'den bazı sabitlere erişim gerekebilir
 // Eğer fs.hpp içinde değillerse, burada tanımlamamız veya fs.hpp'ye eklememiz gerekebilir.
@@ -303,8 +308,12 @@ void test_file_write_operations() {
         fs_create(filename_buf);
         
         if (!fs_exists(filename_buf)) {
-            std::cout << "    [FAILURE] Dosya " << filename_buf << " oluşturulamadı! (MAX_FILES_CALCULATED limitine ulaşılmış olabilir)" << std::endl;
-            std::cout << "    Mevcut dosya sayısı üst sınırı (MAX_FILES_CALCULATED): " << MAX_FILES_CALCULATED << std::endl;
+            // Kök dizin ROOT_DIR_INDEX slotunu kullanır: kullanıcıya MAX_FILES_CALCULATED - 1 slot kalır.
+            if (i == MAX_FILES_CALCULATED - 1) {
+                std::cout << "    [SUCCESS] FileInfo tablosu doldu: " << i << " dosya (MAX_FILES_CALCULATED - 1, kök dizin bir slot kullanır) oluşturuldu." << std::endl;
+            } else {
+                std::cout << "    [FAILURE] Dosya " << filename_buf << " oluşturulamadı! (Beklenen kullanıcı dosyası sınırı: " << MAX_FILES_CALCULATED - 1 << ")" << std::endl;
+            }
             fs_ls();
             break; 
         }
@@ -974,6 +983,23 @@ void test_file_append_operations() {
     }
     delete[] read_buffer;
 
+    // Test 8: 64-bit boyut taşması (old_size + size int64_t sınırını aşmamalı)
+    std::cout << "\n-----------------------------------------------------" << std::endl;
+    std::cout << "[Test 8: 64-bit Boyut Taşması Kontrolü]" << std::endl;
+    std::cout << "-----------------------------------------------------" << std::endl;
+    int64_t size_before_overflow = fs_size(file_block_span);
+    const int64_t huge_size = std::numeric_limits<int64_t>::max();
+    std::cout << "  ACTION: fs_append(\"" << file_block_span << "\", \"x\", INT64_MAX) çağrılıyor... Beklenen: Hata (taşma)." << std::endl;
+    fs_append(file_block_span, "x", huge_size); // Taşma kontrolü veriye dokunmadan reddetmeli
+    if (fs_size(file_block_span) == size_before_overflow) {
+        std::cout << "    [SUCCESS] Taşma reddedildi, boyut değişmedi (" << size_before_overflow << ")." << std::endl;
+    } else {
+        std::cout << "    [FAILURE] Taşma sonrası boyut değişti: " << fs_size(file_block_span) << std::endl;
+    }
+    std::cout << "  ACTION: fs_write(\"" << file_block_span << "\", \"x\", INT64_MAX) çağrılıyor... Beklenen: Hata (-6)." << std::endl;
+    int64_t huge_write_res = fs_write(file_block_span, "x", huge_size);
+    std::cout << "    fs_write sonucu: " << huge_write_res << " (Beklenen: -6)" << std::endl;
+
     std::cout << "\n--- Dosya Ekleme İşlemleri Testleri Tamamlandı ---" << std::endl;
 }
 
@@ -1887,6 +1913,1901 @@ void test_diff_operations() {
     std::cout << "\n--- Dosya Karşılaştırma (fs_diff) Testleri Tamamlandı ---" << std::endl;
 }
 
+void test_directory_operations() {
+    std::cout << "\n--- Dizin (mkdir/rmdir/readdir/mv) İşlemleri Testleri Başlıyor ---" << std::endl;
+    fs_format();
+
+    // Test 1: İç içe dizin oluşturma ve yol çözümleme
+    std::cout << "\n[Test 1: İç İçe Dizin ve Dosya Oluşturma]" << std::endl;
+    fs_mkdir("/docs");
+    fs_mkdir("/docs/notes");
+    fs_create("/docs/notes/a.txt");
+    fs_write("/docs/notes/a.txt", "hello dirs", 10);
+    fs_create("top.txt"); // Baştaki '/' olmadan da kök dizine göre çözülür
+    if (fs_is_directory("/docs/notes") && fs_exists("/docs/notes/a.txt") && fs_size("docs/notes/a.txt") == 10 && fs_exists("/top.txt")) {
+        std::cout << "  [SUCCESS] Dizinler ve dosyalar yol ile çözülebiliyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Yol çözümleme beklendiği gibi çalışmadı!" << std::endl;
+    }
+    std::cout << "  ACTION: Var olmayan dizinde dosya oluşturma (hata bekleniyor)..." << std::endl;
+    fs_create("/nope/b.txt");
+    std::cout << "  ACTION: Dosyanın altında dosya oluşturma (hata bekleniyor)..." << std::endl;
+    fs_create("/top.txt/c.txt");
+    fs_ls();
+
+    // Test 2: readdir
+    std::cout << "\n[Test 2: fs_readdir]" << std::endl;
+    std::vector<std::string> entries;
+    int rd = fs_readdir("/", entries);
+    std::cout << "  '/' içeriği (" << rd << "):";
+    for (const auto& e : entries) std::cout << " " << e;
+    std::cout << std::endl;
+    if (rd == 0 && entries.size() == 2 && entries[0] == "docs/" && entries[1] == "top.txt") {
+        std::cout << "  [SUCCESS] Kök dizin içeriği doğru." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Kök dizin içeriği beklenmedik!" << std::endl;
+    }
+
+    // Test 3: Alt ağacı taşıma (O(1) relink) ve içerik korunması
+    std::cout << "\n[Test 3: Alt Ağaç Taşıma (fs_mv)]" << std::endl;
+    fs_mkdir("/archive");
+    fs_mv("/docs/notes", "/archive"); // Var olan dizine taşı: /archive/notes
+    char buf[32];
+    memset(buf, 0, sizeof(buf));
+    fs_read("/archive/notes/a.txt", 0, 10, buf);
+    if (!fs_exists("/docs/notes") && strcmp(buf, "hello dirs") == 0) {
+        std::cout << "  [SUCCESS] Alt ağaç taşındı, içerik korundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Alt ağaç taşıma başarısız! Okunan: '" << buf << "'" << std::endl;
+    }
+    std::cout << "  ACTION: Dizini kendi alt ağacına taşıma (hata bekleniyor)..." << std::endl;
+    fs_mv("/archive", "/archive/notes/inner");
+    fs_rename("/archive/notes/a.txt", "renamed.txt"); // Aynı dizinde yeniden adlandırma
+    std::cout << "  Yeniden adlandırma sonrası var mı? " << (fs_exists("/archive/notes/renamed.txt") ? "EVET" : "HAYIR") << " (Beklenen: EVET)" << std::endl;
+
+    // Test 4: rmdir
+    std::cout << "\n[Test 4: fs_rmdir]" << std::endl;
+    std::cout << "  ACTION: Boş olmayan dizini silme (hata bekleniyor)..." << std::endl;
+    fs_rmdir("/archive/notes");
+    fs_delete("/archive/notes/renamed.txt");
+    fs_rmdir("/archive/notes");
+    fs_rmdir("/docs");
+    std::cout << "  '/archive/notes' var mı? " << (fs_exists("/archive/notes") ? "EVET" : "HAYIR") << " (Beklenen: HAYIR)" << std::endl;
+
+    // Test 5: Büyük dizin - hash tablosu büyümesi
+    std::cout << "\n[Test 5: Dizin Tablosu Büyümesi]" << std::endl;
+    fs_format();
+    fs_mkdir("/many");
+    int created = 0;
+    for (int i = 0; i < MAX_FILES_CALCULATED - 2; ++i) {
+        std::string name = "/many/f" + std::to_string(i);
+        fs_create(name.c_str());
+        if (fs_exists(name.c_str())) created++;
+    }
+    entries.clear();
+    fs_readdir("/many", entries);
+    std::cout << "  Oluşturulan: " << created << ", readdir: " << entries.size() << std::endl;
+    if (static_cast<int>(entries.size()) == created) {
+        std::cout << "  [SUCCESS] Tüm girdiler dizin tablosunda bulundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Dizin tablosu girdi sayısı tutarsız!" << std::endl;
+    }
+    fs_check_integrity();
+
+    std::cout << "\n--- Dizin İşlemleri Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_inline_data() {
+    std::cout << "\n--- Satır İçi (Inline) Veri Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    const char* cfg = "/app.conf";
+    const char* small = "port=8080\nmode=fast\n";
+    char buf[1024];
+
+    // Test 1: Küçük dosya veri bloğu kullanmaz
+    std::cout << "\n[Test 1: Küçük Dosya Satır İçi Yazılır]" << std::endl;
+    fs_create(cfg);
+    fs_write(cfg, small, strlen(small));
+    FileInfo fi = fs_get_file_info_debug(cfg);
+    memset(buf, 0, sizeof(buf));
+    fs_read(cfg, 0, strlen(small), buf);
+    if ((fi.flags & FILE_FLAG_INLINE_DATA) && fi.num_data_blocks_used == 0 && strcmp(buf, small) == 0) {
+        std::cout << "  [SUCCESS] Dosya satır içi tutuluyor ve doğru okunuyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Satır içi yazma/okuma başarısız! Blok: " << fi.num_data_blocks_used << ", okunan: '" << buf << "'" << std::endl;
+    }
+    memset(buf, 0, sizeof(buf));
+    fs_read(cfg, 5, 4, buf); // Ofsetli okuma
+    std::cout << "  Ofset 5'ten 4 byte: '" << buf << "' (Beklenen: '8080')" << std::endl;
+
+    // Test 2: Büyüyünce bloklara taşınır, küçülünce tekrar satır içine döner
+    std::cout << "\n[Test 2: Büyüme ve Küçülme]" << std::endl;
+    std::string big(INLINE_DATA_MAX_BYTES + 50, 'x');
+    fs_append(cfg, big.c_str(), big.size());
+    fi = fs_get_file_info_debug(cfg);
+    memset(buf, 0, sizeof(buf));
+    fs_read(cfg, 0, fi.size, buf);
+    std::string expected = std::string(small) + big;
+    if (!(fi.flags & FILE_FLAG_INLINE_DATA) && fi.num_data_blocks_used == 1 && expected == buf) {
+        std::cout << "  [SUCCESS] Büyüyen dosya bloklara taşındı, içerik korundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Bloklara taşıma başarısız! Blok: " << fi.num_data_blocks_used << std::endl;
+    }
+    fs_truncate(cfg, 9);
+    fi = fs_get_file_info_debug(cfg);
+    memset(buf, 0, sizeof(buf));
+    fs_read(cfg, 0, 9, buf);
+    if ((fi.flags & FILE_FLAG_INLINE_DATA) && fi.num_data_blocks_used == 0 && strcmp(buf, "port=8080") == 0) {
+        std::cout << "  [SUCCESS] Küçülen dosya tekrar satır içi tutuluyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Küçültme sonrası satır içi değil! Okunan: '" << buf << "'" << std::endl;
+    }
+
+    // Test 3: Uzun isme yeniden adlandırma veriyi bloklara taşır
+    std::cout << "\n[Test 3: Uzun İsimle Yeniden Adlandırma]" << std::endl;
+    std::string long_name(MAX_FILENAME_LENGTH - 4, 'n');
+    fs_rename(cfg, long_name.c_str());
+    fi = fs_get_file_info_debug(("/" + long_name).c_str());
+    memset(buf, 0, sizeof(buf));
+    fs_read(("/" + long_name).c_str(), 0, 9, buf);
+    if (fi.is_used && !(fi.flags & FILE_FLAG_INLINE_DATA) && fi.num_data_blocks_used == 1 && strcmp(buf, "port=8080") == 0) {
+        std::cout << "  [SUCCESS] Veri yeni isme sığmadığı için bloklara taşındı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Yeniden adlandırma sonrası içerik/yerleşim yanlış! Okunan: '" << buf << "'" << std::endl;
+    }
+
+    // Test 4: Kopya ve karşılaştırma satır içi dosyalarla çalışır
+    std::cout << "\n[Test 4: fs_copy / fs_diff]" << std::endl;
+    fs_create("/a.txt");
+    fs_write("/a.txt", "tiny", 4);
+    fs_copy("/a.txt", "/b.txt");
+    if (fs_diff("/a.txt", "/b.txt") == 0 && fs_get_num_blocks_used("/b.txt") == 0) {
+        std::cout << "  [SUCCESS] Satır içi dosya kopyalandı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Satır içi dosya kopyalama başarısız!" << std::endl;
+    }
+    fs_ls();
+    fs_check_integrity();
+
+    std::cout << "\n--- Satır İçi (Inline) Veri Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_tail_packing() {
+    std::cout << "\n--- Kuyruk Paketleme (Tail Packing) Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    const char* names[3] = {"/t1.bin", "/t2.bin", "/t3.bin"};
+    std::string contents[3];
+    char buf[2048];
+
+    // Test 1: Üç dosyanın kuyrukları tek bir blokta paylaşılır
+    std::cout << "\n[Test 1: Kuyrukların Aynı Blokta Paylaşılması]" << std::endl;
+    for (int i = 0; i < 3; ++i) {
+        contents[i] = std::string(BLOCK_SIZE_BYTES, static_cast<char>('a' + i)) + std::string(60 + i * 10, static_cast<char>('A' + i));
+        fs_create(names[i]);
+        fs_write(names[i], contents[i].c_str(), contents[i].size());
+    }
+    FileInfo f1 = fs_get_file_info_debug(names[0]);
+    FileInfo f2 = fs_get_file_info_debug(names[1]);
+    FileInfo f3 = fs_get_file_info_debug(names[2]);
+    std::cout << "  Kuyruk blokları: " << f1.tail_block_index << ", " << f2.tail_block_index << ", " << f3.tail_block_index
+              << " ofsetler: " << f1.tail_offset << ", " << f2.tail_offset << ", " << f3.tail_offset << std::endl;
+    if (f1.tail_block_index >= 0 && f1.tail_block_index == f2.tail_block_index && f2.tail_block_index == f3.tail_block_index &&
+        f1.num_data_blocks_used == 1 && f1.tail_length == 60) {
+        std::cout << "  [SUCCESS] Kuyruklar tek bir paylaşılan blokta." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Kuyruklar beklendiği gibi paketlenmedi!" << std::endl;
+    }
+
+    bool all_ok = true;
+    for (int i = 0; i < 3; ++i) {
+        memset(buf, 0, sizeof(buf));
+        fs_read(names[i], 0, contents[i].size(), buf);
+        if (contents[i] != buf) all_ok = false;
+    }
+    memset(buf, 0, sizeof(buf));
+    fs_read(names[1], BLOCK_SIZE_BYTES - 2, 5, buf); // Tam blok ile kuyruk sınırını geçen okuma
+    std::cout << "  Sınırı geçen okuma: '" << buf << "' (Beklenen: 'bbBBB')" << std::endl;
+    if (all_ok && strcmp(buf, "bbBBB") == 0) {
+        std::cout << "  [SUCCESS] Paketlenmiş dosyalar doğru okunuyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Paketlenmiş dosya içeriği yanlış!" << std::endl;
+    }
+
+    // Test 2: Silme ve defrag sonrası komşu kuyruklar korunur
+    std::cout << "\n[Test 2: Silme ve Defrag]" << std::endl;
+    fs_delete(names[0]);
+    fs_defragment();
+    all_ok = true;
+    for (int i = 1; i < 3; ++i) {
+        memset(buf, 0, sizeof(buf));
+        fs_read(names[i], 0, contents[i].size(), buf);
+        if (contents[i] != buf) all_ok = false;
+    }
+    f2 = fs_get_file_info_debug(names[1]);
+    f3 = fs_get_file_info_debug(names[2]);
+    std::cout << "  Defrag sonrası t2: start " << f2.start_data_block_index << ", kuyruk bloğu " << f2.tail_block_index << std::endl;
+    // Kuyruk bloğu, sıkıştırılmış tam blokların hemen arkasına paketlenir
+    if (all_ok && f2.tail_block_index == f3.tail_block_index && f2.tail_block_index == f3.start_data_block_index + 1) {
+        std::cout << "  [SUCCESS] Kuyruklar silme ve defrag sonrası korundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Silme/defrag sonrası kuyruklar bozuldu!" << std::endl;
+    }
+
+    // Test 3: Büyüyen dosya kuyruğunu bırakır
+    std::cout << "\n[Test 3: Büyüyen Dosya]" << std::endl;
+    std::string extra(BLOCK_SIZE_BYTES, 'z');
+    fs_append(names[2], extra.c_str(), extra.size());
+    memset(buf, 0, sizeof(buf));
+    fs_read(names[2], 0, contents[2].size() + extra.size(), buf);
+    f3 = fs_get_file_info_debug(names[2]);
+    if (contents[2] + extra == buf && f3.num_data_blocks_used == 2 && f3.tail_length == 80) {
+        std::cout << "  [SUCCESS] Büyüyen dosyanın içeriği ve kuyruğu doğru." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Büyüyen dosya hatalı!" << std::endl;
+    }
+    fs_ls();
+    fs_check_integrity();
+
+    std::cout << "\n--- Kuyruk Paketleme Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_size_class_allocation() {
+    std::cout << "\n--- Boyut Sınıfına Göre Tahsis Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    const int large_blocks = SMALL_ALLOCATION_MAX_BLOCKS * 4;
+    std::string large(large_blocks * BLOCK_SIZE_BYTES, 'L');
+    std::string small(2 * BLOCK_SIZE_BYTES, 's');
+
+    // Test 1: Büyük dosya diskin sonuna, küçük dosyalar başına yerleşir
+    std::cout << "\n[Test 1: Yerleşim]" << std::endl;
+    fs_create("/big1.dat");
+    fs_write("/big1.dat", large.c_str(), large.size());
+    fs_create("/small1.dat");
+    fs_write("/small1.dat", small.c_str(), small.size());
+    FileInfo big_fi = fs_get_file_info_debug("/big1.dat");
+    FileInfo small_fi = fs_get_file_info_debug("/small1.dat");
+    std::cout << "  big1 start: " << big_fi.start_data_block_index << " (Beklenen: " << NUM_DATA_BLOCKS - large_blocks << ")"
+              << ", small1 start: " << small_fi.start_data_block_index << std::endl;
+    if (big_fi.start_data_block_index == static_cast<off_t>(NUM_DATA_BLOCKS - large_blocks) && small_fi.start_data_block_index < 8) {
+        std::cout << "  [SUCCESS] Büyük ve küçük tahsisler ayrı uçlarda." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Boyut sınıfı yerleşimi beklenmedik!" << std::endl;
+    }
+
+    // Test 2: Küçük dosyaların silinmesiyle oluşan delikler büyük dosyayı etkilemez
+    std::cout << "\n[Test 2: Delikler ve Büyük Tahsis]" << std::endl;
+    fs_delete("/small1.dat");
+    fs_create("/big2.dat");
+    fs_write("/big2.dat", large.c_str(), large.size());
+    FileInfo big2_fi = fs_get_file_info_debug("/big2.dat");
+    char buf[16];
+    memset(buf, 0, sizeof(buf));
+    fs_read("/big2.dat", large.size() - 4, 4, buf);
+    if (big2_fi.start_data_block_index == big_fi.start_data_block_index - large_blocks && strcmp(buf, "LLLL") == 0) {
+        std::cout << "  [SUCCESS] İkinci büyük dosya ilkinin hemen altına yerleşti." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] İkinci büyük dosya yanlış yerde: " << big2_fi.start_data_block_index << std::endl;
+    }
+    fs_check_integrity();
+
+    std::cout << "\n--- Boyut Sınıfına Göre Tahsis Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_buddy_allocator() {
+    std::cout << "\n--- Buddy Allocator Testleri Başlıyor ---" << std::endl;
+    fs_format(ALLOCATOR_BUDDY);
+    std::cout << "  Tahsis motoru: " << fs_get_allocator_mode() << " (Beklenen: " << ALLOCATOR_BUDDY << ")" << std::endl;
+
+    // Test 1: Tahsisler kendi boyutlarına hizalı parçalardan yapılır
+    std::cout << "\n[Test 1: Hizalı Tahsis]" << std::endl;
+    int a = find_and_allocate_contiguous_data_blocks(3);  // 4'lük parçadan 3 blok
+    int b = find_and_allocate_contiguous_data_blocks(8);
+    int c = find_and_allocate_contiguous_data_blocks(1);  // a'nın parçasında kalan boş bloğu almalı
+    std::cout << "  a=" << a << " b=" << b << " c=" << c << std::endl;
+    if (a % 4 == 0 && b % 8 == 0 && c == a + 3) {
+        std::cout << "  [SUCCESS] Parçalar hizalı, artan bloklar yeniden kullanıldı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Buddy yerleşimi beklenmedik!" << std::endl;
+    }
+
+    // Test 2: Serbest bırakılan bloklar birleşir ve büyük parça tekrar alınabilir
+    std::cout << "\n[Test 2: Birleştirme]" << std::endl;
+    for (int i = 0; i < 3; ++i) free_data_block(a + i);
+    free_data_block(c);
+    for (int i = 0; i < 8; ++i) free_data_block(b + i);
+    // Her şey birleştiyse listeler format sonrasıyla aynıdır: aynı istek aynı yeri almalı
+    int a_again = find_and_allocate_contiguous_data_blocks(3);
+    std::cout << "  Tekrar 3 bloklu tahsis: " << a_again << " (Beklenen: " << a << ")" << std::endl;
+    if (a_again == a) {
+        std::cout << "  [SUCCESS] Boş parçalar birleşti." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Birleştirme çalışmadı!" << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) free_data_block(a_again + i);
+
+    // Test 3: Buddy modunda dosya işlemleri ve listelerin bitmap'ten yeniden kurulması
+    std::cout << "\n[Test 3: Dosya İşlemleri ve Yeniden Kurma]" << std::endl;
+    std::string content(5 * BLOCK_SIZE_BYTES, 'q');
+    fs_create("/grow.dat");
+    fs_write("/grow.dat", content.c_str(), content.size());
+    fs_append("/grow.dat", content.c_str(), content.size());
+    buddy_invalidate_free_lists(); // Yeniden "mount" edilmiş gibi davran
+    fs_create("/other.dat");
+    fs_write("/other.dat", content.c_str(), content.size());
+    FileInfo grow_fi = fs_get_file_info_debug("/grow.dat");
+    FileInfo other_fi = fs_get_file_info_debug("/other.dat");
+    char buf[8];
+    memset(buf, 0, sizeof(buf));
+    fs_read("/grow.dat", content.size() * 2 - 4, 4, buf);
+    std::cout << "  grow.dat start: " << grow_fi.start_data_block_index << ", other.dat start: " << other_fi.start_data_block_index << std::endl;
+    if (strcmp(buf, "qqqq") == 0 && grow_fi.start_data_block_index % 16 == 0 && other_fi.start_data_block_index % 8 == 0) {
+        std::cout << "  [SUCCESS] Buddy modunda dosyalar doğru ve hizalı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Buddy modunda dosya işlemleri hatalı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format(); // Sonraki testler için varsayılan motora dön
+    std::cout << "\n--- Buddy Allocator Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_allocation_groups() {
+    std::cout << "\n--- Tahsis Grubu Testleri Başlıyor ---" << std::endl;
+    fs_format();
+
+    std::vector<AllocationGroupSummary> summaries;
+    uint32_t total_free = 0;
+    fs_get_group_summaries(summaries);
+    for (const AllocationGroupSummary& s : summaries) total_free += s.free_blocks;
+
+    // Test 1: Formattan sonra tüm bloklar boş ve gruplara dağılmış olmalı
+    std::cout << "\n[Test 1: Başlangıç Özetleri]" << std::endl;
+    std::cout << "  Grup sayısı: " << summaries.size() << ", toplam boş: " << total_free << " (Beklenen: " << NUM_DATA_BLOCKS << ")" << std::endl;
+    if (summaries.size() == NUM_ALLOCATION_GROUPS && total_free == NUM_DATA_BLOCKS) {
+        std::cout << "  [SUCCESS] Grup özetleri doğru başlatıldı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Grup özetleri hatalı!" << std::endl;
+    }
+
+    // Test 2: Tahsis ve serbest bırakma grup sayacını günceller
+    std::cout << "\n[Test 2: Sayaç Güncelleme]" << std::endl;
+    int block = find_free_data_block();
+    fs_get_group_summaries(summaries);
+    uint32_t after_alloc = summaries[0].free_blocks;
+    free_data_block(block);
+    fs_get_group_summaries(summaries);
+    std::cout << "  Blok " << block << ": tahsis sonrası grup 0 boş=" << after_alloc << ", serbest sonrası=" << summaries[0].free_blocks << std::endl;
+    if (block == 0 && after_alloc == ALLOCATION_GROUP_BLOCKS - 1 && summaries[0].free_blocks == ALLOCATION_GROUP_BLOCKS) {
+        std::cout << "  [SUCCESS] Grup sayacı tahsis/serbest bırakmayı izliyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Grup sayacı güncellenmedi!" << std::endl;
+    }
+
+    // Test 3: Dolu grup atlanır, tahsis bir sonraki gruba geçer
+    std::cout << "\n[Test 3: Dolu Grubu Atlama]" << std::endl;
+    std::vector<int> taken;
+    for (unsigned int i = 0; i < ALLOCATION_GROUP_BLOCKS; ++i) taken.push_back(find_free_data_block());
+    int next_block = find_free_data_block();
+    int small_run = find_and_allocate_contiguous_data_blocks(4);
+    fs_get_group_summaries(summaries);
+    std::cout << "  Sonraki blok: " << next_block << ", 4 bloklu tahsis: " << small_run << ", grup 0 boş=" << summaries[0].free_blocks << std::endl;
+    if (next_block == static_cast<int>(ALLOCATION_GROUP_BLOCKS) && small_run == next_block + 1 && summaries[0].free_blocks == 0 &&
+        summaries[1].free_blocks == ALLOCATION_GROUP_BLOCKS - 5) {
+        std::cout << "  [SUCCESS] Dolu grup atlandı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Grup atlama beklenmedik!" << std::endl;
+    }
+    for (int b : taken) free_data_block(b);
+    free_data_block(next_block);
+    for (int i = 0; i < 4; ++i) free_data_block(small_run + i);
+
+    // Test 4: Büyük dosyalar (tüm bitmap yolu) da özetleri tutarlı bırakır
+    std::cout << "\n[Test 4: Büyük Tahsis ve Bütünlük]" << std::endl;
+    std::string content(20 * BLOCK_SIZE_BYTES, 'g');
+    fs_create("/group_big.dat");
+    fs_write("/group_big.dat", content.c_str(), content.size());
+    fs_create("/group_small.dat");
+    fs_write("/group_small.dat", content.c_str(), 3 * BLOCK_SIZE_BYTES);
+    fs_sync(); // Gecikmeli tahsis: bloklar ancak boşaltmada ayrılır
+    fs_delete("/group_small.dat");
+    fs_get_group_summaries(summaries);
+    total_free = 0;
+    for (const AllocationGroupSummary& s : summaries) total_free += s.free_blocks;
+    FileInfo big_fi = fs_get_file_info_debug("/group_big.dat");
+    // Kök dizin tablosu 1 blok + büyük dosya 20 blok
+    std::cout << "  Toplam boş: " << total_free << " (Beklenen: " << NUM_DATA_BLOCKS - 21 << ")" << std::endl;
+    if (total_free == NUM_DATA_BLOCKS - 21 && summaries[NUM_ALLOCATION_GROUPS - 1].free_blocks < ALLOCATION_GROUP_BLOCKS &&
+        big_fi.start_data_block_index + 20 == static_cast<int>(NUM_DATA_BLOCKS)) {
+        std::cout << "  [SUCCESS] Büyük tahsis son grubun sayacına yansıdı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Büyük tahsis sonrası özetler hatalı!" << std::endl;
+    }
+    fs_defragment();
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Tahsis Grubu Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_statfs() {
+    std::cout << "\n--- fs_statfs Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FsStatfs st;
+
+    // Test 1: Boş disk tek bir boş parçadır
+    std::cout << "\n[Test 1: Boş Disk]" << std::endl;
+    fs_statfs(st);
+    std::cout << "  Boş: " << st.free_blocks << ", parça: " << st.free_extent_count << ", en büyük: " << st.largest_free_extent_hint << std::endl;
+    if (st.free_blocks == NUM_DATA_BLOCKS && st.free_extent_count == 1 && st.largest_free_extent_hint == NUM_DATA_BLOCKS && st.used_bytes == 0) {
+        std::cout << "  [SUCCESS] Boş disk istatistikleri doğru." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Boş disk istatistikleri hatalı!" << std::endl;
+    }
+
+    // Test 2: Yazma, kuyruk ve silme sonrası sayaçlar
+    std::cout << "\n[Test 2: Dosya İşlemleri]" << std::endl;
+    std::string content(3 * BLOCK_SIZE_BYTES + 100, 's'); // 3 tam blok + paylaşılan kuyruk
+    fs_create("/a.dat");
+    fs_write("/a.dat", content.c_str(), content.size());
+    fs_create("/b.dat");
+    fs_write("/b.dat", content.c_str(), 2 * BLOCK_SIZE_BYTES + 400); // 3 blok, 112 B boşluk
+    fs_create("/c.dat");
+    fs_write("/c.dat", content.c_str(), 2 * BLOCK_SIZE_BYTES);
+    fs_sync(); // Bekleyen yazmalar diske yerleşsin
+    fs_delete("/b.dat"); // a ile c arasında bir delik bırakır
+    fs_statfs(st);
+    int64_t expected_used = static_cast<int64_t>(content.size()) + 2 * BLOCK_SIZE_BYTES;
+    std::cout << "  Kullanılan: " << st.used_bytes << " B (Beklenen: " << expected_used << "), parça: " << st.free_extent_count
+              << ", parçalı dosya: " << st.fragmented_files << ", aktif: " << st.num_active_files << std::endl;
+    if (st.used_bytes == expected_used && st.free_extent_count == 2 && st.fragmented_files == 1 && st.slack_bytes == 0 &&
+        st.num_active_files == 2 && st.fragmentation_percent > 0) {
+        std::cout << "  [SUCCESS] Sayaçlar dosya işlemlerini izliyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Sayaçlar beklenen değerlerde değil!" << std::endl;
+    }
+
+    // Test 3: Birleştirme sonrası tek boş parça kalır ve sayaçlar bütünlük kontrolünden geçer
+    std::cout << "\n[Test 3: Birleştirme]" << std::endl;
+    uint32_t free_before = st.free_blocks;
+    fs_defragment();
+    fs_statfs(st);
+    std::cout << "  Boş: " << st.free_blocks << " (Önce: " << free_before << "), parça: " << st.free_extent_count
+              << ", en büyük: " << st.largest_free_extent_hint << std::endl;
+    if (st.free_blocks == free_before && st.free_extent_count == 1 && st.largest_free_extent_hint == st.free_blocks && st.fragmentation_percent == 0) {
+        std::cout << "  [SUCCESS] Birleştirme sonrası istatistikler kesin." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Birleştirme sonrası istatistikler hatalı!" << std::endl;
+    }
+    fs_check_integrity();
+    fs_ls();
+
+    fs_format();
+    std::cout << "\n--- fs_statfs Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_fallocate() {
+    std::cout << "\n--- fs_fallocate Testleri Başlıyor ---" << std::endl;
+    fs_format();
+
+    // Test 1: Veri yazmadan ardışık blok ayırma
+    std::cout << "\n[Test 1: Rezervasyon]" << std::endl;
+    fs_create("/import.dat");
+    int rc = fs_fallocate("/import.dat", 10 * BLOCK_SIZE_BYTES);
+    FileInfo fi = fs_get_file_info_debug("/import.dat");
+    int reserved_start = static_cast<int>(fi.start_data_block_index);
+    std::cout << "  rc=" << rc << ", boyut: " << fi.size << ", blok: " << fi.num_data_blocks_used << ", başlangıç: " << reserved_start << std::endl;
+    if (rc == 0 && fi.size == 0 && fi.num_data_blocks_used == 10 && (fi.flags & FILE_FLAG_PREALLOCATED)) {
+        std::cout << "  [SUCCESS] 10 blok ayrıldı, dosya boyutu değişmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Rezervasyon beklenmedik!" << std::endl;
+    }
+
+    // Test 2: Parça parça eklemeler ayrılan alanı yerinde doldurur
+    std::cout << "\n[Test 2: Yerinde Ekleme]" << std::endl;
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        std::string chunk(BLOCK_SIZE_BYTES, static_cast<char>('a' + i));
+        fs_append("/import.dat", chunk.c_str(), chunk.size());
+        expected += chunk;
+        fi = fs_get_file_info_debug("/import.dat");
+        if (fi.start_data_block_index != reserved_start) break;
+    }
+    std::string readback(expected.size() + 1, '\0');
+    fs_read("/import.dat", 0, expected.size(), &readback[0]);
+    readback.resize(expected.size());
+    std::cout << "  Başlangıç: " << fi.start_data_block_index << " (Beklenen: " << reserved_start << "), boyut: " << fi.size
+              << ", bayrak: " << ((fi.flags & FILE_FLAG_PREALLOCATED) ? "var" : "yok") << std::endl;
+    if (fi.start_data_block_index == reserved_start && fi.size == static_cast<int64_t>(expected.size()) && readback == expected &&
+        !(fi.flags & FILE_FLAG_PREALLOCATED)) {
+        std::cout << "  [SUCCESS] Eklemeler yeniden tahsis olmadan yerinde yazıldı, alan tükenince bayrak kalktı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Yerinde ekleme hatalı!" << std::endl;
+    }
+
+    // Test 3: fs_truncate büyütme içeriği korur ve sadece eklenen kısmı sıfırlar
+    std::cout << "\n[Test 3: Truncate ile Büyütme]" << std::endl;
+    fs_create("/grow.dat");
+    fs_write("/grow.dat", "baslangic", 9); // Satır içi tutulur
+    fs_truncate("/grow.dat", 3 * BLOCK_SIZE_BYTES);
+    std::string grown(3 * BLOCK_SIZE_BYTES + 1, 'x');
+    fs_read("/grow.dat", 0, 3 * BLOCK_SIZE_BYTES, &grown[0]);
+    bool zeros_ok = true;
+    for (unsigned int i = 9; i < 3 * BLOCK_SIZE_BYTES; ++i) {
+        if (grown[i] != '\0') { zeros_ok = false; break; }
+    }
+    fi = fs_get_file_info_debug("/grow.dat");
+    std::cout << "  Boyut: " << fi.size << ", blok: " << fi.num_data_blocks_used << std::endl;
+    if (grown.compare(0, 9, "baslangic") == 0 && zeros_ok && fi.size == 3 * BLOCK_SIZE_BYTES && fi.num_data_blocks_used == 3) {
+        std::cout << "  [SUCCESS] Büyütülen dosya doğru." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Büyütülen dosya hatalı!" << std::endl;
+    }
+
+    // Test 4: Küçültme fazla rezervasyonu bırakır
+    std::cout << "\n[Test 4: Truncate ile Küçültme]" << std::endl;
+    fs_create("/shrink.dat");
+    fs_fallocate("/shrink.dat", 20 * BLOCK_SIZE_BYTES);
+    fs_write("/shrink.dat", expected.c_str(), 2 * BLOCK_SIZE_BYTES);
+    fs_truncate("/shrink.dat", 300);
+    fi = fs_get_file_info_debug("/shrink.dat");
+    char head[4] = {0};
+    fs_read("/shrink.dat", 0, 3, head);
+    std::cout << "  Boyut: " << fi.size << ", blok: " << fi.num_data_blocks_used << ", ilk byte'lar: " << head << std::endl;
+    if (fi.size == 300 && fi.num_data_blocks_used == 1 && !(fi.flags & FILE_FLAG_PREALLOCATED) && strcmp(head, "aaa") == 0) {
+        std::cout << "  [SUCCESS] Fazla ayrılmış bloklar bırakıldı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Küçültme sonrası rezervasyon hatalı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- fs_fallocate Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_delayed_allocation() {
+    std::cout << "\n--- Gecikmeli Tahsis Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FsStatfs st;
+
+    // Test 1: Küçük eklemeler diske dokunmadan tamponda birikir
+    std::cout << "\n[Test 1: Tamponlama]" << std::endl;
+    fs_create("/log.dat");
+    fs_create("/other.dat");
+    std::string expected;
+    for (int i = 0; i < 8; ++i) {
+        std::string chunk(300, static_cast<char>('a' + i));
+        fs_append("/log.dat", chunk.c_str(), chunk.size());
+        fs_append("/other.dat", chunk.c_str(), 100); // Araya giren ikinci dosya
+        expected += chunk;
+    }
+    fs_statfs(st);
+    std::cout << "  Tamponda: " << st.buffered_bytes << " B / " << st.buffered_files << " dosya, boş blok: " << st.free_blocks
+              << ", fs_size: " << fs_size("/log.dat") << std::endl;
+    if (st.buffered_bytes == static_cast<int64_t>(expected.size()) + 800 && st.buffered_files == 2 &&
+        st.free_blocks == NUM_DATA_BLOCKS - 1 && fs_size("/log.dat") == static_cast<int64_t>(expected.size())) {
+        std::cout << "  [SUCCESS] Eklemeler bekliyor, fs_size tampondaki boyutu görüyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Tamponlama beklenmedik!" << std::endl;
+    }
+
+    // Test 2: fs_sync her dosyayı son boyutuna göre tek ardışık alana yazar
+    std::cout << "\n[Test 2: fs_sync]" << std::endl;
+    int rc = fs_sync();
+    FileInfo log_fi = fs_get_file_info_debug("/log.dat");
+    FileInfo other_fi = fs_get_file_info_debug("/other.dat");
+    std::string readback(expected.size() + 1, '\0');
+    fs_read("/log.dat", 0, expected.size(), &readback[0]);
+    readback.resize(expected.size());
+    fs_statfs(st);
+    std::cout << "  rc=" << rc << ", log: başlangıç " << log_fi.start_data_block_index << ", " << log_fi.num_data_blocks_used
+              << " blok; other: " << other_fi.num_data_blocks_used << " blok, tamponda: " << st.buffered_bytes << std::endl;
+    if (rc == 0 && st.buffered_bytes == 0 && log_fi.size == static_cast<int64_t>(expected.size()) && readback == expected &&
+        log_fi.num_data_blocks_used == 5 && other_fi.size == 800 && st.free_extent_count == 1) {
+        std::cout << "  [SUCCESS] Boşaltma sonrası dosyalar ardışık, boş alan parçalanmadı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] fs_sync sonrası yerleşim hatalı!" << std::endl;
+    }
+
+    // Test 3: Okuma bekleyen yazmayı görür, silme bekleyen veriyi hiç yazmadan atar
+    std::cout << "\n[Test 3: Okuma ve Silme]" << std::endl;
+    fs_write("/other.dat", "yeni icerik", 11);
+    char buf[16] = {0};
+    fs_read("/other.dat", 0, 11, buf);
+    fs_create("/tmp.dat");
+    std::string scratch(2 * BLOCK_SIZE_BYTES, 't');
+    fs_write("/tmp.dat", scratch.c_str(), scratch.size());
+    uint32_t free_before_delete = 0;
+    fs_statfs(st);
+    free_before_delete = st.free_blocks;
+    fs_delete("/tmp.dat");
+    fs_statfs(st);
+    std::cout << "  Okunan: '" << buf << "', silme öncesi/sonrası boş: " << free_before_delete << "/" << st.free_blocks
+              << ", tamponda: " << st.buffered_bytes << std::endl;
+    if (strcmp(buf, "yeni icerik") == 0 && st.free_blocks == free_before_delete && st.buffered_bytes == 0) {
+        std::cout << "  [SUCCESS] Okuma güncel, silinen dosya için blok ayrılmadı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Okuma/silme tamponla tutarsız!" << std::endl;
+    }
+
+    // Test 4: Tampon sınırı aşılınca bekleyen yazmalar kendiliğinden boşaltılır
+    std::cout << "\n[Test 4: Bellek Baskısı]" << std::endl;
+    std::string block_chunk(BLOCK_SIZE_BYTES, 'p');
+    fs_create("/pressure.dat");
+    int64_t appended = 0;
+    while (appended <= static_cast<int64_t>(DELAYED_ALLOC_MAX_BUFFERED_BYTES)) {
+        fs_append("/pressure.dat", block_chunk.c_str(), block_chunk.size());
+        appended += block_chunk.size();
+    }
+    fs_statfs(st);
+    FileInfo pressure_fi = fs_get_file_info_debug("/pressure.dat");
+    std::cout << "  Eklenen: " << appended << " B, tamponda: " << st.buffered_bytes << ", diskteki boyut: " << pressure_fi.size << std::endl;
+    if (st.buffered_bytes < static_cast<int64_t>(DELAYED_ALLOC_MAX_BUFFERED_BYTES) && pressure_fi.size == appended &&
+        pressure_fi.num_data_blocks_used == appended / BLOCK_SIZE_BYTES) {
+        std::cout << "  [SUCCESS] Sınır aşımında tampon diske boşaltıldı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Bellek baskısı boşaltması çalışmadı!" << std::endl;
+    }
+
+    fs_unmount();
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Gecikmeli Tahsis Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_placement_hints() {
+    std::cout << "\n--- Yerleşim İpucu Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    std::string content(4 * BLOCK_SIZE_BYTES, 'h');
+
+    // Test 1: "near file" ipucu, diskin başındaki delik yerine verinin hemen arkasını seçer
+    std::cout << "\n[Test 1: Dosya Yanına Yerleşim]" << std::endl;
+    fs_create("/a.dat");
+    fs_write("/a.dat", content.c_str(), 2 * BLOCK_SIZE_BYTES);
+    fs_create("/data.dat");
+    fs_write("/data.dat", content.c_str(), 3 * BLOCK_SIZE_BYTES);
+    fs_create("/b.dat");
+    fs_write("/b.dat", content.c_str(), 2 * BLOCK_SIZE_BYTES);
+    fs_sync();
+    fs_delete("/a.dat"); // Baştaki delik: ipucusuz first-fit buraya düşerdi
+    fs_delete("/b.dat"); // Verinin hemen arkası boşaldı
+    AllocationHint near_data;
+    near_data.near_file = "/data.dat";
+    fs_create("/index.dat", near_data);
+    int64_t rc = fs_write("/index.dat", content.c_str(), 2 * BLOCK_SIZE_BYTES);
+    FileInfo data_fi = fs_get_file_info_debug("/data.dat");
+    FileInfo index_fi = fs_get_file_info_debug("/index.dat");
+    std::cout << "  data: " << data_fi.start_data_block_index << "+" << data_fi.num_data_blocks_used << ", index: "
+              << index_fi.start_data_block_index << " (Beklenen: " << data_fi.start_data_block_index + data_fi.num_data_blocks_used << ")" << std::endl;
+    if (rc == 2 * BLOCK_SIZE_BYTES && index_fi.start_data_block_index == data_fi.start_data_block_index + data_fi.num_data_blocks_used) {
+        std::cout << "  [SUCCESS] İndeks dosyası verinin hemen arkasına yerleşti." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] İpucu yok sayıldı!" << std::endl;
+    }
+
+    // Test 2: Hedef blok ipucu ve ipucunun sonraki yazmalarda kalıcı olması
+    std::cout << "\n[Test 2: Hedef Blok]" << std::endl;
+    AllocationHint goal;
+    goal.goal_block = 1000;
+    fs_create("/far.dat");
+    rc = fs_write("/far.dat", content.c_str(), BLOCK_SIZE_BYTES, goal);
+    FileInfo far_fi = fs_get_file_info_debug("/far.dat");
+    int first_start = static_cast<int>(far_fi.start_data_block_index);
+    fs_write("/far.dat", content.c_str(), content.size()); // İpucusuz yeniden yazma da hedefi kullanır
+    far_fi = fs_get_file_info_debug("/far.dat");
+    std::cout << "  İlk başlangıç: " << first_start << ", yeniden yazma: " << far_fi.start_data_block_index
+              << ", saklanan hedef: " << far_fi.placement_goal << std::endl;
+    if (rc == BLOCK_SIZE_BYTES && first_start == 1000 && far_fi.start_data_block_index == 1000 && far_fi.placement_goal == 1000) {
+        std::cout << "  [SUCCESS] Dosya hedef bloğa yerleşti, ipucu FileInfo'da kaldı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Hedef blok ipucu çalışmadı!" << std::endl;
+    }
+
+    // Test 3: Geçersiz ipuçları reddedilir
+    std::cout << "\n[Test 3: Geçersiz İpucu]" << std::endl;
+    AllocationHint missing;
+    missing.near_file = "/yok.dat";
+    AllocationHint out_of_range;
+    out_of_range.goal_block = NUM_DATA_BLOCKS;
+    int64_t rc_missing = fs_write("/far.dat", "x", 1, missing);
+    int rc_range = fs_set_placement_hint("/far.dat", out_of_range);
+    std::cout << "  Olmayan dosya: " << rc_missing << ", aralık dışı: " << rc_range << ", boyut: " << fs_size("/far.dat") << std::endl;
+    if (rc_missing == -11 && rc_range < 0 && fs_size("/far.dat") == static_cast<int64_t>(content.size())) {
+        std::cout << "  [SUCCESS] Geçersiz ipuçları dosyaya dokunmadan reddedildi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Geçersiz ipucu kabul edildi!" << std::endl;
+    }
+    fs_check_integrity();
+
+    // Test 4: Geçerli ipucuyla yazmanın hataları fs_write'ın kendi kodlarıdır; başarısız yazma ipucunu geri alır
+    std::cout << "\n[Test 4: İpuçlu Yazma Hata Kodları]" << std::endl;
+    AllocationHint nearer;
+    nearer.goal_block = 500;
+    int64_t rc_absent = fs_write("/absent.dat", "x", 1, nearer);
+    fs_mkdir("/hintdir");
+    int64_t rc_dir = fs_write("/hintdir", "x", 1, nearer);
+    std::vector<char> too_big(static_cast<size_t>(NUM_DATA_BLOCKS + 1) * BLOCK_SIZE_BYTES, 'z');
+    int64_t rc_full = fs_write("/far.dat", too_big.data(), static_cast<int64_t>(too_big.size()), nearer);
+    far_fi = fs_get_file_info_debug("/far.dat");
+    std::cout << "  Olmayan dosya: " << rc_absent << ", dizin: " << rc_dir << ", sığmayan yazma: " << rc_full
+              << ", saklanan hedef: " << far_fi.placement_goal << std::endl;
+    if (rc_absent == -5 && rc_dir == -10 && rc_full < 0 && far_fi.placement_goal == 1000) {
+        std::cout << "  [SUCCESS] Hata kodları ipucusuz fs_write ile aynı, başarısız yazma hedefi değiştirmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] İpuçlu yazma hatası yanlış raporlandı veya ipucu kaldı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Yerleşim İpucu Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_incremental_defrag() {
+    std::cout << "\n--- Artımlı Birleştirme Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FsStatfs st;
+    DefragProgress progress;
+    const int num_files = 8;
+    std::string names[num_files];
+    std::string contents[num_files];
+
+    // Her dosyaya farklı içerikle 3 blok yaz, sonra her ikinciyi silerek delikler aç
+    for (int i = 0; i < num_files; ++i) {
+        names[i] = "/frag" + std::to_string(i) + ".dat";
+        contents[i] = std::string(3 * BLOCK_SIZE_BYTES, static_cast<char>('A' + i));
+        fs_create(names[i].c_str());
+        fs_write(names[i].c_str(), contents[i].c_str(), contents[i].size());
+    }
+    fs_sync();
+    for (int i = 0; i < num_files; i += 2) fs_delete(names[i].c_str());
+
+    // Test 1: Bütçeli tek adım sadece bir extent taşır ve ilerlemeyi saklar
+    std::cout << "\n[Test 1: Bütçeli Adım]" << std::endl;
+    fs_statfs(st);
+    uint32_t extents_before = st.free_extent_count;
+    int rc = fs_defragment_step(3 * BLOCK_SIZE_BYTES, 0);
+    fs_get_defrag_progress(progress);
+    std::cout << "  rc=" << rc << ", taşınan: " << progress.files_moved << ", imleç: " << progress.cursor
+              << ", boş parça (önce): " << extents_before << std::endl;
+    if (rc == 0 && progress.files_moved == 1 && progress.pass_active == 1 && progress.cursor > 0 && extents_before > 1) {
+        std::cout << "  [SUCCESS] Adım bütçede durdu, ilerleme süperblokta." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Bütçeli adım beklenmedik!" << std::endl;
+    }
+
+    // Test 2: Adımlar geçişi tamamlar, içerik korunur
+    std::cout << "\n[Test 2: Geçişi Tamamlama]" << std::endl;
+    int steps = 1;
+    while (rc == 0 && steps < 100) {
+        rc = fs_defragment_step(3 * BLOCK_SIZE_BYTES, 0);
+        steps++;
+    }
+    fs_get_defrag_progress(progress);
+    fs_statfs(st);
+    bool contents_ok = true;
+    for (int i = 1; i < num_files; i += 2) {
+        std::string readback(contents[i].size() + 1, '\0');
+        fs_read(names[i].c_str(), 0, contents[i].size(), &readback[0]);
+        readback.resize(contents[i].size());
+        if (readback != contents[i]) contents_ok = false;
+    }
+    std::cout << "  Adım: " << steps << ", rc=" << rc << ", geçiş: " << progress.passes_completed
+              << ", boş parça: " << st.free_extent_count << std::endl;
+    if (rc == 1 && progress.passes_completed == 1 && progress.pass_active == 0 && st.free_extent_count == 1 && contents_ok) {
+        std::cout << "  [SUCCESS] Disk adım adım sıkıştırıldı, veriler sağlam." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Artımlı geçiş tamamlanamadı!" << std::endl;
+    }
+
+    // Test 3: Arka plan iş parçacığı, ön planda işlemler sürerken birleştirir
+    std::cout << "\n[Test 3: Arka Plan]" << std::endl;
+    for (int i = 0; i < num_files; i += 2) {
+        fs_create(names[i].c_str());
+        fs_write(names[i].c_str(), contents[i].c_str(), contents[i].size());
+    }
+    fs_sync();
+    fs_delete(names[1].c_str());
+    fs_delete(names[4].c_str());
+    rc = fs_defrag_start_background(BLOCK_SIZE_BYTES, 0, 1);
+    int foreground_reads = 0;
+    bool foreground_ok = true;
+    for (int wait = 0; wait < 5000 && fs_defrag_background_running(); ++wait) {
+        std::string readback(contents[7].size() + 1, '\0');
+        fs_read(names[7].c_str(), 0, contents[7].size(), &readback[0]);
+        readback.resize(contents[7].size());
+        if (readback != contents[7]) foreground_ok = false;
+        foreground_reads++;
+    }
+    fs_defrag_stop_background();
+    fs_statfs(st);
+    std::cout << "  rc=" << rc << ", ön plan okuması: " << foreground_reads << ", boş parça: " << st.free_extent_count << std::endl;
+    if (rc == 0 && foreground_ok && st.free_extent_count == 1) {
+        std::cout << "  [SUCCESS] Arka plan birleştirmesi ön plan işlemleriyle birlikte tamamlandı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Arka plan birleştirmesi hatalı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Artımlı Birleştirme Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_defrag_planner() {
+    std::cout << "\n--- Birleştirme Planlayıcısı Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FsStatfs st;
+    DefragPlan plan;
+    const int num_files = 10;
+    std::string names[num_files];
+    std::string contents[num_files];
+    for (int i = 0; i < num_files; ++i) {
+        names[i] = "/plan" + std::to_string(i) + ".dat";
+        contents[i] = std::string(4 * BLOCK_SIZE_BYTES, static_cast<char>('a' + i));
+        fs_create(names[i].c_str());
+        fs_write(names[i].c_str(), contents[i].c_str(), contents[i].size());
+    }
+    fs_sync();
+    for (int i = 1; i < 8; i += 2) fs_delete(names[i].c_str()); // 4 bloklu dört delik
+    fs_statfs(st);
+    FileInfo last_fi = fs_get_file_info_debug(names[9].c_str());
+    // Son dosya taşınırsa sondaki boş alan onun bloklarıyla birleşir
+    uint32_t wanted = st.largest_free_extent_hint + last_fi.num_data_blocks_used;
+
+    // Test 1: Kuru çalıştırma sadece raporlar
+    std::cout << "\n[Test 1: Kuru Çalıştırma]" << std::endl;
+    int rc = fs_plan_defrag(DEFRAG_TARGET_FREE_EXTENT, wanted, plan);
+    int dry_rc = fs_defragment_to_target(DEFRAG_TARGET_FREE_EXTENT, wanted, true);
+    FileInfo after_dry = fs_get_file_info_debug(names[9].c_str());
+    std::cout << "  rc=" << rc << ", strateji: " << plan.strategy << ", taşıma: " << plan.moves.size() << ", byte: " << plan.bytes_to_move
+              << " (tam sıkıştırma: " << plan.full_compaction_bytes << ")" << std::endl;
+    if (rc == 0 && dry_rc == 0 && plan.strategy == "window" && plan.moves.size() == 1 && plan.bytes_to_move == 4 * BLOCK_SIZE_BYTES &&
+        plan.full_compaction_bytes > 4 * plan.bytes_to_move && plan.largest_free_extent_after >= wanted &&
+        after_dry.start_data_block_index == last_fi.start_data_block_index) {
+        std::cout << "  [SUCCESS] Tek küçük dosya taşımalı plan bulundu, disk değişmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Plan beklenmedik!" << std::endl;
+    }
+
+    // Test 2: Planı uygula
+    std::cout << "\n[Test 2: Boş Alan Hedefi]" << std::endl;
+    rc = fs_defragment_to_target(DEFRAG_TARGET_FREE_EXTENT, wanted, false);
+    fs_statfs(st);
+    std::string readback(contents[9].size() + 1, '\0');
+    fs_read(names[9].c_str(), 0, contents[9].size(), &readback[0]);
+    readback.resize(contents[9].size());
+    std::cout << "  rc=" << rc << ", en büyük boş alan: " << st.largest_free_extent_hint << " (İstenen: " << wanted << ")" << std::endl;
+    if (rc == 0 && st.largest_free_extent_hint >= wanted && readback == contents[9]) {
+        std::cout << "  [SUCCESS] Hedef tek taşımayla sağlandı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Boş alan hedefi sağlanamadı!" << std::endl;
+    }
+
+    // Test 3: Sıfır parçalanma hedefi ve zaten sağlanan / ulaşılamaz hedefler
+    std::cout << "\n[Test 3: Sıfır Parçalanma]" << std::endl;
+    rc = fs_plan_defrag(DEFRAG_TARGET_ZERO_FRAGMENTATION, 0, plan);
+    int64_t planned_bytes = plan.bytes_to_move;
+    int64_t full_bytes = plan.full_compaction_bytes;
+    int exec_rc = fs_defragment_to_target(DEFRAG_TARGET_ZERO_FRAGMENTATION, 0, false);
+    fs_statfs(st);
+    bool contents_ok = true;
+    for (int i = 0; i < num_files; i += (i < 8 ? 2 : 1)) {
+        std::string data(contents[i].size() + 1, '\0');
+        fs_read(names[i].c_str(), 0, contents[i].size(), &data[0]);
+        data.resize(contents[i].size());
+        if (data != contents[i]) contents_ok = false;
+    }
+    DefragPlan satisfied;
+    int satisfied_rc = fs_plan_defrag(DEFRAG_TARGET_FREE_EXTENT, 10, satisfied);
+    int unreachable_rc = fs_plan_defrag(DEFRAG_TARGET_FREE_EXTENT, st.free_blocks + 1, plan);
+    std::cout << "  rc=" << rc << "/" << exec_rc << ", byte: " << planned_bytes << " (tam: " << full_bytes << "), boş parça: " << st.free_extent_count
+              << ", zaten sağlanan: " << satisfied.strategy << ", ulaşılamaz rc=" << unreachable_rc << std::endl;
+    if (rc == 0 && exec_rc == 0 && planned_bytes <= full_bytes && st.free_extent_count == 1 && contents_ok &&
+        satisfied_rc == 0 && satisfied.moves.empty() && satisfied.strategy == "none" && unreachable_rc < 0) {
+        std::cout << "  [SUCCESS] Boş alan tek parça, gereksiz taşıma yok." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Sıfır parçalanma hedefi hatalı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Birleştirme Planlayıcısı Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_bulk_block_moves() {
+    std::cout << "\n--- Toplu Blok Taşıma Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    // Her blok farklı içerik taşır; yanlış sırayla yapılan çakışan kopya hemen görünür.
+    auto make_content = [](int blocks, char seed) {
+        std::string data(static_cast<size_t>(blocks) * BLOCK_SIZE_BYTES, '\0');
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<char>(seed + (i / BLOCK_SIZE_BYTES) * 7 + (i % 13));
+        }
+        return data;
+    };
+    auto read_back = [](const std::string& name, size_t size) {
+        std::string data(size + 1, '\0');
+        fs_read(name.c_str(), 0, size, &data[0]);
+        data.resize(size);
+        return data;
+    };
+
+    // Test 1: Çakışan aralıkta ileri ve geri taşıma
+    std::cout << "\n[Test 1: Çakışan Taşıma]" << std::endl;
+    std::string big = make_content(20, 'A');
+    fs_create("/bulk_big.dat");
+    fs_write("/bulk_big.dat", big.c_str(), big.size());
+    fs_sync();
+    FileInfo fi = fs_get_file_info_debug("/bulk_big.dat");
+    int start = fi.start_data_block_index;
+    int shift = (start + 25 <= static_cast<int>(NUM_DATA_BLOCKS)) ? 5 : -5; // Taşıma görüntünün içinde kalmalı
+    bool forward_ok = move_blocks_in_image(start, start + shift, 20);
+    bool backward_ok = move_blocks_in_image(start + shift, start, 20);
+    if (forward_ok && backward_ok && read_back("/bulk_big.dat", big.size()) == big) {
+        std::cout << "  [SUCCESS] İleri ve geri çakışan taşımalar içeriği korudu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Çakışan taşıma içeriği bozdu!" << std::endl;
+    }
+
+    // Test 2: Tam birleştirme hem kendi aralığı içinde kayan hem de uzağa taşınan dosyaları taşır
+    std::cout << "\n[Test 2: Tam Birleştirme]" << std::endl;
+    fs_format();
+    std::string small = make_content(3, 'a');
+    std::string large = make_content(40, 'K');
+    std::string tail = make_content(6, '0');
+    fs_create("/bulk_small.dat");
+    fs_write("/bulk_small.dat", small.c_str(), small.size());
+    fs_create("/bulk_large.dat");
+    fs_write("/bulk_large.dat", large.c_str(), large.size());
+    fs_create("/bulk_tail.dat");
+    fs_write("/bulk_tail.dat", tail.c_str(), tail.size());
+    fs_sync();
+    FileInfo tail_before = fs_get_file_info_debug("/bulk_tail.dat");
+    FileInfo large_before = fs_get_file_info_debug("/bulk_large.dat");
+    fs_delete("/bulk_small.dat"); // 3 bloklu delik: 6 bloklu dosya 3 blok geri kayar (çakışan taşıma)
+    fs_defragment();
+    FileInfo tail_fi = fs_get_file_info_debug("/bulk_tail.dat");
+    FileInfo large_fi = fs_get_file_info_debug("/bulk_large.dat");
+    if (tail_fi.start_data_block_index < tail_before.start_data_block_index &&
+        large_fi.start_data_block_index < large_before.start_data_block_index && read_back("/bulk_large.dat", large.size()) == large &&
+        read_back("/bulk_tail.dat", tail.size()) == tail) {
+        std::cout << "  [SUCCESS] Dosyalar öne toplandı, içerik doğru." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Tam birleştirme sonrası içerik hatalı!" << std::endl;
+    }
+
+    // Test 3: Artımlı birleştirme ve planlayıcı taşımaları da aynı yolu kullanır
+    std::cout << "\n[Test 3: Artımlı ve Planlı Taşımalar]" << std::endl;
+    fs_format();
+    const int num_files = 6;
+    std::string contents[num_files];
+    for (int i = 0; i < num_files; ++i) {
+        std::string name = "/bulk" + std::to_string(i) + ".dat";
+        contents[i] = make_content(5 + i, static_cast<char>('A' + i));
+        fs_create(name.c_str());
+        fs_write(name.c_str(), contents[i].c_str(), contents[i].size());
+    }
+    fs_sync();
+    fs_delete("/bulk0.dat");
+    fs_delete("/bulk3.dat");
+    int step_rc = 0;
+    for (int guard = 0; guard < 100 && (step_rc = fs_defragment_step(BLOCK_SIZE_BYTES * 4, 0)) == 0; ++guard) {}
+    fs_delete("/bulk1.dat");
+    int plan_rc = fs_defragment_to_target(DEFRAG_TARGET_ZERO_FRAGMENTATION, 0, false);
+    bool contents_ok = true;
+    for (int i : {2, 4, 5}) {
+        std::string name = "/bulk" + std::to_string(i) + ".dat";
+        if (read_back(name, contents[i].size()) != contents[i]) contents_ok = false;
+    }
+    FsStatfs st;
+    fs_statfs(st);
+    if (step_rc == 1 && plan_rc == 0 && contents_ok && st.free_extent_count == 1) {
+        std::cout << "  [SUCCESS] Artımlı ve planlı taşımalar içeriği korudu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Artımlı/planlı taşıma hatalı! (step_rc=" << step_rc << ", plan_rc=" << plan_rc << ")" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Toplu Blok Taşıma Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_frag_report() {
+    std::cout << "\n--- Parçalanma Raporu Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FragReport report;
+
+    // Test 1: Boş disk parçalanmamış
+    std::cout << "\n[Test 1: Boş Disk]" << std::endl;
+    int rc = fs_frag_report(report);
+    if (rc == 0 && report.free_extent_count == 1 && report.largest_free_extent == report.free_blocks &&
+        report.score == 0 && !report.defrag_recommended && report.files.size() == 1) {
+        std::cout << "  [SUCCESS] Tek boş parça, skor 0, sadece kök dizin listelendi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Boş disk raporu beklenmedik! (score=" << report.score << ")" << std::endl;
+    }
+
+    // Test 2: Delikler histogramda, kuyruklar ve boşa giden byte'lar dosya başına görünür
+    std::cout << "\n[Test 2: Delikli Disk]" << std::endl;
+    const int num_files = 8;
+    std::string names[num_files];
+    for (int i = 0; i < num_files; ++i) {
+        names[i] = "/frag" + std::to_string(i) + ".dat";
+        std::string data(3 * BLOCK_SIZE_BYTES, static_cast<char>('a' + i));
+        fs_create(names[i].c_str());
+        fs_write(names[i].c_str(), data.c_str(), data.size());
+    }
+    std::string tailed(2 * BLOCK_SIZE_BYTES + 40, 't');       // 40 byte'lık kuyruk paylaşılan bloğa paketlenir
+    std::string slack(BLOCK_SIZE_BYTES + TAIL_PACK_MAX_BYTES + 44, 's'); // Kuyruk paketleme sınırının üstü: son blokta boşluk kalır
+    fs_create("/tailed.dat");
+    fs_write("/tailed.dat", tailed.c_str(), tailed.size());
+    fs_create("/slack.dat");
+    fs_write("/slack.dat", slack.c_str(), slack.size());
+    fs_sync();
+    for (int i = 0; i < num_files; i += 2) fs_delete(names[i].c_str()); // 3 bloklu dört delik
+    fs_frag_report(report);
+    FsStatfs st;
+    fs_statfs(st);
+    const FileFragInfo* tailed_info = nullptr;
+    const FileFragInfo* slack_info = nullptr;
+    for (const FileFragInfo& file : report.files) {
+        if (file.path == "/tailed.dat") tailed_info = &file;
+        if (file.path == "/slack.dat") slack_info = &file;
+    }
+    std::cout << "  Boş parça: " << report.free_extent_count << ", 2-3 bloklu: " << report.free_extent_histogram[1]
+              << ", skor: " << report.score << std::endl;
+    int64_t expected_slack = slack_info ? static_cast<int64_t>(slack_info->data_blocks) * BLOCK_SIZE_BYTES - slack_info->size : -1;
+    if (report.free_extent_histogram[1] >= 3 && report.free_extent_count == st.free_extent_count &&
+        report.free_blocks == st.free_blocks && report.wasted_tail_bytes == st.slack_bytes &&
+        tailed_info != nullptr && tailed_info->extent_count == 2 && report.fragmented_files == st.fragmented_files &&
+        slack_info != nullptr && slack_info->extent_count == 1 && slack_info->wasted_tail_bytes == expected_slack && expected_slack > 0) {
+        std::cout << "  [SUCCESS] Histogram, dosya başına extent ve boşa giden byte'lar fs_statfs ile tutarlı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Delikli disk raporu tutarsız!" << std::endl;
+    }
+
+    // Test 3: Birleştirme sonrası boş alan parçalanması sıfırlanır; JSON çıktısı üretilir
+    std::cout << "\n[Test 3: Birleştirme Sonrası ve JSON]" << std::endl;
+    int before_free_space = report.free_space_fragmentation;
+    fs_defragment();
+    fs_frag_report(report, FRAG_REPORT_JSON);
+    int bad_format_rc = fs_frag_report(report, 99);
+    fs_frag_report(report);
+    if (before_free_space > 0 && report.free_space_fragmentation == 0 && report.free_extent_count == 1 &&
+        !report.defrag_recommended && bad_format_rc < 0) {
+        std::cout << "  [SUCCESS] Birleştirme sonrası boş alan tek parça, birleştirme önerilmiyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Birleştirme sonrası rapor beklenmedik!" << std::endl;
+    }
+
+    fs_format();
+    std::cout << "\n--- Parçalanma Raporu Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_concurrent_access() {
+    std::cout << "\n--- Eşzamanlı Erişim Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    const int num_static = 4;
+    const int num_hot = 2;
+    const int hot_size = 3 * BLOCK_SIZE_BYTES + 100;
+    std::string static_names[num_static];
+    std::string static_contents[num_static];
+    for (int i = 0; i < num_static; ++i) {
+        static_names[i] = "/static" + std::to_string(i) + ".dat";
+        static_contents[i] = std::string(2 * BLOCK_SIZE_BYTES + 37 * i, static_cast<char>('a' + i));
+        fs_create(static_names[i].c_str());
+        fs_write(static_names[i].c_str(), static_contents[i].c_str(), static_contents[i].size());
+    }
+    std::string hot_names[num_hot];
+    for (int i = 0; i < num_hot; ++i) {
+        hot_names[i] = "/hot" + std::to_string(i) + ".dat";
+        std::string initial(hot_size, 'A');
+        fs_create(hot_names[i].c_str());
+        fs_write(hot_names[i].c_str(), initial.c_str(), initial.size());
+    }
+    fs_sync();
+
+    // Test 1: Okuyucular, yazanlar ve arka plan birleştirmesi aynı anda
+    std::cout << "\n[Test 1: Okuyucular + Yazanlar + Arka Plan Birleştirme]" << std::endl;
+    std::atomic<int> read_errors(0);
+    std::atomic<int> reads_done(0);
+    std::atomic<int> writes_done(0);
+    fs_defrag_start_background(4 * BLOCK_SIZE_BYTES, 0, 1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            std::string buffer;
+            for (int iter = 0; iter < 60; ++iter) {
+                const std::string& name = static_names[(t + iter) % num_static];
+                const std::string& expected = static_contents[(t + iter) % num_static];
+                buffer.assign(expected.size() + 1, '\0');
+                fs_read(name.c_str(), 0, expected.size(), &buffer[0]);
+                if (buffer.compare(0, expected.size(), expected) != 0) read_errors++;
+                // Sıcak dosyalar yazılırken okunur: içerik yarım kalmış bir yazma olmamalı (tek karakter)
+                buffer.assign(hot_size + 1, '\0');
+                fs_read(hot_names[iter % num_hot].c_str(), 0, hot_size, &buffer[0]);
+                if (buffer.find_first_not_of(buffer[0], 0) < static_cast<size_t>(hot_size) || buffer[0] < 'A' || buffer[0] > 'Z') {
+                    read_errors++;
+                }
+                reads_done++;
+            }
+        }));
+    }
+    for (int w = 0; w < num_hot; ++w) {
+        threads.push_back(std::thread([&, w]() {
+            for (int iter = 0; iter < 40; ++iter) {
+                std::string version(hot_size, static_cast<char>('A' + (iter + w) % 26));
+                if (fs_write(hot_names[w].c_str(), version.c_str(), version.size()) == hot_size) writes_done++;
+                if (iter % 8 == 0) fs_sync();
+            }
+        }));
+    }
+    for (std::thread& thread : threads) thread.join();
+    fs_defrag_stop_background();
+    fs_sync();
+
+    bool static_ok = true;
+    for (int i = 0; i < num_static; ++i) {
+        std::string data(static_contents[i].size() + 1, '\0');
+        fs_read(static_names[i].c_str(), 0, static_contents[i].size(), &data[0]);
+        data.resize(static_contents[i].size());
+        if (data != static_contents[i]) static_ok = false;
+    }
+    std::cout << "  Okuma: " << reads_done.load() << ", yazma: " << writes_done.load() << ", okuma hatası: " << read_errors.load() << std::endl;
+    if (read_errors.load() == 0 && reads_done.load() == 4 * 60 && writes_done.load() == num_hot * 40 && static_ok) {
+        std::cout << "  [SUCCESS] Eşzamanlı okuma/yazma tutarlı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Eşzamanlı erişimde tutarsızlık!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Eşzamanlı Erişim Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_lock_free_allocation() {
+    std::cout << "\n--- Kilitsiz Bitmap Tahsisi Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    FsStatfs before;
+    fs_statfs(before);
+
+    // Test 1: Eşzamanlı tahsis/serbest bırakma aynı bloğu iki kez vermemeli
+    std::cout << "\n[Test 1: Eşzamanlı Tahsis ve Serbest Bırakma]" << std::endl;
+    const int num_threads = 4;
+    std::vector<std::atomic<int> > owner(NUM_DATA_BLOCKS);
+    for (std::atomic<int>& o : owner) o.store(-1);
+    std::atomic<int> double_allocations(0);
+    std::atomic<int> allocations(0);
+    std::vector<int> first_groups(num_threads, -1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            std::vector<std::pair<int, int> > held; // (başlangıç, blok sayısı)
+            for (int iter = 0; iter < 150; ++iter) {
+                int count = 1 + (iter * 7 + t) % 8;
+                int start;
+                if (iter % 25 == 24) {
+                    start = find_and_allocate_contiguous_data_blocks(12); // Büyük: bitmap'in tamamı taranır
+                    count = 12;
+                } else if (count == 1) {
+                    start = find_free_data_block();
+                } else {
+                    start = find_and_allocate_contiguous_data_blocks(count);
+                }
+                if (start == -1) continue;
+                if (first_groups[t] == -1) first_groups[t] = start / ALLOCATION_GROUP_BLOCKS;
+                allocations++;
+                for (int b = start; b < start + count; ++b) {
+                    int expected = -1;
+                    if (!owner[b].compare_exchange_strong(expected, t)) double_allocations++;
+                }
+                held.push_back(std::make_pair(start, count));
+                if (held.size() > 6) { // En eskiyi bırak
+                    std::pair<int, int> victim = held.front();
+                    held.erase(held.begin());
+                    for (int b = victim.first; b < victim.first + victim.second; ++b) {
+                        owner[b].store(-1);
+                        free_data_block(b);
+                    }
+                }
+            }
+            for (const std::pair<int, int>& run : held) {
+                for (int b = run.first; b < run.first + run.second; ++b) {
+                    owner[b].store(-1);
+                    free_data_block(b);
+                }
+            }
+        }));
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    FsStatfs after;
+    fs_statfs(after);
+    std::cout << "  Tahsis: " << allocations.load() << ", çift tahsis: " << double_allocations.load()
+              << ", boş blok önce/sonra: " << before.free_blocks << "/" << after.free_blocks << std::endl;
+    if (double_allocations.load() == 0 && allocations.load() > 0 && after.free_blocks == before.free_blocks &&
+        after.free_extent_count == before.free_extent_count) {
+        std::cout << "  [SUCCESS] Hiçbir blok iki kez verilmedi, tüm bloklar geri döndü." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Eşzamanlı tahsiste tutarsızlık!" << std::endl;
+    }
+
+    // Test 2: Her iş parçacığı aramaya kendi ev grubundan başlar
+    std::cout << "\n[Test 2: İş Parçacığı Başına Ev Grupları]" << std::endl;
+    std::vector<int> sorted_groups(first_groups);
+    std::sort(sorted_groups.begin(), sorted_groups.end());
+    bool distinct = std::unique(sorted_groups.begin(), sorted_groups.end()) == sorted_groups.end() && sorted_groups[0] != -1;
+    // Küçük tahsisler diskin ön yarısında kalmalı (büyük sınıf arkadan tahsis edilir)
+    bool front_half = sorted_groups.back() < static_cast<int>(NUM_ALLOCATION_GROUPS > 1 ? NUM_ALLOCATION_GROUPS / 2 : 1);
+    std::cout << "  İlk tahsis grupları:";
+    for (int g : first_groups) std::cout << " " << g;
+    std::cout << std::endl;
+    if (distinct && front_half) {
+        std::cout << "  [SUCCESS] İş parçacıkları ön yarıdaki farklı gruplardan başladı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] İş parçacıkları aynı gruptan başladı!" << std::endl;
+    }
+    fs_check_integrity();
+
+    // Test 3: Tahsis sadece bellekteki bitmap'i ve sayaçları değiştirir; diske fs_sync yazar
+    std::cout << "\n[Test 3: Tahsis Durumu fs_sync'te Diske Yazılır]" << std::endl;
+    fs_sync();
+    SpaceStats on_disk_before, on_disk_claimed, on_disk_synced;
+    std::ifstream image(DISK_FILENAME, std::ios::binary);
+    image.seekg(offsetof(Superblock, stats));
+    image.read(reinterpret_cast<char*>(&on_disk_before), sizeof(SpaceStats));
+    int claimed = find_and_allocate_contiguous_data_blocks(3);
+    image.seekg(offsetof(Superblock, stats));
+    image.read(reinterpret_cast<char*>(&on_disk_claimed), sizeof(SpaceStats));
+    fs_sync();
+    image.seekg(offsetof(Superblock, stats));
+    image.read(reinterpret_cast<char*>(&on_disk_synced), sizeof(SpaceStats));
+    std::cout << "  Diskteki boş blok: önce " << on_disk_before.free_blocks << ", tahsisten sonra " << on_disk_claimed.free_blocks
+              << ", fs_sync'ten sonra " << on_disk_synced.free_blocks << std::endl;
+    if (claimed != -1 && on_disk_claimed.free_blocks == on_disk_before.free_blocks && on_disk_synced.free_blocks == on_disk_before.free_blocks - 3) {
+        std::cout << "  [SUCCESS] Tahsis diske yazmadı, fs_sync yazdı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Tahsis durumu beklenmedik anda diske yazıldı (veya hiç yazılmadı)!" << std::endl;
+    }
+    for (int b = claimed; claimed != -1 && b < claimed + 3; ++b) free_data_block(b);
+    fs_check_integrity();
+
+    // Test 4: fs_unmount'suz çıkışta tahsisler diske hiç yazılmaz; yeniden bağlanan görüntü aynı blokları vermemeli
+    std::cout << "\n[Test 4: Temiz Olmayan Kapanıştan Sonra Tahsis]" << std::endl;
+    const int64_t crash_size = 100 * 1024; // Gecikmeli tahsis sınırını aşar, hemen diske yazılır
+    std::vector<char> data_a(crash_size, 'A'), data_b(crash_size, 'B'), read_back(crash_size, 0);
+    fs_create("/crash_a.dat");
+    fs_write("/crash_a.dat", data_a.data(), crash_size);
+    allocation_state_invalidate(); // Süreç burada ölür: bellekteki bitmap ve sayaçlar kaybolur
+    fs_mount(fs_get_block_device()); // Yeni süreç aynı görüntüyü bağlar
+    fs_create("/crash_b.dat");
+    fs_write("/crash_b.dat", data_b.data(), crash_size);
+    fs_read("/crash_a.dat", 0, crash_size, read_back.data());
+    FileInfo crash_a = fs_get_file_info_debug("/crash_a.dat");
+    FileInfo crash_b = fs_get_file_info_debug("/crash_b.dat");
+    bool overlap = crash_a.start_data_block_index < crash_b.start_data_block_index + crash_b.num_data_blocks_used &&
+                   crash_b.start_data_block_index < crash_a.start_data_block_index + crash_a.num_data_blocks_used;
+    std::cout << "  /crash_a.dat: " << crash_a.start_data_block_index << "+" << crash_a.num_data_blocks_used
+              << ", /crash_b.dat: " << crash_b.start_data_block_index << "+" << crash_b.num_data_blocks_used << std::endl;
+    if (!overlap && crash_a.num_data_blocks_used > 0 && read_back == data_a) {
+        std::cout << "  [SUCCESS] Bitmap FileInfo tablosundan yeniden kuruldu, ilk dosyanın verisi korundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Kapanıştan sonra aynı bloklar yeniden verildi!" << std::endl;
+    }
+    fs_check_integrity();
+
+    fs_format();
+    std::cout << "\n--- Kilitsiz Bitmap Tahsisi Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_async_io() {
+    std::cout << "\n--- Asenkron G/Ç Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    const int num_files = 4;
+    std::string names[num_files];
+    std::string contents[num_files];
+    for (int i = 0; i < num_files; ++i) {
+        names[i] = "/async" + std::to_string(i) + ".dat";
+        contents[i] = std::string(BLOCK_SIZE_BYTES * (i + 1) + 17 * i, static_cast<char>('k' + i));
+        fs_create(names[i].c_str());
+    }
+
+    // Test 1: Future döndüren yazma/okuma
+    std::cout << "\n[Test 1: Future ile Yazma ve Okuma]" << std::endl;
+    std::vector<std::future<int64_t> > writes;
+    for (int i = 0; i < num_files; ++i) {
+        writes.push_back(fs_write_async(names[i].c_str(), contents[i].data(), contents[i].size()));
+    }
+    bool writes_ok = true;
+    for (int i = 0; i < num_files; ++i) {
+        if (writes[i].get() != static_cast<int64_t>(contents[i].size())) writes_ok = false;
+    }
+    bool sync_ok = (fs_sync_async().get() == 0);
+
+    const int reads_per_file = 8;
+    std::vector<std::vector<char> > buffers(num_files * reads_per_file);
+    std::vector<std::future<int64_t> > reads;
+    for (int r = 0; r < num_files * reads_per_file; ++r) {
+        int i = r % num_files;
+        buffers[r].assign(contents[i].size() + 1, '\0');
+        reads.push_back(fs_read_async(names[i].c_str(), 0, contents[i].size(), &buffers[r][0]));
+    }
+    bool reads_ok = true;
+    for (int r = 0; r < num_files * reads_per_file; ++r) {
+        int i = r % num_files;
+        if (reads[r].get() != static_cast<int64_t>(contents[i].size()) ||
+            std::string(&buffers[r][0], contents[i].size()) != contents[i]) {
+            reads_ok = false;
+        }
+    }
+    if (writes_ok && sync_ok && reads_ok) {
+        std::cout << "  [SUCCESS] " << num_files << " asenkron yazma ve " << num_files * reads_per_file << " asenkron okuma doğru sonuçlandı." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Asenkron yazma/okuma sonucu hatalı! (yazma: " << writes_ok << ", sync: " << sync_ok << ", okuma: " << reads_ok << ")" << std::endl;
+    }
+
+    // Test 2: Tamamlanma geri çağrısı ve fs_async_drain
+    std::cout << "\n[Test 2: Tamamlanma Geri Çağrıları]" << std::endl;
+    std::atomic<int> completed(0);
+    std::atomic<int64_t> bytes_total(0);
+    std::vector<std::vector<char> > cb_buffers(num_files);
+    for (int i = 0; i < num_files; ++i) {
+        cb_buffers[i].assign(contents[i].size() + 1, '\0');
+        fs_read_async(names[i].c_str(), 1, contents[i].size(), &cb_buffers[i][0], [&](int64_t result) {
+            if (result > 0) bytes_total += result;
+            completed++;
+        });
+    }
+    fs_async_drain();
+    int64_t expected_total = 0;
+    for (int i = 0; i < num_files; ++i) expected_total += static_cast<int64_t>(contents[i].size()) - 1;
+    if (completed.load() == num_files && bytes_total.load() == expected_total) {
+        std::cout << "  [SUCCESS] Tüm geri çağrılar çalıştı, toplam " << bytes_total.load() << " byte okundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Geri çağrılar eksik veya yanlış! (" << completed.load() << " çağrı, " << bytes_total.load() << " byte)" << std::endl;
+    }
+
+    // Test 3: Hata kodları future üzerinden döner
+    std::cout << "\n[Test 3: Asenkron Hata Kodları]" << std::endl;
+    char small_buffer[16];
+    int64_t missing_read = fs_read_async("/yok.dat", 0, 8, small_buffer).get();
+    int64_t missing_write = fs_write_async("/yok.dat", "abc", 3).get();
+    if (missing_read < 0 && missing_write < 0) {
+        std::cout << "  [SUCCESS] Olmayan dosya için negatif sonuç döndü (okuma " << missing_read << ", yazma " << missing_write << ")." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Olmayan dosya için hata bekleniyordu!" << std::endl;
+    }
+
+    // Test 4: Geri çağrı başka bir async işi bekleyebilir (G/Ç iş parçacıkları tıkanmaz); havuzdan cildi beklemek reddedilir
+    std::cout << "\n[Test 4: Geri Çağrıda Bekleme]" << std::endl;
+    const int num_callbacks = static_cast<int>(ASYNC_IO_THREADS) * 2;
+    std::atomic<int> nested_ok(0);
+    std::atomic<int> drain_refused(0);
+    std::atomic<int> unmount_refused(0);
+    std::vector<std::vector<char> > nested_buffers(num_callbacks, std::vector<char>(contents[0].size() + 1, '\0'));
+    for (int i = 0; i < num_callbacks; ++i) {
+        std::vector<char>* nested_buffer = &nested_buffers[i];
+        fs_read_async(names[0].c_str(), 0, 1, &(*nested_buffer)[0], [&, nested_buffer](int64_t) {
+            if (fs_read_async(names[0].c_str(), 0, contents[0].size(), &(*nested_buffer)[0]).get() == static_cast<int64_t>(contents[0].size())) nested_ok++;
+            if (fs_async_drain() == FS_ERROR_ASYNC_WORKER) drain_refused++;
+            if (fs_unmount() == FS_ERROR_ASYNC_WORKER) unmount_refused++;
+        });
+    }
+    int drained = fs_async_drain();
+    if (drained == 0 && nested_ok.load() == num_callbacks && drain_refused.load() == num_callbacks && unmount_refused.load() == num_callbacks) {
+        std::cout << "  [SUCCESS] " << num_callbacks << " geri çağrı iç içe async okumayı bekledi; havuzdan fs_async_drain/fs_unmount reddedildi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Geri çağrıda bekleme hatalı! (iç içe: " << nested_ok.load() << ", drain reddi: " << drain_refused.load()
+                  << ", unmount reddi: " << unmount_refused.load() << ")" << std::endl;
+    }
+
+    fs_unmount(); // Havuzu da durdurur
+    fs_format();
+    std::cout << "\n--- Asenkron G/Ç Testleri Tamamlandı ---" << std::endl;
+}
+
+void test_io_uring_backend() {
+    std::cout << "\n--- Blok G/Ç Arka Ucu (io_uring) Testleri Başlıyor ---" << std::endl;
+    fs_format();
+    // Büyük dosya kayıtlı ara tampona sığmaz (kullanıcı tamponu ile gönderilir); küçük dosyanın kuyruğu paylaşılan bloğa düşer.
+    std::string big(URING_FIXED_BUFFER_BYTES + 3 * BLOCK_SIZE_BYTES + 100, '\0');
+    for (size_t i = 0; i < big.size(); ++i) big[i] = static_cast<char>('a' + (i * 7) % 26);
+    std::string small(2 * BLOCK_SIZE_BYTES + 37, '\0');
+    for (size_t i = 0; i < small.size(); ++i) small[i] = static_cast<char>('A' + (i * 3) % 26);
+
+    const int backends[2] = {IO_BACKEND_IO_URING, IO_BACKEND_PREAD};
+    for (int b = 0; b < 2; ++b) {
+        fs_set_io_backend(backends[b]);
+        std::string big_name = "/uring_big" + std::to_string(b) + ".dat";
+        std::string small_name = "/uring_small" + std::to_string(b) + ".dat";
+        fs_create(big_name.c_str());
+        fs_create(small_name.c_str());
+        fs_write(big_name.c_str(), big.data(), big.size());
+        fs_write(small_name.c_str(), small.data(), small.size());
+        fs_sync();
+
+        std::vector<char> buffer(big.size() + 1, '\0');
+        fs_read(big_name.c_str(), 0, big.size(), &buffer[0]);
+        bool big_ok = std::string(&buffer[0], big.size()) == big;
+        // Blok kısmı ile paylaşılan kuyruğu birlikte kapsayan ofsetli okuma (iki istekli toplu okuma).
+        int64_t from = BLOCK_SIZE_BYTES + 5;
+        std::fill(buffer.begin(), buffer.end(), '\0');
+        fs_read(small_name.c_str(), from, small.size(), &buffer[0]);
+        bool small_ok = std::string(&buffer[0]) == small.substr(from);
+        FileInfo small_info = fs_get_file_info_debug(small_name.c_str());
+        int used = fs_get_io_backend();
+        // Arka uç cilde aittir: başka bir iş parçacığı da aynı değeri görmeli.
+        int used_elsewhere = -1;
+        std::thread observer([&used_elsewhere]() { used_elsewhere = fs_get_io_backend(); });
+        observer.join();
+        bool backend_ok = ((backends[b] == IO_BACKEND_PREAD) ? used == IO_BACKEND_PREAD : true) && used_elsewhere == used;
+        std::string label = (backends[b] == IO_BACKEND_IO_URING) ? "io_uring" : "pread/pwrite";
+        if (big_ok && small_ok && backend_ok) {
+            std::cout << "  [SUCCESS] " << label << " istendi: büyük dosya ve kuyruklu okuma doğru (kullanılan yol: "
+                      << (used == IO_BACKEND_IO_URING ? "io_uring" : "pread/pwrite")
+                      << ", kuyruk bloğu " << small_info.tail_block_index << ")." << std::endl;
+        } else {
+            std::cout << "  [FAILURE] " << label << " ile okuma/yazma hatalı! (büyük: " << big_ok << ", kuyruk: " << small_ok
+                      << ", arka uç: " << used << ")" << std::endl;
+        }
+    }
+
+    // Diğer arka uçla yazılan veri bu arka uçla da aynı okunmalı (aynı disk görüntüsü).
+    fs_set_io_backend(IO_BACKEND_IO_URING);
+    std::vector<char> cross(small.size() + 1, '\0');
+    fs_read("/uring_small1.dat", 0, small.size(), &cross[0]);
+    if (std::string(&cross[0]) == small) {
+        std::cout << "  [SUCCESS] pread/pwrite ile yazılan dosya io_uring arka ucuyla doğru okundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Arka uçlar arası okuma hatalı!" << std::endl;
+    }
+
+    fs_format();
+    std::cout << "--- Blok G/Ç Arka Ucu (io_uring) Testleri Bitti ---" << std::endl;
+}
+
+void test_block_devices() {
+    std::cout << "\n--- Blok Aygıtı Arka Uç Testleri Başlıyor ---" << std::endl;
+    const int types[5] = {BLOCK_DEVICE_BUFFERED_FILE, BLOCK_DEVICE_PREAD, BLOCK_DEVICE_MMAP, BLOCK_DEVICE_DIRECT, BLOCK_DEVICE_RAM};
+    const char* type_names[5] = {"tamponlu fstream", "pread/pwrite", "mmap", "O_DIRECT", "RAM"};
+    std::string content(7 * BLOCK_SIZE_BYTES + 123, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>('a' + (i * 11) % 26);
+
+    // Test 1: Her aygıtta yazma, ofsetli okuma ve birleştirme (aygıt içi taşıma)
+    std::cout << "\n[Test 1: Aygıt Başına Okuma/Yazma]" << std::endl;
+    for (int t = 0; t < 5; ++t) {
+        int rc = fs_mount(types[t]);
+        if (rc != 0) {
+            std::cout << "  [FAILURE] " << type_names[t] << " aygıtı bağlanamadı (kod " << rc << ")." << std::endl;
+            continue;
+        }
+        fs_format();
+        fs_create("/dev_gap.dat");
+        fs_write("/dev_gap.dat", content.data(), 3 * BLOCK_SIZE_BYTES);
+        fs_create("/dev_data.dat");
+        fs_write("/dev_data.dat", content.data(), content.size());
+        fs_delete("/dev_gap.dat");
+        fs_defragment(); // Boşluk kapanırken bloklar aygıtın move_range'i ile taşınır
+        std::vector<char> buffer(content.size() + 1, '\0');
+        fs_read("/dev_data.dat", 100, content.size(), &buffer[0]);
+        bool ok = fs_get_block_device() == types[t] && std::string(&buffer[0]) == content.substr(100);
+        if (ok) {
+            std::cout << "  [SUCCESS] " << type_names[t] << " aygıtında yazılan ve taşınan veri doğru okundu." << std::endl;
+        } else {
+            std::cout << "  [FAILURE] " << type_names[t] << " aygıtında okunan veri hatalı!" << std::endl;
+        }
+    }
+
+    // Test 2: Dosya tabanlı aygıtlar aynı disk.sim'i görür, RAM diski ona dokunmaz
+    std::cout << "\n[Test 2: Aygıtlar Arası Görüntü Paylaşımı]" << std::endl;
+    fs_mount(BLOCK_DEVICE_PREAD);
+    fs_format();
+    fs_create("/dev_shared.dat");
+    fs_write("/dev_shared.dat", content.data(), content.size());
+    bool seen_by_files = true;
+    const int file_types[2] = {BLOCK_DEVICE_MMAP, BLOCK_DEVICE_BUFFERED_FILE};
+    for (int t = 0; t < 2; ++t) {
+        fs_mount(file_types[t]);
+        std::vector<char> buffer(content.size() + 1, '\0');
+        fs_read("/dev_shared.dat", 0, content.size(), &buffer[0]);
+        if (std::string(&buffer[0]) != content) seen_by_files = false;
+    }
+    fs_mount(BLOCK_DEVICE_RAM);
+    bool ram_is_fresh = !fs_exists("/dev_shared.dat");
+    fs_create("/dev_ram_only.dat");
+    fs_mount(BLOCK_DEVICE_PREAD);
+    bool file_untouched = fs_exists("/dev_shared.dat") && !fs_exists("/dev_ram_only.dat");
+    if (seen_by_files && ram_is_fresh && file_untouched) {
+        std::cout << "  [SUCCESS] mmap ve fstream aygıtları aynı görüntüyü okudu; RAM diski disk.sim'den bağımsız." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Aygıtlar arası görüntü hatalı! (dosya aygıtları: " << seen_by_files << ", RAM boş: " << ram_is_fresh
+                  << ", disk.sim korundu: " << file_untouched << ")" << std::endl;
+    }
+
+    // Test 3: RAM diski fs_unmount sonrasında da içeriğini korur
+    std::cout << "\n[Test 3: RAM Diski ve fs_unmount]" << std::endl;
+    fs_mount(BLOCK_DEVICE_RAM);
+    fs_create("/dev_ram.dat");
+    fs_write("/dev_ram.dat", content.data(), content.size());
+    fs_unmount();
+    std::vector<char> ram_buffer(content.size() + 1, '\0');
+    fs_read("/dev_ram.dat", 0, content.size(), &ram_buffer[0]);
+    if (std::string(&ram_buffer[0]) == content && fs_get_block_device() == BLOCK_DEVICE_RAM) {
+        std::cout << "  [SUCCESS] RAM diskindeki dosya bağlantı kesildikten sonra da okunabildi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] RAM diski içeriği kayboldu!" << std::endl;
+    }
+
+    // Test 4: Geçersiz aygıt türü reddedilir, bağlı aygıt değişmez
+    std::cout << "\n[Test 4: Geçersiz Aygıt Türü]" << std::endl;
+    if (fs_mount(42) == -1 && fs_get_block_device() == BLOCK_DEVICE_RAM) {
+        std::cout << "  [SUCCESS] Bilinmeyen aygıt türü -1 ile reddedildi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Bilinmeyen aygıt türü kabul edildi!" << std::endl;
+    }
+
+    fs_mount(BLOCK_DEVICE_PREAD);
+    fs_format();
+    std::cout << "--- Blok Aygıtı Arka Uç Testleri Bitti ---" << std::endl;
+}
+
+void test_ram_disk() {
+    std::cout << "\n--- RAM Diski Testleri Başlıyor ---" << std::endl;
+    const char* image_file = "ram_disk_test.img";
+    std::remove(image_file);
+    fs_mount(BLOCK_DEVICE_PREAD);
+    fs_format();
+    std::ifstream before_stream(DISK_FILENAME, std::ios::binary);
+    std::string disk_before((std::istreambuf_iterator<char>(before_stream)), std::istreambuf_iterator<char>());
+    before_stream.close();
+    std::string content(5 * BLOCK_SIZE_BYTES + 77, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>('a' + (i * 5) % 26);
+
+    // Test 1: Anonim mmap tamponlu RAM diski, fs_sync'te görüntüyü dosyaya yazar, disk.sim'e dokunmaz
+    std::cout << "\n[Test 1: Anonim mmap RAM Diski ve Görüntü Yazma]" << std::endl;
+    RamDiskOptions dump_options;
+    dump_options.dump_image = image_file;
+    dump_options.anonymous_mmap = true;
+    int mount_result = fs_mount_ram(dump_options);
+    fs_create("/ram_a.dat");
+    fs_write("/ram_a.dat", content.data(), content.size());
+    fs_create("/ram_b.dat");
+    fs_write("/ram_b.dat", "kucuk", 5);
+    fs_sync();
+    std::ifstream image_stream(image_file, std::ios::binary | std::ios::ate);
+    int64_t image_size = image_stream ? static_cast<int64_t>(image_stream.tellg()) : -1;
+    image_stream.close();
+    std::ifstream after_stream(DISK_FILENAME, std::ios::binary);
+    std::string disk_after((std::istreambuf_iterator<char>(after_stream)), std::istreambuf_iterator<char>());
+    after_stream.close();
+    if (mount_result == 0 && image_size == static_cast<int64_t>(DISK_SIZE_BYTES) && disk_after == disk_before) {
+        std::cout << "  [SUCCESS] RAM diski görüntüsü '" << image_file << "' dosyasına yazıldı, disk.sim değişmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] RAM diski görüntüsü hatalı! (bağlama: " << mount_result << ", görüntü boyutu: " << image_size
+                  << ", disk.sim korundu: " << (disk_after == disk_before) << ")" << std::endl;
+    }
+
+    // Test 2: Yazılan görüntü heap tamponlu yeni bir RAM diskine yüklenir
+    std::cout << "\n[Test 2: Görüntüden Yükleme]" << std::endl;
+    RamDiskOptions load_options;
+    load_options.load_image = image_file;
+    mount_result = fs_mount_ram(load_options);
+    std::vector<char> buffer(content.size() + 1, '\0');
+    fs_read("/ram_a.dat", 0, content.size(), &buffer[0]);
+    char small_buffer[8] = {0};
+    fs_read("/ram_b.dat", 0, 5, small_buffer);
+    if (mount_result == 0 && std::string(&buffer[0]) == content && std::string(small_buffer) == "kucuk") {
+        std::cout << "  [SUCCESS] Görüntüden yüklenen RAM diskindeki dosyalar doğru okundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Görüntüden yüklenen RAM diski hatalı! (bağlama: " << mount_result << ")" << std::endl;
+    }
+
+    // Test 3: Geçersiz görüntü reddedilir, bağlı RAM diski korunur
+    std::cout << "\n[Test 3: Geçersiz Görüntü]" << std::endl;
+    RamDiskOptions bad_options;
+    bad_options.load_image = "yok_boyle_bir_goruntu.img";
+    int bad_result = fs_mount_ram(bad_options);
+    if (bad_result == -2 && fs_get_block_device() == BLOCK_DEVICE_RAM && fs_exists("/ram_a.dat")) {
+        std::cout << "  [SUCCESS] Olmayan görüntü -2 ile reddedildi, bağlı RAM diski değişmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Geçersiz görüntü yanlış işlendi! (kod " << bad_result << ")" << std::endl;
+    }
+
+    // Test 4: Loglama kapatılabilir
+    std::cout << "\n[Test 4: Loglamayı Kapatma]" << std::endl;
+    std::ifstream log_before(LOG_FILENAME, std::ios::binary | std::ios::ate);
+    int64_t log_size_before = log_before ? static_cast<int64_t>(log_before.tellg()) : 0;
+    log_before.close();
+    fs_set_log_file(nullptr);
+    fs_create("/ram_sessiz.dat");
+    fs_write("/ram_sessiz.dat", "sessiz", 6);
+    fs_set_log_file(LOG_FILENAME);
+    std::ifstream log_after(LOG_FILENAME, std::ios::binary | std::ios::ate);
+    int64_t log_size_after = log_after ? static_cast<int64_t>(log_after.tellg()) : 0;
+    log_after.close();
+    if (log_size_after == log_size_before && fs_exists("/ram_sessiz.dat")) {
+        std::cout << "  [SUCCESS] Loglama kapalıyken " << LOG_FILENAME << " büyümedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Loglama kapalıyken log dosyası değişti!" << std::endl;
+    }
+
+    fs_mount(BLOCK_DEVICE_PREAD);
+    fs_format();
+    std::remove(image_file);
+    std::cout << "--- RAM Diski Testleri Bitti ---" << std::endl;
+}
+
+void test_direct_io() {
+    std::cout << "\n--- O_DIRECT Aygıtı ve Sayfa Önbelleği Testleri Başlıyor ---" << std::endl;
+    std::string content(5 * DIRECT_IO_ALIGNMENT + 777, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>('a' + (i * 7) % 26);
+
+    // Test 1: Hizasız eklemeler önbellekte okuma-değiştir-yaz ile yapılır, tekrar okumalar önbellekten gelir
+    std::cout << "\n[Test 1: Hizasız Yazma ve Önbellekten Okuma]" << std::endl;
+    if (fs_mount(BLOCK_DEVICE_DIRECT) != 0) {
+        std::cout << "  [FAILURE] O_DIRECT aygıtı bağlanamadı." << std::endl;
+        return;
+    }
+    fs_format();
+    fs_create("/direct.dat");
+    for (size_t done = 0; done < content.size(); done += 1001) { // 1001 byte: her ekleme sayfa sınırlarını kaydırır
+        size_t chunk = std::min<size_t>(1001, content.size() - done);
+        fs_append("/direct.dat", content.data() + done, static_cast<int>(chunk));
+    }
+    DirectIoStats before;
+    fs_get_direct_io_stats(before);
+    std::vector<char> buffer(content.size() + 1, '\0');
+    fs_read("/direct.dat", 0, content.size(), &buffer[0]);
+    fs_read("/direct.dat", 0, content.size(), &buffer[0]);
+    DirectIoStats after;
+    bool has_stats = fs_get_direct_io_stats(after);
+    if (has_stats && std::string(&buffer[0]) == content && after.cache_hits > before.cache_hits && after.pages_written > 0) {
+        std::cout << "  [SUCCESS] Hizasız eklemeler doğru okundu; " << after.cache_hits - before.cache_hits
+                  << " sayfa önbellekten geldi (RMW okuması: " << after.rmw_reads << ")." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] O_DIRECT okuma/yazma hatalı! (sayaçlar: " << has_stats << ", isabet: " << after.cache_hits << ")" << std::endl;
+    }
+
+    // Test 2: Önbellek yazarak-geçir çalışır; başka aygıt disk.sim'de aynı veriyi görür
+    std::cout << "\n[Test 2: Önbellek ve Disk Tutarlılığı]" << std::endl;
+    fs_mount(BLOCK_DEVICE_PREAD);
+    std::vector<char> pread_buffer(content.size() + 1, '\0');
+    fs_read("/direct.dat", 0, content.size(), &pread_buffer[0]);
+    DirectIoStats unused;
+    if (std::string(&pread_buffer[0]) == content && !fs_get_direct_io_stats(unused)) {
+        std::cout << "  [SUCCESS] O_DIRECT ile yazılan veri pread aygıtından da okundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] O_DIRECT yazmaları diske ulaşmadı!" << std::endl;
+    }
+
+    fs_format();
+    std::cout << "--- O_DIRECT Aygıtı ve Sayfa Önbelleği Testleri Bitti ---" << std::endl;
+}
+
+void test_multiple_volumes() {
+    std::cout << "\n--- Çoklu Cilt (FileSystem) Testleri Başlıyor ---" << std::endl;
+    const int num_tenants = 4;
+    std::string images[num_tenants];
+    for (int t = 0; t < num_tenants; ++t) {
+        images[t] = "tenant" + std::to_string(t) + ".sim";
+        std::remove(images[t].c_str());
+    }
+    fs_format();
+
+    // Test 1: Ciltler birbirinden ve varsayılan ciltten bağımsızdır
+    std::cout << "\n[Test 1: Cilt İzolasyonu]" << std::endl;
+    {
+        bool isolated = true;
+        std::vector<FileSystem*> tenants;
+        for (int t = 0; t < num_tenants; ++t) tenants.push_back(new FileSystem(images[t].c_str()));
+        for (int t = 0; t < num_tenants; ++t) {
+            std::string content(BLOCK_SIZE_BYTES * (t + 1) + 7, static_cast<char>('a' + t));
+            tenants[t]->call([] { fs_create("/ortak.dat"); });
+            if (tenants[t]->call([&content] { return fs_write("/ortak.dat", content.data(), static_cast<int64_t>(content.size())); }) !=
+                static_cast<int64_t>(content.size())) {
+                isolated = false;
+            }
+        }
+        for (int t = 0; t < num_tenants; ++t) {
+            FileSystem::Scope scope(*tenants[t]);
+            if (fs_size("/ortak.dat") != static_cast<int64_t>(BLOCK_SIZE_BYTES * (t + 1) + 7)) isolated = false;
+        }
+        if (fs_exists("/ortak.dat")) isolated = false; // Varsayılan cilt (disk.sim) etkilenmedi
+        if (isolated) {
+            std::cout << "  [SUCCESS] Aynı isimli dosyalar her cilt için ayrı tutuldu." << std::endl;
+        } else {
+            std::cout << "  [FAILURE] Ciltler arası izolasyon bozuk!" << std::endl;
+        }
+
+        // Test 2: Ortak asenkron havuz; işler gönderildikleri cilde yazar
+        std::cout << "\n[Test 2: Ortak Asenkron Havuz]" << std::endl;
+        std::string async_content(3 * BLOCK_SIZE_BYTES, 'z');
+        std::vector<std::future<int64_t> > writes;
+        for (int t = 0; t < num_tenants; ++t) {
+            FileSystem::Scope scope(*tenants[t]);
+            fs_create("/async.dat");
+            writes.push_back(fs_write_async("/async.dat", async_content.data(), static_cast<int64_t>(async_content.size())));
+        }
+        bool async_ok = true;
+        for (int t = 0; t < num_tenants; ++t) {
+            if (writes[t].get() != static_cast<int64_t>(async_content.size())) async_ok = false;
+            if (tenants[t]->call([] { return fs_size("/async.dat"); }) != static_cast<int64_t>(async_content.size())) async_ok = false;
+        }
+        if (async_ok && !fs_exists("/async.dat")) {
+            std::cout << "  [SUCCESS] " << num_tenants << " cildin asenkron yazmaları ortak havuzda doğru cilde gitti." << std::endl;
+        } else {
+            std::cout << "  [FAILURE] Asenkron yazmalar yanlış cilde gitti veya başarısız oldu!" << std::endl;
+        }
+        for (int t = 0; t < num_tenants; ++t) delete tenants[t]; // Bekleyen yazmalar diske gider
+    }
+
+    // Test 3: Yıkıcı veriyi diske yazar; aynı görüntü yeniden açılınca içerik görünür
+    std::cout << "\n[Test 3: Yeniden Açılış]" << std::endl;
+    FileSystem reopened(images[num_tenants - 1].c_str());
+    std::string expected(BLOCK_SIZE_BYTES * num_tenants + 7, static_cast<char>('a' + num_tenants - 1));
+    std::vector<char> buffer(expected.size() + 1, '\0');
+    reopened.call([&] { return fs_read("/ortak.dat", 0, static_cast<int64_t>(expected.size()), &buffer[0]); });
+    if (std::string(&buffer[0]) == expected && std::string(reopened.disk_filename()) == images[num_tenants - 1]) {
+        std::cout << "  [SUCCESS] Yeniden açılan cilt dosyayı okudu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Yeniden açılan ciltte veri kayıp!" << std::endl;
+    }
+
+    for (int t = 0; t < num_tenants; ++t) std::remove(images[t].c_str());
+    std::cout << "--- Çoklu Cilt (FileSystem) Testleri Bitti ---" << std::endl;
+}
+
+void test_striped_device() {
+    std::cout << "\n--- Şeritli Aygıt Testleri Başlıyor ---" << std::endl;
+    StripedDeviceOptions options;
+    options.stripe_unit_bytes = 4 * BLOCK_SIZE_BYTES;
+    for (int m = 0; m < 3; ++m) {
+        options.members.push_back("stripe" + std::to_string(m) + ".sim");
+        std::remove(options.members.back().c_str());
+    }
+    std::string content(100 * BLOCK_SIZE_BYTES + 33, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>('A' + (i / 7) % 26);
+
+    // Test 1: Üyeler oluşturulur; büyük dosya tüm üyelere dağılır ve doğru okunur
+    std::cout << "\n[Test 1: Şeritli Yazma ve Okuma]" << std::endl;
+    int rc = fs_mount_striped(options);
+    fs_create("/stripe.dat");
+    fs_write("/stripe.dat", content.data(), content.size());
+    fs_sync();
+    std::vector<char> buffer(content.size() + 1, '\0');
+    fs_read("/stripe.dat", 0, content.size(), &buffer[0]);
+    bool spread = true;
+    for (size_t m = 0; m < options.members.size(); ++m) {
+        std::ifstream member(options.members[m].c_str(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(member)), std::istreambuf_iterator<char>());
+        bool has_file_data = false; // İçerik 7'şerli aynı harf dizilerinden oluşur; metadata'da böyle bir dizi yok
+        for (char c = 'A'; c <= 'Z' && !has_file_data; ++c) has_file_data = bytes.find(std::string(7, c)) != std::string::npos;
+        if (!has_file_data) spread = false;
+    }
+    // Kapasite artmaz: veri alanı tek görüntününkiyle aynıdır (şeritleme yalnızca paralel G/Ç içindir).
+    FsStatfs st;
+    bool same_capacity = fs_statfs(st) == 0 && st.total_blocks == NUM_DATA_BLOCKS;
+    if (rc == 0 && fs_get_block_device() == BLOCK_DEVICE_STRIPED && std::string(&buffer[0]) == content && spread && same_capacity) {
+        std::cout << "  [SUCCESS] " << options.members.size() << " üyeli şeritli aygıtta dosya doğru okundu, veri tüm üyelere dağıldı"
+                  << " (kapasite tek görüntününki kadar)." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Şeritli aygıt hatalı! (bağlama: " << rc << ", üyelere dağılım: " << spread << ", kapasite: " << same_capacity << ")" << std::endl;
+    }
+
+    // Test 2: Başka aygıta geçip aynı üyelerle yeniden bağlanınca veri korunur
+    std::cout << "\n[Test 2: Yeniden Bağlama]" << std::endl;
+    fs_mount(BLOCK_DEVICE_PREAD);
+    bool hidden = !fs_exists("/stripe.dat");
+    rc = fs_mount(BLOCK_DEVICE_STRIPED); // Son şeritli seçeneklerle
+    std::vector<char> reread(content.size() + 1, '\0');
+    fs_read("/stripe.dat", 0, content.size(), &reread[0]);
+    if (rc == 0 && hidden && std::string(&reread[0]) == content) {
+        std::cout << "  [SUCCESS] Şeritli aygıt yeniden bağlandı, dosya korunmuş." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Yeniden bağlanan şeritli aygıtta veri kayıp!" << std::endl;
+    }
+
+    // Test 3: Geçersiz seçenekler ve farklı birimle oluşturulmuş üyeler reddedilir
+    std::cout << "\n[Test 3: Geçersiz Seçenekler]" << std::endl;
+    StripedDeviceOptions bad_unit = options;
+    bad_unit.stripe_unit_bytes = BLOCK_SIZE_BYTES + 1;
+    StripedDeviceOptions duplicate = options;
+    duplicate.members[1] = duplicate.members[0];
+    StripedDeviceOptions wrong_layout = options;
+    wrong_layout.members.pop_back(); // Üye boyutları iki üyeli yerleşime uymaz
+    int rc_unit = fs_mount_striped(bad_unit);
+    int rc_duplicate = fs_mount_striped(duplicate);
+    int rc_layout = fs_mount_striped(wrong_layout);
+    if (rc_unit == -1 && rc_duplicate == -1 && rc_layout == -2 && fs_get_block_device() == BLOCK_DEVICE_STRIPED && fs_exists("/stripe.dat")) {
+        std::cout << "  [SUCCESS] Hatalı seçenekler reddedildi, bağlı cilt değişmedi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Hatalı seçenekler kabul edildi! (" << rc_unit << ", " << rc_duplicate << ", " << rc_layout << ")" << std::endl;
+    }
+
+    fs_mount(BLOCK_DEVICE_PREAD);
+    for (size_t m = 0; m < options.members.size(); ++m) std::remove(options.members[m].c_str());
+    std::cout << "--- Şeritli Aygıt Testleri Bitti ---" << std::endl;
+}
+
+void test_file_handles() {
+    std::cout << "\n--- Tutamaç Tabanlı G/Ç Testleri Başlıyor ---" << std::endl;
+    fs_mkdir("/hdir");
+    fs_create("/hdir/h.dat");
+    std::string content(6 * BLOCK_SIZE_BYTES + 100, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>('a' + (i / 5) % 26);
+
+    // Test 1: Sıralı yazma ve parça parça okuma; dosya sonunda okuma 0 döner
+    std::cout << "\n[Test 1: Sıralı Yazma ve Okuma]" << std::endl;
+    int handle = fs_open("/hdir/h.dat");
+    bool writes_ok = handle >= 0;
+    for (size_t done = 0; done < content.size() && writes_ok; done += 300) {
+        int64_t chunk = std::min<int64_t>(300, content.size() - done);
+        writes_ok = fs_hwrite(handle, content.data() + done, chunk) == chunk;
+    }
+    int64_t end_position = fs_hseek(handle, 0, FS_SEEK_CUR);
+    fs_hseek(handle, 0, FS_SEEK_SET);
+    std::string read_back;
+    char chunk_buffer[700];
+    int64_t got = 0;
+    while ((got = fs_hread(handle, chunk_buffer, sizeof(chunk_buffer))) > 0) read_back.append(chunk_buffer, static_cast<size_t>(got));
+    if (writes_ok && end_position == static_cast<int64_t>(content.size()) && got == 0 && read_back == content &&
+        fs_size("/hdir/h.dat") == static_cast<int64_t>(content.size())) {
+        std::cout << "  [SUCCESS] " << content.size() << " byte tutamaçla yazıldı ve parça parça aynen okundu." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Tutamaçla okunan içerik farklı! (tutamaç: " << handle << ", konum: " << end_position << ", okunan: " << read_back.size() << ")" << std::endl;
+    }
+
+    // Test 2: Yerinde üzerine yazma, dosya sonunun ötesine yazma; yeniden adlandırma ve birleştirme sonrası tutamaç geçerli
+    std::cout << "\n[Test 2: Konumlu Yazma, Yeniden Adlandırma ve Birleştirme]" << std::endl;
+    fs_hseek(handle, BLOCK_SIZE_BYTES + 10, FS_SEEK_SET);
+    fs_hwrite(handle, "XYZ", 3);
+    content.replace(BLOCK_SIZE_BYTES + 10, 3, "XYZ");
+    // Blok kısmı ile paketlenmiş kuyruğu birlikte kapsayan üzerine yazma yerinde yapılır: yerleşim değişmez.
+    FileInfo before_overwrite = fs_get_file_info_debug("/hdir/h.dat");
+    fs_hseek(handle, content.size() - 104, FS_SEEK_SET);
+    fs_hwrite(handle, "TAILWRITE", 9);
+    content.replace(content.size() - 104, 9, "TAILWRITE");
+    FileInfo after_overwrite = fs_get_file_info_debug("/hdir/h.dat");
+    bool layout_kept = before_overwrite.start_data_block_index == after_overwrite.start_data_block_index &&
+                       before_overwrite.tail_block_index == after_overwrite.tail_block_index &&
+                       before_overwrite.tail_offset == after_overwrite.tail_offset;
+    fs_hseek(handle, 20, FS_SEEK_END);
+    fs_hwrite(handle, "END", 3);
+    content.append(20, '\0');
+    content.append("END");
+    fs_rename("/hdir/h.dat", "/hdir/renamed.dat");
+    fs_defragment();
+    std::vector<char> whole(content.size() + 1, '\0');
+    fs_hseek(handle, 0, FS_SEEK_SET);
+    int64_t whole_read = fs_hread(handle, &whole[0], content.size() + 50);
+    std::vector<char> by_name(content.size() + 1, '\0');
+    fs_read("/hdir/renamed.dat", 0, content.size(), &by_name[0]);
+    if (layout_kept && whole_read == static_cast<int64_t>(content.size()) && std::string(whole.begin(), whole.end() - 1) == content &&
+        std::string(by_name.begin(), by_name.end() - 1) == content) {
+        std::cout << "  [SUCCESS] Konumlu yazmalar doğru; tutamaç yeniden adlandırma ve birleştirmeden sonra da doğru okuyor." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Konumlu yazma veya önbellek tazeleme hatalı! (okunan: " << whole_read << ", yerleşim korundu: " << layout_kept << ")" << std::endl;
+    }
+
+    // Test 3: Silinen dosyanın tutamacı geçersizleşir, kapatılabilir; geçersiz tutamaçlar reddedilir
+    std::cout << "\n[Test 3: Geçersiz Tutamaçlar]" << std::endl;
+    fs_delete("/hdir/renamed.dat");
+    int64_t stale_read = fs_hread(handle, chunk_buffer, 10);
+    int close_stale = fs_close(handle);
+    int close_again = fs_close(handle);
+    int open_missing = fs_open("/hdir/renamed.dat");
+    int open_dir = fs_open("/hdir");
+    if (stale_read == -12 && close_stale == 0 && close_again == -12 && open_missing == -5 && open_dir == -10 &&
+        fs_hseek(FS_MAX_OPEN_FILES, 0, FS_SEEK_SET) == -12) {
+        std::cout << "  [SUCCESS] Silinen dosyanın tutamacı geçersizleşti, hatalı tutamaç ve yollar reddedildi." << std::endl;
+    } else {
+        std::cout << "  [FAILURE] Geçersiz tutamaç kabul edildi! (" << stale_read << ", " << close_stale << ", " << close_again
+                  << ", " << open_missing << ", " << open_dir << ")" << std::endl;
+    }
+
+    fs_rmdir("/hdir");
+    std::cout << "--- Tutamaç Tabanlı G/Ç Testleri Bitti ---" << std::endl;
+}
+
 void display_menu() {
     std::cout << "\n===== SimpleFS Kullanıcı Arayüzü =====" << std::endl;
     std::cout << "1.  Dosya Oluştur (fs_create)" << std::endl;
@@ -1907,11 +3828,20 @@ void display_menu() {
     std::cout << "16. İki Dosyayı Karşılaştır (fs_diff)" << std::endl;
     std::cout << "17. Diski Formatla (fs_format)" << std::endl;
     std::cout << "18. Dosya Sistemini Başlat (fs_init)" << std::endl;
+    std::cout << "19. Dizin Oluştur (fs_mkdir)" << std::endl;
+    std::cout << "20. Dizin Sil (fs_rmdir)" << std::endl;
+    std::cout << "21. Dizin İçeriğini Listele (fs_readdir)" << std::endl;
+    std::cout << "22. Dosya İçin Yer Ayır (fs_fallocate)" << std::endl;
+    std::cout << "23. Bekleyen Yazmaları Diske Yaz (fs_sync)" << std::endl;
+    std::cout << "24. Artımlı Birleştirme Adımı (fs_defragment_step)" << std::endl;
+    std::cout << "25. Arka Plan Birleştirmeyi Başlat/Durdur" << std::endl;
+    std::cout << "26. Hedefli Birleştirme Planı (fs_defragment_to_target)" << std::endl;
+    std::cout << "27. Parçalanma Raporu (fs_frag_report)" << std::endl;
     std::cout << "0.  Çıkış" << std::endl;
     std::cout << "Lütfen bir işlem seçin: ";
 }
 
-int main() {
+int main(int argc, char** argv) {
     // fs_init(); // Disk dosyasının var olduğundan emin olmak için başlangıçta çağrılabilir.
                 // Ancak formatlama veya diğer testler disk.sim'i zaten oluşturabilir/yönetebilir.
                 // Kullanıcı menüden 18'i seçerek de başlatabilir.
@@ -1936,18 +3866,78 @@ int main() {
     // test_backup_operations();
     // test_restore_operations();
     //test_diff_operations();
+    // test_directory_operations();
+    // test_inline_data();
+    // test_tail_packing();
+    // test_size_class_allocation();
+    // test_buddy_allocator();
+    // test_allocation_groups();
+    // test_statfs();
+    // test_fallocate();
+    // test_delayed_allocation();
+    // test_placement_hints();
+    // test_incremental_defrag();
+    // test_defrag_planner();
+    // test_bulk_block_moves();
+    // test_frag_report();
+    // test_concurrent_access();
+    // test_lock_free_allocation();
+    // test_async_io();
+    // test_io_uring_backend();
+    // test_block_devices();
+    // test_ram_disk();
+    // test_direct_io();
+    // test_multiple_volumes();
+    // test_striped_device();
+    // test_file_handles();
 
 
     int choice;
     char filename1[MAX_FILENAME_LENGTH + 1];
     char filename2[MAX_FILENAME_LENGTH + 1];
     char data_buffer[MAX_FILE_SIZE_FOR_USER_INPUT + 1]; // Yazma ve okuma için buffer. Yeni sabit kullanıldı.
-    int size, offset, new_size_truncate;
+    int64_t size, offset, new_size_truncate; // 64-bit API ile uyumlu
 
     // Diski başlat (fs_init içindeki disk.sim yoksa oluşturur ve fs_log için gerekli)
     // Eğer disk.sim yoksa ve formatlanmamışsa bazı işlemler hata verebilir.
     // Kullanıcının bilinçli olarak formatlaması veya init yapması beklenebilir.
     // Şimdilik, program başlarken temel bir başlatma yapalım.
+    // Komut satırı seçenekleri (fs_init'ten önce, disk.sim gereksiz yere oluşturulmasın diye):
+    //   --ram            Disk bellekte açılır, disk.sim'e dokunulmaz
+    //   --ram=<görüntü>  RAM diski görüntüden yüklenir (yoksa boş başlar), fs_sync ve çıkışta görüntüye geri yazılır
+    //   --stripe=<üye1>,<üye2>,...  Disk üye dosyalarına şeritlenir (varsayılan şerit birimi; üye yoksa oluşturulur)
+    //   --no-log         fs.log'a yazılmaz
+    // Böylece testler ayrı süreçlerde, ortak disk.sim/fs.log dosyalarını paylaşmadan paralel çalıştırılabilir.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--no-log") fs_set_log_file(nullptr); // Bağlama mesajları da loglanmasın
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string option(argv[i]);
+        if (option == "--no-log") {
+            continue;
+        } else if (option == "--ram" || option.compare(0, 6, "--ram=") == 0) {
+            RamDiskOptions ram_options;
+            std::string image = option.size() > 6 ? option.substr(6) : "";
+            std::ifstream existing(image.c_str(), std::ios::binary);
+            if (!image.empty() && existing) ram_options.load_image = image.c_str();
+            if (!image.empty()) ram_options.dump_image = image.c_str();
+            existing.close();
+            if (fs_mount_ram(ram_options) != 0) return 1;
+        } else if (option.compare(0, 9, "--stripe=") == 0) {
+            StripedDeviceOptions striped_options;
+            std::string members = option.substr(9);
+            for (size_t start = 0; start <= members.size(); ) {
+                size_t comma = members.find(',', start);
+                if (comma == std::string::npos) comma = members.size();
+                striped_options.members.push_back(members.substr(start, comma - start));
+                start = comma + 1;
+            }
+            if (fs_mount_striped(striped_options) != 0) return 1;
+        } else {
+            std::cerr << "Bilinmeyen seçenek: " << option << std::endl;
+            return 1;
+        }
+    }
     fs_init(); // fs_log'un çalışması için log dosyasının oluşturulması gerekebilir, fs_init bunu yapabilir.
 
 
@@ -2090,15 +4080,106 @@ int main() {
                 std::cin.getline(filename2, MAX_FILENAME_LENGTH);
                 fs_diff(filename1, filename2);
                 break;
-            case 17: // fs_format
-                fs_format();
+            case 17: { // fs_format
+                int allocator_mode = ALLOCATOR_BITMAP_FIRST_FIT;
+                std::cout << "Tahsis motoru (0: bitmap first-fit, 1: buddy): ";
+                std::cin >> allocator_mode;
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Temizle
+                fs_format(allocator_mode);
                 std::cout << "Dosya sistemi başarıyla formatlandı." << std::endl;
                 break;
+            }
             case 18: // fs_init
                 fs_init();
                 std::cout << "Dosya sistemi başarıyla başlatıldı." << std::endl;
                 break;
+            case 19: // fs_mkdir
+                std::cout << "Oluşturulacak dizin yolu: ";
+                std::cin.getline(filename1, MAX_FILENAME_LENGTH);
+                fs_mkdir(filename1);
+                break;
+            case 20: // fs_rmdir
+                std::cout << "Silinecek dizin yolu: ";
+                std::cin.getline(filename1, MAX_FILENAME_LENGTH);
+                fs_rmdir(filename1);
+                break;
+            case 21: { // fs_readdir
+                std::cout << "Listelenecek dizin yolu: ";
+                std::cin.getline(filename1, MAX_FILENAME_LENGTH);
+                std::vector<std::string> entries;
+                if (fs_readdir(filename1, entries) == 0) {
+                    for (const auto& entry : entries) {
+                        std::cout << "  " << entry << std::endl;
+                    }
+                    std::cout << entries.size() << " girdi." << std::endl;
+                } else {
+                    std::cout << "Hata: Dizin okunamadı." << std::endl;
+                }
+                break;
+            }
+            case 22: // fs_fallocate
+                std::cout << "Yer ayrılacak dosya adı: ";
+                std::cin.getline(filename1, MAX_FILENAME_LENGTH);
+                std::cout << "Ayrılacak boyut (byte): ";
+                std::cin >> size;
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Temizle
+                if (fs_fallocate(filename1, size) == 0) {
+                    std::cout << "Yer başarıyla ayrıldı." << std::endl;
+                }
+                break;
+            case 23: // fs_sync
+                if (fs_sync() == 0) {
+                    std::cout << "Bekleyen yazmalar diske yazıldı." << std::endl;
+                }
+                break;
+            case 24: { // fs_defragment_step
+                std::cout << "Adım başına taşınacak en fazla byte (0: sınırsız): ";
+                std::cin >> size;
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Temizle
+                int step_result = fs_defragment_step(size, 0);
+                DefragProgress progress;
+                if (step_result >= 0 && fs_get_defrag_progress(progress)) {
+                    std::cout << (step_result == 1 ? "Geçiş tamamlandı." : "Geçiş devam ediyor.") << " İmleç: " << progress.cursor
+                              << ", toplam taşınan: " << progress.files_moved << " extent / " << progress.bytes_moved << " byte." << std::endl;
+                }
+                break;
+            }
+            case 25: // Arka plan birleştirme
+                if (fs_defrag_background_running()) {
+                    fs_defrag_stop_background();
+                    std::cout << "Arka plan birleştirme durduruldu." << std::endl;
+                } else if (fs_defrag_start_background(64 * 1024, 20, 100) == 0) {
+                    std::cout << "Arka plan birleştirme başlatıldı (adım başına 64 KB / 20 ms)." << std::endl;
+                }
+                break;
+            case 26: { // fs_defragment_to_target
+                std::cout << "Gereken en büyük boş alan (blok, 0: sıfır parçalanma): ";
+                std::cin >> size;
+                std::cout << "Sadece raporla? (1: evet, 0: uygula): ";
+                int dry_run = 1;
+                std::cin >> dry_run;
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Temizle
+                if (size < 0) {
+                    std::cout << "Hata: Blok sayısı negatif olamaz." << std::endl;
+                    break;
+                }
+                int target = size == 0 ? DEFRAG_TARGET_ZERO_FRAGMENTATION : DEFRAG_TARGET_FREE_EXTENT;
+                if (fs_defragment_to_target(target, static_cast<uint32_t>(size), dry_run != 0) == 0 && dry_run == 0) {
+                    std::cout << "Plan uygulandı." << std::endl;
+                }
+                break;
+            }
+            case 27: { // fs_frag_report
+                std::cout << "Çıktı biçimi (1: tablo, 2: JSON): ";
+                int format = FRAG_REPORT_TEXT;
+                std::cin >> format;
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Temizle
+                FragReport report;
+                fs_frag_report(report, format == 2 ? FRAG_REPORT_JSON : FRAG_REPORT_TEXT);
+                break;
+            }
             case 0: // Çıkış
+                fs_unmount(); // Tamponda kalan veriler kaybolmasın
                 std::cout << "\nProgramdan çıkılıyor." << std::endl;
                 return 0;
             default: